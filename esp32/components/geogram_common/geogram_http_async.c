@@ -0,0 +1,174 @@
+#include "geogram_http_async.h"
+#include "geogram_http_metrics.h"
+#include "geogram_metrics.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+
+#ifndef CONFIG_GEOGRAM_HTTP_ASYNC_WORKERS
+#define CONFIG_GEOGRAM_HTTP_ASYNC_WORKERS   2
+#endif
+#ifndef CONFIG_GEOGRAM_HTTP_ASYNC_QUEUE
+#define CONFIG_GEOGRAM_HTTP_ASYNC_QUEUE     3
+#endif
+
+// Handlers stream in pooled buffers; nothing large lives on the stack
+#define WORKER_STACK_SIZE   8192
+// Same priority as the httpd task
+#define WORKER_PRIORITY     5
+
+typedef struct {
+    httpd_req_t *req;
+    geo_http_async_handler_t handler;
+    geo_http_metrics_span_t span;
+} async_job_t;
+
+static const char *TAG = "http_async";
+
+static QueueHandle_t s_queue = NULL;
+static TaskHandle_t s_workers[CONFIG_GEOGRAM_HTTP_ASYNC_WORKERS > 0 ? CONFIG_GEOGRAM_HTTP_ASYNC_WORKERS : 1];
+static geo_http_async_stats_t s_stats = {0};
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static geo_metric_t *s_metric_deferred = NULL;
+static geo_metric_t *s_metric_rejected = NULL;
+static geo_metric_t *s_metric_queued = NULL;
+static geo_metric_t *s_metric_busy = NULL;
+
+static void collect_metrics(void)
+{
+    geo_http_async_stats_t stats;
+    geo_http_async_get_stats(&stats);
+    geo_metric_set(s_metric_deferred, stats.deferred);
+    geo_metric_set(s_metric_rejected, stats.rejected);
+    geo_metric_set(s_metric_queued, stats.queued);
+    geo_metric_set(s_metric_busy, stats.busy);
+}
+
+static void worker_task(void *arg)
+{
+    async_job_t job;
+    while (true) {
+        if (xQueueReceive(s_queue, &job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        taskENTER_CRITICAL(&s_stats_lock);
+        s_stats.busy++;
+        taskEXIT_CRITICAL(&s_stats_lock);
+
+        if (geo_http_metrics_resume(&job.span, job.req, job.handler) != ESP_OK) {
+            // httpd closes the connection when a handler fails; do the same
+            httpd_sess_trigger_close(job.req->handle, httpd_req_to_sockfd(job.req));
+        }
+        httpd_req_async_handler_complete(job.req);
+
+        taskENTER_CRITICAL(&s_stats_lock);
+        s_stats.busy--;
+        taskEXIT_CRITICAL(&s_stats_lock);
+    }
+}
+
+esp_err_t geo_http_async_init(void)
+{
+    if (s_queue != NULL || CONFIG_GEOGRAM_HTTP_ASYNC_WORKERS == 0) {
+        return ESP_OK;
+    }
+
+    s_queue = xQueueCreate(CONFIG_GEOGRAM_HTTP_ASYNC_QUEUE, sizeof(async_job_t));
+    if (s_queue == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (int i = 0; i < CONFIG_GEOGRAM_HTTP_ASYNC_WORKERS; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "http_async%d", i);
+        if (xTaskCreate(worker_task, name, WORKER_STACK_SIZE, NULL, WORKER_PRIORITY,
+                        &s_workers[i]) != pdPASS) {
+            // Workers already started keep serving the queue
+            ESP_LOGE(TAG, "Failed to start worker %d", i);
+            return i > 0 ? ESP_OK : ESP_ERR_NO_MEM;
+        }
+    }
+
+    s_metric_deferred = geo_metric_counter("geogram_http_async_deferred_total", NULL,
+                                           "Requests handed to an HTTP worker");
+    s_metric_rejected = geo_metric_counter("geogram_http_async_rejected_total", NULL,
+                                           "Requests refused because all workers were busy");
+    s_metric_queued = geo_metric_gauge("geogram_http_async_queued", NULL,
+                                       "Requests waiting for an HTTP worker");
+    s_metric_busy = geo_metric_gauge("geogram_http_async_busy", NULL,
+                                     "HTTP workers running a handler");
+    geo_metrics_register_collector(collect_metrics);
+
+    ESP_LOGI(TAG, "HTTP worker pool: %d workers, queue of %d",
+             CONFIG_GEOGRAM_HTTP_ASYNC_WORKERS, CONFIG_GEOGRAM_HTTP_ASYNC_QUEUE);
+    return ESP_OK;
+}
+
+bool geo_http_async_in_worker(void)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < CONFIG_GEOGRAM_HTTP_ASYNC_WORKERS; i++) {
+        if (s_workers[i] != NULL && s_workers[i] == self) {
+            return true;
+        }
+    }
+    return false;
+}
+
+esp_err_t geo_http_async_defer(httpd_req_t *req, geo_http_async_handler_t handler)
+{
+    if (s_queue == NULL || geo_http_async_in_worker()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Only the httpd task queues jobs, so a free slot now is still free below.
+    // Checking first keeps the original request usable for a 503.
+    if (uxQueueSpacesAvailable(s_queue) == 0) {
+        taskENTER_CRITICAL(&s_stats_lock);
+        s_stats.rejected++;
+        taskEXIT_CRITICAL(&s_stats_lock);
+        ESP_LOGW(TAG, "Workers busy, refusing %s", req->uri);
+        return ESP_ERR_NO_MEM;
+    }
+
+    async_job_t job = { .handler = handler };
+    esp_err_t ret = httpd_req_async_handler_begin(req, &job.req);
+    if (ret != ESP_OK) {
+        return ret == ESP_ERR_NO_MEM ? ESP_ERR_NO_MEM : ESP_ERR_INVALID_STATE;
+    }
+    // The worker carries on timing the request from here
+    geo_http_metrics_handoff(&job.span);
+    if (xQueueSend(s_queue, &job, 0) != pdTRUE) {
+        httpd_req_async_handler_complete(job.req);
+        return ESP_ERR_NO_MEM;
+    }
+
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_stats.deferred++;
+    taskEXIT_CRITICAL(&s_stats_lock);
+    return ESP_OK;
+}
+
+esp_err_t geo_http_send_busy(httpd_req_t *req)
+{
+    httpd_resp_set_status(req, "503 Service Unavailable");
+    httpd_resp_set_type(req, "text/plain");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    httpd_resp_set_hdr(req, "Retry-After", "1");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    return httpd_resp_sendstr(req, "Server busy");
+}
+
+void geo_http_async_get_stats(geo_http_async_stats_t *stats)
+{
+    taskENTER_CRITICAL(&s_stats_lock);
+    *stats = s_stats;
+    taskEXIT_CRITICAL(&s_stats_lock);
+    stats->queued = s_queue != NULL ? (uint32_t)uxQueueMessagesWaiting(s_queue) : 0;
+}
@@ -0,0 +1,146 @@
+#include "geogram_http_metrics.h"
+#include "geogram_metrics.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <sys/socket.h>
+#include "sdkconfig.h"
+#include "esp_timer.h"
+
+// Sent-byte counters, indexed by socket number (lwIP hands out few)
+#define GEO_HTTP_METRICS_FDS    32
+
+typedef struct {
+    esp_err_t (*handler)(httpd_req_t *req);
+    void *user_ctx;
+    geo_metric_t *requests;
+    geo_metric_t *errors;
+    geo_metric_t *bytes;
+    geo_metric_t *latency;
+} endpoint_t;
+
+// Request being handled on the httpd task (handlers never nest)
+typedef struct {
+    endpoint_t *endpoint;
+    int64_t start_us;
+    bool handed_off;
+} current_t;
+
+static current_t s_current;
+static volatile uint32_t s_fd_sent[GEO_HTTP_METRICS_FDS];
+
+static uint32_t fd_sent(int fd)
+{
+    return fd >= 0 ? s_fd_sent[fd % GEO_HTTP_METRICS_FDS] : 0;
+}
+
+/**
+ * @brief httpd's default send, plus a per-socket byte count
+ */
+static int counting_send(httpd_handle_t hd, int sockfd, const char *buf, size_t buf_len, int flags)
+{
+    (void)hd;
+    if (buf == NULL) {
+        return HTTPD_SOCK_ERR_INVALID;
+    }
+    int ret = send(sockfd, buf, buf_len, flags);
+    if (ret < 0) {
+        return (errno == EAGAIN || errno == EINTR) ? HTTPD_SOCK_ERR_TIMEOUT : HTTPD_SOCK_ERR_FAIL;
+    }
+    if (sockfd >= 0) {
+        s_fd_sent[sockfd % GEO_HTTP_METRICS_FDS] += (uint32_t)ret;
+    }
+    return ret;
+}
+
+static void record(endpoint_t *ep, esp_err_t ret, int64_t start_us, uint32_t sent)
+{
+    geo_metric_add(ep->requests, 1);
+    if (ret != ESP_OK) {
+        geo_metric_add(ep->errors, 1);
+    }
+    geo_metric_add(ep->bytes, sent);
+    geo_metric_observe_us(ep->latency, esp_timer_get_time() - start_us);
+}
+
+static esp_err_t measured_handler(httpd_req_t *req)
+{
+    endpoint_t *ep = req->user_ctx;
+    req->user_ctx = ep->user_ctx;
+
+    int fd = httpd_req_to_sockfd(req);
+    httpd_sess_set_send_override(req->handle, fd, counting_send);
+    uint32_t sent = fd_sent(fd);
+
+    s_current = (current_t){ .endpoint = ep, .start_us = esp_timer_get_time() };
+    esp_err_t ret = ep->handler(req);
+    if (!s_current.handed_off) {
+        record(ep, ret, s_current.start_us, fd_sent(fd) - sent);
+    }
+    s_current.endpoint = NULL;
+    return ret;
+}
+
+esp_err_t geo_http_register_uri(httpd_handle_t server, const httpd_uri_t *uri)
+{
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+    if (uri->is_websocket) {
+        return httpd_register_uri_handler(server, uri);
+    }
+#endif
+
+    endpoint_t *ep = calloc(1, sizeof(endpoint_t));
+    if (ep == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    ep->handler = uri->handler;
+    ep->user_ctx = uri->user_ctx;
+
+    char labels[GEO_METRICS_LABELS_MAX];
+    snprintf(labels, sizeof(labels), "handler=\"%s\",method=\"%s\"",
+             uri->uri, http_method_str(uri->method));
+    ep->requests = geo_metric_counter("geogram_http_requests_total", labels,
+                                      "HTTP requests handled");
+    ep->errors = geo_metric_counter("geogram_http_request_errors_total", labels,
+                                    "HTTP handlers that failed (connection dropped)");
+    ep->bytes = geo_metric_counter("geogram_http_response_bytes_total", labels,
+                                   "Bytes sent in HTTP responses, headers included");
+    ep->latency = geo_metric_histogram("geogram_http_request_duration_seconds", labels,
+                                       "Time from handler start to response sent");
+
+    httpd_uri_t measured = *uri;
+    measured.handler = measured_handler;
+    measured.user_ctx = ep;
+    esp_err_t ret = httpd_register_uri_handler(server, &measured);
+    if (ret != ESP_OK) {
+        // Metrics stay registered (they cannot be removed) but read zero
+        free(ep);
+    }
+    return ret;
+}
+
+void geo_http_metrics_handoff(geo_http_metrics_span_t *span)
+{
+    span->endpoint = s_current.endpoint;
+    span->start_us = s_current.start_us;
+    if (s_current.endpoint != NULL) {
+        s_current.handed_off = true;
+    }
+}
+
+esp_err_t geo_http_metrics_resume(const geo_http_metrics_span_t *span, httpd_req_t *req,
+                                  esp_err_t (*handler)(httpd_req_t *req))
+{
+    endpoint_t *ep = span->endpoint;
+    if (ep == NULL) {
+        return handler(req);
+    }
+
+    int fd = httpd_req_to_sockfd(req);
+    uint32_t sent = fd_sent(fd);
+    esp_err_t ret = handler(req);
+    record(ep, ret, span->start_us, fd_sent(fd) - sent);
+    return ret;
+}
@@ -0,0 +1,327 @@
+#include "geogram_http_util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdbool.h>
+#include <limits.h>
+#include "freertos/FreeRTOS.h"
+
+// Pooled buffers; enough for the HTTP task plus a few async workers
+#define GEO_HTTP_POOL_COUNT     4
+
+// Largest response head accepted by geo_http_send_head()
+#define GEO_HTTP_HEAD_MAX       512
+
+// Longest If-None-Match / If-Modified-Since value examined
+#define GEO_HTTP_VALIDATOR_MAX  256
+
+static void *s_pool[GEO_HTTP_POOL_COUNT];
+static bool s_pool_busy[GEO_HTTP_POOL_COUNT];
+static portMUX_TYPE s_pool_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void *geo_http_buf_acquire(void)
+{
+    int slot = -1;
+
+    taskENTER_CRITICAL(&s_pool_lock);
+    for (int i = 0; i < GEO_HTTP_POOL_COUNT; i++) {
+        if (!s_pool_busy[i]) {
+            s_pool_busy[i] = true;
+            slot = i;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&s_pool_lock);
+
+    if (slot < 0) {
+        return malloc(GEO_HTTP_CHUNK_SIZE);
+    }
+
+    // Pool buffers are allocated on first use and never freed
+    if (s_pool[slot] == NULL) {
+        s_pool[slot] = malloc(GEO_HTTP_CHUNK_SIZE);
+        if (s_pool[slot] == NULL) {
+            taskENTER_CRITICAL(&s_pool_lock);
+            s_pool_busy[slot] = false;
+            taskEXIT_CRITICAL(&s_pool_lock);
+            return NULL;
+        }
+    }
+    return s_pool[slot];
+}
+
+void geo_http_buf_release(void *buf)
+{
+    if (buf == NULL) {
+        return;
+    }
+
+    for (int i = 0; i < GEO_HTTP_POOL_COUNT; i++) {
+        if (s_pool[i] == buf) {
+            taskENTER_CRITICAL(&s_pool_lock);
+            s_pool_busy[i] = false;
+            taskEXIT_CRITICAL(&s_pool_lock);
+            return;
+        }
+    }
+    free(buf);
+}
+
+/**
+ * @brief Append "Name: value" lines and the blank line ending the head
+ * @return New length, or -1 if the head does not fit
+ */
+static int finish_head(char *head, int len, const geo_http_header_t *headers, size_t header_count)
+{
+    for (size_t i = 0; i < header_count && len > 0 && len < GEO_HTTP_HEAD_MAX; i++) {
+        len += snprintf(head + len, GEO_HTTP_HEAD_MAX - len, "%s: %s\r\n",
+                        headers[i].name, headers[i].value);
+    }
+    if (len > 0 && len < GEO_HTTP_HEAD_MAX) {
+        len += snprintf(head + len, GEO_HTTP_HEAD_MAX - len, "\r\n");
+    }
+    return (len > 0 && len < GEO_HTTP_HEAD_MAX) ? len : -1;
+}
+
+esp_err_t geo_http_send_head(httpd_req_t *req, const char *status, const char *content_type,
+                             size_t content_length, const geo_http_header_t *headers,
+                             size_t header_count)
+{
+    char head[GEO_HTTP_HEAD_MAX];
+    int len = snprintf(head, sizeof(head),
+                       "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %u\r\n",
+                       status, content_type, (unsigned)content_length);
+    len = finish_head(head, len, headers, header_count);
+    if (len < 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    return geo_http_send_body(req, head, (size_t)len);
+}
+
+esp_err_t geo_http_send_body(httpd_req_t *req, const void *data, size_t len)
+{
+    const char *p = data;
+    while (len > 0) {
+        // Short writes are possible; a timeout means the client stalled
+        int sent = httpd_send(req, p, len);
+        if (sent <= 0) {
+            return ESP_FAIL;
+        }
+        p += sent;
+        len -= (size_t)sent;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Weak comparison of one entity tag against the current one
+ */
+static bool etag_matches(const char *tag, size_t tag_len, const char *etag)
+{
+    if (tag_len >= 2 && strncmp(tag, "W/", 2) == 0) {
+        tag += 2;
+        tag_len -= 2;
+    }
+    const char *cur = etag;
+    if (strncmp(cur, "W/", 2) == 0) {
+        cur += 2;
+    }
+    return strlen(cur) == tag_len && strncmp(tag, cur, tag_len) == 0;
+}
+
+bool geo_http_not_modified(httpd_req_t *req, const char *etag, time_t last_modified)
+{
+    char value[GEO_HTTP_VALIDATOR_MAX];
+
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", value, sizeof(value)) == ESP_OK) {
+        // If-None-Match wins over If-Modified-Since even when it does not match
+        if (etag == NULL) {
+            return false;
+        }
+        const char *p = value;
+        while (*p != '\0') {
+            while (*p == ' ' || *p == '\t' || *p == ',') {
+                p++;
+            }
+            const char *start = p;
+            while (*p != '\0' && *p != ',') {
+                p++;
+            }
+            const char *end = p;
+            while (end > start && (end[-1] == ' ' || end[-1] == '\t')) {
+                end--;
+            }
+            if ((end - start == 1 && *start == '*') ||
+                (end > start && etag_matches(start, (size_t)(end - start), etag))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    if (last_modified != 0 &&
+        httpd_req_get_hdr_value_str(req, "If-Modified-Since", value, sizeof(value)) == ESP_OK) {
+        time_t since = geo_http_parse_date(value);
+        return since != 0 && last_modified <= since;
+    }
+
+    return false;
+}
+
+static bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/**
+ * @brief Check an If-Range value (entity tag or date) against the resource
+ */
+static bool if_range_current(const char *value, const char *etag, time_t last_modified)
+{
+    if (value[0] == '"' || strncmp(value, "W/", 2) == 0) {
+        // If-Range requires a strong match
+        return etag != NULL && strncmp(etag, "W/", 2) != 0 && strcmp(value, etag) == 0;
+    }
+    return last_modified != 0 && geo_http_parse_date(value) == last_modified;
+}
+
+geo_http_range_t geo_http_get_range(httpd_req_t *req, size_t size, const char *etag,
+                                    time_t last_modified, size_t *first, size_t *last)
+{
+    char value[GEO_HTTP_VALIDATOR_MAX];
+
+    if (httpd_req_get_hdr_value_str(req, "Range", value, sizeof(value)) != ESP_OK ||
+        strncmp(value, "bytes=", 6) != 0) {
+        return GEO_HTTP_RANGE_NONE;
+    }
+
+    char if_range[GEO_HTTP_VALIDATOR_MAX];
+    if (httpd_req_get_hdr_value_str(req, "If-Range", if_range, sizeof(if_range)) == ESP_OK &&
+        !if_range_current(if_range, etag, last_modified)) {
+        // Client's partial copy is stale; it needs the whole resource
+        return GEO_HTTP_RANGE_NONE;
+    }
+
+    const char *spec = value + 6;
+    while (*spec == ' ') {
+        spec++;
+    }
+    if (strchr(spec, ',') != NULL) {
+        return GEO_HTTP_RANGE_NONE;
+    }
+
+    char *end;
+    unsigned long long from, to;
+    if (*spec == '-') {
+        // Last N bytes
+        if (!is_digit(spec[1])) {
+            return GEO_HTTP_RANGE_NONE;
+        }
+        unsigned long long suffix = strtoull(spec + 1, &end, 10);
+        if (suffix == 0 || size == 0) {
+            return GEO_HTTP_RANGE_UNSATISFIABLE;
+        }
+        from = suffix >= size ? 0 : size - suffix;
+        to = size - 1;
+    } else {
+        if (!is_digit(spec[0])) {
+            return GEO_HTTP_RANGE_NONE;
+        }
+        from = strtoull(spec, &end, 10);
+        if (*end != '-') {
+            return GEO_HTTP_RANGE_NONE;
+        }
+        end++;
+        to = ULLONG_MAX;
+        if (is_digit(*end)) {
+            to = strtoull(end, &end, 10);
+            if (to < from) {
+                return GEO_HTTP_RANGE_NONE;
+            }
+        }
+        if (from >= size) {
+            return GEO_HTTP_RANGE_UNSATISFIABLE;
+        }
+        if (to >= size) {
+            to = size - 1;
+        }
+    }
+    while (*end == ' ') {
+        end++;
+    }
+    if (*end != '\0') {
+        return GEO_HTTP_RANGE_NONE;
+    }
+
+    *first = (size_t)from;
+    *last = (size_t)to;
+    return GEO_HTTP_RANGE_PARTIAL;
+}
+
+esp_err_t geo_http_send_not_modified(httpd_req_t *req, const char *etag, time_t last_modified,
+                                     const geo_http_header_t *headers, size_t header_count)
+{
+    char head[GEO_HTTP_HEAD_MAX];
+    int len = snprintf(head, sizeof(head), "HTTP/1.1 304 Not Modified\r\n");
+    if (etag != NULL) {
+        len += snprintf(head + len, sizeof(head) - len, "ETag: %s\r\n", etag);
+    }
+    if (last_modified != 0) {
+        char date[GEO_HTTP_DATE_LEN];
+        geo_http_format_date(last_modified, date, sizeof(date));
+        len += snprintf(head + len, sizeof(head) - len, "Last-Modified: %s\r\n", date);
+    }
+    len = finish_head(head, len, headers, header_count);
+    if (len < 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    return geo_http_send_body(req, head, (size_t)len);
+}
+
+void geo_http_format_date(time_t t, char *buf, size_t size)
+{
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    strftime(buf, size, "%a, %d %b %Y %H:%M:%S GMT", &tm);
+}
+
+time_t geo_http_parse_date(const char *s)
+{
+    static const char *const months[] = {
+        "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+    };
+
+    char wday[4];
+    char mon[4];
+    int day, year, hour, min, sec;
+    if (s == NULL ||
+        sscanf(s, "%3s, %d %3s %d %d:%d:%d", wday, &day, mon, &year, &hour, &min, &sec) != 7) {
+        return 0;
+    }
+
+    int m = -1;
+    for (int i = 0; i < 12; i++) {
+        if (strcasecmp(mon, months[i]) == 0) {
+            m = i + 1;
+            break;
+        }
+    }
+    if (m < 0 || day < 1 || day > 31 || year < 1970 ||
+        hour > 23 || min > 59 || sec > 60) {
+        return 0;
+    }
+
+    // Days since 1970-01-01 (civil calendar, no timezone involved)
+    int y = year - (m <= 2);
+    int era = y / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    long days = (long)era * 146097 + doe - 719468;
+
+    return (time_t)(days * 86400L + hour * 3600L + min * 60L + sec);
+}
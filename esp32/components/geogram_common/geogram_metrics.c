@@ -0,0 +1,344 @@
+#include "geogram_metrics.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_heap_caps.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+
+// Collectors registered by components (tiles, updates, mesh, WebSocket...)
+#define GEO_METRICS_MAX_COLLECTORS  12
+
+// Longest rendered line: name, labels, le and value
+#define GEO_METRICS_LINE_MAX        192
+
+static const int64_t s_bucket_us[GEO_METRICS_BUCKET_COUNT] = GEO_METRICS_BUCKETS_US;
+static const char *const s_bucket_le[GEO_METRICS_BUCKET_COUNT] = {
+    "0.001", "0.005", "0.01", "0.025", "0.05", "0.1",
+    "0.25", "0.5", "1", "2.5", "5", "10",
+};
+
+typedef struct {
+    uint32_t buckets[GEO_METRICS_BUCKET_COUNT + 1];     // Last one is +Inf
+    uint64_t sum_us;
+    uint32_t count;
+} geo_histogram_t;
+
+struct geo_metric {
+    struct geo_metric *next;
+    const char *name;
+    const char *help;
+    geo_metric_type_t type;
+    char labels[GEO_METRICS_LABELS_MAX];
+    int64_t value;
+    geo_histogram_t *hist;      // Histograms only
+};
+
+// Metrics are appended and never freed, so the list can be walked
+// without the lock; values are read and written under it
+static geo_metric_t *s_head = NULL;
+static geo_metric_t *s_tail = NULL;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static geo_metrics_collector_t s_collectors[GEO_METRICS_MAX_COLLECTORS];
+static int s_collector_count = 0;
+
+static geo_metric_t *s_heap_free = NULL;
+static geo_metric_t *s_heap_min_free = NULL;
+static geo_metric_t *s_heap_largest = NULL;
+static geo_metric_t *s_psram_free = NULL;
+static geo_metric_t *s_uptime = NULL;
+
+static geo_metric_t *find_metric(const char *name, const char *labels)
+{
+    for (geo_metric_t *m = s_head; m != NULL; m = m->next) {
+        if (strcmp(m->name, name) == 0 && strcmp(m->labels, labels) == 0) {
+            return m;
+        }
+    }
+    return NULL;
+}
+
+static geo_metric_t *register_metric(geo_metric_type_t type, const char *name,
+                                     const char *labels, const char *help)
+{
+    if (labels == NULL) {
+        labels = "";
+    }
+
+    geo_metric_t *m = calloc(1, sizeof(geo_metric_t));
+    if (m == NULL) {
+        return NULL;
+    }
+    if (type == GEO_METRIC_HISTOGRAM) {
+        m->hist = calloc(1, sizeof(geo_histogram_t));
+        if (m->hist == NULL) {
+            free(m);
+            return NULL;
+        }
+    }
+    m->name = name;
+    m->help = help;
+    m->type = type;
+    strlcpy(m->labels, labels, sizeof(m->labels));
+
+    taskENTER_CRITICAL(&s_lock);
+    geo_metric_t *existing = find_metric(name, m->labels);
+    if (existing == NULL) {
+        if (s_tail != NULL) {
+            s_tail->next = m;
+        } else {
+            s_head = m;
+        }
+        s_tail = m;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (existing != NULL) {
+        free(m->hist);
+        free(m);
+        return existing->type == type ? existing : NULL;
+    }
+    return m;
+}
+
+geo_metric_t *geo_metric_counter(const char *name, const char *labels, const char *help)
+{
+    return register_metric(GEO_METRIC_COUNTER, name, labels, help);
+}
+
+geo_metric_t *geo_metric_gauge(const char *name, const char *labels, const char *help)
+{
+    return register_metric(GEO_METRIC_GAUGE, name, labels, help);
+}
+
+geo_metric_t *geo_metric_histogram(const char *name, const char *labels, const char *help)
+{
+    return register_metric(GEO_METRIC_HISTOGRAM, name, labels, help);
+}
+
+void geo_metric_add(geo_metric_t *m, int64_t delta)
+{
+    if (m == NULL) {
+        return;
+    }
+    // 64-bit updates are not atomic on 32-bit cores
+    taskENTER_CRITICAL(&s_lock);
+    m->value += delta;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+void geo_metric_set(geo_metric_t *m, int64_t value)
+{
+    if (m == NULL) {
+        return;
+    }
+    taskENTER_CRITICAL(&s_lock);
+    m->value = value;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+void geo_metric_observe_us(geo_metric_t *m, int64_t us)
+{
+    if (m == NULL || m->hist == NULL) {
+        return;
+    }
+    if (us < 0) {
+        us = 0;
+    }
+    int bucket = 0;
+    while (bucket < GEO_METRICS_BUCKET_COUNT && us > s_bucket_us[bucket]) {
+        bucket++;
+    }
+
+    taskENTER_CRITICAL(&s_lock);
+    m->hist->buckets[bucket]++;
+    m->hist->sum_us += (uint64_t)us;
+    m->hist->count++;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+esp_err_t geo_metrics_register_collector(geo_metrics_collector_t collector)
+{
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    taskENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < s_collector_count; i++) {
+        if (s_collectors[i] == collector) {
+            ret = ESP_OK;
+        }
+    }
+    if (ret != ESP_OK && s_collector_count < GEO_METRICS_MAX_COLLECTORS) {
+        s_collectors[s_collector_count++] = collector;
+        ret = ESP_OK;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    return ret;
+}
+
+/**
+ * @brief Heap and uptime, exported by every firmware
+ */
+static void collect_system(void)
+{
+    if (s_heap_free == NULL) {
+        s_heap_free = geo_metric_gauge("geogram_heap_free_bytes", NULL,
+                                       "Free heap (internal and PSRAM)");
+        s_heap_min_free = geo_metric_gauge("geogram_heap_min_free_bytes", NULL,
+                                           "Lowest free heap since boot");
+        s_heap_largest = geo_metric_gauge("geogram_heap_largest_free_block_bytes", NULL,
+                                          "Largest allocatable internal block");
+        s_psram_free = geo_metric_gauge("geogram_psram_free_bytes", NULL,
+                                        "Free PSRAM (0 without PSRAM)");
+        s_uptime = geo_metric_counter("geogram_uptime_seconds_total", NULL,
+                                      "Seconds since boot");
+    }
+    geo_metric_set(s_heap_free, esp_get_free_heap_size());
+    geo_metric_set(s_heap_min_free, esp_get_minimum_free_heap_size());
+    geo_metric_set(s_heap_largest, heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+    geo_metric_set(s_psram_free, heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+    geo_metric_set(s_uptime, esp_timer_get_time() / 1000000);
+}
+
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t pos;
+    geo_metrics_sink_t sink;
+    void *ctx;
+    bool error;
+} metrics_out_t;
+
+static void out_flush(metrics_out_t *out)
+{
+    if (out->pos > 0 && !out->error) {
+        out->error = !out->sink(out->ctx, out->buf, out->pos);
+    }
+    out->pos = 0;
+}
+
+static void out_line(metrics_out_t *out, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static void out_line(metrics_out_t *out, const char *fmt, ...)
+{
+    char line[GEO_METRICS_LINE_MAX];
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    if (len <= 0 || out->error) {
+        return;
+    }
+    if ((size_t)len >= sizeof(line)) {
+        // Truncated: keep the line well-formed
+        len = sizeof(line) - 1;
+        line[len - 1] = '\n';
+    }
+    if (out->pos + (size_t)len > out->size) {
+        out_flush(out);
+    }
+    memcpy(out->buf + out->pos, line, (size_t)len);
+    out->pos += (size_t)len;
+}
+
+// Separator between the metric's own labels and an extra one
+static const char *label_sep(const geo_metric_t *m)
+{
+    return m->labels[0] != '\0' ? "," : "";
+}
+
+static void write_sample(metrics_out_t *out, const geo_metric_t *m)
+{
+    if (m->type != GEO_METRIC_HISTOGRAM) {
+        taskENTER_CRITICAL(&s_lock);
+        int64_t value = m->value;
+        taskEXIT_CRITICAL(&s_lock);
+        if (m->labels[0] != '\0') {
+            out_line(out, "%s{%s} %" PRId64 "\n", m->name, m->labels, value);
+        } else {
+            out_line(out, "%s %" PRId64 "\n", m->name, value);
+        }
+        return;
+    }
+
+    geo_histogram_t hist;
+    taskENTER_CRITICAL(&s_lock);
+    hist = *m->hist;
+    taskEXIT_CRITICAL(&s_lock);
+
+    uint32_t cumulative = 0;
+    for (int i = 0; i < GEO_METRICS_BUCKET_COUNT; i++) {
+        cumulative += hist.buckets[i];
+        out_line(out, "%s_bucket{%s%sle=\"%s\"} %" PRIu32 "\n",
+                 m->name, m->labels, label_sep(m), s_bucket_le[i], cumulative);
+    }
+    out_line(out, "%s_bucket{%s%sle=\"+Inf\"} %" PRIu32 "\n",
+             m->name, m->labels, label_sep(m), hist.count);
+
+    // Seconds with microsecond precision, without floating point printf
+    const char *open = m->labels[0] != '\0' ? "{" : "";
+    const char *close = m->labels[0] != '\0' ? "}" : "";
+    out_line(out, "%s_sum%s%s%s %" PRIu64 ".%06" PRIu64 "\n", m->name, open, m->labels, close,
+             hist.sum_us / 1000000, hist.sum_us % 1000000);
+    out_line(out, "%s_count%s%s%s %" PRIu32 "\n", m->name, open, m->labels, close, hist.count);
+}
+
+static const char *type_name(geo_metric_type_t type)
+{
+    switch (type) {
+        case GEO_METRIC_COUNTER: return "counter";
+        case GEO_METRIC_GAUGE: return "gauge";
+        default: return "histogram";
+    }
+}
+
+bool geo_metrics_write(char *buf, size_t size, geo_metrics_sink_t sink, void *ctx)
+{
+    collect_system();
+
+    geo_metrics_collector_t collectors[GEO_METRICS_MAX_COLLECTORS];
+    taskENTER_CRITICAL(&s_lock);
+    int count = s_collector_count;
+    memcpy(collectors, s_collectors, sizeof(collectors[0]) * count);
+    taskEXIT_CRITICAL(&s_lock);
+    for (int i = 0; i < count; i++) {
+        collectors[i]();
+    }
+
+    metrics_out_t out = {
+        .buf = buf,
+        .size = size,
+        .sink = sink,
+        .ctx = ctx,
+        .error = buf == NULL || size < GEO_METRICS_LINE_MAX,
+    };
+
+    // Samples of a family must be adjacent; emit each family at its first
+    // member, followed by all later members with the same name
+    for (geo_metric_t *m = s_head; m != NULL && !out.error; m = m->next) {
+        bool seen = false;
+        for (geo_metric_t *p = s_head; p != m; p = p->next) {
+            if (strcmp(p->name, m->name) == 0) {
+                seen = true;
+                break;
+            }
+        }
+        if (seen) {
+            continue;
+        }
+
+        out_line(&out, "# HELP %s %s\n", m->name, m->help ? m->help : "");
+        out_line(&out, "# TYPE %s %s\n", m->name, type_name(m->type));
+        for (geo_metric_t *s = m; s != NULL; s = s->next) {
+            if (strcmp(s->name, m->name) == 0) {
+                write_sample(&out, s);
+            }
+        }
+    }
+
+    out_flush(&out);
+    return !out.error;
+}
@@ -0,0 +1,83 @@
+#ifndef GEOGRAM_HTTP_ASYNC_H
+#define GEOGRAM_HTTP_ASYNC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Handler run on a worker; same contract as an httpd URI handler
+ */
+typedef esp_err_t (*geo_http_async_handler_t)(httpd_req_t *req);
+
+/**
+ * @brief Worker pool counters
+ */
+typedef struct {
+    uint32_t deferred;          /**< Requests handed to a worker since boot */
+    uint32_t rejected;          /**< Requests refused because the queue was full */
+    uint32_t queued;            /**< Requests waiting for a worker right now */
+    uint32_t busy;              /**< Workers running a handler right now */
+} geo_http_async_stats_t;
+
+/**
+ * @brief Start the worker pool for slow HTTP handlers.
+ *
+ * Slow handlers (SD card streaming, waiting on a download) hand their
+ * request to one of CONFIG_GEOGRAM_HTTP_ASYNC_WORKERS tasks so the
+ * httpd task keeps serving chat and status. At most
+ * CONFIG_GEOGRAM_HTTP_ASYNC_QUEUE requests wait for a worker; each one
+ * holds a socket until it is answered.
+ *
+ * Safe to call more than once. With zero workers configured the pool
+ * stays off and every handler runs on the httpd task as before.
+ *
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the tasks or queue could
+ *         not be created
+ */
+esp_err_t geo_http_async_init(void);
+
+/**
+ * @brief Hand a request to a worker.
+ *
+ * Call from a URI handler before doing the slow part; the worker calls
+ * @p handler with a copy of the request (usually the same handler, which
+ * then runs to completion since it is already on a worker). Handlers
+ * returning an error have their connection closed, as httpd does.
+ *
+ * A request body is left unread for the worker, which receives it with
+ * httpd_req_recv() as usual (long uploads hold that worker meanwhile).
+ *
+ * @return ESP_OK if a worker took the request (return ESP_OK from the
+ *         handler, the worker answers it), ESP_ERR_NO_MEM if the queue
+ *         is full (nothing sent; answer now, e.g. geo_http_send_busy()),
+ *         ESP_ERR_INVALID_STATE if the handler should just carry on
+ *         inline (pool off, or already on a worker)
+ */
+esp_err_t geo_http_async_defer(httpd_req_t *req, geo_http_async_handler_t handler);
+
+/**
+ * @brief Check whether the caller runs on a pool worker
+ */
+bool geo_http_async_in_worker(void);
+
+/**
+ * @brief Answer 503 Service Unavailable with Retry-After.
+ */
+esp_err_t geo_http_send_busy(httpd_req_t *req);
+
+/**
+ * @brief Get worker pool counters
+ */
+void geo_http_async_get_stats(geo_http_async_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_HTTP_ASYNC_H
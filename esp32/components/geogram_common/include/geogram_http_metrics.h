@@ -0,0 +1,55 @@
+#ifndef GEOGRAM_HTTP_METRICS_H
+#define GEOGRAM_HTTP_METRICS_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Timing of a request handed from the httpd task to a worker
+ */
+typedef struct {
+    void *endpoint;             /**< Endpoint metrics, NULL if not measured */
+    int64_t start_us;           /**< When the httpd task picked it up */
+} geo_http_metrics_span_t;
+
+/**
+ * @brief Register a URI handler that records per-endpoint metrics.
+ *
+ * Drop-in for httpd_register_uri_handler(). Each request to the handler
+ * counts towards geogram_http_requests_total, _request_errors_total,
+ * _response_bytes_total and the _request_duration_seconds histogram,
+ * labelled with the URI pattern and method. WebSocket handlers are
+ * registered as they are: their frames are not requests.
+ *
+ * @return Result of httpd_register_uri_handler(), or ESP_ERR_NO_MEM
+ */
+esp_err_t geo_http_register_uri(httpd_handle_t server, const httpd_uri_t *uri);
+
+/**
+ * @brief Take over the timing of the request being handled.
+ *
+ * For geo_http_async_defer(): the httpd task stops measuring once the
+ * handler returns, and the worker continues with
+ * geo_http_metrics_resume() so the histogram covers queueing as well.
+ *
+ * @param span Receives the timing (endpoint NULL outside a measured handler)
+ */
+void geo_http_metrics_handoff(geo_http_metrics_span_t *span);
+
+/**
+ * @brief Run a handed-off handler and record it against its endpoint.
+ * @return What @p handler returned
+ */
+esp_err_t geo_http_metrics_resume(const geo_http_metrics_span_t *span, httpd_req_t *req,
+                                  esp_err_t (*handler)(httpd_req_t *req));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_HTTP_METRICS_H
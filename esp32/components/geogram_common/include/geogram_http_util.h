@@ -0,0 +1,146 @@
+#ifndef GEOGRAM_HTTP_UTIL_H
+#define GEOGRAM_HTTP_UTIL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Size of buffers handed out by geo_http_buf_acquire()
+#define GEO_HTTP_CHUNK_SIZE     4096
+
+// Buffer size for an HTTP date ("Sun, 06 Nov 1994 08:49:37 GMT")
+#define GEO_HTTP_DATE_LEN       32
+
+/**
+ * @brief Outcome of geo_http_get_range()
+ */
+typedef enum {
+    GEO_HTTP_RANGE_NONE,            /**< Send the whole body (200) */
+    GEO_HTTP_RANGE_PARTIAL,         /**< Send the requested bytes (206) */
+    GEO_HTTP_RANGE_UNSATISFIABLE,   /**< Range starts past the end (416) */
+} geo_http_range_t;
+
+/**
+ * @brief Extra response header for geo_http_send_head()
+ */
+typedef struct {
+    const char *name;
+    const char *value;
+} geo_http_header_t;
+
+/**
+ * @brief Borrow a GEO_HTTP_CHUNK_SIZE buffer for streaming a response.
+ *
+ * Buffers come from a small pool that is allocated once and reused, so
+ * streaming handlers do not churn the heap. Falls back to malloc() when
+ * all pooled buffers are in use.
+ *
+ * @return Buffer, or NULL if out of memory
+ */
+void *geo_http_buf_acquire(void);
+
+/**
+ * @brief Return a buffer obtained from geo_http_buf_acquire().
+ * @param buf Buffer (may be NULL)
+ */
+void geo_http_buf_release(void *buf);
+
+/**
+ * @brief Send status line and headers with an explicit Content-Length.
+ *
+ * esp_http_server only sends Content-Length for bodies passed whole to
+ * httpd_resp_send(); httpd_resp_send_chunk() switches to chunked encoding.
+ * This writes the response head directly so the body can follow in
+ * pieces with geo_http_send_body() while clients still get the length.
+ *
+ * Headers set with httpd_resp_set_hdr() / httpd_resp_set_type() are not
+ * sent; pass them in @p headers instead.
+ *
+ * @param req Request
+ * @param status Status line text, e.g. "200 OK"
+ * @param content_type Content-Type value
+ * @param content_length Exact number of body bytes that will follow
+ * @param headers Extra headers (may be NULL)
+ * @param header_count Number of extra headers
+ * @return ESP_OK on success, ESP_FAIL if the socket write failed
+ */
+esp_err_t geo_http_send_head(httpd_req_t *req, const char *status, const char *content_type,
+                             size_t content_length, const geo_http_header_t *headers,
+                             size_t header_count);
+
+/**
+ * @brief Send body bytes after geo_http_send_head().
+ * @return ESP_OK once all bytes are written, ESP_FAIL on socket error
+ */
+esp_err_t geo_http_send_body(httpd_req_t *req, const void *data, size_t len);
+
+/**
+ * @brief Check the request's cache validators against the current resource.
+ *
+ * If-None-Match is compared (weakly) against @p etag and takes precedence;
+ * otherwise If-Modified-Since is compared against @p last_modified.
+ *
+ * @param req Request
+ * @param etag Current ETag including quotes, e.g. "\"1a2b-3c\"" (may be NULL)
+ * @param last_modified Modification time (0 if unknown)
+ * @return true if the client's copy is current and a 304 should be sent
+ */
+bool geo_http_not_modified(httpd_req_t *req, const char *etag, time_t last_modified);
+
+/**
+ * @brief Evaluate the request's Range (and If-Range) header.
+ *
+ * A single "bytes=first-last", "bytes=first-" or "bytes=-suffix" range is
+ * supported. Multiple ranges, malformed values and an If-Range that no
+ * longer matches @p etag / @p last_modified yield GEO_HTTP_RANGE_NONE,
+ * which RFC 9110 allows to be answered with the full body.
+ *
+ * @param req Request
+ * @param size Size of the full body
+ * @param etag Current strong ETag including quotes (may be NULL)
+ * @param last_modified Modification time (0 if unknown)
+ * @param first Receives the first byte offset for GEO_HTTP_RANGE_PARTIAL
+ * @param last Receives the last byte offset (inclusive)
+ * @return How to answer
+ */
+geo_http_range_t geo_http_get_range(httpd_req_t *req, size_t size, const char *etag,
+                                    time_t last_modified, size_t *first, size_t *last);
+
+/**
+ * @brief Send a bodyless 304 Not Modified response.
+ *
+ * @param req Request
+ * @param etag ETag to repeat (may be NULL)
+ * @param last_modified Last-Modified to repeat (0 to omit)
+ * @param headers Extra headers such as Cache-Control (may be NULL)
+ * @param header_count Number of extra headers
+ * @return ESP_OK on success
+ */
+esp_err_t geo_http_send_not_modified(httpd_req_t *req, const char *etag, time_t last_modified,
+                                     const geo_http_header_t *headers, size_t header_count);
+
+/**
+ * @brief Format a time as an HTTP date (IMF-fixdate, GMT).
+ * @param t Time
+ * @param buf Output buffer of at least GEO_HTTP_DATE_LEN bytes
+ * @param size Buffer size
+ */
+void geo_http_format_date(time_t t, char *buf, size_t size);
+
+/**
+ * @brief Parse an HTTP date (IMF-fixdate).
+ * @return Time, or 0 if the string is not a valid date
+ */
+time_t geo_http_parse_date(const char *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_HTTP_UTIL_H
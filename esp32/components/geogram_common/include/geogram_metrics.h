@@ -0,0 +1,111 @@
+#ifndef GEOGRAM_METRICS_H
+#define GEOGRAM_METRICS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Upper bounds of the latency histogram buckets, in microseconds
+#define GEO_METRICS_BUCKETS_US  { 1000, 5000, 10000, 25000, 50000, 100000, \
+                                  250000, 500000, 1000000, 2500000, 5000000, 10000000 }
+#define GEO_METRICS_BUCKET_COUNT 12
+
+// Longest label set accepted, e.g. handler="/tiles/*",method="GET"
+#define GEO_METRICS_LABELS_MAX  64
+
+/**
+ * @brief Kind of metric, as in the Prometheus exposition format
+ */
+typedef enum {
+    GEO_METRIC_COUNTER,
+    GEO_METRIC_GAUGE,
+    GEO_METRIC_HISTOGRAM,
+} geo_metric_type_t;
+
+typedef struct geo_metric geo_metric_t;
+
+/**
+ * @brief Refresh metrics that mirror a component's own state
+ *
+ * Called before every scrape. Components that already keep statistics
+ * (tile cache, update mirror, mesh bridge) copy them in here with
+ * geo_metric_set() instead of counting twice.
+ */
+typedef void (*geo_metrics_collector_t)(void);
+
+/**
+ * @brief Receives rendered output. Returns false to abort.
+ */
+typedef bool (*geo_metrics_sink_t)(void *ctx, const char *data, size_t len);
+
+/**
+ * @brief Register a counter, or return the existing one.
+ *
+ * Metrics live for the lifetime of the firmware; register them once at
+ * init and keep the handle. Metrics with the same name share one
+ * family and must have the same type and help text.
+ *
+ * @param name Metric name, e.g. "geogram_http_requests_total" (not copied)
+ * @param labels Label set without braces (copied; may be NULL)
+ * @param help Help text (not copied)
+ * @return Metric, or NULL if out of memory or the name has another type
+ */
+geo_metric_t *geo_metric_counter(const char *name, const char *labels, const char *help);
+
+/**
+ * @brief Register a gauge, or return the existing one.
+ * @see geo_metric_counter()
+ */
+geo_metric_t *geo_metric_gauge(const char *name, const char *labels, const char *help);
+
+/**
+ * @brief Register a latency histogram (GEO_METRICS_BUCKETS_US, exported
+ *        in seconds), or return the existing one.
+ * @see geo_metric_counter()
+ */
+geo_metric_t *geo_metric_histogram(const char *name, const char *labels, const char *help);
+
+/**
+ * @brief Add to a counter or gauge. NULL metrics are ignored.
+ */
+void geo_metric_add(geo_metric_t *m, int64_t delta);
+
+/**
+ * @brief Set a gauge, or a counter mirrored from a component's statistics.
+ *        NULL metrics are ignored.
+ */
+void geo_metric_set(geo_metric_t *m, int64_t value);
+
+/**
+ * @brief Record a duration in a histogram. NULL metrics are ignored.
+ */
+void geo_metric_observe_us(geo_metric_t *m, int64_t us);
+
+/**
+ * @brief Register a function run before each scrape.
+ * @return ESP_OK, or ESP_ERR_NO_MEM when all collector slots are taken
+ */
+esp_err_t geo_metrics_register_collector(geo_metrics_collector_t collector);
+
+/**
+ * @brief Run the collectors and render every metric as Prometheus text.
+ *
+ * Output collects in @p buf and goes to @p sink whenever it fills up,
+ * so any number of metrics is rendered in constant memory.
+ *
+ * @param buf Work buffer (at least 256 bytes)
+ * @param size Buffer size
+ * @return true if the sink accepted everything
+ */
+bool geo_metrics_write(char *buf, size_t size, geo_metrics_sink_t sink, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_METRICS_H
@@ -0,0 +1,147 @@
+/**
+ * @file cmd_ota.c
+ * @brief Firmware update CLI commands
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_err.h"
+#include "esp_console.h"
+#include "esp_system.h"
+#include "argtable3/argtable3.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "geogram_ota.h"
+
+static struct {
+    struct arg_str *action;
+    struct arg_str *source;
+    struct arg_str *sha256;
+    struct arg_lit *no_reboot;
+    struct arg_end *end;
+} ota_args;
+
+static const char *state_name(geogram_ota_state_t state)
+{
+    switch (state) {
+        case GEOGRAM_OTA_RUNNING: return "running";
+        case GEOGRAM_OTA_DONE:    return "installed";
+        case GEOGRAM_OTA_FAILED:  return "failed";
+        default:                  return "idle";
+    }
+}
+
+static void print_status(void)
+{
+    geogram_ota_status_t st;
+    geogram_ota_get_status(&st);
+
+    printf("Running: %s in %s%s\n", st.running_version, st.running_slot,
+           st.pending_verify ? " (on trial)" : "");
+    printf("Rollback: %s\n", st.can_rollback ? "available" : "none");
+    printf("Update: %s", state_name(st.state));
+    if (st.state != GEOGRAM_OTA_IDLE) {
+        printf(", %s, %u", st.new_version[0] ? st.new_version : "?", (unsigned)st.written);
+        if (st.total > 0) {
+            printf(" / %u", (unsigned)st.total);
+        }
+        printf(" bytes");
+    }
+    if (st.state == GEOGRAM_OTA_FAILED) {
+        printf(" (%s)", esp_err_to_name(st.result));
+    }
+    printf("\n");
+}
+
+static int cmd_ota(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **)&ota_args);
+
+    if (nerrors != 0) {
+        arg_print_errors(stderr, ota_args.end, argv[0]);
+        return 1;
+    }
+
+    const char *action = ota_args.action->sval[0];
+    const char *sha256 = ota_args.sha256->count > 0 ? ota_args.sha256->sval[0] : NULL;
+
+    if (strcmp(action, "status") == 0) {
+        print_status();
+    }
+    else if (strcmp(action, "file") == 0 || strcmp(action, "url") == 0) {
+        if (ota_args.source->count == 0) {
+            printf("Usage: ota %s <%s> [--sha256 <hex>] [-n]\n", action,
+                   action[0] == 'f' ? "path" : "url");
+            return 1;
+        }
+
+        const char *source = ota_args.source->sval[0];
+        printf("Installing firmware from %s...\n", source);
+        esp_err_t ret = action[0] == 'f' ? geogram_ota_update_from_file(source, sha256)
+                                         : geogram_ota_update_from_url(source, sha256);
+        if (ret == ESP_ERR_INVALID_STATE) {
+            printf("An update is already running\n");
+            return 1;
+        } else if (ret != ESP_OK) {
+            printf("Update failed: %s\n", esp_err_to_name(ret));
+            return 1;
+        }
+
+        print_status();
+        if (ota_args.no_reboot->count > 0) {
+            printf("New firmware starts on next reboot\n");
+            return 0;
+        }
+        printf("Rebooting into the new firmware...\n");
+        vTaskDelay(pdMS_TO_TICKS(500));
+        esp_restart();
+    }
+    else if (strcmp(action, "confirm") == 0) {
+        if (geogram_ota_confirm() != ESP_OK) {
+            printf("Failed to confirm firmware\n");
+            return 1;
+        }
+        printf("Running firmware confirmed\n");
+    }
+    else if (strcmp(action, "rollback") == 0) {
+        printf("Returning to the previous firmware...\n");
+        vTaskDelay(pdMS_TO_TICKS(100));
+        if (geogram_ota_rollback() != ESP_OK) {
+            printf("No previous firmware to return to\n");
+            return 1;
+        }
+    }
+    else {
+        printf("Unknown action: %s\n", action);
+        printf("Usage:\n");
+        printf("  ota status                  - Show running slot and update progress\n");
+        printf("  ota file <path> [--sha256 <hex>] [-n]\n");
+        printf("                              - Install an image from the SD card and reboot\n");
+        printf("  ota url <url> [--sha256 <hex>] [-n]\n");
+        printf("                              - Download and install an image and reboot\n");
+        printf("  ota confirm                 - Keep the running firmware (end trial now)\n");
+        printf("  ota rollback                - Reboot into the previous firmware\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+void register_ota_commands(void)
+{
+    ota_args.action = arg_str1(NULL, NULL, "<action>", "status | file | url | confirm | rollback");
+    ota_args.source = arg_str0(NULL, NULL, "<source>", "Image path or URL");
+    ota_args.sha256 = arg_str0(NULL, "sha256", "<hex>", "Expected SHA-256 of the image");
+    ota_args.no_reboot = arg_lit0("n", "no-reboot", "Do not reboot after installing");
+    ota_args.end = arg_end(4);
+
+    const esp_console_cmd_t cmd = {
+        .command = "ota",
+        .help = "Firmware update (A/B slots with rollback)",
+        .hint = NULL,
+        .func = &cmd_ota,
+        .argtable = &ota_args
+    };
+
+    esp_console_cmd_register(&cmd);
+}
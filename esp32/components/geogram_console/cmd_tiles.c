@@ -0,0 +1,198 @@
+/**
+ * @file cmd_tiles.c
+ * @brief Tile cache management CLI commands
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_err.h"
+#include "esp_console.h"
+#include "argtable3/argtable3.h"
+#include "app_config.h"
+
+#if BOARD_MODEL == MODEL_ESP32S3_EPAPER_1IN54
+#include "tiles.h"
+
+static struct {
+    struct arg_str *action;
+    struct arg_lit *keep;
+    struct arg_str *bbox;
+    struct arg_int *zmin;
+    struct arg_int *zmax;
+    struct arg_str *layer;
+    struct arg_end *end;
+} tiles_args;
+
+static void print_prefetch_status(void)
+{
+    tile_prefetch_status_t st;
+    tiles_prefetch_get_status(&st);
+
+    if (st.total == 0) {
+        printf("Prefetch: idle\n");
+        return;
+    }
+    printf("Prefetch: %s (%s, z%d-%d)\n", st.running ? "running" : "finished",
+           st.layer == TILE_LAYER_SATELLITE ? "satellite" : "standard", st.zmin, st.zmax);
+    printf("  Progress: %lu / %lu tiles, at %d/%d/%d\n",
+           (unsigned long)st.done, (unsigned long)st.total, st.z, st.x, st.y);
+    printf("  Fetched: %lu  Cached: %lu  Failed: %lu\n",
+           (unsigned long)st.fetched, (unsigned long)st.skipped, (unsigned long)st.failed);
+}
+
+static void print_import_status(void)
+{
+    tile_import_status_t st;
+    tiles_import_get_status(&st);
+
+    if (!st.running && st.bytes == 0) {
+        return;
+    }
+    printf("Archive import: %s, %llu KB received\n",
+           st.running ? "running" : (st.result == ESP_OK ? "finished" : esp_err_to_name(st.result)),
+           (unsigned long long)(st.bytes / 1024));
+    printf("  Imported: %lu  Skipped: %lu  Failed: %lu\n",
+           (unsigned long)st.imported, (unsigned long)st.skipped, (unsigned long)st.failed);
+}
+
+static int cmd_tiles(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **)&tiles_args);
+
+    if (nerrors != 0) {
+        arg_print_errors(stderr, tiles_args.end, argv[0]);
+        return 1;
+    }
+
+    if (!tiles_is_available()) {
+        printf("Tile cache not available (SD card not mounted?)\n");
+        return 1;
+    }
+
+    const char *action = tiles_args.action->sval[0];
+
+    if (strcmp(action, "status") == 0) {
+        tile_cache_stats_t stats;
+        tiles_get_stats(&stats);
+        printf("Tiles: %lu\n", (unsigned long)stats.total_tiles);
+        printf("Size: %lu KB\n", (unsigned long)(stats.cache_size_bytes / 1024));
+        if (stats.quota_bytes > 0) {
+            printf("On card: %llu KB of %llu KB quota (%lu evicted)\n",
+                   (unsigned long long)(stats.disk_bytes / 1024),
+                   (unsigned long long)(stats.quota_bytes / 1024),
+                   (unsigned long)stats.evicted);
+        } else {
+            printf("On card: %llu KB (no quota)\n", (unsigned long long)(stats.disk_bytes / 1024));
+        }
+        printf("Hits: %lu  Misses: %lu  Errors: %lu\n",
+               (unsigned long)stats.cache_hits, (unsigned long)stats.cache_misses,
+               (unsigned long)stats.download_errors);
+        printf("RAM cache: %lu KB, hits: %lu  misses: %lu\n",
+               (unsigned long)(stats.ram_cache_bytes / 1024),
+               (unsigned long)stats.ram_hits, (unsigned long)stats.ram_misses);
+        printf("Coalesced downloads: %lu\n", (unsigned long)stats.coalesced);
+        printf("From parent node: %lu\n", (unsigned long)stats.peer_hits);
+        printf("Not modified (304): %lu\n", (unsigned long)stats.not_modified);
+        printf("Legacy directories: %s\n", tiles_has_legacy_cache() ? "present" : "none");
+        print_prefetch_status();
+        print_import_status();
+    }
+    else if (strcmp(action, "import") == 0) {
+        bool keep = tiles_args.keep->count > 0;
+        printf("Importing legacy tiles%s...\n", keep ? " (keeping source files)" : "");
+
+        uint32_t imported = 0;
+        if (tiles_import_legacy(!keep, &imported) != ESP_OK) {
+            printf("Import failed\n");
+            return 1;
+        }
+        printf("Imported %lu tiles\n", (unsigned long)imported);
+    }
+    else if (strcmp(action, "prefetch") == 0) {
+        if (tiles_args.bbox->count == 0 || tiles_args.zmin->count == 0 || tiles_args.zmax->count == 0) {
+            printf("Usage: tiles prefetch --bbox <min_lat,min_lon,max_lat,max_lon> --zmin <z> --zmax <z> [--layer satellite]\n");
+            return 1;
+        }
+
+        tile_bbox_t bbox;
+        if (sscanf(tiles_args.bbox->sval[0], "%lf,%lf,%lf,%lf",
+                   &bbox.min_lat, &bbox.min_lon, &bbox.max_lat, &bbox.max_lon) != 4) {
+            printf("Invalid bbox: %s\n", tiles_args.bbox->sval[0]);
+            return 1;
+        }
+
+        tile_layer_t layer = TILE_LAYER_STANDARD;
+        if (tiles_args.layer->count > 0 && strcmp(tiles_args.layer->sval[0], "satellite") == 0) {
+            layer = TILE_LAYER_SATELLITE;
+        }
+
+        esp_err_t ret = tiles_prefetch(&bbox, tiles_args.zmin->ival[0], tiles_args.zmax->ival[0], layer);
+        if (ret == ESP_ERR_INVALID_STATE) {
+            printf("A prefetch job is already running (use 'tiles cancel')\n");
+            return 1;
+        } else if (ret == ESP_ERR_INVALID_SIZE) {
+            printf("Region too large (limit %d tiles)\n", CONFIG_GEOGRAM_TILES_PREFETCH_MAX_TILES);
+            return 1;
+        } else if (ret != ESP_OK) {
+            printf("Failed to start prefetch: %s\n", esp_err_to_name(ret));
+            return 1;
+        }
+        print_prefetch_status();
+    }
+    else if (strcmp(action, "cancel") == 0) {
+        if (tiles_prefetch_cancel() != ESP_OK) {
+            printf("No prefetch job running\n");
+            return 1;
+        }
+        printf("Prefetch cancelled\n");
+    }
+    else if (strcmp(action, "clear") == 0) {
+        if (tiles_clear_cache() != ESP_OK) {
+            printf("Failed to clear tile cache\n");
+            return 1;
+        }
+        printf("Tile cache cleared\n");
+    }
+    else {
+        printf("Unknown action: %s\n", action);
+        printf("Usage:\n");
+        printf("  tiles status         - Show tile cache status\n");
+        printf("  tiles import [-k]    - Pack legacy {z}/{x}/{y}.png tiles (-k keeps files)\n");
+        printf("  tiles prefetch --bbox <s,w,n,e> --zmin <z> --zmax <z> [--layer satellite]\n");
+        printf("                       - Download a region into the cache (resumes after reboot)\n");
+        printf("  tiles cancel         - Stop the running prefetch\n");
+        printf("  tiles clear          - Delete all cached tiles\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+void register_tiles_commands(void)
+{
+    tiles_args.action = arg_str1(NULL, NULL, "<action>", "status | import | prefetch | cancel | clear");
+    tiles_args.keep = arg_lit0("k", "keep", "Keep legacy files after import");
+    tiles_args.bbox = arg_str0(NULL, "bbox", "<s,w,n,e>", "Prefetch region: min_lat,min_lon,max_lat,max_lon");
+    tiles_args.zmin = arg_int0(NULL, "zmin", "<z>", "Prefetch first zoom level");
+    tiles_args.zmax = arg_int0(NULL, "zmax", "<z>", "Prefetch last zoom level");
+    tiles_args.layer = arg_str0(NULL, "layer", "<layer>", "standard | satellite");
+    tiles_args.end = arg_end(6);
+
+    const esp_console_cmd_t cmd = {
+        .command = "tiles",
+        .help = "Tile cache management",
+        .hint = NULL,
+        .func = &cmd_tiles,
+        .argtable = &tiles_args
+    };
+
+    esp_console_cmd_register(&cmd);
+}
+
+#else
+// No tile cache for boards without SD card
+void register_tiles_commands(void)
+{
+    // Tile commands not available on this board
+}
+#endif
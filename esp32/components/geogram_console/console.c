@@ -157,6 +157,8 @@ esp_err_t console_init(void)
     register_config_commands();
     register_ssh_commands();
     register_ftp_commands();
+    register_tiles_commands();
+    register_ota_commands();
 #ifdef CONFIG_GEOGRAM_MESH_ENABLED
     register_mesh_commands();
 #endif
@@ -5,6 +5,7 @@
 
 #include "ftp_server.h"
 #include "sdcard.h"
+#include "tiles.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -448,6 +449,64 @@ static void cmd_retr(ftp_session_t *session, const char *arg)
     ftp_send(session, "226 Transfer complete");
 }
 
+/**
+ * @brief Stream an upload into the tile cache instead of a file
+ *
+ * Files stored in TILES_IMPORT_DIR are tar or .pack tile archives. A name
+ * starting with "satellite" selects the layer for tiles whose path inside
+ * the archive does not name one.
+ */
+static void stor_tile_import(ftp_session_t *session, const char *name)
+{
+    tile_layer_t layer = (strncmp(name, "satellite", 9) == 0) ? TILE_LAYER_SATELLITE : TILE_LAYER_STANDARD;
+
+    tiles_import_t *imp = NULL;
+    esp_err_t ret = tiles_import_begin(layer, false, &imp);
+    if (ret != ESP_OK) {
+        ftp_send(session, ret == ESP_ERR_INVALID_STATE ? "450 Tile import already running"
+                                                       : "451 Tile cache not available");
+        return;
+    }
+
+    ftp_send(session, "150 Opening data connection");
+
+    int data_sock = open_data_connection(session);
+    if (data_sock < 0) {
+        tiles_import_end(imp);
+        ftp_send(session, "425 Cannot open data connection");
+        return;
+    }
+
+    char *buf = malloc(FTP_DATA_BUFFER_SIZE);
+    if (!buf) {
+        tiles_import_end(imp);
+        close(data_sock);
+        ftp_send(session, "451 Local error");
+        return;
+    }
+
+    ssize_t n;
+    while (ret == ESP_OK && (n = recv(data_sock, buf, FTP_DATA_BUFFER_SIZE, 0)) > 0) {
+        ret = tiles_import_write(imp, buf, n);
+    }
+
+    free(buf);
+    close(data_sock);
+
+    ret = tiles_import_end(imp);
+    tile_import_status_t st;
+    tiles_import_get_status(&st);
+    if (ret == ESP_OK) {
+        ftp_send(session, "226 Imported %lu tiles (%lu skipped)",
+                 (unsigned long)st.imported, (unsigned long)st.skipped);
+    } else if (ret == ESP_ERR_INVALID_ARG) {
+        ftp_send(session, "451 Not a tar or tile pack archive");
+    } else {
+        ftp_send(session, "451 Import failed after %lu tiles: %s",
+                 (unsigned long)st.imported, esp_err_to_name(ret));
+    }
+}
+
 /**
  * @brief Handle STOR command (upload)
  */
@@ -456,6 +515,12 @@ static void cmd_stor(ftp_session_t *session, const char *arg)
     char fullpath[FTP_FULL_PATH_SIZE];
     get_full_path(session, arg, fullpath);
 
+    const size_t import_len = strlen(TILES_IMPORT_DIR "/");
+    if (strncmp(fullpath, TILES_IMPORT_DIR "/", import_len) == 0) {
+        stor_tile_import(session, fullpath + import_len);
+        return;
+    }
+
     FILE *f = fopen(fullpath, "wb");
     if (!f) {
         ftp_send(session, "550 Cannot create file");
@@ -5,7 +5,7 @@
 
 #include "geoloc.h"
 #include "esp_log.h"
-#include "esp_http_client.h"
+#include "http_client_async.h"
 #include "cJSON.h"
 #include <string.h>
 #include <time.h>
@@ -23,26 +23,6 @@ static const char *TAG = "geoloc";
 // Cached geolocation data
 static geoloc_data_t s_geoloc = {0};
 static char s_response_buffer[RESPONSE_BUFFER_SIZE];
-static int s_response_len = 0;
-
-/**
- * @brief HTTP event handler for collecting response
- */
-static esp_err_t http_event_handler(esp_http_client_event_t *evt)
-{
-    switch (evt->event_id) {
-        case HTTP_EVENT_ON_DATA:
-            if (s_response_len + evt->data_len < RESPONSE_BUFFER_SIZE - 1) {
-                memcpy(s_response_buffer + s_response_len, evt->data, evt->data_len);
-                s_response_len += evt->data_len;
-                s_response_buffer[s_response_len] = '\0';
-            }
-            break;
-        default:
-            break;
-    }
-    return ESP_OK;
-}
 
 esp_err_t geoloc_fetch(geoloc_data_t *data)
 {
@@ -51,38 +31,33 @@ esp_err_t geoloc_fetch(geoloc_data_t *data)
     }
 
     memset(data, 0, sizeof(geoloc_data_t));
-    s_response_len = 0;
     s_response_buffer[0] = '\0';
 
     ESP_LOGI(TAG, "Fetching geolocation from ip-api.com...");
 
-    esp_http_client_config_t config = {
-        .url = GEOLOC_API_URL,
-        .event_handler = http_event_handler,
-        .timeout_ms = 10000,
-    };
+    http_client_request_t request = http_client_default_config();
+    request.url = GEOLOC_API_URL;
+    request.timeout_ms = 10000;
 
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    if (client == NULL) {
-        ESP_LOGE(TAG, "Failed to initialize HTTP client");
-        return ESP_FAIL;
-    }
+    http_client_response_t response = {
+        .data = (uint8_t *)s_response_buffer,
+        .buffer_size = RESPONSE_BUFFER_SIZE - 1,
+        .data_len = 0,
+        .status_code = 0,
+    };
 
-    esp_err_t err = esp_http_client_perform(client);
+    esp_err_t err = http_client_get_async(&request, &response);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "HTTP request failed: %s", esp_err_to_name(err));
-        esp_http_client_cleanup(client);
         return err;
     }
 
-    int status_code = esp_http_client_get_status_code(client);
-    esp_http_client_cleanup(client);
-
-    if (status_code != 200) {
-        ESP_LOGE(TAG, "HTTP request returned status %d", status_code);
+    if (response.status_code != 200) {
+        ESP_LOGE(TAG, "HTTP request returned status %d", response.status_code);
         return ESP_FAIL;
     }
 
+    s_response_buffer[response.data_len] = '\0';
     ESP_LOGD(TAG, "Response: %s", s_response_buffer);
 
     // Parse JSON response
@@ -0,0 +1,123 @@
+/**
+ * @file chat_wait.c
+ * @brief Long-poll delivery of chat messages
+ */
+
+#include "chat_wait.h"
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "mesh_chat.h"
+
+static const char *TAG = "chat_wait";
+
+typedef struct {
+    httpd_req_t *req;           // Detached request, NULL if the slot is free
+    uint32_t since_id;
+    int64_t deadline_us;
+} chat_waiter_t;
+
+static chat_waiter_t s_waiters[CHAT_WAIT_MAX_CLIENTS];
+static SemaphoreHandle_t s_lock = NULL;
+static TaskHandle_t s_task = NULL;
+static chat_wait_send_fn_t s_send = NULL;
+
+static void on_chat_message(const mesh_chat_message_t *msg)
+{
+    if (s_task != NULL) {
+        xTaskNotifyGive(s_task);
+    }
+}
+
+static void chat_wait_task(void *arg)
+{
+    for (;;) {
+        // Woken by new messages; the timeout only expires idle waiters
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+
+        uint32_t latest_id = mesh_chat_get_latest_id();
+        int64_t now = esp_timer_get_time();
+        chat_waiter_t ready[CHAT_WAIT_MAX_CLIENTS];
+        size_t ready_count = 0;
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        for (size_t i = 0; i < CHAT_WAIT_MAX_CLIENTS; i++) {
+            chat_waiter_t *w = &s_waiters[i];
+            if (w->req != NULL && (latest_id > w->since_id || now >= w->deadline_us)) {
+                ready[ready_count++] = *w;
+                w->req = NULL;
+            }
+        }
+        xSemaphoreGive(s_lock);
+
+        // Answer outside the lock; a slow client must not hold up parking
+        for (size_t i = 0; i < ready_count; i++) {
+            s_send(ready[i].req, ready[i].since_id);
+            httpd_req_async_handler_complete(ready[i].req);
+        }
+    }
+}
+
+esp_err_t chat_wait_init(chat_wait_send_fn_t send)
+{
+    if (s_task != NULL) {
+        return ESP_OK;
+    }
+
+    s_lock = xSemaphoreCreateMutex();
+    if (s_lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_send = send;
+
+    if (xTaskCreate(chat_wait_task, "chat_wait", 6144, NULL, 5, &s_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create wait task");
+        vSemaphoreDelete(s_lock);
+        s_lock = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    mesh_chat_register_callback(on_chat_message);
+    ESP_LOGI(TAG, "Chat long-poll ready (%d clients)", CHAT_WAIT_MAX_CLIENTS);
+    return ESP_OK;
+}
+
+esp_err_t chat_wait_park(httpd_req_t *req, uint32_t since_id, int wait_s)
+{
+    if (s_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (wait_s < 1) {
+        wait_s = 1;
+    } else if (wait_s > CHAT_WAIT_MAX_S) {
+        wait_s = CHAT_WAIT_MAX_S;
+    }
+
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (size_t i = 0; i < CHAT_WAIT_MAX_CLIENTS; i++) {
+        chat_waiter_t *w = &s_waiters[i];
+        if (w->req != NULL) {
+            continue;
+        }
+        httpd_req_t *async_req = NULL;
+        ret = httpd_req_async_handler_begin(req, &async_req);
+        if (ret == ESP_OK) {
+            w->req = async_req;
+            w->since_id = since_id;
+            w->deadline_us = esp_timer_get_time() + (int64_t)wait_s * 1000000;
+        }
+        break;
+    }
+    xSemaphoreGive(s_lock);
+
+    if (ret == ESP_OK) {
+        // A message may have arrived since the caller checked
+        xTaskNotifyGive(s_task);
+    }
+    return ret;
+}
@@ -0,0 +1,62 @@
+/**
+ * @file chat_wait.h
+ * @brief Long-poll delivery of chat messages
+ *
+ * GET /api/chat/messages?since=<id>&wait=<s> with nothing newer than
+ * <id> is parked instead of answered: the request is detached from the
+ * HTTP server task and answered as soon as a chat message arrives (or
+ * after <s> seconds with an empty list). Idle browsers then cost one
+ * open socket each instead of a request, an 8 KB buffer and a JSON
+ * rebuild every few seconds.
+ */
+
+#ifndef GEOGRAM_CHAT_WAIT_H
+#define GEOGRAM_CHAT_WAIT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Requests parked at once; keep well below the server's max_open_sockets
+#define CHAT_WAIT_MAX_CLIENTS   6
+
+// Longest wait a client may ask for (seconds)
+#define CHAT_WAIT_MAX_S         25
+
+/**
+ * @brief Answers a request with the messages newer than since_id
+ */
+typedef esp_err_t (*chat_wait_send_fn_t)(httpd_req_t *req, uint32_t since_id);
+
+/**
+ * @brief Start the task answering parked requests
+ *
+ * @param send Builds and sends the response (also used for timeouts)
+ * @return ESP_OK on success
+ */
+esp_err_t chat_wait_init(chat_wait_send_fn_t send);
+
+/**
+ * @brief Park a request until a message newer than since_id exists
+ *
+ * On success the request belongs to the wait task and the handler must
+ * return ESP_OK without responding.
+ *
+ * @param req Request (from the HTTP server task)
+ * @param since_id Last message ID the client has
+ * @param wait_s Longest wait in seconds (capped at CHAT_WAIT_MAX_S)
+ * @return ESP_OK if parked, ESP_ERR_NO_MEM if all slots are taken
+ *         (answer immediately instead)
+ */
+esp_err_t chat_wait_park(httpd_req_t *req, uint32_t since_id, int wait_s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_CHAT_WAIT_H
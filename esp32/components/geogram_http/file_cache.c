@@ -0,0 +1,610 @@
+/**
+ * @file file_cache.c
+ * @brief Store-and-forward cache for chat files on the SD card
+ */
+
+#include "file_cache.h"
+
+#include <string.h>
+#include "sdkconfig.h"
+
+#if CONFIG_GEOGRAM_BOARD_EPAPER_1IN54
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <dirent.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "mbedtls/sha1.h"
+#include "sdcard.h"
+
+static const char *TAG = "file_cache";
+
+#define INCOMING_DIR        FILE_CACHE_DIR "/.incoming"
+#define QUOTA_BYTES         ((uint64_t)CONFIG_GEOGRAM_FILE_CACHE_QUOTA_MB * 1024 * 1024)
+
+// Stored files start with a fixed-size header holding the metadata
+#define HEADER_MAGIC        0x31434647  // "GFC1"
+#define HEADER_SIZE         128
+
+// Files larger than this share of the quota are relayed but not stored
+#define MAX_FILE_SHARE      4
+
+// Index entries are added in blocks of this many
+#define INDEX_GROW          64
+
+// A file's access stamp is written back to the card once it is this many
+// cache uses ahead of the stamp in its header
+#define TOUCH_INTERVAL      32
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;             // HEADER_MAGIC
+    uint32_t size;              // Content size
+    char filename[65];
+    char mime[33];
+    uint32_t stamp;             // Access clock at the last use written back
+    uint8_t reserved[HEADER_SIZE - 110];
+} cache_header_t;
+
+_Static_assert(sizeof(cache_header_t) == HEADER_SIZE, "cache header size");
+
+typedef struct {
+    uint8_t sha1[20];
+    uint32_t size;              // Card space used, header included
+    uint32_t stamp;             // Access clock at the last use, for LRU eviction
+    uint32_t saved_stamp;       // Stamp in the file header
+} cache_entry_t;
+
+struct file_cache_writer {
+    FILE *f;
+    char sha1[41];
+    mbedtls_sha1_context sha;
+    cache_header_t header;
+    size_t written;
+};
+
+struct file_cache_reader {
+    FILE *f;
+    size_t size;
+    uint8_t sha1[20];
+    file_cache_reader_t *next;
+};
+
+static cache_entry_t *s_index = NULL;
+static size_t s_count = 0;
+static size_t s_capacity = 0;
+static uint64_t s_bytes = 0;
+static file_cache_stats_t s_stats = {0};
+static bool s_initialized = false;
+
+// Open readers, which keep their file from eviction; closed without the lock
+static file_cache_reader_t *s_readers = NULL;
+static portMUX_TYPE s_readers_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Access clock: counts cache uses and continues after the newest stamp on
+// the card. Unlike time() it does not depend on SNTP having set the clock.
+static uint32_t s_clock = 0;
+
+static uint32_t clock_tick(void)
+{
+    return ++s_clock;
+}
+
+static void clock_observe(uint32_t stamp)
+{
+    if (stamp > s_clock) {
+        s_clock = stamp;
+    }
+}
+
+static bool parse_sha1(const char *hex, uint8_t out[20])
+{
+    if (hex == NULL || strlen(hex) != 40) {
+        return false;
+    }
+    for (int i = 0; i < 20; i++) {
+        char byte[3] = { hex[i * 2], hex[i * 2 + 1], '\0' };
+        char *end;
+        out[i] = (uint8_t)strtoul(byte, &end, 16);
+        if (*end != '\0') {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void format_sha1(const uint8_t sha1[20], char hex[41])
+{
+    for (int i = 0; i < 20; i++) {
+        sprintf(hex + i * 2, "%02x", sha1[i]);
+    }
+}
+
+static void cache_path(const char *dir, const char *sha1, char *path, size_t size)
+{
+    snprintf(path, size, "%s/%s", dir, sha1);
+}
+
+static cache_entry_t *find_entry(const uint8_t sha1[20])
+{
+    for (size_t i = 0; i < s_count; i++) {
+        if (memcmp(s_index[i].sha1, sha1, 20) == 0) {
+            return &s_index[i];
+        }
+    }
+    return NULL;
+}
+
+static esp_err_t add_entry(const uint8_t sha1[20], uint32_t size, uint32_t stamp)
+{
+    if (s_count == s_capacity) {
+        size_t capacity = s_capacity + INDEX_GROW;
+        cache_entry_t *index = heap_caps_realloc(s_index, capacity * sizeof(cache_entry_t),
+                                                 MALLOC_CAP_SPIRAM);
+        if (index == NULL) {
+            index = realloc(s_index, capacity * sizeof(cache_entry_t));
+        }
+        if (index == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        s_index = index;
+        s_capacity = capacity;
+    }
+
+    cache_entry_t *e = &s_index[s_count++];
+    memcpy(e->sha1, sha1, 20);
+    e->size = size;
+    e->stamp = stamp;
+    e->saved_stamp = stamp;
+    s_bytes += size;
+    return ESP_OK;
+}
+
+static void drop_entry(cache_entry_t *e)
+{
+    s_bytes -= e->size;
+    *e = s_index[--s_count];
+}
+
+static void remove_entry(cache_entry_t *e)
+{
+    char hex[41];
+    char path[80];
+    format_sha1(e->sha1, hex);
+    cache_path(FILE_CACHE_DIR, hex, path, sizeof(path));
+    unlink(path);
+    drop_entry(e);
+}
+
+static bool is_open(const uint8_t sha1[20])
+{
+    bool open = false;
+    taskENTER_CRITICAL(&s_readers_lock);
+    for (const file_cache_reader_t *r = s_readers; r != NULL && !open; r = r->next) {
+        open = memcmp(r->sha1, sha1, 20) == 0;
+    }
+    taskEXIT_CRITICAL(&s_readers_lock);
+    return open;
+}
+
+/**
+ * @brief Evict least recently used files until @p needed bytes fit
+ *
+ * Files being downloaded are skipped.
+ */
+static bool make_room(uint64_t needed)
+{
+    while (s_count > 0 && s_bytes + needed > QUOTA_BYTES) {
+        cache_entry_t *oldest = NULL;
+        for (size_t i = 0; i < s_count; i++) {
+            if ((oldest == NULL || s_index[i].stamp < oldest->stamp) &&
+                !is_open(s_index[i].sha1)) {
+                oldest = &s_index[i];
+            }
+        }
+        if (oldest == NULL) {
+            break;
+        }
+        ESP_LOGI(TAG, "Evicting %02x%02x%02x%02x (%lu bytes)", oldest->sha1[0], oldest->sha1[1],
+                 oldest->sha1[2], oldest->sha1[3], (unsigned long)oldest->size);
+        remove_entry(oldest);
+        s_stats.evicted++;
+    }
+    return s_bytes + needed <= QUOTA_BYTES;
+}
+
+static bool read_header(const char *path, cache_header_t *header)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return false;
+    }
+    bool ok = fread(header, 1, HEADER_SIZE, f) == HEADER_SIZE && header->magic == HEADER_MAGIC;
+    fclose(f);
+    return ok;
+}
+
+/**
+ * @brief Write an entry's access stamp back into its file header
+ *
+ * Done once the file is TOUCH_INTERVAL uses ahead of its header, so the
+ * eviction order survives a reboot without a card write per download.
+ */
+static void save_stamp(cache_entry_t *e, const char *path)
+{
+    if (e->stamp - e->saved_stamp < TOUCH_INTERVAL) {
+        return;
+    }
+    FILE *f = fopen(path, "r+b");
+    if (f == NULL) {
+        return;
+    }
+    if (fseek(f, offsetof(cache_header_t, stamp), SEEK_SET) == 0 &&
+        fwrite(&e->stamp, 1, sizeof(e->stamp), f) == sizeof(e->stamp)) {
+        e->saved_stamp = e->stamp;
+    }
+    fclose(f);
+}
+
+static void clear_incoming(void)
+{
+    DIR *dir = opendir(INCOMING_DIR);
+    if (dir == NULL) {
+        return;
+    }
+    struct dirent *de;
+    char path[320];
+    while ((de = readdir(dir)) != NULL) {
+        if (de->d_type == DT_REG) {
+            snprintf(path, sizeof(path), "%s/%s", INCOMING_DIR, de->d_name);
+            unlink(path);
+        }
+    }
+    closedir(dir);
+}
+
+esp_err_t file_cache_init(void)
+{
+    if (s_initialized) {
+        return ESP_OK;
+    }
+    if (!sdcard_is_mounted()) {
+        ESP_LOGW(TAG, "SD card not mounted - file cache unavailable");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    mkdir(FILE_CACHE_DIR, 0755);
+    mkdir(INCOMING_DIR, 0755);
+    clear_incoming();
+
+    DIR *dir = opendir(FILE_CACHE_DIR);
+    if (dir == NULL) {
+        ESP_LOGE(TAG, "Cannot open %s", FILE_CACHE_DIR);
+        return ESP_FAIL;
+    }
+
+    struct dirent *de;
+    char path[320];
+    while ((de = readdir(dir)) != NULL) {
+        uint8_t sha1[20];
+        if (de->d_type != DT_REG || !parse_sha1(de->d_name, sha1)) {
+            continue;
+        }
+        struct stat st;
+        cache_header_t header;
+        snprintf(path, sizeof(path), "%s/%s", FILE_CACHE_DIR, de->d_name);
+        if (stat(path, &st) != 0 || !read_header(path, &header)) {
+            unlink(path);
+            continue;
+        }
+        clock_observe(header.stamp);
+        if (add_entry(sha1, (uint32_t)st.st_size, header.stamp) != ESP_OK) {
+            ESP_LOGW(TAG, "Index full, ignoring remaining files");
+            break;
+        }
+    }
+    closedir(dir);
+
+    // The quota may have been lowered since the files were stored
+    make_room(0);
+
+    s_initialized = true;
+    ESP_LOGI(TAG, "File cache: %u files, %llu KB of %llu KB", (unsigned)s_count,
+             (unsigned long long)(s_bytes / 1024), (unsigned long long)(QUOTA_BYTES / 1024));
+    return ESP_OK;
+}
+
+bool file_cache_available(void)
+{
+    return s_initialized && sdcard_is_mounted();
+}
+
+bool file_cache_contains(const char *sha1)
+{
+    uint8_t bin[20];
+    return file_cache_available() && parse_sha1(sha1, bin) && find_entry(bin) != NULL;
+}
+
+file_cache_writer_t *file_cache_write_begin(const char *sha1, const file_cache_info_t *info)
+{
+    uint8_t bin[20];
+    if (!file_cache_available() || !parse_sha1(sha1, bin) || find_entry(bin) != NULL) {
+        return NULL;
+    }
+
+    uint64_t needed = (uint64_t)info->size + HEADER_SIZE;
+    if (info->size > UINT32_MAX - HEADER_SIZE || needed > QUOTA_BYTES / MAX_FILE_SHARE ||
+        !make_room(needed)) {
+        ESP_LOGI(TAG, "Not caching %.8s (%zu bytes)", sha1, info->size);
+        return NULL;
+    }
+
+    file_cache_writer_t *w = calloc(1, sizeof(file_cache_writer_t));
+    if (w == NULL) {
+        return NULL;
+    }
+
+    // Paths always use lowercase hex, whatever the client sent
+    format_sha1(bin, w->sha1);
+
+    char path[80];
+    cache_path(INCOMING_DIR, w->sha1, path, sizeof(path));
+    w->f = fopen(path, "w+b");
+    if (w->f == NULL) {
+        ESP_LOGW(TAG, "Cannot create %s", path);
+        free(w);
+        return NULL;
+    }
+
+    w->header.magic = HEADER_MAGIC;
+    w->header.size = (uint32_t)info->size;
+    w->header.stamp = clock_tick();
+    strlcpy(w->header.filename, info->filename, sizeof(w->header.filename));
+    strlcpy(w->header.mime, info->mime, sizeof(w->header.mime));
+    if (fwrite(&w->header, 1, HEADER_SIZE, w->f) != HEADER_SIZE) {
+        fclose(w->f);
+        unlink(path);
+        free(w);
+        return NULL;
+    }
+
+    mbedtls_sha1_init(&w->sha);
+    mbedtls_sha1_starts(&w->sha);
+    return w;
+}
+
+esp_err_t file_cache_write(file_cache_writer_t *w, const void *data, size_t len)
+{
+    if (w->written + len > w->header.size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (fwrite(data, 1, len, w->f) != len) {
+        return ESP_FAIL;
+    }
+    mbedtls_sha1_update(&w->sha, data, len);
+    w->written += len;
+    return ESP_OK;
+}
+
+size_t file_cache_writer_read(file_cache_writer_t *w, size_t offset, void *buf, size_t len)
+{
+    if (offset >= w->written) {
+        return 0;
+    }
+    if (len > w->written - offset) {
+        len = w->written - offset;
+    }
+
+    size_t n = 0;
+    if (fseek(w->f, HEADER_SIZE + offset, SEEK_SET) == 0) {
+        n = fread(buf, 1, len, w->f);
+    }
+    fseek(w->f, 0, SEEK_END);
+    return n;
+}
+
+esp_err_t file_cache_write_end(file_cache_writer_t *w, bool commit)
+{
+    uint8_t digest[20];
+    mbedtls_sha1_finish(&w->sha, digest);
+    mbedtls_sha1_free(&w->sha);
+
+    uint8_t expected[20];
+    parse_sha1(w->sha1, expected);
+
+    esp_err_t ret = ESP_OK;
+    if (fclose(w->f) != 0) {
+        ret = ESP_FAIL;
+    } else if (commit && (w->written != w->header.size || memcmp(digest, expected, 20) != 0)) {
+        ESP_LOGW(TAG, "Discarding %.8s: content does not match its SHA-1", w->sha1);
+        s_stats.rejected++;
+        ret = ESP_ERR_INVALID_CRC;
+    }
+
+    char tmp_path[80];
+    char path[80];
+    cache_path(INCOMING_DIR, w->sha1, tmp_path, sizeof(tmp_path));
+    cache_path(FILE_CACHE_DIR, w->sha1, path, sizeof(path));
+
+    if (!commit || ret != ESP_OK) {
+        unlink(tmp_path);
+        free(w);
+        return commit ? ret : ESP_OK;
+    }
+
+    // A second upload of the same file may have finished first
+    if (find_entry(expected) != NULL || !make_room(w->written + HEADER_SIZE) ||
+        rename(tmp_path, path) != 0) {
+        unlink(tmp_path);
+        free(w);
+        return ESP_FAIL;
+    }
+
+    ret = add_entry(expected, (uint32_t)(w->written + HEADER_SIZE), w->header.stamp);
+    if (ret != ESP_OK) {
+        unlink(path);
+    } else {
+        s_stats.stored++;
+        ESP_LOGI(TAG, "Stored %.8s: %s (%zu bytes)", w->sha1, w->header.filename, w->written);
+    }
+    free(w);
+    return ret;
+}
+
+file_cache_reader_t *file_cache_open(const char *sha1, file_cache_info_t *info)
+{
+    uint8_t bin[20];
+    if (!file_cache_available() || !parse_sha1(sha1, bin)) {
+        return NULL;
+    }
+    cache_entry_t *e = find_entry(bin);
+    if (e == NULL) {
+        return NULL;
+    }
+
+    char hex[41];
+    char path[80];
+    format_sha1(bin, hex);
+    cache_path(FILE_CACHE_DIR, hex, path, sizeof(path));
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        // Deleted behind our back (e.g. over FTP)
+        drop_entry(e);
+        return NULL;
+    }
+
+    cache_header_t header;
+    if (fread(&header, 1, HEADER_SIZE, f) != HEADER_SIZE || header.magic != HEADER_MAGIC) {
+        fclose(f);
+        remove_entry(e);
+        return NULL;
+    }
+
+    file_cache_reader_t *r = malloc(sizeof(file_cache_reader_t));
+    if (r == NULL) {
+        fclose(f);
+        return NULL;
+    }
+    r->f = f;
+    r->size = header.size;
+    memcpy(r->sha1, bin, 20);
+    taskENTER_CRITICAL(&s_readers_lock);
+    r->next = s_readers;
+    s_readers = r;
+    taskEXIT_CRITICAL(&s_readers_lock);
+
+    if (info) {
+        memcpy(info->filename, header.filename, sizeof(info->filename));
+        info->filename[sizeof(info->filename) - 1] = '\0';
+        memcpy(info->mime, header.mime, sizeof(info->mime));
+        info->mime[sizeof(info->mime) - 1] = '\0';
+        info->size = header.size;
+    }
+
+    e->stamp = clock_tick();
+    save_stamp(e, path);
+    return r;
+}
+
+size_t file_cache_read(file_cache_reader_t *r, size_t offset, void *buf, size_t len)
+{
+    if (offset >= r->size) {
+        return 0;
+    }
+    if (len > r->size - offset) {
+        len = r->size - offset;
+    }
+    if (fseek(r->f, HEADER_SIZE + offset, SEEK_SET) != 0) {
+        return 0;
+    }
+    return fread(buf, 1, len, r->f);
+}
+
+void file_cache_close(file_cache_reader_t *r)
+{
+    if (r == NULL) {
+        return;
+    }
+    taskENTER_CRITICAL(&s_readers_lock);
+    for (file_cache_reader_t **p = &s_readers; *p != NULL; p = &(*p)->next) {
+        if (*p == r) {
+            *p = r->next;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&s_readers_lock);
+    fclose(r->f);
+    free(r);
+}
+
+void file_cache_get_stats(file_cache_stats_t *stats)
+{
+    *stats = s_stats;
+    stats->files = (uint32_t)s_count;
+    stats->bytes = s_bytes;
+    stats->quota_bytes = QUOTA_BYTES;
+}
+
+#else
+
+// No SD card on this board: files are only relayed live
+
+esp_err_t file_cache_init(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+bool file_cache_available(void)
+{
+    return false;
+}
+
+bool file_cache_contains(const char *sha1)
+{
+    return false;
+}
+
+file_cache_writer_t *file_cache_write_begin(const char *sha1, const file_cache_info_t *info)
+{
+    return NULL;
+}
+
+esp_err_t file_cache_write(file_cache_writer_t *w, const void *data, size_t len)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+size_t file_cache_writer_read(file_cache_writer_t *w, size_t offset, void *buf, size_t len)
+{
+    return 0;
+}
+
+esp_err_t file_cache_write_end(file_cache_writer_t *w, bool commit)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+file_cache_reader_t *file_cache_open(const char *sha1, file_cache_info_t *info)
+{
+    return NULL;
+}
+
+size_t file_cache_read(file_cache_reader_t *r, size_t offset, void *buf, size_t len)
+{
+    return 0;
+}
+
+void file_cache_close(file_cache_reader_t *r)
+{
+}
+
+void file_cache_get_stats(file_cache_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+#endif // CONFIG_GEOGRAM_BOARD_EPAPER_1IN54
@@ -0,0 +1,152 @@
+/**
+ * @file file_cache.h
+ * @brief Store-and-forward cache for chat files on the SD card
+ *
+ * Files relayed through the station (see file_relay.h) are written to
+ * /sdcard/files/<sha1> as they are uploaded and kept after the transfer
+ * ends, so anyone opening the file later downloads it from the station
+ * even after the sender has left. Files are content-addressed: a file
+ * is stored once whatever its name, and only if the uploaded bytes
+ * match its SHA-1. When the cache exceeds its quota the least recently
+ * downloaded files are evicted.
+ *
+ * Only available on boards with an SD card; elsewhere every call fails
+ * and the relay works as before.
+ *
+ * Not thread-safe: callers hold the HTTP server's file lock, except for
+ * file_cache_read() and file_cache_close(), so a download can be sent
+ * without it. A file stays out of eviction while a reader has it open.
+ */
+
+#ifndef GEOGRAM_FILE_CACHE_H
+#define GEOGRAM_FILE_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FILE_CACHE_DIR          "/sdcard/files"
+
+/**
+ * @brief Metadata of a cached file
+ */
+typedef struct {
+    char filename[65];          // Original filename
+    char mime[33];              // MIME type
+    size_t size;                // File size in bytes
+} file_cache_info_t;
+
+/**
+ * @brief Cache usage
+ */
+typedef struct {
+    uint32_t files;             // Files in the cache
+    uint64_t bytes;             // Card space used
+    uint64_t quota_bytes;       // Card space limit
+    uint32_t stored;            // Files stored since boot
+    uint32_t evicted;           // Files evicted since boot
+    uint32_t rejected;          // Uploads discarded (SHA-1 or size mismatch)
+} file_cache_stats_t;
+
+typedef struct file_cache_writer file_cache_writer_t;
+typedef struct file_cache_reader file_cache_reader_t;
+
+/**
+ * @brief Index the cache directory
+ *
+ * Requires the SD card to be mounted. Creates FILE_CACHE_DIR and drops
+ * uploads left incomplete by a reboot.
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE without SD card
+ */
+esp_err_t file_cache_init(void);
+
+/**
+ * @brief Check whether the cache is usable
+ */
+bool file_cache_available(void);
+
+/**
+ * @brief Check whether a file is cached
+ *
+ * @param sha1 SHA-1 as 40 hex digits
+ */
+bool file_cache_contains(const char *sha1);
+
+/**
+ * @brief Start storing a file
+ *
+ * Makes room for the file by evicting older ones if needed.
+ *
+ * @param sha1 SHA-1 the content must match, as 40 hex digits
+ * @param info File metadata (size is the exact size expected)
+ * @return Writer, or NULL if the file is already cached, too large for
+ *         the quota, or the cache is unavailable
+ */
+file_cache_writer_t *file_cache_write_begin(const char *sha1, const file_cache_info_t *info);
+
+/**
+ * @brief Append data to a file being stored
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE past the expected
+ *         size, ESP_FAIL on card errors
+ */
+esp_err_t file_cache_write(file_cache_writer_t *w, const void *data, size_t len);
+
+/**
+ * @brief Read back data already written (for receivers behind the writer)
+ *
+ * @return Bytes read
+ */
+size_t file_cache_writer_read(file_cache_writer_t *w, size_t offset, void *buf, size_t len);
+
+/**
+ * @brief Finish storing a file
+ *
+ * With @p commit the file is added to the cache if its size and SHA-1
+ * match; otherwise (or on mismatch) the partial file is deleted.
+ * The writer is freed in every case.
+ *
+ * @return ESP_OK if the file was stored, ESP_ERR_INVALID_CRC on SHA-1 or
+ *         size mismatch, ESP_FAIL on card errors
+ */
+esp_err_t file_cache_write_end(file_cache_writer_t *w, bool commit);
+
+/**
+ * @brief Open a cached file for reading
+ *
+ * Counts as a use for LRU eviction.
+ *
+ * @param sha1 SHA-1 as 40 hex digits
+ * @param info Receives the metadata (may be NULL)
+ * @return Reader, or NULL if not cached
+ */
+file_cache_reader_t *file_cache_open(const char *sha1, file_cache_info_t *info);
+
+/**
+ * @brief Read file content
+ *
+ * @return Bytes read (0 at the end of the file or on error)
+ */
+size_t file_cache_read(file_cache_reader_t *r, size_t offset, void *buf, size_t len);
+
+/**
+ * @brief Close a reader
+ */
+void file_cache_close(file_cache_reader_t *r);
+
+/**
+ * @brief Get cache usage
+ */
+void file_cache_get_stats(file_cache_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_FILE_CACHE_H
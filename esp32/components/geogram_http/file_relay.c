@@ -0,0 +1,388 @@
+/**
+ * @file file_relay.c
+ * @brief Browser-to-browser file relay transfers
+ */
+
+#include "file_relay.h"
+#include "file_cache.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+static const char *TAG = "file_relay";
+
+struct file_relay_pin {
+    int count;                  // Requests using the buffer with the file lock dropped
+};
+
+typedef struct {
+    uint8_t *data;              // FILE_RELAY_CHUNK_SIZE bytes, allocated on first use
+    int chunk;                  // Chunk held, -1 if none
+    size_t len;
+    bool delivered;
+    file_relay_pin_t pin;
+} relay_slot_t;
+
+typedef struct {
+    file_relay_info_t info;
+    relay_slot_t slots[FILE_RELAY_WINDOW];
+    file_cache_writer_t *cache; // Chunks also go to the SD card, NULL if not
+    uint8_t *read_buf;          // For chunks read back from the card
+    file_relay_pin_t read_pin;
+    int64_t last_activity;      // ms, for timeout cleanup
+    bool active;
+    bool closing;               // Ended, freed once nothing is pinned
+} relay_transfer_t;
+
+static relay_transfer_t s_transfers[FILE_RELAY_MAX_TRANSFERS];
+static int s_window = 0;
+
+// Pins are released without the file lock
+static portMUX_TYPE s_pin_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static int window_size(void)
+{
+    if (s_window == 0) {
+        s_window = heap_caps_get_total_size(MALLOC_CAP_SPIRAM) > 0 ? FILE_RELAY_WINDOW : 1;
+        ESP_LOGI(TAG, "Relay window: %d chunks of %d bytes", s_window, FILE_RELAY_CHUNK_SIZE);
+    }
+    return s_window;
+}
+
+static uint8_t *alloc_chunk(void)
+{
+    uint8_t *p = heap_caps_malloc(FILE_RELAY_CHUNK_SIZE, MALLOC_CAP_SPIRAM);
+    if (p == NULL) {
+        p = malloc(FILE_RELAY_CHUNK_SIZE);
+    }
+    return p;
+}
+
+static int64_t now_ms(void)
+{
+    return esp_timer_get_time() / 1000;
+}
+
+/**
+ * @brief Pin a buffer; an exclusive pin fails while anyone else holds one
+ */
+static bool pin_take(file_relay_pin_t *pin, bool exclusive)
+{
+    taskENTER_CRITICAL(&s_pin_lock);
+    bool ok = !exclusive || pin->count == 0;
+    if (ok) {
+        pin->count++;
+    }
+    taskEXIT_CRITICAL(&s_pin_lock);
+    return ok;
+}
+
+void file_relay_unpin(file_relay_pin_t *pin)
+{
+    if (pin == NULL) {
+        return;
+    }
+    taskENTER_CRITICAL(&s_pin_lock);
+    if (pin->count > 0) {
+        pin->count--;
+    }
+    taskEXIT_CRITICAL(&s_pin_lock);
+}
+
+static bool transfer_pinned(const relay_transfer_t *t)
+{
+    bool pinned = false;
+    taskENTER_CRITICAL(&s_pin_lock);
+    for (int i = 0; i < FILE_RELAY_WINDOW; i++) {
+        pinned |= t->slots[i].pin.count > 0;
+    }
+    pinned |= t->read_pin.count > 0;
+    taskEXIT_CRITICAL(&s_pin_lock);
+    return pinned;
+}
+
+/**
+ * @brief End a transfer; its buffers are freed once no request uses them
+ */
+static void close_transfer(relay_transfer_t *t)
+{
+    if (t->cache) {
+        file_cache_write_end(t->cache, false);
+        t->cache = NULL;
+    }
+    if (transfer_pinned(t)) {
+        t->closing = true;
+        return;
+    }
+    for (int i = 0; i < FILE_RELAY_WINDOW; i++) {
+        free(t->slots[i].data);
+    }
+    free(t->read_buf);
+    memset(t, 0, sizeof(*t));
+}
+
+static void expire_idle(void)
+{
+    int64_t now = now_ms();
+    for (int i = 0; i < FILE_RELAY_MAX_TRANSFERS; i++) {
+        relay_transfer_t *t = &s_transfers[i];
+        if (!t->active) {
+            continue;
+        }
+        if (t->closing) {
+            if (!transfer_pinned(t)) {
+                close_transfer(t);
+            }
+            continue;
+        }
+        if (now - t->last_activity > FILE_RELAY_TIMEOUT_MS && !transfer_pinned(t)) {
+            ESP_LOGW(TAG, "Transfer %.8s timed out at %d/%d chunks",
+                     t->info.sha1, t->info.delivered, t->info.total_chunks);
+            close_transfer(t);
+        }
+    }
+}
+
+static relay_transfer_t *find_transfer(const char *sha1)
+{
+    expire_idle();
+    for (int i = 0; i < FILE_RELAY_MAX_TRANSFERS; i++) {
+        const relay_transfer_t *t = &s_transfers[i];
+        if (t->active && !t->closing && strcmp(t->info.sha1, sha1) == 0) {
+            return &s_transfers[i];
+        }
+    }
+    return NULL;
+}
+
+static relay_transfer_t *open_transfer(const file_relay_info_t *info)
+{
+    for (int i = 0; i < FILE_RELAY_MAX_TRANSFERS; i++) {
+        relay_transfer_t *t = &s_transfers[i];
+        if (t->active) {
+            continue;
+        }
+        memset(t, 0, sizeof(*t));
+        strlcpy(t->info.sha1, info->sha1, sizeof(t->info.sha1));
+        strlcpy(t->info.filename, info->filename, sizeof(t->info.filename));
+        strlcpy(t->info.mime, info->mime, sizeof(t->info.mime));
+        t->info.total_size = info->total_size;
+        t->info.total_chunks = info->total_chunks > 0 ? info->total_chunks : 1;
+        for (int s = 0; s < FILE_RELAY_WINDOW; s++) {
+            t->slots[s].chunk = -1;
+        }
+        t->last_activity = now_ms();
+        t->active = true;
+
+        // Keep a copy on the card for receivers that come later
+        file_cache_info_t cache_info = { .size = info->total_size };
+        strlcpy(cache_info.filename, info->filename, sizeof(cache_info.filename));
+        strlcpy(cache_info.mime, info->mime, sizeof(cache_info.mime));
+        t->cache = file_cache_write_begin(info->sha1, &cache_info);
+
+        ESP_LOGI(TAG, "Transfer %.8s started: %s (%zu bytes, %d chunks%s)",
+                 t->info.sha1, t->info.filename, t->info.total_size, t->info.total_chunks,
+                 t->cache ? ", caching" : "");
+        return t;
+    }
+    return NULL;
+}
+
+esp_err_t file_relay_chunk_buffer(const file_relay_info_t *info, int chunk, uint8_t **buf,
+                                  file_relay_pin_t **pin)
+{
+    *buf = NULL;
+    *pin = NULL;
+
+    relay_transfer_t *t = find_transfer(info->sha1);
+    if (t == NULL) {
+        if (chunk != 0) {
+            return ESP_ERR_NOT_FOUND;
+        }
+        t = open_transfer(info);
+        if (t == NULL) {
+            ESP_LOGW(TAG, "No free transfer slot for %.8s", info->sha1);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    // Retry of a chunk that already arrived
+    if (chunk < t->info.uploaded) {
+        return ESP_OK;
+    }
+    if (chunk != t->info.uploaded || chunk >= t->info.total_chunks) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // The slot is reused once the receiver has the chunk a window earlier,
+    // or right away when that chunk is safe on the card
+    int window = window_size();
+    if (t->cache == NULL && chunk >= t->info.delivered + window) {
+        return ESP_ERR_NOT_FINISHED;
+    }
+
+    relay_slot_t *slot = &t->slots[chunk % window];
+    if (!pin_take(&slot->pin, true)) {
+        // A receiver is still being sent the chunk held there
+        return ESP_ERR_NOT_FINISHED;
+    }
+    if (slot->data == NULL) {
+        slot->data = alloc_chunk();
+        if (slot->data == NULL) {
+            file_relay_unpin(&slot->pin);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    slot->chunk = -1;
+    t->last_activity = now_ms();
+    *buf = slot->data;
+    *pin = &slot->pin;
+    return ESP_OK;
+}
+
+void file_relay_commit(const char *sha1, int chunk, size_t len)
+{
+    relay_transfer_t *t = find_transfer(sha1);
+    if (t == NULL || chunk != t->info.uploaded) {
+        return;
+    }
+
+    relay_slot_t *slot = &t->slots[chunk % window_size()];
+    slot->chunk = chunk;
+    slot->len = len;
+    slot->delivered = false;
+    t->info.uploaded = chunk + 1;
+    t->last_activity = now_ms();
+
+    if (t->cache == NULL) {
+        return;
+    }
+    if (file_cache_write(t->cache, slot->data, len) != ESP_OK) {
+        // Chunks already overwritten in the window are lost to the receiver
+        ESP_LOGW(TAG, "Transfer %.8s: caching failed, relaying only", t->info.sha1);
+        file_cache_write_end(t->cache, false);
+        t->cache = NULL;
+        return;
+    }
+    if (t->info.uploaded == t->info.total_chunks) {
+        // Complete: receivers continue from the cached file
+        esp_err_t ret = file_cache_write_end(t->cache, true);
+        t->cache = NULL;
+        if (ret == ESP_OK) {
+            close_transfer(t);
+        }
+    }
+}
+
+esp_err_t file_relay_get_chunk(const char *sha1, int chunk, const uint8_t **data, size_t *len,
+                               file_relay_info_t *info, file_relay_pin_t **pin)
+{
+    *pin = NULL;
+
+    relay_transfer_t *t = find_transfer(sha1);
+    if (t == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (info) {
+        *info = t->info;
+    }
+    if (chunk < 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (chunk >= t->info.uploaded) {
+        return ESP_ERR_NOT_FINISHED;
+    }
+
+    relay_slot_t *slot = &t->slots[chunk % window_size()];
+    if (slot->chunk == chunk) {
+        pin_take(&slot->pin, false);
+        *data = slot->data;
+        *len = slot->len;
+        *pin = &slot->pin;
+    } else if (t->cache != NULL) {
+        // The uploader ran ahead; read the chunk back from the card
+        if (!pin_take(&t->read_pin, true)) {
+            return ESP_ERR_NOT_FINISHED;
+        }
+        if (t->read_buf == NULL) {
+            t->read_buf = alloc_chunk();
+            if (t->read_buf == NULL) {
+                file_relay_unpin(&t->read_pin);
+                return ESP_ERR_NO_MEM;
+            }
+        }
+        *len = file_cache_writer_read(t->cache, (size_t)chunk * FILE_RELAY_CHUNK_SIZE,
+                                      t->read_buf, FILE_RELAY_CHUNK_SIZE);
+        if (*len == 0 && t->info.total_size > 0) {
+            file_relay_unpin(&t->read_pin);
+            return ESP_ERR_INVALID_STATE;
+        }
+        *data = t->read_buf;
+        *pin = &t->read_pin;
+    } else {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    t->last_activity = now_ms();
+    return ESP_OK;
+}
+
+void file_relay_delivered(const char *sha1, int chunk)
+{
+    relay_transfer_t *t = find_transfer(sha1);
+    if (t == NULL) {
+        return;
+    }
+
+    int window = window_size();
+    relay_slot_t *slot = &t->slots[chunk % window];
+    if (slot->chunk == chunk) {
+        slot->delivered = true;
+    } else if (chunk == t->info.delivered) {
+        // Served from the card
+        t->info.delivered++;
+    } else {
+        return;
+    }
+
+    // Advance over every chunk the receiver now has in order
+    while (t->info.delivered < t->info.uploaded) {
+        const relay_slot_t *next = &t->slots[t->info.delivered % window];
+        if (next->chunk != t->info.delivered || !next->delivered) {
+            break;
+        }
+        t->info.delivered++;
+    }
+    t->last_activity = now_ms();
+
+    if (t->info.delivered >= t->info.total_chunks) {
+        ESP_LOGI(TAG, "Transfer %.8s complete (%d chunks)", t->info.sha1, t->info.total_chunks);
+        close_transfer(t);
+    }
+}
+
+bool file_relay_get_info(const char *sha1, file_relay_info_t *info)
+{
+    relay_transfer_t *t = find_transfer(sha1);
+    if (t == NULL) {
+        return false;
+    }
+    *info = t->info;
+    return true;
+}
+
+int file_relay_active_count(void)
+{
+    expire_idle();
+    int count = 0;
+    for (int i = 0; i < FILE_RELAY_MAX_TRANSFERS; i++) {
+        if (s_transfers[i].active && !s_transfers[i].closing) {
+            count++;
+        }
+    }
+    return count;
+}
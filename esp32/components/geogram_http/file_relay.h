@@ -0,0 +1,146 @@
+/**
+ * @file file_relay.h
+ * @brief Browser-to-browser file relay transfers
+ *
+ * A file shared in the chat is relayed through the station: the sender
+ * uploads it chunk by chunk, the receiver downloads the chunks as they
+ * arrive. Transfers are keyed by the file's SHA-1, several may run at
+ * once, and each buffers a small window of chunks so the sender can
+ * run ahead of the receiver instead of waiting for every chunk to be
+ * fetched. Idle transfers are dropped after FILE_RELAY_TIMEOUT_MS.
+ *
+ * Chunk buffers live in PSRAM. Without PSRAM the window shrinks to one
+ * chunk, which keeps the old lockstep relay within internal RAM.
+ *
+ * Not thread-safe: callers hold the HTTP server's file lock, except for
+ * file_relay_unpin(). A chunk buffer handed out is pinned, so the lock
+ * can be dropped while it is received into or sent from: the slot is
+ * not reused and the transfer not freed until it is unpinned.
+ */
+
+#ifndef GEOGRAM_FILE_RELAY_H
+#define GEOGRAM_FILE_RELAY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Bytes per chunk (every chunk but the last is exactly this size)
+#define FILE_RELAY_CHUNK_SIZE       16384
+
+// Transfers relayed at once
+#define FILE_RELAY_MAX_TRANSFERS    4
+
+// Chunks buffered per transfer (with PSRAM)
+#define FILE_RELAY_WINDOW           4
+
+// A transfer without uploads or downloads for this long is dropped
+#define FILE_RELAY_TIMEOUT_MS       60000
+
+/**
+ * @brief Transfer metadata and progress
+ */
+typedef struct {
+    char sha1[41];              // File identifier (hex string)
+    char filename[65];          // Original filename
+    char mime[33];              // MIME type
+    size_t total_size;          // Total file size
+    int total_chunks;           // Total chunks expected
+    int uploaded;               // Chunks received from the sender
+    int delivered;              // Chunks fetched by the receiver, in order
+} file_relay_info_t;
+
+/**
+ * @brief Pin on a chunk buffer, released with file_relay_unpin()
+ */
+typedef struct file_relay_pin file_relay_pin_t;
+
+/**
+ * @brief Get the buffer for an uploaded chunk
+ *
+ * Chunk 0 opens the transfer described by @p info (unless it exists).
+ * Fill the buffer with at most FILE_RELAY_CHUNK_SIZE bytes, then call
+ * file_relay_commit() and unpin it; unpin without committing to give
+ * up. A chunk that was already received returns ESP_OK with *buf set
+ * to NULL, so retried uploads are harmless.
+ *
+ * @param info Transfer (sha1, and for chunk 0 the file metadata)
+ * @param chunk Chunk index; must be the next one expected
+ * @param buf Receives the chunk buffer
+ * @param pin Receives the buffer's pin (if *buf is set)
+ * @return ESP_OK, ESP_ERR_NOT_FINISHED if the window is full or the
+ *         slot is still being sent (retry later), ESP_ERR_NOT_FOUND if there is no
+ *         such transfer, ESP_ERR_INVALID_ARG if the chunk is out of
+ *         sequence, ESP_ERR_NO_MEM if no transfer slot or buffer is free
+ */
+esp_err_t file_relay_chunk_buffer(const file_relay_info_t *info, int chunk, uint8_t **buf,
+                                  file_relay_pin_t **pin);
+
+/**
+ * @brief Make a chunk filled via file_relay_chunk_buffer() available
+ *
+ * @param sha1 Transfer
+ * @param chunk Chunk index
+ * @param len Bytes written into the buffer
+ */
+void file_relay_commit(const char *sha1, int chunk, size_t len);
+
+/**
+ * @brief Get a buffered chunk for the receiver
+ *
+ * @param sha1 Transfer
+ * @param chunk Chunk index
+ * @param data Receives the chunk data, valid until unpinned
+ * @param len Receives the chunk length
+ * @param info Receives the transfer metadata (may be NULL)
+ * @param pin Receives the data's pin (on ESP_OK)
+ * @return ESP_OK, ESP_ERR_NOT_FINISHED if the chunk has not been uploaded
+ *         yet or is being read by another request, ESP_ERR_NOT_FOUND if
+ *         there is no such transfer, ESP_ERR_INVALID_STATE if the chunk
+ *         is no longer buffered
+ */
+esp_err_t file_relay_get_chunk(const char *sha1, int chunk, const uint8_t **data, size_t *len,
+                               file_relay_info_t *info, file_relay_pin_t **pin);
+
+/**
+ * @brief Release a chunk buffer pinned by file_relay_chunk_buffer() or
+ *        file_relay_get_chunk()
+ *
+ * Safe to call without the file lock.
+ */
+void file_relay_unpin(file_relay_pin_t *pin);
+
+/**
+ * @brief Mark a chunk as received by the receiver, freeing its window slot
+ *
+ * The transfer ends once its last chunk has been delivered.
+ *
+ * @param sha1 Transfer
+ * @param chunk Chunk index
+ */
+void file_relay_delivered(const char *sha1, int chunk);
+
+/**
+ * @brief Get the state of a transfer
+ *
+ * @param sha1 Transfer
+ * @param info Receives metadata and progress
+ * @return true if the transfer is active
+ */
+bool file_relay_get_info(const char *sha1, file_relay_info_t *info);
+
+/**
+ * @brief Get the number of active transfers
+ */
+int file_relay_active_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_FILE_RELAY_H
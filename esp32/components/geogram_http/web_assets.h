@@ -0,0 +1,38 @@
+/**
+ * @file web_assets.h
+ * @brief Precompressed web pages linked into the firmware
+ *
+ * The files in www/ are minified and gzipped at build time by
+ * scripts/build_web_assets.py and served as-is with Content-Encoding:
+ * gzip. Assets other than pages are referenced through versioned URLs
+ * (?v=<etag>) and may be cached by browsers indefinitely.
+ */
+
+#ifndef GEOGRAM_WEB_ASSETS_H
+#define GEOGRAM_WEB_ASSETS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    const char *path;           // URL path ("/" or "/assets/<name>")
+    const char *content_type;
+    const char *etag;           // Strong ETag of the compressed body, quoted
+    const uint8_t *data;        // gzip-compressed body
+    size_t size;
+    bool immutable;             // Versioned URL: cache for a year
+} web_asset_t;
+
+extern const web_asset_t web_assets[];
+extern const size_t web_asset_count;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_WEB_ASSETS_H
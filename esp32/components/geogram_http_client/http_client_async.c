@@ -1,20 +1,32 @@
 /**
  * @file http_client_async.c
  * @brief Async HTTP client implementation
+ *
+ * Requests are queued as jobs and run by a fixed pool of worker tasks,
+ * which read the body in HTTP_READ_CHUNK pieces and hand them to the
+ * job's sink (the caller's buffer for http_client_get_async()).
+ * Each worker keeps a small LRU of clients keyed by origin
+ * (scheme://host[:port]); a request to a known origin reuses the open
+ * connection, and a reconnect resumes the TLS session from its ticket.
  */
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include "sdkconfig.h"
 #include "http_client_async.h"
 #include "esp_http_client.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 #include "freertos/semphr.h"
 
 static const char *TAG = "http_async";
 
 // Task stack size - must be large enough for TLS (mbedTLS needs ~10KB)
 #define HTTP_TASK_STACK_SIZE    (12 * 1024)
+#define HTTP_TASK_PRIORITY      5
 
 // Default timeout
 #define DEFAULT_TIMEOUT_MS      15000
@@ -22,99 +34,539 @@ static const char *TAG = "http_async";
 // Default user agent
 #define DEFAULT_USER_AGENT      "ESP32-HTTP/1.0"
 
+// Extra time a caller waits on top of the request timeout (queueing, connect)
+#define HTTP_WAIT_MARGIN_MS     5000
+
+// Queued requests per priority
+#define HTTP_QUEUE_DEPTH        8
+#define HTTP_PRIORITIES         3
+
+// Longest origin (scheme://host:port) a connection is kept for
+#define HTTP_ORIGIN_LEN         96
+
+// Body read size between cancellation checks
+#define HTTP_READ_CHUNK         4096
+
+// Error bodies up to this size are drained to keep the connection
+#define HTTP_DRAIN_MAX          4096
+
+// Response headers kept per request for the sink's on_header
+#define HTTP_HEADER_STORE       2048
+
+// Redirects followed per request (release assets redirect to a CDN)
+#define HTTP_MAX_REDIRECTS      5
+#define HTTP_URL_MAX            2048
+
+typedef enum {
+    JOB_QUEUED,
+    JOB_RUNNING,
+    JOB_DONE,
+} http_job_state_t;
+
 /**
- * @brief Internal request context passed to task
+ * @brief One queued request
+ *
+ * Freed by the caller once done, or by the worker if the caller gave up
+ * while it was still queued.
  */
 typedef struct {
-    http_client_request_t request;
-    http_client_response_t *response;
+    const char *url;            // Stored after the struct
+    const char *user_agent;     // Stored after the struct
+    const http_client_header_t *headers;    // Stored after the struct
+    size_t header_count;
+    int timeout_ms;
+    http_client_sink_t sink;
+    bool streaming;             // Caller waits for as long as data arrives
+    int status_code;
     esp_err_t result;
+    http_job_state_t state;
+    volatile bool cancelled;
     SemaphoreHandle_t done_sem;
-} http_task_ctx_t;
+} http_job_t;
 
 /**
- * @brief Perform the actual HTTP request (runs in dedicated task)
+ * @brief Client kept open by a worker between requests
  */
-static void http_request_task(void *arg)
+typedef struct {
+    char origin[HTTP_ORIGIN_LEN];
+    esp_http_client_handle_t client;
+    bool connected;             // Last request left the connection open
+    TickType_t last_used;
+} http_conn_t;
+
+/**
+ * @brief Per-worker state
+ */
+typedef struct {
+    http_conn_t conns[CONFIG_GEOGRAM_HTTP_CLIENT_HOSTS];
+    uint8_t *chunk;             // HTTP_READ_CHUNK body buffer
+    char *headers;              // "name\0value\0" pairs of the current response
+    size_t headers_used;
+} http_worker_t;
+
+static SemaphoreHandle_t s_lock = NULL;
+static SemaphoreHandle_t s_pending = NULL;
+static QueueHandle_t s_queues[HTTP_PRIORITIES];
+
+static portMUX_TYPE s_init_mux = portMUX_INITIALIZER_UNLOCKED;
+static volatile int s_pool_state = 0;   // 0 = not started, 1 = starting, 2 = running
+
+/**
+ * @brief Extract scheme://host[:port] from a URL
+ */
+static bool url_origin(const char *url, char *origin, size_t size)
 {
-    http_task_ctx_t *ctx = (http_task_ctx_t *)arg;
-    http_client_response_t *resp = ctx->response;
+    const char *host = strstr(url, "://");
+    if (host == NULL) {
+        return false;
+    }
+    host += 3;
 
-    // Initialize response
-    resp->status_code = 0;
-    resp->data_len = 0;
+    size_t len = (size_t)(host - url) + strcspn(host, "/?#");
+    if (len >= size) {
+        return false;
+    }
+    memcpy(origin, url, len);
+    origin[len] = '\0';
+    return true;
+}
 
-    // Configure HTTP client - use insecure mode for tile downloads
-    // Certificate verification is skipped as tiles are not sensitive data
-    esp_http_client_config_t config = {
-        .url = ctx->request.url,
-        .timeout_ms = ctx->request.timeout_ms > 0 ? ctx->request.timeout_ms : DEFAULT_TIMEOUT_MS,
-        .user_agent = ctx->request.user_agent ? ctx->request.user_agent : DEFAULT_USER_AGENT,
-        .cert_pem = NULL,
-        .skip_cert_common_name_check = true,
-        .use_global_ca_store = false,
-    };
+static void job_free(http_job_t *job)
+{
+    vSemaphoreDelete(job->done_sem);
+    free(job);
+}
+
+static void conn_close(http_conn_t *conn)
+{
+    if (conn->connected) {
+        esp_http_client_close(conn->client);
+        conn->connected = false;
+    }
+}
+
+/**
+ * @brief Keep response headers until the response is known to be final
+ */
+static esp_err_t http_event_handler(esp_http_client_event_t *evt)
+{
+    http_worker_t *w = (http_worker_t *)evt->user_data;
+    if (evt->event_id != HTTP_EVENT_ON_HEADER || w == NULL) {
+        return ESP_OK;
+    }
+
+    size_t name_len = strlen(evt->header_key) + 1;
+    size_t value_len = strlen(evt->header_value) + 1;
+    if (name_len + value_len > HTTP_HEADER_STORE - w->headers_used) {
+        ESP_LOGD(TAG, "Header store full, skipping %s", evt->header_key);
+        return ESP_OK;
+    }
+    memcpy(w->headers + w->headers_used, evt->header_key, name_len);
+    memcpy(w->headers + w->headers_used + name_len, evt->header_value, value_len);
+    w->headers_used += name_len + value_len;
+    return ESP_OK;
+}
+
+/**
+ * @brief Add or remove a job's extra request headers on a kept client
+ */
+static void conn_set_headers(http_conn_t *conn, const http_job_t *job, bool set)
+{
+    for (size_t i = 0; i < job->header_count; i++) {
+        if (set) {
+            esp_http_client_set_header(conn->client, job->headers[i].name, job->headers[i].value);
+        } else {
+            esp_http_client_delete_header(conn->client, job->headers[i].name);
+        }
+    }
+}
 
-    ESP_LOGI(TAG, "HTTP GET: %s", config.url);
+/**
+ * @brief Find or create the client for a request's origin
+ */
+static http_conn_t *conn_get(http_worker_t *w, const http_job_t *job, const char *url)
+{
+    http_conn_t *conns = w->conns;
+    char origin[HTTP_ORIGIN_LEN];
+    if (!url_origin(url, origin, sizeof(origin))) {
+        ESP_LOGE(TAG, "Unsupported URL: %s", url);
+        return NULL;
+    }
 
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    if (client == NULL) {
-        ESP_LOGE(TAG, "Failed to init HTTP client");
-        ctx->result = ESP_FAIL;
-        goto done;
+    http_conn_t *conn = NULL;
+    for (int i = 0; i < CONFIG_GEOGRAM_HTTP_CLIENT_HOSTS; i++) {
+        if (conns[i].client != NULL && strcmp(conns[i].origin, origin) == 0) {
+            conn = &conns[i];
+            break;
+        }
     }
 
-    ESP_LOGI(TAG, "Opening HTTP connection...");
-    esp_err_t err = esp_http_client_open(client, 0);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open HTTP connection: %s", esp_err_to_name(err));
-        esp_http_client_cleanup(client);
-        ctx->result = err;
-        goto done;
+    if (conn != NULL) {
+        // Same origin keeps the socket; set_url only swaps path and query
+        if (esp_http_client_set_url(conn->client, url) != ESP_OK) {
+            return NULL;
+        }
+        esp_http_client_set_timeout_ms(conn->client, job->timeout_ms);
+    } else {
+        // Replace an unused slot or the least recently used client
+        conn = &conns[0];
+        for (int i = 0; i < CONFIG_GEOGRAM_HTTP_CLIENT_HOSTS; i++) {
+            if (conns[i].client == NULL) {
+                conn = &conns[i];
+                break;
+            }
+            if ((TickType_t)(conns[i].last_used - conn->last_used) > portMAX_DELAY / 2) {
+                conn = &conns[i];
+            }
+        }
+        if (conn->client != NULL) {
+            ESP_LOGD(TAG, "Dropping client for %s", conn->origin);
+            conn_close(conn);
+            esp_http_client_cleanup(conn->client);
+            conn->client = NULL;
+        }
+
+        // Configure HTTP client - use insecure mode for tile downloads
+        // Certificate verification is skipped as tiles are not sensitive data
+        esp_http_client_config_t config = {
+            .url = url,
+            .timeout_ms = job->timeout_ms,
+            .cert_pem = NULL,
+            .skip_cert_common_name_check = true,
+            .use_global_ca_store = false,
+            .event_handler = http_event_handler,
+            .user_data = w,
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+            .save_client_session = true,
+#endif
+        };
+        conn->client = esp_http_client_init(&config);
+        if (conn->client == NULL) {
+            ESP_LOGE(TAG, "Failed to init HTTP client");
+            return NULL;
+        }
+        strcpy(conn->origin, origin);
+        conn->connected = false;
     }
-    ESP_LOGI(TAG, "HTTP connection opened");
 
-    int content_length = esp_http_client_fetch_headers(client);
-    resp->status_code = esp_http_client_get_status_code(client);
+    esp_http_client_set_header(conn->client, "User-Agent", job->user_agent);
+    conn_set_headers(conn, job, true);
+    return conn;
+}
 
-    ESP_LOGD(TAG, "HTTP status: %d, content-length: %d", resp->status_code, content_length);
+/**
+ * @brief Pass the response body to the sink chunk by chunk
+ */
+static esp_err_t read_body(http_conn_t *conn, http_job_t *job, uint8_t *chunk)
+{
+    size_t total = 0;
+    while (1) {
+        if (job->cancelled) {
+            return ESP_ERR_TIMEOUT;
+        }
+        int len = esp_http_client_read(conn->client, (char *)chunk, HTTP_READ_CHUNK);
+        if (len < 0) {
+            ESP_LOGE(TAG, "Failed to read HTTP response");
+            return ESP_FAIL;
+        }
+        if (len == 0) {
+            break;
+        }
+        total += (size_t)len;
+        if (job->sink.on_data != NULL) {
+            esp_err_t err = job->sink.on_data(job->sink.ctx, chunk, (size_t)len);
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+    }
 
-    if (resp->status_code != 200) {
-        ESP_LOGW(TAG, "HTTP error %d for %s", resp->status_code, config.url);
-        esp_http_client_close(client);
-        esp_http_client_cleanup(client);
-        ctx->result = ESP_FAIL;
-        goto done;
+    if (!esp_http_client_is_complete_data_received(conn->client)) {
+        ESP_LOGE(TAG, "Connection closed after %zu bytes", total);
+        return ESP_FAIL;
     }
+    ESP_LOGD(TAG, "HTTP GET complete: %zu bytes", total);
+    return ESP_OK;
+}
 
-    // Check if response fits in buffer
-    if (content_length > 0 && (size_t)content_length > resp->buffer_size) {
-        ESP_LOGE(TAG, "Response too large: %d bytes (buffer: %zu)", content_length, resp->buffer_size);
-        esp_http_client_close(client);
-        esp_http_client_cleanup(client);
-        ctx->result = ESP_ERR_NO_MEM;
-        goto done;
+static bool is_redirect(int status_code)
+{
+    return status_code == 301 || status_code == 302 || status_code == 303 ||
+           status_code == 307 || status_code == 308;
+}
+
+/**
+ * @brief Point a client at the Location of its redirect response
+ *
+ * @return The new URL in `url_buf`, or NULL if there is none
+ */
+static const char *follow_redirect(http_conn_t *conn, char **url_buf)
+{
+    if (*url_buf == NULL) {
+        *url_buf = malloc(HTTP_URL_MAX);
+        if (*url_buf == NULL) {
+            return NULL;
+        }
+    }
+    if (esp_http_client_set_redirection(conn->client) != ESP_OK ||
+        esp_http_client_get_url(conn->client, *url_buf, HTTP_URL_MAX) != ESP_OK) {
+        return NULL;
+    }
+
+    // A redirect to another host has closed the connection
+    char origin[HTTP_ORIGIN_LEN];
+    if (!url_origin(*url_buf, origin, sizeof(origin))) {
+        return NULL;
+    }
+    if (strcmp(origin, conn->origin) != 0) {
+        conn->connected = false;
+        strcpy(conn->origin, origin);
+    }
+    return *url_buf;
+}
+
+/**
+ * @brief Perform the actual HTTP request (runs on a worker)
+ */
+static esp_err_t run_job(http_worker_t *w, http_job_t *job)
+{
+    const char *url = job->url;
+    char *url_buf = NULL;
+    int redirects = 0;
+    bool retried = false;
+    http_conn_t *conn = NULL;
+    esp_err_t err;
+
+    while (1) {
+        conn = conn_get(w, job, url);
+        if (conn == NULL) {
+            err = ESP_FAIL;
+            break;
+        }
+        w->headers_used = 0;
+        bool reused = conn->connected;
+        conn->last_used = xTaskGetTickCount();
+
+        ESP_LOGI(TAG, "HTTP GET: %s%s", url, reused ? " (keep-alive)" : "");
+
+        // Opening an already connected client only sends the request
+        err = esp_http_client_open(conn->client, 0);
+        int64_t content_length = -1;
+        if (err == ESP_OK) {
+            content_length = esp_http_client_fetch_headers(conn->client);
+            if (content_length < 0) {
+                err = ESP_FAIL;
+            } else if (esp_http_client_is_chunked_response(conn->client)) {
+                // IDF returns 0 and flags the response chunked whenever the
+                // length is not known up front (an explicit Content-Length: 0
+                // looks the same); report it as unknown
+                content_length = -1;
+            }
+        }
+        if (err != ESP_OK) {
+            esp_http_client_close(conn->client);
+            conn->connected = false;
+            if (reused && !retried && !job->cancelled) {
+                // The server dropped the idle connection; reconnect once
+                ESP_LOGD(TAG, "Kept connection to %s is gone, reconnecting", conn->origin);
+                retried = true;
+                conn_set_headers(conn, job, false);
+                continue;
+            }
+            ESP_LOGE(TAG, "Failed to open HTTP connection: %s", esp_err_to_name(err));
+            break;
+        }
+        conn->connected = true;
+
+        job->status_code = esp_http_client_get_status_code(conn->client);
+        ESP_LOGD(TAG, "HTTP status: %d, content-length: %lld",
+                 job->status_code, (long long)content_length);
+
+        // Drain small bodies so the connection can be reused; a body of
+        // unknown length could be any size, so its connection is closed
+        bool drain = job->status_code / 100 != 2;
+        if (is_redirect(job->status_code) && redirects < HTTP_MAX_REDIRECTS) {
+            if (content_length < 0 || content_length > HTTP_DRAIN_MAX ||
+                esp_http_client_flush_response(conn->client, NULL) != ESP_OK) {
+                conn_close(conn);
+            }
+            const char *location = follow_redirect(conn, &url_buf);
+            conn_set_headers(conn, job, false);
+            if (location != NULL) {
+                url = location;
+                redirects++;
+                retried = false;
+                continue;
+            }
+            drain = false;
+        }
+
+        if (job->sink.on_header != NULL) {
+            for (size_t pos = 0; pos < w->headers_used; ) {
+                const char *name = w->headers + pos;
+                const char *value = name + strlen(name) + 1;
+                job->sink.on_header(job->sink.ctx, name, value);
+                pos = (size_t)(value - w->headers) + strlen(value) + 1;
+            }
+        }
+        if (job->sink.on_headers != NULL) {
+            err = job->sink.on_headers(job->sink.ctx, job->status_code, content_length);
+        }
+
+        if (err != ESP_OK || job->status_code / 100 != 2) {
+            if (job->status_code / 100 != 2) {
+                ESP_LOGW(TAG, "HTTP error %d for %s", job->status_code, url);
+            }
+            if (!drain || content_length < 0 || content_length > HTTP_DRAIN_MAX ||
+                esp_http_client_flush_response(conn->client, NULL) != ESP_OK) {
+                conn_close(conn);
+            }
+            break;
+        }
+
+        err = read_body(conn, job, w->chunk);
+        if (err != ESP_OK) {
+            conn_close(conn);
+        }
+        conn->last_used = xTaskGetTickCount();
+        break;
+    }
+
+    if (conn != NULL) {
+        conn_set_headers(conn, job, false);
+    }
+
+    free(url_buf);
+    return err;
+}
+
+/**
+ * @brief Take the next job, highest priority first
+ */
+static http_job_t *next_job(TickType_t wait)
+{
+    if (xSemaphoreTake(s_pending, wait) != pdTRUE) {
+        return NULL;
+    }
+
+    static const http_client_priority_t order[HTTP_PRIORITIES] = {
+        HTTP_CLIENT_PRIORITY_HIGH,
+        HTTP_CLIENT_PRIORITY_NORMAL,
+        HTTP_CLIENT_PRIORITY_LOW,
+    };
+    http_job_t *job = NULL;
+    for (int i = 0; i < HTTP_PRIORITIES; i++) {
+        if (xQueueReceive(s_queues[order[i]], &job, 0) == pdTRUE) {
+            return job;
+        }
+    }
+    return NULL;
+}
+
+static void http_worker_task(void *arg)
+{
+    // Lives as long as the task; clients point their user_data at it
+    http_worker_t w;
+    memset(&w, 0, sizeof(w));
+    w.chunk = malloc(HTTP_READ_CHUNK);
+    w.headers = malloc(HTTP_HEADER_STORE);
+    if (w.chunk == NULL || w.headers == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate read buffer");
+        free(w.chunk);
+        free(w.headers);
+        vTaskDelete(NULL);
+        return;
+    }
+    const TickType_t idle = pdMS_TO_TICKS(CONFIG_GEOGRAM_HTTP_CLIENT_IDLE_S * 1000);
+
+    while (1) {
+        http_job_t *job = next_job(idle);
+
+        // Give back TLS buffers of connections nobody used for a while;
+        // the client (and its session ticket) stays
+        TickType_t now = xTaskGetTickCount();
+        for (int i = 0; i < CONFIG_GEOGRAM_HTTP_CLIENT_HOSTS; i++) {
+            if (w.conns[i].connected && now - w.conns[i].last_used >= idle) {
+                ESP_LOGD(TAG, "Closing idle connection to %s", w.conns[i].origin);
+                conn_close(&w.conns[i]);
+            }
+        }
+
+        if (job == NULL) {
+            continue;
+        }
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        bool cancelled = job->cancelled;
+        job->state = JOB_RUNNING;
+        xSemaphoreGive(s_lock);
+
+        if (cancelled) {
+            // Caller timed out while the job was queued
+            job_free(job);
+            continue;
+        }
+
+        esp_err_t result = run_job(&w, job);
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        job->result = job->cancelled ? ESP_ERR_TIMEOUT : result;
+        job->state = JOB_DONE;
+        xSemaphoreGive(s_lock);
+
+        // Signal completion
+        xSemaphoreGive(job->done_sem);
     }
+}
 
-    // Read response
-    int read_len = esp_http_client_read(client, (char *)resp->data, resp->buffer_size);
-    esp_http_client_close(client);
-    esp_http_client_cleanup(client);
+/**
+ * @brief Start the worker pool on first use
+ */
+static esp_err_t pool_start(void)
+{
+    bool start = false;
+    taskENTER_CRITICAL(&s_init_mux);
+    if (s_pool_state == 0) {
+        s_pool_state = 1;
+        start = true;
+    }
+    taskEXIT_CRITICAL(&s_init_mux);
 
-    if (read_len < 0) {
-        ESP_LOGE(TAG, "Failed to read HTTP response");
-        ctx->result = ESP_FAIL;
-        goto done;
+    if (!start) {
+        while (s_pool_state == 1) {
+            vTaskDelay(1);
+        }
+        return s_pool_state == 2 ? ESP_OK : ESP_ERR_NO_MEM;
     }
 
-    resp->data_len = (size_t)read_len;
-    ESP_LOGD(TAG, "HTTP GET complete: %zu bytes", resp->data_len);
-    ctx->result = ESP_OK;
+    s_lock = xSemaphoreCreateMutex();
+    s_pending = xSemaphoreCreateCounting(HTTP_QUEUE_DEPTH * HTTP_PRIORITIES, 0);
+    bool ok = s_lock != NULL && s_pending != NULL;
+    for (int i = 0; i < HTTP_PRIORITIES && ok; i++) {
+        s_queues[i] = xQueueCreate(HTTP_QUEUE_DEPTH, sizeof(http_job_t *));
+        ok = s_queues[i] != NULL;
+    }
+
+    int workers = 0;
+    for (int i = 0; i < CONFIG_GEOGRAM_HTTP_CLIENT_WORKERS && ok; i++) {
+        char name[configMAX_TASK_NAME_LEN];
+        snprintf(name, sizeof(name), "http_req%d", i);
+        if (xTaskCreate(http_worker_task, name, HTTP_TASK_STACK_SIZE,
+                        NULL, HTTP_TASK_PRIORITY, NULL) == pdPASS) {
+            workers++;
+        }
+    }
 
-done:
-    // Signal completion
-    xSemaphoreGive(ctx->done_sem);
-    vTaskDelete(NULL);
+    if (workers == 0) {
+        // Objects of a failed start are kept; only reached on heap exhaustion
+        ESP_LOGE(TAG, "Failed to start HTTP workers");
+        s_pool_state = 0;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "HTTP client pool started (%d workers)", workers);
+    s_pool_state = 2;
+    return ESP_OK;
 }
 
 http_client_request_t http_client_default_config(void)
@@ -124,53 +576,180 @@ http_client_request_t http_client_default_config(void)
         .user_agent = DEFAULT_USER_AGENT,
         .timeout_ms = DEFAULT_TIMEOUT_MS,
         .skip_cert_verify = true,
+        .priority = HTTP_CLIENT_PRIORITY_NORMAL,
     };
     return config;
 }
 
-esp_err_t http_client_get_async(const http_client_request_t *request, http_client_response_t *response)
+/**
+ * @brief Queue a job and wait for it
+ */
+static esp_err_t submit(const http_client_request_t *request, const http_client_sink_t *sink,
+                        bool streaming, int *status_code)
 {
-    if (request == NULL || request->url == NULL || response == NULL) {
+    if (request == NULL || request->url == NULL || sink == NULL) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    if (response->data == NULL || response->buffer_size == 0) {
+    char origin[HTTP_ORIGIN_LEN];
+    if (!url_origin(request->url, origin, sizeof(origin)) ||
+        (unsigned)request->priority >= HTTP_PRIORITIES) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    // Create task context
-    http_task_ctx_t ctx = {
-        .request = *request,
-        .response = response,
-        .result = ESP_FAIL,
-        .done_sem = xSemaphoreCreateBinary()
-    };
+    esp_err_t ret = pool_start();
+    if (ret != ESP_OK) {
+        return ret;
+    }
 
-    if (ctx.done_sem == NULL) {
+    // Copy the strings; a queued job may outlive a caller that timed out
+    const char *user_agent = request->user_agent ? request->user_agent : DEFAULT_USER_AGENT;
+    size_t header_count = request->headers != NULL ? request->header_count : 0;
+    size_t strings_len = strlen(request->url) + 1 + strlen(user_agent) + 1;
+    for (size_t i = 0; i < header_count; i++) {
+        strings_len += strlen(request->headers[i].name) + 1 + strlen(request->headers[i].value) + 1;
+    }
+    size_t headers_size = header_count * sizeof(http_client_header_t);
+    http_job_t *job = calloc(1, sizeof(http_job_t) + headers_size + strings_len);
+    if (job == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    http_client_header_t *headers = (http_client_header_t *)(job + 1);
+    char *strings = (char *)headers + headers_size;
+    job->url = strings;
+    strings = stpcpy(strings, request->url) + 1;
+    job->user_agent = strings;
+    strings = stpcpy(strings, user_agent) + 1;
+    for (size_t i = 0; i < header_count; i++) {
+        headers[i].name = strings;
+        strings = stpcpy(strings, request->headers[i].name) + 1;
+        headers[i].value = strings;
+        strings = stpcpy(strings, request->headers[i].value) + 1;
+    }
+    job->headers = headers;
+    job->header_count = header_count;
+    job->timeout_ms = request->timeout_ms > 0 ? request->timeout_ms : DEFAULT_TIMEOUT_MS;
+    job->sink = *sink;
+    job->streaming = streaming;
+    job->result = ESP_FAIL;
+    job->state = JOB_QUEUED;
+    job->done_sem = xSemaphoreCreateBinary();
+    if (job->done_sem == NULL) {
         ESP_LOGE(TAG, "Failed to create semaphore");
+        free(job);
         return ESP_ERR_NO_MEM;
     }
 
-    // Spawn task with adequate stack for TLS
-    BaseType_t ret = xTaskCreate(http_request_task, "http_req", HTTP_TASK_STACK_SIZE,
-                                  &ctx, 5, NULL);
-    if (ret != pdPASS) {
-        ESP_LOGE(TAG, "Failed to create HTTP task");
-        vSemaphoreDelete(ctx.done_sem);
-        return ESP_ERR_NO_MEM;
+    // Wait budget covers both queueing and the request itself
+    TickType_t start = xTaskGetTickCount();
+    TickType_t budget = pdMS_TO_TICKS(job->timeout_ms + HTTP_WAIT_MARGIN_MS);
+
+    if (xQueueSend(s_queues[request->priority], &job, budget) != pdTRUE) {
+        ESP_LOGE(TAG, "HTTP request queue full");
+        job_free(job);
+        return ESP_ERR_TIMEOUT;
     }
+    xSemaphoreGive(s_pending);
 
-    // Calculate wait timeout
-    int timeout_ms = request->timeout_ms > 0 ? request->timeout_ms : DEFAULT_TIMEOUT_MS;
-    timeout_ms += 5000;  // Extra margin for task overhead
+    TickType_t elapsed = xTaskGetTickCount() - start;
+    TickType_t wait = elapsed < budget ? budget - elapsed : 0;
 
     // Wait for completion
-    if (xSemaphoreTake(ctx.done_sem, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
-        ESP_LOGE(TAG, "HTTP request timed out");
-        vSemaphoreDelete(ctx.done_sem);
-        return ESP_ERR_TIMEOUT;
+    if (xSemaphoreTake(job->done_sem, wait) != pdTRUE) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        bool queued = job->state == JOB_QUEUED;
+        if (queued || !streaming) {
+            job->cancelled = true;
+        }
+        xSemaphoreGive(s_lock);
+
+        if (queued) {
+            // The worker that picks it up frees it
+            ESP_LOGE(TAG, "HTTP request timed out in queue");
+            return ESP_ERR_TIMEOUT;
+        }
+        if (!streaming) {
+            ESP_LOGE(TAG, "HTTP request timed out");
+        }
+
+        // The worker is still using the caller's sink; a buffered request
+        // stops at the next read, a stream runs until the socket times out
+        xSemaphoreTake(job->done_sem, portMAX_DELAY);
+    }
+
+    ret = job->result;
+    if (status_code != NULL) {
+        *status_code = job->status_code;
+    }
+    job_free(job);
+    return ret;
+}
+
+/**
+ * @brief Sink storing the body of a 200 response in the caller's buffer
+ */
+static esp_err_t buffer_on_headers(void *ctx, int status_code, int64_t content_length)
+{
+    http_client_response_t *resp = ctx;
+
+    // A reconnect after a dropped keep-alive connection starts over
+    resp->status_code = status_code;
+    resp->data_len = 0;
+
+    // Check if response fits in buffer
+    if (status_code == 200 && content_length > 0 &&
+        (uint64_t)content_length > resp->buffer_size) {
+        ESP_LOGE(TAG, "Response too large: %lld bytes (buffer: %zu)",
+                 (long long)content_length, resp->buffer_size);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t buffer_on_data(void *ctx, const uint8_t *data, size_t len)
+{
+    http_client_response_t *resp = ctx;
+
+    if (resp->status_code != 200) {
+        return ESP_OK;
+    }
+    if (len > resp->buffer_size - resp->data_len) {
+        ESP_LOGE(TAG, "Response too large (buffer: %zu)", resp->buffer_size);
+        return ESP_ERR_NO_MEM;
     }
+    memcpy(resp->data + resp->data_len, data, len);
+    resp->data_len += len;
+    return ESP_OK;
+}
 
-    vSemaphoreDelete(ctx.done_sem);
-    return ctx.result;
+esp_err_t http_client_get_async(const http_client_request_t *request, http_client_response_t *response)
+{
+    if (response == NULL || response->data == NULL || response->buffer_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Initialize response
+    response->status_code = 0;
+    response->data_len = 0;
+
+    const http_client_sink_t sink = {
+        .on_headers = buffer_on_headers,
+        .on_data = buffer_on_data,
+        .ctx = response,
+    };
+    return submit(request, &sink, false, NULL);
+}
+
+esp_err_t http_client_get_stream(const http_client_request_t *request,
+                                 const http_client_sink_t *sink, int *status_code)
+{
+    if (status_code != NULL) {
+        *status_code = 0;
+    }
+
+    esp_err_t ret = submit(request, sink, true, status_code);
+    if (sink != NULL && sink->on_complete != NULL) {
+        sink->on_complete(sink->ctx, ret);
+    }
+    return ret;
 }
@@ -1,9 +1,17 @@
 /**
  * @file http_client_async.h
- * @brief Async HTTP client for ESP32 - runs requests in separate task with adequate TLS stack
+ * @brief Async HTTP client for ESP32 - runs requests on worker tasks with adequate TLS stack
  *
  * ESP-IDF's HTTP client with TLS requires a larger stack than the default httpd task provides.
- * This wrapper runs HTTP requests in a dedicated task with sufficient stack for TLS operations.
+ * This wrapper runs HTTP requests on a fixed pool of worker tasks with sufficient stack for
+ * TLS operations (CONFIG_GEOGRAM_HTTP_CLIENT_WORKERS), fed by a priority queue.
+ *
+ * Each worker keeps one client per host open between requests (HTTP keep-alive), and closed
+ * connections resume their TLS session from a session ticket, so back-to-back requests to the
+ * same server skip the TLS handshake.
+ *
+ * Redirects are followed. http_client_get_async() collects the body in one caller buffer. Larger downloads use
+ * http_client_get_stream(), which hands the body to a sink in fixed-size chunks.
  */
 
 #pragma once
@@ -17,6 +25,23 @@
 extern "C" {
 #endif
 
+/**
+ * @brief Request queue priority
+ */
+typedef enum {
+    HTTP_CLIENT_PRIORITY_NORMAL = 0,    /**< Default */
+    HTTP_CLIENT_PRIORITY_HIGH,          /**< Served before all queued normal requests */
+    HTTP_CLIENT_PRIORITY_LOW,           /**< Background work, served when nothing else waits */
+} http_client_priority_t;
+
+/**
+ * @brief Extra request header
+ */
+typedef struct {
+    const char *name;
+    const char *value;
+} http_client_header_t;
+
 /**
  * @brief HTTP request configuration
  */
@@ -25,6 +50,9 @@ typedef struct {
     const char *user_agent;     /**< User agent string (optional, defaults to "ESP32-HTTP/1.0") */
     int timeout_ms;             /**< Request timeout in ms (optional, defaults to 15000) */
     bool skip_cert_verify;      /**< Skip TLS certificate verification (default: true for simplicity) */
+    http_client_priority_t priority; /**< Queue priority (optional, defaults to normal) */
+    const http_client_header_t *headers; /**< Extra request headers (optional) */
+    size_t header_count;        /**< Number of extra request headers */
 } http_client_request_t;
 
 /**
@@ -38,18 +66,58 @@ typedef struct {
 } http_client_response_t;
 
 /**
- * @brief Perform HTTP GET request asynchronously (in separate task)
+ * @brief Receiver of a streamed response
+ *
+ * on_headers and on_data run on the worker task; any callback may be NULL.
+ * A callback returning an error aborts the request with that error.
+ */
+typedef struct {
+    /** One header of the final response (after redirects); headers that do
+     *  not fit the worker's 2 KB header store are skipped */
+    void (*on_header)(void *ctx, const char *name, const char *value);
+    /** Status line and headers received (content_length is -1 if unknown,
+     *  e.g. chunked; IDF cannot tell an empty body apart, so 0 never shows).
+     *  May be called again if a kept connection had to be reopened before
+     *  any body byte arrived. */
+    esp_err_t (*on_headers)(void *ctx, int status_code, int64_t content_length);
+    /** Next piece of the body of a 2xx response (at most 4 KB) */
+    esp_err_t (*on_data)(void *ctx, const uint8_t *data, size_t len);
+    /** Called once with the final result, before http_client_get_stream() returns */
+    void (*on_complete)(void *ctx, esp_err_t result);
+    void *ctx;                  /**< Passed to every callback */
+} http_client_sink_t;
+
+/**
+ * @brief Perform HTTP GET request asynchronously (on a worker task)
  *
- * This function spawns a temporary task with adequate stack for TLS operations,
- * performs the HTTP request, and returns the response. The caller blocks until
- * the request completes or times out.
+ * Queues the request for the worker pool, which is started on first use.
+ * The caller blocks until the request completes or times out.
  *
  * @param request Request configuration
  * @param response Response buffer (caller provides data buffer)
- * @return ESP_OK on success, ESP_FAIL on HTTP error, ESP_ERR_TIMEOUT on timeout
+ * @return ESP_OK once a response was received (check status_code; the body
+ *         is only stored for 200), ESP_ERR_NO_MEM if the body does not fit
+ *         the buffer, ESP_ERR_TIMEOUT on timeout, or the connection error
  */
 esp_err_t http_client_get_async(const http_client_request_t *request, http_client_response_t *response);
 
+/**
+ * @brief Perform HTTP GET request and stream the body to a sink
+ *
+ * The caller blocks until the download ends. timeout_ms bounds the time in
+ * the queue and every network operation, not the whole download, so bodies
+ * of any size can be received with bounded RAM.
+ *
+ * @param request Request configuration
+ * @param sink Response receiver
+ * @param status_code Receives the HTTP status (may be NULL)
+ * @return ESP_OK once a response was received (check status_code; the body
+ *         is only passed on for 2xx), ESP_ERR_TIMEOUT if the request was not
+ *         started in time, the first sink error, or the connection error
+ */
+esp_err_t http_client_get_stream(const http_client_request_t *request,
+                                 const http_client_sink_t *sink, int *status_code);
+
 /**
  * @brief Get default request configuration
  *
@@ -0,0 +1,277 @@
+#include "json_stream.h"
+#include <string.h>
+
+enum {
+    ST_VALUE,           // Expecting a value
+    ST_VALUE_OR_END,    // After '[': a value or ']'
+    ST_KEY_OR_END,      // After '{': a key or '}'
+    ST_KEY,             // After ',' in an object
+    ST_COLON,
+    ST_AFTER,           // After a value: ',' or a closing bracket
+    ST_STRING,
+    ST_ESCAPE,
+    ST_UNICODE,
+    ST_LITERAL,         // Number, true, false or null
+    ST_DONE,
+};
+
+static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool is_literal_char(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+           c == '-' || c == '+' || c == '.' || c == 'E';
+}
+
+static bool parent_is_object(const geo_json_stream_t *s, int depth) {
+    return depth > 0 && ((s->is_object >> (depth - 1)) & 1);
+}
+
+static const char *key_for(const geo_json_stream_t *s, int depth) {
+    return parent_is_object(s, depth) ? s->keys[depth] : NULL;
+}
+
+static void token_add(geo_json_stream_t *s, char c) {
+    if (s->token_len < sizeof(s->token) - 1) {
+        s->token[s->token_len++] = c;
+    }
+}
+
+// Emit a scalar at the current depth and move past it
+static void scalar_done(geo_json_stream_t *s, geo_json_event_t event) {
+    s->token[s->token_len] = '\0';
+    s->cb(s->ctx, event, s->depth, key_for(s, s->depth), s->token);
+    s->state = s->depth == 0 ? ST_DONE : ST_AFTER;
+    if (s->depth == 0) {
+        s->done = true;
+    }
+}
+
+static bool open_container(geo_json_stream_t *s, bool object) {
+    int depth = s->depth;
+    if (depth >= GEO_JSON_STREAM_DEPTH - 1) {
+        return false;
+    }
+    s->cb(s->ctx, object ? GEO_JSON_OBJECT_START : GEO_JSON_ARRAY_START,
+          depth, key_for(s, depth), NULL);
+    if (object) {
+        s->is_object |= (1u << depth);
+    } else {
+        s->is_object &= ~(1u << depth);
+    }
+    s->depth = depth + 1;
+    s->state = object ? ST_KEY_OR_END : ST_VALUE_OR_END;
+    return true;
+}
+
+static bool close_container(geo_json_stream_t *s, char c) {
+    if (s->depth == 0) {
+        return false;
+    }
+    int depth = s->depth - 1;
+    bool object = (s->is_object >> depth) & 1;
+    if (c != (object ? '}' : ']')) {
+        return false;
+    }
+    s->depth = depth;
+    s->cb(s->ctx, object ? GEO_JSON_OBJECT_END : GEO_JSON_ARRAY_END,
+          depth, key_for(s, depth), NULL);
+    s->state = depth == 0 ? ST_DONE : ST_AFTER;
+    if (depth == 0) {
+        s->done = true;
+    }
+    return true;
+}
+
+static bool start_value(geo_json_stream_t *s, char c) {
+    if (c == '{') {
+        return open_container(s, true);
+    }
+    if (c == '[') {
+        return open_container(s, false);
+    }
+    s->token_len = 0;
+    if (c == '"') {
+        s->in_key = false;
+        s->state = ST_STRING;
+        return true;
+    }
+    if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n') {
+        token_add(s, c);
+        s->state = ST_LITERAL;
+        return true;
+    }
+    return false;
+}
+
+static void add_utf8(geo_json_stream_t *s, uint16_t cp) {
+    if (cp >= 0xD800 && cp <= 0xDFFF) {
+        // Surrogate halves are not paired up
+        token_add(s, '?');
+    } else if (cp < 0x80) {
+        token_add(s, (char)cp);
+    } else if (cp < 0x800) {
+        token_add(s, (char)(0xC0 | (cp >> 6)));
+        token_add(s, (char)(0x80 | (cp & 0x3F)));
+    } else {
+        token_add(s, (char)(0xE0 | (cp >> 12)));
+        token_add(s, (char)(0x80 | ((cp >> 6) & 0x3F)));
+        token_add(s, (char)(0x80 | (cp & 0x3F)));
+    }
+}
+
+static bool finish_literal(geo_json_stream_t *s) {
+    s->token[s->token_len] = '\0';
+    if (strcmp(s->token, "true") == 0 || strcmp(s->token, "false") == 0) {
+        scalar_done(s, GEO_JSON_BOOL);
+    } else if (strcmp(s->token, "null") == 0) {
+        scalar_done(s, GEO_JSON_NULL);
+    } else if (s->token[0] == '-' || (s->token[0] >= '0' && s->token[0] <= '9')) {
+        scalar_done(s, GEO_JSON_NUMBER);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool step(geo_json_stream_t *s, char c) {
+    switch (s->state) {
+        case ST_STRING:
+            if (c == '"') {
+                if (s->in_key) {
+                    size_t len = s->token_len < GEO_JSON_STREAM_KEY - 1 ?
+                                 s->token_len : GEO_JSON_STREAM_KEY - 1;
+                    memcpy(s->keys[s->depth], s->token, len);
+                    s->keys[s->depth][len] = '\0';
+                    s->state = ST_COLON;
+                } else {
+                    scalar_done(s, GEO_JSON_STRING);
+                }
+            } else if (c == '\\') {
+                s->state = ST_ESCAPE;
+            } else if ((unsigned char)c < 0x20) {
+                return false;
+            } else {
+                token_add(s, c);
+            }
+            return true;
+
+        case ST_ESCAPE:
+            s->state = ST_STRING;
+            switch (c) {
+                case '"': case '\\': case '/': token_add(s, c); break;
+                case 'b': token_add(s, '\b'); break;
+                case 'f': token_add(s, '\f'); break;
+                case 'n': token_add(s, '\n'); break;
+                case 'r': token_add(s, '\r'); break;
+                case 't': token_add(s, '\t'); break;
+                case 'u':
+                    s->hex_left = 4;
+                    s->hex_value = 0;
+                    s->state = ST_UNICODE;
+                    break;
+                default: return false;
+            }
+            return true;
+
+        case ST_UNICODE: {
+            int digit;
+            if (c >= '0' && c <= '9') digit = c - '0';
+            else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+            else return false;
+            s->hex_value = (uint16_t)((s->hex_value << 4) | digit);
+            if (--s->hex_left == 0) {
+                add_utf8(s, s->hex_value);
+                s->state = ST_STRING;
+            }
+            return true;
+        }
+
+        case ST_LITERAL:
+            if (is_literal_char(c)) {
+                token_add(s, c);
+                return true;
+            }
+            if (!finish_literal(s)) {
+                return false;
+            }
+            // The delimiter belongs to what follows
+            return step(s, c);
+
+        default:
+            break;
+    }
+
+    if (is_space(c)) {
+        return true;
+    }
+
+    switch (s->state) {
+        case ST_VALUE_OR_END:
+            if (c == ']') {
+                return close_container(s, c);
+            }
+            return start_value(s, c);
+
+        case ST_VALUE:
+            return start_value(s, c);
+
+        case ST_KEY_OR_END:
+            if (c == '}') {
+                return close_container(s, c);
+            }
+            // fall through
+        case ST_KEY:
+            if (c != '"') {
+                return false;
+            }
+            s->token_len = 0;
+            s->in_key = true;
+            s->state = ST_STRING;
+            return true;
+
+        case ST_COLON:
+            if (c != ':') {
+                return false;
+            }
+            s->state = ST_VALUE;
+            return true;
+
+        case ST_AFTER:
+            if (c == ',') {
+                s->state = parent_is_object(s, s->depth) ? ST_KEY : ST_VALUE;
+                return true;
+            }
+            return close_container(s, c);
+
+        default:
+            // Only whitespace may follow the top-level value
+            return false;
+    }
+}
+
+void geo_json_stream_init(geo_json_stream_t *stream, geo_json_stream_cb_t cb, void *ctx) {
+    memset(stream, 0, sizeof(*stream));
+    stream->cb = cb;
+    stream->ctx = ctx;
+    stream->state = ST_VALUE;
+}
+
+bool geo_json_stream_feed(geo_json_stream_t *stream, const char *data, size_t len) {
+    if (stream->error) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (!step(stream, data[i])) {
+            stream->error = true;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool geo_json_stream_done(const geo_json_stream_t *stream) {
+    return stream->done && !stream->error;
+}
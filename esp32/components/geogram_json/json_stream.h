@@ -0,0 +1,69 @@
+#ifndef GEOGRAM_JSON_STREAM_H
+#define GEOGRAM_JSON_STREAM_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Longest string or number passed to the callback; longer ones are truncated
+#define GEO_JSON_STREAM_TOKEN   256
+// Longest object key kept
+#define GEO_JSON_STREAM_KEY     48
+// Deepest nesting accepted
+#define GEO_JSON_STREAM_DEPTH   32
+
+// Incremental (SAX-style) JSON scanner. Input can be fed in pieces of any
+// size as it arrives, so documents are read without buffering them whole.
+typedef enum {
+    GEO_JSON_OBJECT_START,
+    GEO_JSON_OBJECT_END,
+    GEO_JSON_ARRAY_START,
+    GEO_JSON_ARRAY_END,
+    GEO_JSON_STRING,        // value: unescaped text
+    GEO_JSON_NUMBER,        // value: number as written
+    GEO_JSON_BOOL,          // value: "true" or "false"
+    GEO_JSON_NULL,
+} geo_json_event_t;
+
+// Called for every value. depth is 0 for the top-level value, 1 for its
+// members and so on; key is the member name inside an object and NULL
+// for array elements. Container end events carry the same depth and key
+// as their start.
+typedef void (*geo_json_stream_cb_t)(void *ctx, geo_json_event_t event, int depth,
+                                     const char *key, const char *value);
+
+typedef struct {
+    geo_json_stream_cb_t cb;
+    void *ctx;
+    uint8_t state;
+    uint8_t hex_left;           // Digits left in a \uXXXX escape
+    uint16_t hex_value;
+    bool in_key;                // String being read is an object key
+    bool error;
+    bool done;                  // Top-level value complete
+    int depth;                  // Open containers
+    uint32_t is_object;         // Bit per depth: container is an object
+    size_t token_len;
+    char token[GEO_JSON_STREAM_TOKEN];
+    char keys[GEO_JSON_STREAM_DEPTH][GEO_JSON_STREAM_KEY];  // Member key per depth
+} geo_json_stream_t;
+
+// Prepare a scanner; the struct is about 2 KB, allocate it accordingly
+void geo_json_stream_init(geo_json_stream_t *stream, geo_json_stream_cb_t cb, void *ctx);
+
+// Feed the next piece of the document. Returns false on a syntax error
+// (further input is ignored).
+bool geo_json_stream_feed(geo_json_stream_t *stream, const char *data, size_t len);
+
+// True once a complete top-level value was read
+bool geo_json_stream_done(const geo_json_stream_t *stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_JSON_STREAM_H
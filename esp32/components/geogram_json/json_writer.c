@@ -0,0 +1,133 @@
+#include "json_writer.h"
+#include <stdio.h>
+#include <string.h>
+
+static void flush(geo_json_writer_t *w) {
+    if (w->pos > 0 && !w->error) {
+        w->error = !w->sink(w->ctx, w->buf, w->pos);
+    }
+    w->pos = 0;
+}
+
+static void put(geo_json_writer_t *w, const char *data, size_t len) {
+    while (len > 0 && !w->error) {
+        if (w->pos == w->size) {
+            flush(w);
+            continue;
+        }
+        size_t n = w->size - w->pos;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(w->buf + w->pos, data, n);
+        w->pos += n;
+        data += n;
+        len -= n;
+    }
+}
+
+static void put_str(geo_json_writer_t *w, const char *s) {
+    put(w, s, strlen(s));
+}
+
+static void put_escaped(geo_json_writer_t *w, const char *s) {
+    put(w, "\"", 1);
+    const char *run = s;
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        // Copy the plain run before the character, then its escape
+        put(w, run, (size_t)(s - run));
+        run = s + 1;
+        char esc[8];
+        switch (c) {
+            case '"':  put(w, "\\\"", 2); break;
+            case '\\': put(w, "\\\\", 2); break;
+            case '\n': put(w, "\\n", 2); break;
+            case '\r': put(w, "\\r", 2); break;
+            case '\t': put(w, "\\t", 2); break;
+            default:
+                snprintf(esc, sizeof(esc), "\\u%04x", c);
+                put(w, esc, 6);
+                break;
+        }
+    }
+    put(w, run, (size_t)(s - run));
+    put(w, "\"", 1);
+}
+
+// Separator and key before a value
+static void member(geo_json_writer_t *w, const char *key) {
+    if (!w->first) {
+        put(w, ",", 1);
+    }
+    w->first = false;
+    if (key) {
+        put_escaped(w, key);
+        put(w, ":", 1);
+    }
+}
+
+void geo_json_writer_init(geo_json_writer_t *w, char *buf, size_t size,
+                          geo_json_sink_t sink, void *ctx) {
+    w->sink = sink;
+    w->ctx = ctx;
+    w->buf = buf;
+    w->size = size;
+    w->pos = 0;
+    w->first = true;
+    w->error = (buf == NULL || size == 0);
+}
+
+void geo_json_writer_object_start(geo_json_writer_t *w, const char *key) {
+    member(w, key);
+    put(w, "{", 1);
+    w->first = true;
+}
+
+void geo_json_writer_object_end(geo_json_writer_t *w) {
+    put(w, "}", 1);
+    w->first = false;
+}
+
+void geo_json_writer_array_start(geo_json_writer_t *w, const char *key) {
+    member(w, key);
+    put(w, "[", 1);
+    w->first = true;
+}
+
+void geo_json_writer_array_end(geo_json_writer_t *w) {
+    put(w, "]", 1);
+    w->first = false;
+}
+
+void geo_json_writer_string(geo_json_writer_t *w, const char *key, const char *value) {
+    member(w, key);
+    put_escaped(w, value ? value : "");
+}
+
+void geo_json_writer_int(geo_json_writer_t *w, const char *key, int32_t value) {
+    char num[16];
+    member(w, key);
+    snprintf(num, sizeof(num), "%ld", (long)value);
+    put_str(w, num);
+}
+
+void geo_json_writer_uint(geo_json_writer_t *w, const char *key, uint32_t value) {
+    char num[16];
+    member(w, key);
+    snprintf(num, sizeof(num), "%lu", (unsigned long)value);
+    put_str(w, num);
+}
+
+void geo_json_writer_bool(geo_json_writer_t *w, const char *key, bool value) {
+    member(w, key);
+    put_str(w, value ? "true" : "false");
+}
+
+bool geo_json_writer_finish(geo_json_writer_t *w) {
+    flush(w);
+    return !w->error;
+}
@@ -0,0 +1,55 @@
+#ifndef GEOGRAM_JSON_WRITER_H
+#define GEOGRAM_JSON_WRITER_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Streaming JSON writer. Output collects in a small caller-provided buffer
+// that is handed to a sink whenever it fills up, so documents of any size
+// are produced in constant memory (e.g. straight into
+// httpd_resp_send_chunk()).
+//
+// Keys are written as given; pass NULL as key for array elements and the
+// top-level value. Errors are sticky: once the sink fails, further calls
+// do nothing and geo_json_writer_finish() reports the failure.
+
+// Receives the next piece of output. Returns false to abort.
+typedef bool (*geo_json_sink_t)(void *ctx, const char *data, size_t len);
+
+typedef struct {
+    geo_json_sink_t sink;
+    void *ctx;
+    char *buf;
+    size_t size;
+    size_t pos;
+    bool first;                 // No member written yet in the open container
+    bool error;
+} geo_json_writer_t;
+
+// Prepare a writer; buf must stay valid until geo_json_writer_finish()
+void geo_json_writer_init(geo_json_writer_t *w, char *buf, size_t size,
+                          geo_json_sink_t sink, void *ctx);
+
+void geo_json_writer_object_start(geo_json_writer_t *w, const char *key);
+void geo_json_writer_object_end(geo_json_writer_t *w);
+void geo_json_writer_array_start(geo_json_writer_t *w, const char *key);
+void geo_json_writer_array_end(geo_json_writer_t *w);
+
+void geo_json_writer_string(geo_json_writer_t *w, const char *key, const char *value);
+void geo_json_writer_int(geo_json_writer_t *w, const char *key, int32_t value);
+void geo_json_writer_uint(geo_json_writer_t *w, const char *key, uint32_t value);
+void geo_json_writer_bool(geo_json_writer_t *w, const char *key, bool value);
+
+// Hand the buffered rest to the sink. Returns false if any write failed.
+bool geo_json_writer_finish(geo_json_writer_t *w);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_JSON_WRITER_H
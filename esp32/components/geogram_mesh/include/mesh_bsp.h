@@ -158,6 +158,13 @@ uint8_t geogram_mesh_get_subnet_id(void);
  */
 esp_err_t geogram_mesh_get_parent_mac(uint8_t *mac);
 
+/**
+ * @brief Get parent node IP address (its SoftAP address, our gateway)
+ * @param ip Receives the IPv4 address (network byte order)
+ * @return ESP_OK if parent exists and an address is assigned
+ */
+esp_err_t geogram_mesh_get_parent_ip(uint32_t *ip);
+
 /**
  * @brief Check if this node has a parent (connected to mesh)
  * @return true if connected to a parent mesh node
@@ -221,6 +228,15 @@ uint8_t geogram_mesh_get_external_ap_client_count(void);
 // Node Discovery
 // ============================================================================
 
+/**
+ * @brief Maximum number of nodes in the mesh routing table
+ */
+#ifdef CONFIG_MESH_LITE_MAXIMUM_NODE_NUMBER
+#define GEOGRAM_MESH_MAX_NODES  CONFIG_MESH_LITE_MAXIMUM_NODE_NUMBER
+#else
+#define GEOGRAM_MESH_MAX_NODES  50
+#endif
+
 /**
  * @brief Get list of known mesh nodes
  * @param nodes Buffer for node info
@@ -314,6 +330,36 @@ esp_err_t geogram_mesh_send_to_node(const uint8_t *dest_mac, const void *data, s
 typedef void (*geogram_mesh_data_cb_t)(const uint8_t *src_mac, const void *data, size_t len);
 void geogram_mesh_register_data_callback(geogram_mesh_data_cb_t callback);
 
+// ============================================================================
+// Application Packets
+// ============================================================================
+
+/**
+ * @brief Maximum number of application packet handlers
+ */
+#define GEOGRAM_MESH_MAX_PACKET_HANDLERS    4
+
+/**
+ * @brief Receive application packets from other nodes
+ *
+ * Handlers see every packet delivered while bridging is enabled (after
+ * chat) and must ignore packets whose magic is not theirs. They run in
+ * the mesh receive task, so they should only copy data or signal a task.
+ *
+ * @param handler Function to call with received packets
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if all slots are taken
+ */
+esp_err_t geogram_mesh_add_packet_handler(geogram_mesh_data_cb_t handler);
+
+/**
+ * @brief Send a packet to every other node in the mesh
+ *
+ * @param data Packet (keep it small, it travels as one ESP-NOW frame)
+ * @param len Packet length
+ * @return Number of nodes the packet was sent to
+ */
+size_t geogram_mesh_broadcast(const void *data, size_t len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -37,6 +37,11 @@ extern "C" {
  */
 #define MESH_CHAT_HISTORY_SIZE      100
 
+/**
+ * @brief Maximum number of registered message callbacks
+ */
+#define MESH_CHAT_MAX_CALLBACKS     4
+
 /**
  * @brief Maximum filename length for file messages
  */
@@ -85,6 +90,14 @@ typedef struct {
  */
 typedef void (*mesh_chat_callback_t)(const mesh_chat_message_t *msg);
 
+/**
+ * @brief Visitor for mesh_chat_foreach_since()
+ * @param msg Message in the history (valid during the call only)
+ * @param ctx Caller context
+ * @return true to continue, false to stop
+ */
+typedef bool (*mesh_chat_visit_cb_t)(const mesh_chat_message_t *msg, void *ctx);
+
 /**
  * @brief Initialize chat system
  * @return ESP_OK on success
@@ -172,18 +185,27 @@ size_t mesh_chat_get_count(void);
 
 /**
  * @brief Register callback for new messages
+ *
+ * Up to MESH_CHAT_MAX_CALLBACKS callbacks can be registered; each is
+ * called for every new message (local or received) in the context of
+ * whoever added it, so callbacks must not block.
+ *
  * @param callback Function to call when message received
  */
 void mesh_chat_register_callback(mesh_chat_callback_t callback);
 
 /**
- * @brief Build JSON array of chat messages
- * @param buffer Output buffer
- * @param size Buffer size
- * @param since_id Only include messages with ID > since_id
- * @return Number of bytes written
+ * @brief Visit messages in history order without copying them
+ *
+ * The history is locked while visiting, so new messages wait until the
+ * walk is done; keep the visitor short.
+ *
+ * @param since_id Only visit messages with ID > since_id (0 for all)
+ * @param visit Called for each message; return false to stop
+ * @param ctx Passed to visit
+ * @return Number of messages visited
  */
-size_t mesh_chat_build_json(char *buffer, size_t size, uint32_t since_id);
+size_t mesh_chat_foreach_since(uint32_t since_id, mesh_chat_visit_cb_t visit, void *ctx);
 
 /**
  * @brief Internal: Handle incoming mesh chat packet
@@ -10,7 +10,9 @@
 
 #include "mesh_bsp.h"
 #include "mesh_chat.h"
+#include "geogram_metrics.h"
 
+#include <stdlib.h>
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -18,6 +20,7 @@
 #include "esp_log.h"
 #include "esp_mac.h"
 #include "esp_netif.h"
+#include "esp_wifi.h"
 #include "lwip/ip4_addr.h"
 #include "lwip/netif.h"
 #include "lwip/pbuf.h"
@@ -63,6 +66,10 @@ typedef struct __attribute__((packed)) {
 
 static bool s_bridge_enabled = false;
 
+// Application packet handlers (geogram_mesh_add_packet_handler)
+static geogram_mesh_data_cb_t s_packet_handlers[GEOGRAM_MESH_MAX_PACKET_HANDLERS];
+static size_t s_packet_handler_count = 0;
+
 // Statistics
 static uint32_t s_packets_tx = 0;
 static uint32_t s_packets_rx = 0;
@@ -75,6 +82,7 @@ static uint32_t s_bytes_rx = 0;
 
 static void mesh_data_handler(const uint8_t *src_mac, const void *data, size_t len);
 static uint16_t calculate_checksum(const uint8_t *data, size_t len);
+static void bridge_collect_metrics(void);
 
 // ============================================================================
 // Public API
@@ -106,6 +114,7 @@ esp_err_t geogram_mesh_enable_bridge(void)
     s_packets_rx = 0;
     s_bytes_tx = 0;
     s_bytes_rx = 0;
+    geo_metrics_register_collector(bridge_collect_metrics);
 
     ESP_LOGI(TAG, "[BRIDGE] Data bridging enabled successfully");
     return ESP_OK;
@@ -142,6 +151,80 @@ void geogram_mesh_bridge_get_stats(uint32_t *packets_tx, uint32_t *packets_rx,
     if (bytes_rx) *bytes_rx = s_bytes_rx;
 }
 
+/**
+ * @brief Copy the bridge counters into /api/metrics
+ *
+ * The counters restart when the bridge is re-enabled; Prometheus treats
+ * that as a counter reset.
+ */
+static void bridge_collect_metrics(void)
+{
+    static geo_metric_t *packets_tx, *packets_rx, *bytes_tx, *bytes_rx, *nodes;
+    if (packets_tx == NULL) {
+        packets_tx = geo_metric_counter("geogram_mesh_packets_total", "direction=\"tx\"",
+                                        "Packets bridged over the mesh");
+        packets_rx = geo_metric_counter("geogram_mesh_packets_total", "direction=\"rx\"",
+                                        "Packets bridged over the mesh");
+        bytes_tx = geo_metric_counter("geogram_mesh_bytes_total", "direction=\"tx\"",
+                                      "Payload bytes bridged over the mesh");
+        bytes_rx = geo_metric_counter("geogram_mesh_bytes_total", "direction=\"rx\"",
+                                      "Payload bytes bridged over the mesh");
+        nodes = geo_metric_gauge("geogram_mesh_nodes", NULL, "Nodes in the mesh");
+    }
+    geo_metric_set(packets_tx, s_packets_tx);
+    geo_metric_set(packets_rx, s_packets_rx);
+    geo_metric_set(bytes_tx, s_bytes_tx);
+    geo_metric_set(bytes_rx, s_bytes_rx);
+    geo_metric_set(nodes, geogram_mesh_get_node_count());
+}
+
+// ============================================================================
+// Application Packets
+// ============================================================================
+
+esp_err_t geogram_mesh_add_packet_handler(geogram_mesh_data_cb_t handler)
+{
+    if (!handler) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_packet_handler_count >= GEOGRAM_MESH_MAX_PACKET_HANDLERS) {
+        ESP_LOGE(TAG, "No free packet handler slot");
+        return ESP_ERR_NO_MEM;
+    }
+    s_packet_handlers[s_packet_handler_count++] = handler;
+    return ESP_OK;
+}
+
+size_t geogram_mesh_broadcast(const void *data, size_t len)
+{
+    if (!geogram_mesh_is_connected()) {
+        return 0;
+    }
+
+    uint8_t local_mac[6];
+    esp_wifi_get_mac(WIFI_IF_STA, local_mac);
+
+    // Whole routing table, too big for the callers' stacks
+    geogram_mesh_node_t *nodes = malloc(GEOGRAM_MESH_MAX_NODES * sizeof(geogram_mesh_node_t));
+    if (nodes == NULL) {
+        return 0;
+    }
+    size_t node_count = 0;
+    geogram_mesh_get_nodes(nodes, GEOGRAM_MESH_MAX_NODES, &node_count);
+
+    size_t sent = 0;
+    for (size_t i = 0; i < node_count; i++) {
+        if (memcmp(nodes[i].mac, local_mac, 6) == 0) {
+            continue;
+        }
+        if (geogram_mesh_send_to_node(nodes[i].mac, data, len) == ESP_OK) {
+            sent++;
+        }
+    }
+    free(nodes);
+    return sent;
+}
+
 // ============================================================================
 // Data Forwarding
 // ============================================================================
@@ -193,6 +276,10 @@ static void mesh_data_handler(const uint8_t *src_mac, const void *data, size_t l
     // First, try to handle as chat message
     mesh_chat_handle_packet(src_mac, data, len);
 
+    for (size_t i = 0; i < s_packet_handler_count; i++) {
+        s_packet_handlers[i](src_mac, data, len);
+    }
+
     // Check if it's a bridge packet
     if (len < sizeof(bridge_header_t)) {
         ESP_LOGD(TAG, "[BRIDGE RX] Packet too small for bridge header");
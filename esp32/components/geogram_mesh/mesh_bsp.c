@@ -475,6 +475,22 @@ esp_err_t geogram_mesh_get_parent_mac(uint8_t *mac)
     return ESP_OK;
 }
 
+esp_err_t geogram_mesh_get_parent_ip(uint32_t *ip)
+{
+    if (!ip) return ESP_ERR_INVALID_ARG;
+    if (!s_has_parent) return ESP_ERR_NOT_FOUND;
+
+    // The parent is the DHCP gateway of our station interface
+    esp_netif_t *sta = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    esp_netif_ip_info_t info;
+    if (!sta || esp_netif_get_ip_info(sta, &info) != ESP_OK || info.gw.addr == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    *ip = info.gw.addr;
+    return ESP_OK;
+}
+
 bool geogram_mesh_has_parent(void)
 {
     return s_has_parent;
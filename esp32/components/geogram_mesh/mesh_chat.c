@@ -61,7 +61,8 @@ static mesh_chat_message_t s_history[MESH_CHAT_HISTORY_SIZE];
 static size_t s_history_head = 0;  // Next write position
 static size_t s_history_count = 0;
 static uint32_t s_next_msg_id = 1;
-static mesh_chat_callback_t s_callback = NULL;
+static mesh_chat_callback_t s_callbacks[MESH_CHAT_MAX_CALLBACKS];
+static size_t s_callback_count = 0;
 static uint8_t s_local_mac[6] = {0};
 
 // ============================================================================
@@ -69,6 +70,7 @@ static uint8_t s_local_mac[6] = {0};
 // ============================================================================
 
 static void add_message_to_history(const mesh_chat_message_t *msg);
+static void notify_callbacks(const mesh_chat_message_t *msg);
 static uint32_t get_timestamp(void);
 
 // ============================================================================
@@ -190,10 +192,8 @@ esp_err_t mesh_chat_send(const char *text)
 
     add_message_to_history(&local_msg);
 
-    // Notify callback
-    if (s_callback) {
-        s_callback(&local_msg);
-    }
+    // Notify callbacks
+    notify_callbacks(&local_msg);
 
     // Broadcast to all mesh nodes
     if (geogram_mesh_is_connected()) {
@@ -274,9 +274,7 @@ esp_err_t mesh_chat_add_local_message_with_timestamp(const char *callsign,
 
     add_message_to_history(&local_msg);
 
-    if (s_callback) {
-        s_callback(&local_msg);
-    }
+    notify_callbacks(&local_msg);
 
     ESP_LOGI(TAG, "[CHAT RX] %s: %s", local_msg.callsign, local_msg.text);
     return ESP_OK;
@@ -336,9 +334,7 @@ esp_err_t mesh_chat_add_local_file_message(const char *callsign,
 
     add_message_to_history(&local_msg);
 
-    if (s_callback) {
-        s_callback(&local_msg);
-    }
+    notify_callbacks(&local_msg);
 
     return ESP_OK;
 }
@@ -436,10 +432,8 @@ esp_err_t mesh_chat_send_file(const char *text, const uint8_t *sha1,
 
     add_message_to_history(&local_msg);
 
-    // Notify callback
-    if (s_callback) {
-        s_callback(&local_msg);
-    }
+    // Notify callbacks
+    notify_callbacks(&local_msg);
 
     // Broadcast to all mesh nodes
     if (geogram_mesh_is_connected()) {
@@ -529,8 +523,10 @@ void mesh_chat_handle_packet(const uint8_t *src_mac, const void *data, size_t le
         .msg_type = msg_type
     };
     memcpy(msg.sender_mac, src_mac, 6);
-    strncpy(msg.callsign, wire_msg->callsign, MESH_CHAT_MAX_CALLSIGN_LEN - 1);
-    msg.callsign[MESH_CHAT_MAX_CALLSIGN_LEN - 1] = '\0';
+    // The wire field need not be terminated
+    size_t callsign_len = strnlen(wire_msg->callsign, MESH_CHAT_MAX_CALLSIGN_LEN - 1);
+    memcpy(msg.callsign, wire_msg->callsign, callsign_len);
+    msg.callsign[callsign_len] = '\0';
 
     size_t copy_len = wire_msg->text_len;
     if (copy_len > MESH_CHAT_MAX_MESSAGE_LEN) {
@@ -554,10 +550,8 @@ void mesh_chat_handle_packet(const uint8_t *src_mac, const void *data, size_t le
     // Add to history
     add_message_to_history(&msg);
 
-    // Notify callback
-    if (s_callback) {
-        s_callback(&msg);
-    }
+    // Notify callbacks
+    notify_callbacks(&msg);
 
 #if CONFIG_IDF_TARGET_ESP32C3
     // Blink blue LED 3 times to indicate incoming chat message
@@ -627,114 +621,62 @@ size_t mesh_chat_get_count(void)
 
 void mesh_chat_register_callback(mesh_chat_callback_t callback)
 {
-    s_callback = callback;
+    if (!callback) {
+        return;
+    }
+    for (size_t i = 0; i < s_callback_count; i++) {
+        if (s_callbacks[i] == callback) {
+            return;
+        }
+    }
+    if (s_callback_count >= MESH_CHAT_MAX_CALLBACKS) {
+        ESP_LOGE(TAG, "No free callback slot");
+        return;
+    }
+    s_callbacks[s_callback_count++] = callback;
+}
+
+static void notify_callbacks(const mesh_chat_message_t *msg)
+{
+    for (size_t i = 0; i < s_callback_count; i++) {
+        s_callbacks[i](msg);
+    }
 }
 
 // ============================================================================
 // JSON Builder
 // ============================================================================
 
-size_t mesh_chat_build_json(char *buffer, size_t size, uint32_t since_id)
+size_t mesh_chat_foreach_since(uint32_t since_id, mesh_chat_visit_cb_t visit, void *ctx)
 {
-    if (!buffer || size < 64) {
+    if (!s_initialized || !visit) {
         return 0;
     }
 
-    // Limit batch size to reduce memory usage (especially on ESP32-C3)
-    const size_t max_batch = 20;
-    mesh_chat_message_t *messages = malloc(sizeof(mesh_chat_message_t) * max_batch);
-    if (!messages) {
-        ESP_LOGE("mesh_chat", "Failed to alloc messages, free heap: %lu",
-                 (unsigned long)esp_get_free_heap_size());
-        return 0;
-    }
-    size_t count = mesh_chat_get_history(messages, max_batch, since_id);
-
-    // Get local callsign for identification
-    extern const char *nostr_keys_get_callsign(void);
-    const char *my_callsign = nostr_keys_get_callsign();
-    if (!my_callsign) my_callsign = "";
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
 
-    size_t pos = 0;
-    pos += snprintf(buffer + pos, size - pos,
-                    "{\"messages\":[");
+    size_t count = 0;
 
-    for (size_t i = 0; i < count; i++) {
-        if (i > 0) {
-            pos += snprintf(buffer + pos, size - pos, ",");
+    // Iterate through history in order (oldest to newest)
+    for (size_t i = 0; i < s_history_count; i++) {
+        size_t idx;
+        if (s_history_count < MESH_CHAT_HISTORY_SIZE) {
+            idx = i;
+        } else {
+            idx = (s_history_head + i) % MESH_CHAT_HISTORY_SIZE;
         }
 
-        // Escape the text for JSON
-        char escaped_text[MESH_CHAT_MAX_MESSAGE_LEN * 2 + 1];
-        size_t esc_pos = 0;
-        for (size_t j = 0; messages[i].text[j] && esc_pos < sizeof(escaped_text) - 2; j++) {
-            char c = messages[i].text[j];
-            if (c == '"' || c == '\\') {
-                escaped_text[esc_pos++] = '\\';
-            } else if (c == '\n') {
-                escaped_text[esc_pos++] = '\\';
-                c = 'n';
-            } else if (c == '\r') {
-                continue;
+        if (s_history[idx].id > since_id) {
+            count++;
+            if (!visit(&s_history[idx], ctx)) {
+                break;
             }
-            escaped_text[esc_pos++] = c;
         }
-        escaped_text[esc_pos] = '\0';
-
-        // Build message JSON with type
-        if (messages[i].msg_type == MESH_CHAT_MSG_FILE) {
-            // Convert SHA1 to hex string
-            char sha1_hex[41];
-            for (int j = 0; j < 20; j++) {
-                sprintf(sha1_hex + j * 2, "%02x", messages[i].file.sha1[j]);
-            }
-            sha1_hex[40] = '\0';
-
-            // Escape filename for JSON
-            char escaped_filename[MESH_CHAT_MAX_FILENAME_LEN * 2 + 1];
-            size_t fn_pos = 0;
-            for (size_t j = 0; messages[i].file.filename[j] && fn_pos < sizeof(escaped_filename) - 2; j++) {
-                char c = messages[i].file.filename[j];
-                if (c == '"' || c == '\\') {
-                    escaped_filename[fn_pos++] = '\\';
-                }
-                escaped_filename[fn_pos++] = c;
-            }
-            escaped_filename[fn_pos] = '\0';
-
-            pos += snprintf(buffer + pos, size - pos,
-                "{\"id\":%lu,\"ts\":%lu,\"from\":\"%s\",\"type\":\"file\",\"text\":\"%s\",\"local\":%s,"
-                "\"file\":{\"sha1\":\"%s\",\"name\":\"%s\",\"size\":%lu,\"mime\":\"%s\"}}",
-                (unsigned long)messages[i].id,
-                (unsigned long)messages[i].timestamp,
-                messages[i].callsign,
-                escaped_text,
-                messages[i].is_local ? "true" : "false",
-                sha1_hex,
-                escaped_filename,
-                (unsigned long)messages[i].file.size,
-                messages[i].file.mime_type);
-        } else {
-            pos += snprintf(buffer + pos, size - pos,
-                "{\"id\":%lu,\"ts\":%lu,\"from\":\"%s\",\"type\":\"text\",\"text\":\"%s\",\"local\":%s}",
-                (unsigned long)messages[i].id,
-                (unsigned long)messages[i].timestamp,
-                messages[i].callsign,
-                escaped_text,
-                messages[i].is_local ? "true" : "false");
-        }
-
-        if (pos >= size - 1) break;
     }
 
-    pos += snprintf(buffer + pos, size - pos,
-                    "],\"latest_id\":%lu,\"my_callsign\":\"%s\",\"max_len\":%d}",
-                    (unsigned long)mesh_chat_get_latest_id(),
-                    my_callsign,
-                    MESH_CHAT_MAX_MESSAGE_LEN);
+    xSemaphoreGive(s_mutex);
 
-    free(messages);
-    return pos;
+    return count;
 }
 
 // ============================================================================
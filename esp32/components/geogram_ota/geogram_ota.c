@@ -0,0 +1,597 @@
+/**
+ * @file geogram_ota.c
+ * @brief Streamed A/B firmware update with boot confirmation
+ */
+
+#include "geogram_ota.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_ota_ops.h"
+#include "esp_app_desc.h"
+#include "esp_image_format.h"
+#include "esp_timer.h"
+#include "mbedtls/sha256.h"
+#include "freertos/FreeRTOS.h"
+#include "http_client_async.h"
+#include "ota_delta.h"
+
+static const char *TAG = "ota";
+
+#ifndef BOARD_NAME
+#define BOARD_NAME "Unknown Board"
+#endif
+
+#define OTA_BOARD_MAGIC 0x44424747  // "GGBD"
+
+/**
+ * @brief Board the image was built for
+ *
+ * Custom app description: the linker places it right after esp_app_desc_t,
+ * so it is part of the header checked before an update is written.
+ */
+typedef struct {
+    uint32_t magic;
+    char board[32];
+} ota_board_desc_t;
+
+const __attribute__((section(".rodata_custom_desc"))) ota_board_desc_t geogram_ota_board_desc = {
+    .magic = OTA_BOARD_MAGIC,
+    .board = BOARD_NAME,
+};
+
+// Start of an image: checked before anything is written to flash
+#define OTA_HEADER_LEN  (sizeof(esp_image_header_t) + sizeof(esp_image_segment_header_t) + \
+                         sizeof(esp_app_desc_t) + sizeof(ota_board_desc_t))
+
+// Read size for file updates
+#define OTA_CHUNK_SIZE  4096
+
+// Interval between health checks of a firmware on trial
+#define OTA_HEALTH_RETRY_S  10
+
+typedef struct {
+    const esp_partition_t *partition;
+    esp_ota_handle_t handle;
+    bool begun;
+    mbedtls_sha256_context sha;
+    uint8_t header[OTA_HEADER_LEN];
+    size_t header_len;
+    bool header_checked;
+} ota_writer_t;
+
+// Progress of the current or last update
+static geogram_ota_status_t s_status = {0};
+static bool s_busy = false;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static esp_timer_handle_t s_confirm_timer = NULL;
+static geogram_ota_health_cb_t s_health = NULL;
+
+static bool update_claim(void)
+{
+    bool claimed = false;
+    taskENTER_CRITICAL(&s_lock);
+    if (!s_busy) {
+        s_busy = true;
+        claimed = true;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    return claimed;
+}
+
+static void update_release(esp_err_t result)
+{
+    s_status.result = result;
+    s_status.state = result == ESP_OK ? GEOGRAM_OTA_DONE : GEOGRAM_OTA_FAILED;
+
+    taskENTER_CRITICAL(&s_lock);
+    s_busy = false;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+static esp_err_t writer_begin(ota_writer_t *w, size_t total)
+{
+    memset(w, 0, sizeof(*w));
+
+    w->partition = esp_ota_get_next_update_partition(NULL);
+    if (w->partition == NULL) {
+        ESP_LOGE(TAG, "No update slot (partition table without ota_0/ota_1?)");
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (total > w->partition->size) {
+        ESP_LOGE(TAG, "Image of %u bytes does not fit %s (%u bytes)",
+                 (unsigned)total, w->partition->label, (unsigned)w->partition->size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // Sequential writes erase sector by sector instead of the whole slot up front
+    esp_err_t ret = esp_ota_begin(w->partition, OTA_WITH_SEQUENTIAL_WRITES, &w->handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "esp_ota_begin failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    w->begun = true;
+    mbedtls_sha256_init(&w->sha);
+    mbedtls_sha256_starts(&w->sha, 0);
+
+    s_status.written = 0;
+    s_status.total = total;
+    s_status.new_version[0] = '\0';
+    ESP_LOGI(TAG, "Writing image to %s", w->partition->label);
+    return ESP_OK;
+}
+
+/**
+ * @brief Refuse images that are not firmware for this station
+ */
+static esp_err_t writer_check_header(ota_writer_t *w)
+{
+    const esp_image_header_t *image = (const esp_image_header_t *)w->header;
+    esp_app_desc_t desc;
+    ota_board_desc_t board;
+    const uint8_t *p = w->header + sizeof(esp_image_header_t) + sizeof(esp_image_segment_header_t);
+    memcpy(&desc, p, sizeof(desc));
+    memcpy(&board, p + sizeof(desc), sizeof(board));
+
+    if (image->magic != ESP_IMAGE_HEADER_MAGIC || desc.magic_word != ESP_APP_DESC_MAGIC_WORD) {
+        ESP_LOGE(TAG, "Not a firmware image");
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (image->chip_id != CONFIG_IDF_FIRMWARE_CHIP_ID) {
+        ESP_LOGE(TAG, "Image is for another chip (id %d)", (int)image->chip_id);
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    const esp_app_desc_t *running = esp_app_get_description();
+    if (strncmp(desc.project_name, running->project_name, sizeof(desc.project_name)) != 0) {
+        ESP_LOGE(TAG, "Image is for project \"%.32s\"", desc.project_name);
+        return ESP_ERR_INVALID_VERSION;
+    }
+    // Same chip, other board: pins and peripherals differ
+    if (board.magic != OTA_BOARD_MAGIC) {
+        ESP_LOGE(TAG, "Image does not name its board");
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (strncmp(board.board, geogram_ota_board_desc.board, sizeof(board.board)) != 0) {
+        ESP_LOGE(TAG, "Image is for board \"%.32s\", this is \"%s\"",
+                 board.board, geogram_ota_board_desc.board);
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    strlcpy(s_status.new_version, desc.version, sizeof(s_status.new_version));
+    ESP_LOGI(TAG, "Image version %s (running %s)", s_status.new_version, running->version);
+    return ESP_OK;
+}
+
+static esp_err_t writer_write(ota_writer_t *w, const uint8_t *data, size_t len)
+{
+    mbedtls_sha256_update(&w->sha, data, len);
+    s_status.written += len;
+
+    if (!w->header_checked) {
+        size_t take = sizeof(w->header) - w->header_len;
+        if (take > len) {
+            take = len;
+        }
+        memcpy(w->header + w->header_len, data, take);
+        w->header_len += take;
+        data += take;
+        len -= take;
+        if (w->header_len < sizeof(w->header)) {
+            return ESP_OK;
+        }
+
+        esp_err_t ret = writer_check_header(w);
+        if (ret == ESP_OK) {
+            ret = esp_ota_write(w->handle, w->header, w->header_len);
+        }
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        w->header_checked = true;
+    }
+
+    return len > 0 ? esp_ota_write(w->handle, data, len) : ESP_OK;
+}
+
+static void writer_abort(ota_writer_t *w)
+{
+    if (w->begun) {
+        esp_ota_abort(w->handle);
+        mbedtls_sha256_free(&w->sha);
+        w->begun = false;
+    }
+}
+
+/**
+ * @brief Verify the complete image and select it for the next boot
+ *
+ * @param sha256 Expected SHA-256 of the written image (NULL or "" to skip)
+ */
+static esp_err_t writer_finish(ota_writer_t *w, const char *sha256)
+{
+    uint8_t digest[32];
+    char hex[65];
+    mbedtls_sha256_finish(&w->sha, digest);
+    for (int i = 0; i < 32; i++) {
+        snprintf(hex + i * 2, 3, "%02x", digest[i]);
+    }
+
+    if (!w->header_checked) {
+        ESP_LOGE(TAG, "Image too short (%u bytes)", (unsigned)w->header_len);
+        writer_abort(w);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (sha256 != NULL && sha256[0] != '\0' && strcasecmp(hex, sha256) != 0) {
+        ESP_LOGE(TAG, "SHA-256 mismatch (got %s)", hex);
+        writer_abort(w);
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    mbedtls_sha256_free(&w->sha);
+    w->begun = false;
+
+    // Checks segment layout and the digest the build appended to the image
+    esp_err_t ret = esp_ota_end(w->handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Image verification failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ret = esp_ota_set_boot_partition(w->partition);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to select %s: %s", w->partition->label, esp_err_to_name(ret));
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Firmware %s installed in %s, active after reboot",
+             s_status.new_version, w->partition->label);
+    return ESP_OK;
+}
+
+/**
+ * @brief Update input: a full image, or a delta against the running image
+ *
+ * The format is told apart by the first four bytes.
+ */
+typedef struct {
+    ota_writer_t writer;
+    ota_delta_t *delta;
+    mbedtls_sha256_context sha;     // Of the input as received
+    size_t total;                   // Input size (0 if unknown)
+    uint8_t lead[4];
+    size_t lead_len;
+    bool started;
+} ota_input_t;
+
+static esp_err_t delta_out(void *ctx, const uint8_t *data, size_t len)
+{
+    return writer_write((ota_writer_t *)ctx, data, len);
+}
+
+static void input_init(ota_input_t *in, size_t total)
+{
+    memset(in, 0, sizeof(*in));
+    in->total = total;
+    mbedtls_sha256_init(&in->sha);
+    mbedtls_sha256_starts(&in->sha, 0);
+}
+
+static esp_err_t input_consume(ota_input_t *in, const uint8_t *data, size_t len)
+{
+    if (in->delta != NULL) {
+        esp_err_t ret = ota_delta_feed(in->delta, data, len);
+        s_status.total = ota_delta_target_size(in->delta);
+        return ret;
+    }
+    return writer_write(&in->writer, data, len);
+}
+
+static esp_err_t input_start(ota_input_t *in)
+{
+    in->started = true;
+    if (memcmp(in->lead, OTA_DELTA_MAGIC, sizeof(in->lead)) != 0) {
+        return writer_begin(&in->writer, in->total);
+    }
+
+    ESP_LOGI(TAG, "Input is a delta against the running firmware");
+    esp_err_t ret = writer_begin(&in->writer, 0);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    in->delta = ota_delta_create(esp_ota_get_running_partition(), delta_out, &in->writer);
+    return in->delta != NULL ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+static esp_err_t input_feed(ota_input_t *in, const uint8_t *data, size_t len)
+{
+    mbedtls_sha256_update(&in->sha, data, len);
+
+    if (!in->started) {
+        size_t take = sizeof(in->lead) - in->lead_len;
+        if (take > len) {
+            take = len;
+        }
+        memcpy(in->lead + in->lead_len, data, take);
+        in->lead_len += take;
+        data += take;
+        len -= take;
+        if (in->lead_len < sizeof(in->lead)) {
+            return ESP_OK;
+        }
+
+        esp_err_t ret = input_start(in);
+        if (ret == ESP_OK) {
+            ret = input_consume(in, in->lead, in->lead_len);
+        }
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+
+    return len > 0 ? input_consume(in, data, len) : ESP_OK;
+}
+
+static void input_abort(ota_input_t *in)
+{
+    writer_abort(&in->writer);
+    ota_delta_free(in->delta);
+    in->delta = NULL;
+    mbedtls_sha256_free(&in->sha);
+}
+
+/**
+ * @brief Check the input against its published digest and install the image
+ */
+static esp_err_t input_finish(ota_input_t *in, const char *sha256)
+{
+    uint8_t digest[32];
+    char hex[65];
+    mbedtls_sha256_finish(&in->sha, digest);
+    for (int i = 0; i < 32; i++) {
+        snprintf(hex + i * 2, 3, "%02x", digest[i]);
+    }
+
+    esp_err_t ret = ESP_OK;
+    if (!in->started) {
+        ESP_LOGE(TAG, "Input too short (%u bytes)", (unsigned)in->lead_len);
+        ret = ESP_ERR_INVALID_SIZE;
+    } else if (sha256 != NULL && sha256[0] != '\0' && strcasecmp(hex, sha256) != 0) {
+        ESP_LOGE(TAG, "SHA-256 mismatch (got %s)", hex);
+        ret = ESP_ERR_INVALID_CRC;
+    }
+    if (ret != ESP_OK) {
+        input_abort(in);
+        return ret;
+    }
+
+    if (in->delta == NULL) {
+        ret = writer_finish(&in->writer, NULL);
+    } else {
+        // The rebuilt image must match the target named in the delta
+        char target[65];
+        ret = ota_delta_finish(in->delta, target);
+        if (ret == ESP_OK) {
+            ret = writer_finish(&in->writer, target);
+        } else {
+            writer_abort(&in->writer);
+        }
+    }
+
+    ota_delta_free(in->delta);
+    in->delta = NULL;
+    mbedtls_sha256_free(&in->sha);
+    return ret;
+}
+
+esp_err_t geogram_ota_update_from_file(const char *path, const char *sha256)
+{
+    if (!update_claim()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_status.state = GEOGRAM_OTA_RUNNING;
+
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        ESP_LOGE(TAG, "Cannot open %s", path);
+        update_release(ESP_ERR_NOT_FOUND);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    struct stat st = {0};
+    size_t total = fstat(fileno(f), &st) == 0 ? (size_t)st.st_size : 0;
+
+    uint8_t *chunk = malloc(OTA_CHUNK_SIZE);
+    ota_input_t *in = calloc(1, sizeof(ota_input_t));
+    if (chunk == NULL || in == NULL) {
+        fclose(f);
+        free(chunk);
+        free(in);
+        update_release(ESP_ERR_NO_MEM);
+        return ESP_ERR_NO_MEM;
+    }
+    input_init(in, total);
+
+    esp_err_t ret = ESP_OK;
+    while (ret == ESP_OK) {
+        size_t n = fread(chunk, 1, OTA_CHUNK_SIZE, f);
+        if (n == 0) {
+            ret = ferror(f) ? ESP_FAIL : ESP_ERR_NOT_FINISHED;
+            break;
+        }
+        ret = input_feed(in, chunk, n);
+    }
+
+    // End of file
+    if (ret == ESP_ERR_NOT_FINISHED) {
+        ret = input_finish(in, sha256);
+    } else {
+        input_abort(in);
+    }
+
+    fclose(f);
+    free(chunk);
+    free(in);
+    update_release(ret);
+    return ret;
+}
+
+typedef struct {
+    ota_input_t input;
+    bool begun;
+} ota_stream_t;
+
+static esp_err_t ota_on_headers(void *ctx, int status_code, int64_t content_length)
+{
+    ota_stream_t *stream = (ota_stream_t *)ctx;
+
+    // Called again if a kept connection had to be reopened
+    if (status_code != 200 || stream->begun) {
+        return ESP_OK;
+    }
+    input_init(&stream->input, content_length > 0 ? (size_t)content_length : 0);
+    stream->begun = true;
+    return ESP_OK;
+}
+
+static esp_err_t ota_on_data(void *ctx, const uint8_t *data, size_t len)
+{
+    ota_stream_t *stream = (ota_stream_t *)ctx;
+    return input_feed(&stream->input, data, len);
+}
+
+esp_err_t geogram_ota_update_from_url(const char *url, const char *sha256)
+{
+    if (!update_claim()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_status.state = GEOGRAM_OTA_RUNNING;
+
+    ota_stream_t *stream = calloc(1, sizeof(ota_stream_t));
+    if (stream == NULL) {
+        update_release(ESP_ERR_NO_MEM);
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Downloading firmware from %s", url);
+
+    http_client_request_t request = http_client_default_config();
+    request.url = url;
+    request.timeout_ms = 30000;
+    request.user_agent = "Geogram-ESP32/1.0";
+
+    const http_client_sink_t sink = {
+        .on_headers = ota_on_headers,
+        .on_data = ota_on_data,
+        .ctx = stream,
+    };
+
+    int status = 0;
+    esp_err_t ret = http_client_get_stream(&request, &sink, &status);
+    if (ret == ESP_OK && status != 200) {
+        ESP_LOGE(TAG, "Firmware download failed: HTTP %d", status);
+        ret = status == 404 ? ESP_ERR_NOT_FOUND : ESP_FAIL;
+    }
+
+    if (ret == ESP_OK) {
+        ret = input_finish(&stream->input, sha256);
+    } else {
+        ESP_LOGE(TAG, "Firmware update failed after %u bytes: %s",
+                 (unsigned)s_status.written, esp_err_to_name(ret));
+        if (stream->begun) {
+            input_abort(&stream->input);
+        }
+    }
+
+    free(stream);
+    update_release(ret);
+    return ret;
+}
+
+static bool on_trial(const esp_partition_t *running)
+{
+    esp_ota_img_states_t state;
+    return running != NULL && esp_ota_get_state_partition(running, &state) == ESP_OK &&
+           state == ESP_OTA_IMG_PENDING_VERIFY;
+}
+
+static void confirm_timer_cb(void *arg)
+{
+    // Confirmed by hand in the meantime
+    if (!on_trial(esp_ota_get_running_partition())) {
+        return;
+    }
+    if (s_health == NULL || s_health()) {
+        geogram_ota_confirm();
+        return;
+    }
+
+    if (esp_timer_get_time() / 1000000 >= CONFIG_GEOGRAM_OTA_HEALTH_TIMEOUT_S) {
+        ESP_LOGE(TAG, "Firmware failed its health check for %d s", CONFIG_GEOGRAM_OTA_HEALTH_TIMEOUT_S);
+        geogram_ota_rollback();
+        return;
+    }
+    ESP_LOGW(TAG, "Firmware on trial is not healthy yet, checking again in %d s", OTA_HEALTH_RETRY_S);
+    esp_timer_start_once(s_confirm_timer, (uint64_t)OTA_HEALTH_RETRY_S * 1000000ULL);
+}
+
+esp_err_t geogram_ota_init(geogram_ota_health_cb_t health)
+{
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    if (!on_trial(running)) {
+        return ESP_OK;
+    }
+    s_health = health;
+
+    ESP_LOGW(TAG, "Firmware %s on trial in %s, confirming in %d s",
+             esp_app_get_description()->version, running->label, CONFIG_GEOGRAM_OTA_CONFIRM_S);
+
+    const esp_timer_create_args_t args = {
+        .callback = confirm_timer_cb,
+        .name = "ota_confirm",
+    };
+    esp_err_t ret = esp_timer_create(&args, &s_confirm_timer);
+    if (ret == ESP_OK) {
+        ret = esp_timer_start_once(s_confirm_timer, (uint64_t)CONFIG_GEOGRAM_OTA_CONFIRM_S * 1000000ULL);
+    }
+    return ret;
+}
+
+esp_err_t geogram_ota_confirm(void)
+{
+    esp_err_t ret = esp_ota_mark_app_valid_cancel_rollback();
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Firmware %s confirmed", esp_app_get_description()->version);
+    } else {
+        ESP_LOGE(TAG, "Failed to confirm firmware: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+esp_err_t geogram_ota_rollback(void)
+{
+    if (!esp_ota_check_rollback_is_possible()) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    ESP_LOGW(TAG, "Returning to the previous firmware");
+    return esp_ota_mark_app_invalid_rollback_and_reboot();
+}
+
+void geogram_ota_get_status(geogram_ota_status_t *status)
+{
+    *status = s_status;
+
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    strlcpy(status->running_slot, running != NULL ? running->label : "?", sizeof(status->running_slot));
+    strlcpy(status->running_version, esp_app_get_description()->version,
+            sizeof(status->running_version));
+
+    status->pending_verify = on_trial(running);
+    status->can_rollback = esp_ota_check_rollback_is_possible();
+}
@@ -0,0 +1,128 @@
+/**
+ * @file geogram_ota.h
+ * @brief Over-the-air update of the station firmware
+ *
+ * The flash holds two app slots (ota_0 / ota_1). An update streams a
+ * firmware image from the SD card or an HTTP URL into the slot that is not
+ * running, in small chunks, so no RAM buffer of image size is needed. The
+ * image header (chip, project and board) is checked before anything is
+ * written, and the image digest
+ * (plus an optional published SHA-256) after the last byte. Only then is the
+ * new slot selected for the next boot.
+ *
+ * Instead of a full image the input may be a binary delta against the
+ * running firmware (see ota_delta.h, built with scripts/make_delta.py). It
+ * is recognised by its "GDLT" magic and rebuilt into the update slot on the
+ * fly.
+ *
+ * A new firmware boots on trial and is confirmed once it has run for
+ * CONFIG_GEOGRAM_OTA_CONFIRM_S seconds and passes the health check. If it
+ * resets before that, the bootloader rolls back to the previous slot; if it
+ * is still unhealthy after CONFIG_GEOGRAM_OTA_HEALTH_TIMEOUT_S, it rolls
+ * itself back.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Firmware update progress
+ */
+typedef enum {
+    GEOGRAM_OTA_IDLE,           /**< No update since boot */
+    GEOGRAM_OTA_RUNNING,        /**< Image being written */
+    GEOGRAM_OTA_DONE,           /**< Image installed, active after reboot */
+    GEOGRAM_OTA_FAILED,         /**< Last update failed (see result) */
+} geogram_ota_state_t;
+
+/**
+ * @brief OTA status
+ */
+typedef struct {
+    geogram_ota_state_t state;  /**< Progress of the last update */
+    esp_err_t result;           /**< Result of the last update */
+    size_t written;             /**< Bytes written to the update slot */
+    size_t total;               /**< Image size (0 if unknown) */
+    char new_version[32];       /**< Version of the image being written */
+    char running_slot[17];      /**< Label of the running partition */
+    char running_version[32];   /**< Version of the running firmware */
+    bool pending_verify;        /**< Running firmware is still on trial */
+    bool can_rollback;          /**< A previous valid firmware exists */
+} geogram_ota_status_t;
+
+/**
+ * @brief Check that the station works well enough to keep its firmware
+ * @return true if healthy
+ */
+typedef bool (*geogram_ota_health_cb_t)(void);
+
+/**
+ * @brief Start the trial period of a freshly installed firmware
+ *
+ * Call early in app_main. Does nothing if the running firmware is already
+ * confirmed.
+ *
+ * @param health Checked before the firmware is confirmed, and again every
+ *               few seconds while it fails (NULL to confirm on uptime alone)
+ * @return ESP_OK on success
+ */
+esp_err_t geogram_ota_init(geogram_ota_health_cb_t health);
+
+/**
+ * @brief Install a firmware image from a file
+ *
+ * Blocks until the image is written and verified.
+ *
+ * @param path Image or delta path, e.g. on /sdcard/updates
+ * @param sha256 Expected SHA-256 of the file as hex (NULL or "" to skip)
+ * @return ESP_OK once the image is installed (reboot to run it),
+ *         ESP_ERR_INVALID_STATE if an update is already running,
+ *         ESP_ERR_INVALID_VERSION if the image is not firmware for this
+ *         station or a delta was made for another firmware,
+ *         ESP_ERR_INVALID_CRC on a checksum mismatch
+ */
+esp_err_t geogram_ota_update_from_file(const char *path, const char *sha256);
+
+/**
+ * @brief Install a firmware image streamed from a URL
+ *
+ * Same as geogram_ota_update_from_file(); the body is written as it
+ * arrives.
+ *
+ * @param url Image or delta URL
+ * @param sha256 Expected SHA-256 as hex (NULL or "" to skip)
+ * @return As geogram_ota_update_from_file(), or the HTTP error
+ */
+esp_err_t geogram_ota_update_from_url(const char *url, const char *sha256);
+
+/**
+ * @brief End the trial period now and keep the running firmware
+ * @return ESP_OK on success
+ */
+esp_err_t geogram_ota_confirm(void);
+
+/**
+ * @brief Return to the previous firmware
+ *
+ * Marks the running firmware invalid and reboots; only returns on error.
+ *
+ * @return ESP_ERR_NOT_FOUND if there is no firmware to return to
+ */
+esp_err_t geogram_ota_rollback(void);
+
+/**
+ * @brief Get OTA status
+ * @param status Receives the status
+ */
+void geogram_ota_get_status(geogram_ota_status_t *status);
+
+#ifdef __cplusplus
+}
+#endif
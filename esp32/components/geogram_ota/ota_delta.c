@@ -0,0 +1,322 @@
+/**
+ * @file ota_delta.c
+ * @brief Streaming application of binary firmware deltas
+ */
+
+#include "ota_delta.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "mbedtls/sha256.h"
+#include "rom/miniz.h"
+
+static const char *TAG = "ota_delta";
+
+#define DELTA_VERSION       1
+#define DELTA_HEADER_LEN    (4 + 4 + 4 + 32 + 4 + 32)
+#define DELTA_BLOCK_LEN     12
+
+// Source bytes read from flash at a time
+#define DELTA_SOURCE_CHUNK  1024
+
+typedef enum {
+    DELTA_HEADER,
+    DELTA_BLOCK,        // Reading a block's add_len, extra_len, seek
+    DELTA_ADD,
+    DELTA_EXTRA,
+} delta_state_t;
+
+struct ota_delta {
+    const esp_partition_t *source;
+    ota_delta_out_t out;
+    void *out_ctx;
+
+    delta_state_t state;
+    uint8_t header[DELTA_HEADER_LEN];
+    size_t header_len;
+    uint32_t source_size;
+    uint32_t target_size;
+    uint8_t target_sha256[32];
+
+    uint8_t block[DELTA_BLOCK_LEN];
+    size_t block_len;
+    uint32_t add_left;
+    uint32_t extra_left;
+    int32_t seek;
+    uint32_t source_pos;
+    uint32_t written;
+
+    bool inflate_done;
+    size_t dict_ofs;
+    uint8_t source_buf[DELTA_SOURCE_CHUNK];
+    tinfl_decompressor inflator;
+    uint8_t dict[TINFL_LZ_DICT_SIZE];
+};
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void to_hex(const uint8_t *digest, char *hex)
+{
+    for (int i = 0; i < 32; i++) {
+        snprintf(hex + i * 2, 3, "%02x", digest[i]);
+    }
+}
+
+/**
+ * @brief Parse the header and make sure the running image is the delta's source
+ */
+static esp_err_t delta_check_header(ota_delta_t *d)
+{
+    const uint8_t *h = d->header;
+    if (memcmp(h, OTA_DELTA_MAGIC, 4) != 0 || get_u32(h + 4) != DELTA_VERSION) {
+        ESP_LOGE(TAG, "Unsupported delta format");
+        return ESP_ERR_INVALID_VERSION;
+    }
+    d->source_size = get_u32(h + 8);
+    d->target_size = get_u32(h + 44);
+    memcpy(d->target_sha256, h + 48, sizeof(d->target_sha256));
+
+    if (d->source_size > d->source->size) {
+        ESP_LOGE(TAG, "Delta source (%lu bytes) is larger than %s",
+                 (unsigned long)d->source_size, d->source->label);
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    mbedtls_sha256_context sha;
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts(&sha, 0);
+    esp_err_t ret = ESP_OK;
+    for (uint32_t pos = 0; pos < d->source_size && ret == ESP_OK; pos += DELTA_SOURCE_CHUNK) {
+        size_t n = d->source_size - pos < DELTA_SOURCE_CHUNK ? d->source_size - pos : DELTA_SOURCE_CHUNK;
+        ret = esp_partition_read(d->source, pos, d->source_buf, n);
+        mbedtls_sha256_update(&sha, d->source_buf, n);
+    }
+    uint8_t digest[32];
+    mbedtls_sha256_finish(&sha, digest);
+    mbedtls_sha256_free(&sha);
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read %s: %s", d->source->label, esp_err_to_name(ret));
+        return ret;
+    }
+    if (memcmp(digest, h + 12, sizeof(digest)) != 0) {
+        char hex[65];
+        to_hex(h + 12, hex);
+        ESP_LOGE(TAG, "Delta is for another firmware (source SHA-256 %s)", hex);
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    ESP_LOGI(TAG, "Applying delta: %lu -> %lu bytes",
+             (unsigned long)d->source_size, (unsigned long)d->target_size);
+    return ESP_OK;
+}
+
+static esp_err_t delta_block_done(ota_delta_t *d)
+{
+    int64_t pos = (int64_t)d->source_pos + d->seek;
+    if (pos < 0 || pos > d->source_size) {
+        ESP_LOGE(TAG, "Delta seeks outside the source");
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    d->source_pos = (uint32_t)pos;
+    d->state = DELTA_BLOCK;
+    return ESP_OK;
+}
+
+/**
+ * @brief Consume inflated block data
+ */
+static esp_err_t delta_apply(ota_delta_t *d, const uint8_t *data, size_t len)
+{
+    esp_err_t ret = ESP_OK;
+
+    while (len > 0 && ret == ESP_OK) {
+        size_t n;
+        switch (d->state) {
+            case DELTA_BLOCK:
+                n = DELTA_BLOCK_LEN - d->block_len;
+                if (n > len) {
+                    n = len;
+                }
+                memcpy(d->block + d->block_len, data, n);
+                d->block_len += n;
+                data += n;
+                len -= n;
+                if (d->block_len < DELTA_BLOCK_LEN) {
+                    break;
+                }
+                d->block_len = 0;
+                d->add_left = get_u32(d->block);
+                d->extra_left = get_u32(d->block + 4);
+                d->seek = (int32_t)get_u32(d->block + 8);
+
+                if (d->add_left > d->source_size - d->source_pos ||
+                    (uint64_t)d->add_left + d->extra_left > d->target_size - d->written) {
+                    ESP_LOGE(TAG, "Delta block out of range");
+                    return ESP_ERR_INVALID_RESPONSE;
+                }
+                if (d->add_left > 0) {
+                    d->state = DELTA_ADD;
+                } else if (d->extra_left > 0) {
+                    d->state = DELTA_EXTRA;
+                } else {
+                    ret = delta_block_done(d);
+                }
+                break;
+
+            case DELTA_ADD:
+                n = d->add_left < DELTA_SOURCE_CHUNK ? d->add_left : DELTA_SOURCE_CHUNK;
+                if (n > len) {
+                    n = len;
+                }
+                ret = esp_partition_read(d->source, d->source_pos, d->source_buf, n);
+                if (ret != ESP_OK) {
+                    break;
+                }
+                for (size_t i = 0; i < n; i++) {
+                    d->source_buf[i] += data[i];
+                }
+                ret = d->out(d->out_ctx, d->source_buf, n);
+                d->source_pos += n;
+                d->add_left -= n;
+                d->written += n;
+                data += n;
+                len -= n;
+                if (ret == ESP_OK && d->add_left == 0) {
+                    if (d->extra_left > 0) {
+                        d->state = DELTA_EXTRA;
+                    } else {
+                        ret = delta_block_done(d);
+                    }
+                }
+                break;
+
+            case DELTA_EXTRA:
+                n = d->extra_left < len ? d->extra_left : len;
+                ret = d->out(d->out_ctx, data, n);
+                d->extra_left -= n;
+                d->written += n;
+                data += n;
+                len -= n;
+                if (ret == ESP_OK && d->extra_left == 0) {
+                    ret = delta_block_done(d);
+                }
+                break;
+
+            default:
+                return ESP_ERR_INVALID_STATE;
+        }
+    }
+    return ret;
+}
+
+ota_delta_t *ota_delta_create(const esp_partition_t *source, ota_delta_out_t out, void *ctx)
+{
+    // Inflate window and state take ~45 KB; keep them out of internal RAM
+    ota_delta_t *d = heap_caps_calloc(1, sizeof(ota_delta_t), MALLOC_CAP_SPIRAM);
+    if (d == NULL) {
+        d = calloc(1, sizeof(ota_delta_t));
+        if (d == NULL) {
+            return NULL;
+        }
+    }
+    d->source = source;
+    d->out = out;
+    d->out_ctx = ctx;
+    d->state = DELTA_HEADER;
+    tinfl_init(&d->inflator);
+    return d;
+}
+
+esp_err_t ota_delta_feed(ota_delta_t *d, const uint8_t *data, size_t len)
+{
+    if (d->state == DELTA_HEADER) {
+        size_t n = DELTA_HEADER_LEN - d->header_len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(d->header + d->header_len, data, n);
+        d->header_len += n;
+        data += n;
+        len -= n;
+        if (d->header_len < DELTA_HEADER_LEN) {
+            return ESP_OK;
+        }
+        esp_err_t ret = delta_check_header(d);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        d->state = DELTA_BLOCK;
+    }
+
+    // Inflate until the input is used up and no output is pending
+    for (;;) {
+        if (d->inflate_done) {
+            if (len > 0) {
+                ESP_LOGE(TAG, "Data after the end of the delta");
+                return ESP_ERR_INVALID_RESPONSE;
+            }
+            break;
+        }
+
+        size_t in_bytes = len;
+        size_t out_bytes = TINFL_LZ_DICT_SIZE - d->dict_ofs;
+        tinfl_status status = tinfl_decompress(&d->inflator, data, &in_bytes, d->dict,
+                                               d->dict + d->dict_ofs, &out_bytes,
+                                               TINFL_FLAG_HAS_MORE_INPUT);
+        data += in_bytes;
+        len -= in_bytes;
+
+        if (out_bytes > 0) {
+            esp_err_t ret = delta_apply(d, d->dict + d->dict_ofs, out_bytes);
+            if (ret != ESP_OK) {
+                return ret;
+            }
+            d->dict_ofs = (d->dict_ofs + out_bytes) & (TINFL_LZ_DICT_SIZE - 1);
+        }
+
+        if (status < TINFL_STATUS_DONE) {
+            ESP_LOGE(TAG, "Delta stream corrupt (%d)", (int)status);
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+        if (status == TINFL_STATUS_DONE) {
+            d->inflate_done = true;
+        } else if (status == TINFL_STATUS_NEEDS_MORE_INPUT && len == 0) {
+            break;
+        }
+    }
+    return ESP_OK;
+}
+
+size_t ota_delta_target_size(const ota_delta_t *d)
+{
+    return d->target_size;
+}
+
+esp_err_t ota_delta_finish(ota_delta_t *d, char target_sha256[65])
+{
+    if (d->state == DELTA_HEADER) {
+        ESP_LOGE(TAG, "Delta header incomplete");
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (!d->inflate_done || d->state != DELTA_BLOCK || d->block_len != 0 ||
+        d->written != d->target_size) {
+        ESP_LOGE(TAG, "Delta ended early at %lu of %lu bytes",
+                 (unsigned long)d->written, (unsigned long)d->target_size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    to_hex(d->target_sha256, target_sha256);
+    return ESP_OK;
+}
+
+void ota_delta_free(ota_delta_t *d)
+{
+    free(d);
+}
@@ -0,0 +1,83 @@
+/**
+ * @file ota_delta.h
+ * @brief Streaming application of binary firmware deltas
+ *
+ * Delta file layout (little endian), produced by scripts/make_delta.py:
+ *
+ *   header  "GDLT", u32 format version (1), u32 source size,
+ *           u8[32] SHA-256 of the source image, u32 target size,
+ *           u8[32] SHA-256 of the target image
+ *   body    raw deflate stream of blocks
+ *             u32 add_len, u32 extra_len, i32 seek
+ *             add_len bytes, each added (mod 256) to the next source byte
+ *             extra_len bytes copied as they are
+ *           after a block the source cursor moves on by seek
+ *
+ * These are the bsdiff control, diff and extra streams interleaved so the
+ * delta can be applied front to back: source bytes are read from the
+ * running slot while the target is written out in order. RAM use is the
+ * inflate state and its 32 KB window, independent of image size.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_partition.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OTA_DELTA_MAGIC     "GDLT"
+
+typedef struct ota_delta ota_delta_t;
+
+/**
+ * @brief Receiver of the reconstructed image, in order
+ */
+typedef esp_err_t (*ota_delta_out_t)(void *ctx, const uint8_t *data, size_t len);
+
+/**
+ * @brief Create a delta decoder
+ *
+ * @param source Partition holding the image the delta was made against
+ * @param out Receiver of the target image
+ * @param ctx Passed to out
+ * @return Decoder, or NULL if out of memory
+ */
+ota_delta_t *ota_delta_create(const esp_partition_t *source, ota_delta_out_t out, void *ctx);
+
+/**
+ * @brief Feed the next piece of the delta file
+ *
+ * The source image is checked against the header before any output.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_VERSION if the delta was made for another
+ *         source image, ESP_ERR_INVALID_RESPONSE if the delta is corrupt,
+ *         or the error of the receiver
+ */
+esp_err_t ota_delta_feed(ota_delta_t *delta, const uint8_t *data, size_t len);
+
+/**
+ * @brief Target image size from the header (0 until the header is read)
+ */
+size_t ota_delta_target_size(const ota_delta_t *delta);
+
+/**
+ * @brief Check that the whole target was produced
+ *
+ * @param target_sha256 Receives the expected SHA-256 of the target as hex
+ * @return ESP_OK, or ESP_ERR_INVALID_SIZE if the delta ended early
+ */
+esp_err_t ota_delta_finish(ota_delta_t *delta, char target_sha256[65]);
+
+/**
+ * @brief Free a decoder
+ */
+void ota_delta_free(ota_delta_t *delta);
+
+#ifdef __cplusplus
+}
+#endif
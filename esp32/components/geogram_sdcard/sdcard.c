@@ -47,7 +47,7 @@ esp_err_t sdcard_init(void)
     // Mount configuration
     esp_vfs_fat_sdmmc_mount_config_t mount_config = {
         .format_if_mount_failed = true,     // Auto-format if unformatted
-        .max_files = 5,
+        .max_files = 10,                    // Tile archives keep 4 files open
         .allocation_unit_size = 16 * 1024   // 16KB allocation unit
     };
 
@@ -155,6 +155,19 @@ float sdcard_get_capacity_gb(void)
     return (float)(s_card->csd.capacity) / 2048.0f / 1024.0f;
 }
 
+esp_err_t sdcard_get_free_bytes(uint64_t *free_bytes)
+{
+    if (free_bytes == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_mounted) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint64_t total = 0;
+    return esp_vfs_fat_info(SDCARD_MOUNT_POINT, &total, free_bytes);
+}
+
 esp_err_t sdcard_write_file(const char *path, const void *data, size_t len)
 {
     if (path == NULL || data == NULL) {
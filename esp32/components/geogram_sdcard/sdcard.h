@@ -2,6 +2,7 @@
 #define GEOGRAM_SDCARD_H
 
 #include <stddef.h>
+#include <stdint.h>
 #include <stdbool.h>
 #include "esp_err.h"
 
@@ -68,6 +69,14 @@ esp_err_t sdcard_get_info(sdcard_info_t *info);
  */
 float sdcard_get_capacity_gb(void);
 
+/**
+ * @brief Get free space on the SD card
+ *
+ * @param free_bytes Receives the free space in bytes
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not mounted
+ */
+esp_err_t sdcard_get_free_bytes(uint64_t *free_bytes);
+
 /**
  * @brief Write data to a file on the SD card
  *
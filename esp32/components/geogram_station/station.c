@@ -217,6 +217,15 @@ size_t station_build_status_json(char *buffer, size_t size) {
     geo_json_add_bool(&builder, "osm_fallback", !tile_available);
     geo_json_add_uint(&builder, "cache_size", tile_available ? tiles_get_cache_count() : 0);
     geo_json_add_uint(&builder, "cache_size_bytes", tile_available ? tiles_get_cache_size() : 0);
+
+    // Bulk tile import progress (only once an import has started)
+    tile_import_status_t import;
+    if (tile_available && tiles_import_get_status(&import) == ESP_OK &&
+        (import.running || import.bytes > 0)) {
+        geo_json_add_bool(&builder, "tile_import_running", import.running);
+        geo_json_add_uint(&builder, "tile_import_tiles", import.imported);
+        geo_json_add_int64(&builder, "tile_import_bytes", (int64_t)import.bytes);
+    }
 #else
     geo_json_add_bool(&builder, "tile_server", false);
     geo_json_add_bool(&builder, "osm_fallback", true);
@@ -0,0 +1,229 @@
+/**
+ * @file tile_fetch.c
+ * @brief Background tile download queue with request coalescing
+ */
+
+#include "sdkconfig.h"
+
+#if CONFIG_GEOGRAM_BOARD_EPAPER_1IN54
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tile_fetch.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+
+static const char *TAG = "tile_fetch";
+
+// Maximum distinct tiles queued or downloading at once
+#define FETCH_SLOTS         16
+
+#define FETCH_TASK_STACK    4096
+#define FETCH_TASK_PRIORITY 4
+
+#define FETCH_DONE_BIT      (1 << 0)
+
+/**
+ * @brief One queued or in-flight download
+ *
+ * The worker and every waiting requester hold a reference; the slot is
+ * reused only after all of them have let go.
+ */
+typedef struct {
+    bool busy;
+    bool done;
+    int z;
+    int x;
+    int y;
+    int layer;
+    uint32_t refs;              // Popular tiles can have hundreds of waiters
+    esp_err_t result;
+    EventGroupHandle_t event;
+} fetch_slot_t;
+
+static fetch_slot_t s_slots[FETCH_SLOTS];
+static SemaphoreHandle_t s_mutex = NULL;
+static QueueHandle_t s_queue = NULL;
+static tile_fetch_fn_t s_fetch_fn = NULL;
+static size_t s_buffer_size = 0;
+static uint32_t s_coalesced = 0;
+
+// Must be called with s_mutex held
+static void slot_release(fetch_slot_t *slot)
+{
+    if (slot->refs > 0) {
+        slot->refs--;
+    }
+    if (slot->refs == 0) {
+        slot->busy = false;
+    }
+}
+
+static void fetch_worker(void *arg)
+{
+    uint8_t *buffer = heap_caps_malloc(s_buffer_size, MALLOC_CAP_SPIRAM);
+    if (buffer == NULL) {
+        buffer = malloc(s_buffer_size);
+    }
+    if (buffer == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate fetch buffer");
+        vTaskDelete(NULL);
+        return;
+    }
+
+    uint8_t idx;
+    while (true) {
+        if (xQueueReceive(s_queue, &idx, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        fetch_slot_t *slot = &s_slots[idx];
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        int z = slot->z;
+        int x = slot->x;
+        int y = slot->y;
+        int layer = slot->layer;
+        xSemaphoreGive(s_mutex);
+
+        esp_err_t ret = s_fetch_fn(z, x, y, layer, buffer, s_buffer_size);
+
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        slot->result = ret;
+        slot->done = true;
+        xEventGroupSetBits(slot->event, FETCH_DONE_BIT);
+        slot_release(slot);
+        xSemaphoreGive(s_mutex);
+    }
+}
+
+esp_err_t tile_fetch_init(tile_fetch_fn_t fetch_fn, size_t buffer_size, int workers)
+{
+    if (fetch_fn == NULL || buffer_size == 0 || workers < 1) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (s_queue != NULL) {
+        return ESP_OK;
+    }
+
+    s_mutex = xSemaphoreCreateMutex();
+    s_queue = xQueueCreate(FETCH_SLOTS, sizeof(uint8_t));
+    if (s_mutex == NULL || s_queue == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (int i = 0; i < FETCH_SLOTS; i++) {
+        s_slots[i].event = xEventGroupCreate();
+        if (s_slots[i].event == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    s_fetch_fn = fetch_fn;
+    s_buffer_size = buffer_size;
+
+    for (int i = 0; i < workers; i++) {
+        if (xTaskCreate(fetch_worker, "tile_fetch", FETCH_TASK_STACK, NULL,
+                        FETCH_TASK_PRIORITY, NULL) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create fetch worker %d", i);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    ESP_LOGI(TAG, "Tile fetch queue started (%d workers)", workers);
+    return ESP_OK;
+}
+
+esp_err_t tile_fetch_request(int z, int x, int y, int layer, uint32_t wait_ms)
+{
+    if (s_queue == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    fetch_slot_t *slot = NULL;
+    fetch_slot_t *free_slot = NULL;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    for (int i = 0; i < FETCH_SLOTS; i++) {
+        fetch_slot_t *s = &s_slots[i];
+        if (!s->busy) {
+            if (free_slot == NULL) {
+                free_slot = s;
+            }
+            continue;
+        }
+        if (s->z == z && s->x == x && s->y == y && s->layer == layer) {
+            if (s->done && s->result != ESP_OK) {
+                // Failed download still held by its waiters: fetch anew
+                continue;
+            }
+            slot = s;
+            break;
+        }
+    }
+
+    if (slot != NULL) {
+        // Same tile is already queued or downloading; or just downloaded,
+        // in which case it is in the cache now
+        if (slot->done) {
+            xSemaphoreGive(s_mutex);
+            return ESP_OK;
+        }
+        s_coalesced++;
+        if (wait_ms == 0) {
+            xSemaphoreGive(s_mutex);
+            return ESP_ERR_TIMEOUT;
+        }
+        slot->refs++;
+    } else {
+        if (free_slot == NULL) {
+            xSemaphoreGive(s_mutex);
+            ESP_LOGW(TAG, "Fetch queue full");
+            return ESP_ERR_NO_MEM;
+        }
+
+        slot = free_slot;
+        slot->busy = true;
+        slot->done = false;
+        slot->z = z;
+        slot->x = x;
+        slot->y = y;
+        slot->layer = layer;
+        slot->result = ESP_FAIL;
+        slot->refs = (wait_ms > 0) ? 2 : 1;     // Worker + waiting caller
+        xEventGroupClearBits(slot->event, FETCH_DONE_BIT);
+
+        uint8_t idx = (uint8_t)(slot - s_slots);
+        xQueueSend(s_queue, &idx, 0);   // Queue holds FETCH_SLOTS items, never full here
+
+        if (wait_ms == 0) {
+            xSemaphoreGive(s_mutex);
+            return ESP_ERR_TIMEOUT;
+        }
+    }
+
+    xSemaphoreGive(s_mutex);
+
+    xEventGroupWaitBits(slot->event, FETCH_DONE_BIT, pdFALSE, pdTRUE, pdMS_TO_TICKS(wait_ms));
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    esp_err_t ret = slot->done ? slot->result : ESP_ERR_TIMEOUT;
+    slot_release(slot);
+    xSemaphoreGive(s_mutex);
+
+    return ret;
+}
+
+uint32_t tile_fetch_get_coalesced(void)
+{
+    return s_coalesced;
+}
+
+#endif // CONFIG_GEOGRAM_BOARD_EPAPER_1IN54
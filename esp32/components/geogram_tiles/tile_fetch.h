@@ -0,0 +1,73 @@
+/**
+ * @file tile_fetch.h
+ * @brief Background tile download queue with request coalescing
+ *
+ * Cache misses are handed to a small pool of fetch workers instead of
+ * downloading inside the HTTP handler. Concurrent requests for the same
+ * tile share one in-flight download.
+ */
+
+#ifndef GEOGRAM_TILE_FETCH_H
+#define GEOGRAM_TILE_FETCH_H
+
+#include "esp_err.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Download and store one tile
+ *
+ * Called from a fetch worker. Must leave the tile readable from the
+ * cache on success.
+ *
+ * @param z Zoom level
+ * @param x X tile coordinate
+ * @param y Y tile coordinate
+ * @param layer Layer index
+ * @param buffer Scratch buffer owned by the worker
+ * @param buffer_size Size of scratch buffer
+ * @return ESP_OK on success
+ */
+typedef esp_err_t (*tile_fetch_fn_t)(int z, int x, int y, int layer,
+                                     uint8_t *buffer, size_t buffer_size);
+
+/**
+ * @brief Start fetch workers
+ *
+ * @param fetch_fn Function that downloads and stores a tile
+ * @param buffer_size Scratch buffer size per worker
+ * @param workers Number of worker tasks
+ * @return ESP_OK on success
+ */
+esp_err_t tile_fetch_init(tile_fetch_fn_t fetch_fn, size_t buffer_size, int workers);
+
+/**
+ * @brief Request a tile and wait for it
+ *
+ * Joins an in-flight download of the same tile if there is one,
+ * otherwise queues a new one.
+ *
+ * @param z Zoom level
+ * @param x X tile coordinate
+ * @param y Y tile coordinate
+ * @param layer Layer index
+ * @param wait_ms How long to wait (0 = queue and return immediately)
+ * @return ESP_OK if the tile was fetched, ESP_ERR_TIMEOUT if still pending,
+ *         ESP_ERR_NO_MEM if the queue is full, or the download error
+ */
+esp_err_t tile_fetch_request(int z, int x, int y, int layer, uint32_t wait_ms);
+
+/**
+ * @brief Number of requests that joined an existing download
+ */
+uint32_t tile_fetch_get_coalesced(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_TILE_FETCH_H
@@ -0,0 +1,645 @@
+/**
+ * @file tile_import.c
+ * @brief Bulk tile import from a streamed archive
+ *
+ * The archive is parsed as it arrives, so nothing is staged on the card:
+ * tile data is copied from the network buffer straight into the
+ * write-behind buffer of a pack batch, which reaches the card as large
+ * sequential writes with one index update per buffer.
+ *
+ * The format is detected from the first bytes: a valid pack record
+ * header means a .pack data file, anything else must be a tar archive.
+ */
+
+#include "sdkconfig.h"
+
+#if CONFIG_GEOGRAM_BOARD_EPAPER_1IN54
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "tiles.h"
+#include "tile_import.h"
+#include "tile_pack.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "tile_import";
+
+#define TAR_BLOCK           512
+
+// Longest tar path examined (ustar prefix + '/' + name)
+#define TAR_PATH_MAX        257
+
+// Largest GNU long-name or pax header read for a tile path
+#define TAR_META_MAX        1024
+
+// Largest entry treated as a tile; bigger files are skipped
+#define IMPORT_MAX_TILE     (1024 * 1024)
+
+// Tiles between progress callbacks (quota checks)
+#define IMPORT_NOTIFY_EVERY 512
+
+#define IMPORT_LAYERS       2
+
+typedef enum {
+    FORMAT_UNKNOWN,         // Waiting for the first header
+    FORMAT_TAR,
+    FORMAT_PACK,
+} import_format_t;
+
+typedef enum {
+    IMPORT_HEADER,          // Collecting a tar block or pack record header
+    IMPORT_DATA,            // Copying tile data
+    IMPORT_SKIP,            // Discarding an entry or tar padding
+    IMPORT_META,            // Collecting a long name or pax header
+    IMPORT_END,             // Past the end-of-archive marker
+} import_state_t;
+
+struct tiles_import {
+    import_format_t format;
+    import_state_t state;
+    tile_layer_t default_layer;
+    bool replace;
+    esp_err_t error;                    // First error; stops the import
+    tile_pack_batch_t *batch[IMPORT_LAYERS];
+
+    uint8_t header[TAR_BLOCK];
+    size_t header_fill;
+    uint64_t remaining;                 // Bytes left in the DATA or SKIP span
+    uint32_t padding;                   // Tar padding after the current entry
+
+    // Path of the next tar entry from a long-name or pax header
+    char meta[TAR_META_MAX + 1];
+    size_t meta_fill;
+    char meta_type;
+    char long_path[TAR_PATH_MAX];
+
+    // Tile being received
+    tile_layer_t layer;
+    int z;
+    int x;
+    int y;
+    size_t len;
+    size_t got;
+    uint8_t *dst;                       // Batch reservation or `large`
+    uint8_t *large;                     // Tile too big for the batch buffer
+
+    uint64_t bytes;
+    uint32_t imported;
+    uint32_t skipped;
+    uint32_t failed;
+};
+
+static tile_pack_t *s_packs[IMPORT_LAYERS] = {NULL};
+static tile_import_notify_fn_t s_notify = NULL;
+static SemaphoreHandle_t s_mutex = NULL;
+static tile_import_status_t s_status = {0};
+
+static size_t header_size(const tiles_import_t *imp)
+{
+    return imp->format == FORMAT_TAR ? TAR_BLOCK : TILE_PACK_RECORD_SIZE;
+}
+
+/**
+ * @brief Move on to the next entry header, skipping tar padding first
+ */
+static void next_entry(tiles_import_t *imp)
+{
+    if (imp->padding > 0) {
+        imp->state = IMPORT_SKIP;
+        imp->remaining = imp->padding;
+        imp->padding = 0;
+    } else {
+        imp->state = IMPORT_HEADER;
+        imp->header_fill = 0;
+    }
+}
+
+static void skip_entry(tiles_import_t *imp, uint64_t len)
+{
+    imp->remaining = len;
+    if (len > 0) {
+        imp->state = IMPORT_SKIP;
+    } else {
+        next_entry(imp);
+    }
+}
+
+static esp_err_t begin_tile(tiles_import_t *imp, tile_layer_t layer, int z, int x, int y, size_t len)
+{
+    if (!imp->replace && tile_pack_contains(s_packs[layer], z, x, y)) {
+        imp->skipped++;
+        skip_entry(imp, len);
+        return ESP_OK;
+    }
+
+    if (imp->batch[layer] == NULL) {
+        esp_err_t ret = tile_pack_batch_begin(s_packs[layer], &imp->batch[layer]);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+
+    esp_err_t ret = tile_pack_batch_reserve(imp->batch[layer], z, x, y, len, &imp->dst);
+    if (ret == ESP_ERR_INVALID_SIZE) {
+        imp->large = heap_caps_malloc(len, MALLOC_CAP_SPIRAM);
+        if (imp->large == NULL) {
+            imp->large = malloc(len);
+        }
+        if (imp->large == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        imp->dst = imp->large;
+    } else if (ret == ESP_ERR_INVALID_ARG) {
+        ESP_LOGD(TAG, "Invalid tile %d/%d/%d", z, x, y);
+        imp->failed++;
+        skip_entry(imp, len);
+        return ESP_OK;
+    } else if (ret != ESP_OK) {
+        return ret;
+    }
+
+    imp->layer = layer;
+    imp->z = z;
+    imp->x = x;
+    imp->y = y;
+    imp->len = len;
+    imp->got = 0;
+    imp->remaining = len;
+    imp->state = IMPORT_DATA;
+    return ESP_OK;
+}
+
+static esp_err_t finish_tile(tiles_import_t *imp)
+{
+    esp_err_t ret;
+    if (imp->large != NULL) {
+        ret = tile_pack_append(s_packs[imp->layer], imp->z, imp->x, imp->y, imp->large, imp->len);
+        free(imp->large);
+        imp->large = NULL;
+    } else {
+        ret = tile_pack_batch_commit(imp->batch[imp->layer]);
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    imp->imported++;
+    if (imp->imported % IMPORT_NOTIFY_EVERY == 0 && s_notify != NULL) {
+        s_notify(false, imp->replace);
+    }
+    next_entry(imp);
+    return ESP_OK;
+}
+
+/**
+ * @brief Parse a tar numeric field (octal, or base-256 for large sizes)
+ */
+static bool tar_number(const uint8_t *p, size_t n, uint64_t *out)
+{
+    uint64_t v = 0;
+
+    if (p[0] & 0x80) {
+        v = p[0] & 0x7F;
+        for (size_t i = 1; i < n; i++) {
+            v = (v << 8) | p[i];
+        }
+        *out = v;
+        return true;
+    }
+
+    size_t i = 0;
+    while (i < n && p[i] == ' ') {
+        i++;
+    }
+    bool digits = false;
+    for (; i < n && p[i] >= '0' && p[i] <= '7'; i++) {
+        v = v * 8 + (p[i] - '0');
+        digits = true;
+    }
+    for (; i < n; i++) {
+        if (p[i] != ' ' && p[i] != '\0') {
+            return false;
+        }
+    }
+    *out = v;
+    return digits;
+}
+
+static bool tar_checksum_ok(const uint8_t *h)
+{
+    uint64_t stored;
+    if (!tar_number(h + 148, 8, &stored)) {
+        return false;
+    }
+
+    // The checksum field itself counts as spaces
+    uint32_t sum = 0;
+    for (int i = 0; i < TAR_BLOCK; i++) {
+        sum += (i >= 148 && i < 156) ? ' ' : h[i];
+    }
+    return sum == stored;
+}
+
+/**
+ * @brief Take the next entry's path from a collected long-name or pax header
+ */
+static void tar_meta(tiles_import_t *imp)
+{
+    const char *p = imp->meta;
+    const char *end = imp->meta + imp->meta_fill;
+    imp->meta[imp->meta_fill] = '\0';
+
+    if (imp->meta_type == 'L') {
+        // GNU long name: the data is the NUL-terminated path
+        size_t n = strnlen(p, imp->meta_fill);
+        if (n < sizeof(imp->long_path)) {
+            memcpy(imp->long_path, p, n);
+            imp->long_path[n] = '\0';
+        }
+        return;
+    }
+
+    // pax extended header: records of "{len} {key}={value}\n"
+    while (p < end) {
+        char *sp;
+        long rec_len = strtol(p, &sp, 10);
+        if (rec_len <= 0 || sp >= end || *sp != ' ' || rec_len > end - p) {
+            return;
+        }
+        const char *key = sp + 1;
+        const char *rec_end = p + rec_len - 1;      // At the '\n'
+        if (rec_end - key > 5 && strncmp(key, "path=", 5) == 0) {
+            size_t n = (size_t)(rec_end - key - 5);
+            if (n < sizeof(imp->long_path)) {
+                memcpy(imp->long_path, key + 5, n);
+                imp->long_path[n] = '\0';
+            }
+        }
+        p += rec_len;
+    }
+}
+
+static void tar_path(const uint8_t *h, char *path, size_t size)
+{
+    char name[101];
+    char prefix[156] = {0};
+
+    memcpy(name, h, 100);
+    name[100] = '\0';
+    if (memcmp(h + 257, "ustar", 5) == 0) {
+        memcpy(prefix, h + 345, 155);
+    }
+    snprintf(path, size, "%s%s%s", prefix, prefix[0] ? "/" : "", name);
+}
+
+static bool parse_number(const char *s, const char *end, int *out)
+{
+    if (s == end || end - s > 7) {
+        return false;
+    }
+    int v = 0;
+    for (; s < end; s++) {
+        if (*s < '0' || *s > '9') {
+            return false;
+        }
+        v = v * 10 + (*s - '0');
+    }
+    *out = v;
+    return true;
+}
+
+/**
+ * @brief Match .../{z}/{x}/{y}.{ext}, taking the layer from a standard/
+ *        or satellite/ directory in the path
+ */
+static bool parse_tile_path(const char *path, tile_layer_t *layer, int *z, int *x, int *y)
+{
+    const char *seg[3] = {NULL};
+    const char *seg_end[3] = {NULL};
+
+    for (const char *p = path; *p != '\0'; ) {
+        const char *end = strchr(p, '/');
+        if (end == NULL) {
+            end = p + strlen(p);
+        }
+        size_t n = (size_t)(end - p);
+        if (n > 0) {
+            if (n == 8 && strncmp(p, "standard", 8) == 0) {
+                *layer = TILE_LAYER_STANDARD;
+            } else if (n == 9 && strncmp(p, "satellite", 9) == 0) {
+                *layer = TILE_LAYER_SATELLITE;
+            }
+            seg[0] = seg[1];
+            seg_end[0] = seg_end[1];
+            seg[1] = seg[2];
+            seg_end[1] = seg_end[2];
+            seg[2] = p;
+            seg_end[2] = end;
+        }
+        p = (*end != '\0') ? end + 1 : end;
+    }
+
+    if (seg[0] == NULL) {
+        return false;
+    }
+    const char *dot = memchr(seg[2], '.', (size_t)(seg_end[2] - seg[2]));
+    return parse_number(seg[0], seg_end[0], z) &&
+           parse_number(seg[1], seg_end[1], x) &&
+           parse_number(seg[2], dot != NULL ? dot : seg_end[2], y);
+}
+
+static esp_err_t tar_header(tiles_import_t *imp)
+{
+    const uint8_t *h = imp->header;
+
+    // A zero block marks the end of the archive
+    bool zero = true;
+    for (int i = 0; i < TAR_BLOCK && zero; i++) {
+        zero = (h[i] == 0);
+    }
+    if (zero) {
+        imp->state = IMPORT_END;
+        return ESP_OK;
+    }
+
+    uint64_t size;
+    if (!tar_checksum_ok(h) || !tar_number(h + 124, 12, &size)) {
+        ESP_LOGW(TAG, "Not a tar or tile pack archive");
+        return ESP_ERR_INVALID_ARG;
+    }
+    imp->padding = (uint32_t)((TAR_BLOCK - size % TAR_BLOCK) % TAR_BLOCK);
+
+    char type = (char)h[156];
+    if ((type == 'L' || type == 'x') && size <= TAR_META_MAX) {
+        imp->meta_type = type;
+        imp->meta_fill = 0;
+        imp->remaining = size;
+        imp->state = size > 0 ? IMPORT_META : IMPORT_HEADER;
+        imp->header_fill = 0;
+        return ESP_OK;
+    }
+
+    char path[TAR_PATH_MAX];
+    if (imp->long_path[0] != '\0') {
+        strlcpy(path, imp->long_path, sizeof(path));
+        imp->long_path[0] = '\0';
+    } else {
+        tar_path(h, path, sizeof(path));
+    }
+
+    // Regular files only; directories, links and global headers are skipped
+    if ((type == '0' || type == '\0' || type == '7') && size > 0) {
+
+        tile_layer_t layer = imp->default_layer;
+        int z, x, y;
+        if (parse_tile_path(path, &layer, &z, &x, &y)) {
+            if (size <= IMPORT_MAX_TILE) {
+                return begin_tile(imp, layer, z, x, y, (size_t)size);
+            }
+            imp->failed++;
+        } else {
+            imp->skipped++;
+        }
+    }
+
+    skip_entry(imp, size);
+    return ESP_OK;
+}
+
+static esp_err_t parse_header(tiles_import_t *imp)
+{
+    int z, x, y;
+    size_t len;
+
+    if (imp->format == FORMAT_UNKNOWN) {
+        if (!tile_pack_parse_record(imp->header, &z, &x, &y, &len)) {
+            // Keep collecting the rest of the first tar block
+            imp->format = FORMAT_TAR;
+            return ESP_OK;
+        }
+        imp->format = FORMAT_PACK;
+        ESP_LOGI(TAG, "Importing tile pack");
+    } else if (imp->format == FORMAT_TAR) {
+        return tar_header(imp);
+    } else if (!tile_pack_parse_record(imp->header, &z, &x, &y, &len)) {
+        ESP_LOGW(TAG, "Corrupt pack record");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    return begin_tile(imp, imp->default_layer, z, x, y, len);
+}
+
+static void publish_status(const tiles_import_t *imp)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_status.bytes = imp->bytes;
+    s_status.imported = imp->imported;
+    s_status.skipped = imp->skipped;
+    s_status.failed = imp->failed;
+    xSemaphoreGive(s_mutex);
+}
+
+esp_err_t tile_import_init(tile_pack_t *const *packs, int layer_count,
+                           tile_import_notify_fn_t notify_fn)
+{
+    if (packs == NULL || layer_count != IMPORT_LAYERS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (s_mutex == NULL) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (s_mutex == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    for (int i = 0; i < IMPORT_LAYERS; i++) {
+        s_packs[i] = packs[i];
+    }
+    s_notify = notify_fn;
+
+    // Drop directory for FTP uploads
+    mkdir(TILES_IMPORT_DIR, 0755);
+    return ESP_OK;
+}
+
+esp_err_t tiles_import_begin(tile_layer_t layer, bool replace, tiles_import_t **out_import)
+{
+    if (out_import == NULL || (int)layer < 0 || (int)layer >= IMPORT_LAYERS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (s_status.running) {
+        xSemaphoreGive(s_mutex);
+        return ESP_ERR_INVALID_STATE;
+    }
+    memset(&s_status, 0, sizeof(s_status));
+    s_status.running = true;
+    xSemaphoreGive(s_mutex);
+
+    tiles_import_t *imp = calloc(1, sizeof(tiles_import_t));
+    if (imp == NULL) {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        s_status.running = false;
+        s_status.result = ESP_ERR_NO_MEM;
+        xSemaphoreGive(s_mutex);
+        return ESP_ERR_NO_MEM;
+    }
+
+    imp->default_layer = layer;
+    imp->replace = replace;
+    imp->state = IMPORT_HEADER;
+
+    ESP_LOGI(TAG, "Import started (default layer %s%s)",
+             layer == TILE_LAYER_SATELLITE ? "satellite" : "standard",
+             replace ? ", replacing cached tiles" : "");
+    *out_import = imp;
+    return ESP_OK;
+}
+
+esp_err_t tiles_import_write(tiles_import_t *imp, const void *data, size_t len)
+{
+    if (imp == NULL || (data == NULL && len > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (imp->error != ESP_OK) {
+        return imp->error;
+    }
+
+    const uint8_t *p = data;
+    esp_err_t ret = ESP_OK;
+
+    while (len > 0 && ret == ESP_OK) {
+        size_t n = len;
+
+        switch (imp->state) {
+            case IMPORT_HEADER: {
+                size_t want = header_size(imp) - imp->header_fill;
+                n = want < len ? want : len;
+                memcpy(imp->header + imp->header_fill, p, n);
+                imp->header_fill += n;
+                if (imp->header_fill == header_size(imp)) {
+                    ret = parse_header(imp);
+                }
+                break;
+            }
+
+            case IMPORT_DATA:
+                if (imp->remaining < n) {
+                    n = (size_t)imp->remaining;
+                }
+                memcpy(imp->dst + imp->got, p, n);
+                imp->got += n;
+                imp->remaining -= n;
+                if (imp->remaining == 0) {
+                    ret = finish_tile(imp);
+                }
+                break;
+
+            case IMPORT_SKIP:
+                if (imp->remaining < n) {
+                    n = (size_t)imp->remaining;
+                }
+                imp->remaining -= n;
+                if (imp->remaining == 0) {
+                    next_entry(imp);
+                }
+                break;
+
+            case IMPORT_META:
+                if (imp->remaining < n) {
+                    n = (size_t)imp->remaining;
+                }
+                memcpy(imp->meta + imp->meta_fill, p, n);
+                imp->meta_fill += n;
+                imp->remaining -= n;
+                if (imp->remaining == 0) {
+                    tar_meta(imp);
+                    next_entry(imp);
+                }
+                break;
+
+            case IMPORT_END:
+                // Trailing zero blocks and record padding
+                break;
+        }
+
+        p += n;
+        len -= n;
+        imp->bytes += n;
+    }
+
+    publish_status(imp);
+    if (ret != ESP_OK) {
+        imp->error = ret;
+    }
+    return ret;
+}
+
+esp_err_t tiles_import_end(tiles_import_t *imp)
+{
+    if (imp == NULL) {
+        return ESP_OK;
+    }
+
+    esp_err_t ret = imp->error;
+
+    free(imp->large);
+    for (int i = 0; i < IMPORT_LAYERS; i++) {
+        esp_err_t err = tile_pack_batch_end(imp->batch[i]);
+        if (ret == ESP_OK) {
+            ret = err;
+        }
+    }
+
+    bool at_boundary = imp->state == IMPORT_END ||
+                       (imp->state == IMPORT_HEADER && imp->header_fill == 0);
+    if (ret == ESP_OK && !at_boundary) {
+        ESP_LOGW(TAG, "Archive ended inside an entry");
+        ret = ESP_ERR_INVALID_SIZE;
+    }
+
+    publish_status(imp);
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_status.running = false;
+    s_status.result = ret;
+    xSemaphoreGive(s_mutex);
+
+    ESP_LOGI(TAG, "Import %s: %lu tiles imported, %lu skipped, %lu failed (%llu KB)",
+             ret == ESP_OK ? "finished" : esp_err_to_name(ret),
+             (unsigned long)imp->imported, (unsigned long)imp->skipped,
+             (unsigned long)imp->failed, (unsigned long long)(imp->bytes / 1024));
+
+    if (s_notify != NULL) {
+        s_notify(true, imp->replace);
+    }
+    free(imp);
+    return ret;
+}
+
+esp_err_t tiles_import_get_status(tile_import_status_t *status)
+{
+    if (status == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_mutex == NULL) {
+        memset(status, 0, sizeof(*status));
+        return ESP_OK;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    *status = s_status;
+    xSemaphoreGive(s_mutex);
+    return ESP_OK;
+}
+
+#endif // CONFIG_GEOGRAM_BOARD_EPAPER_1IN54
@@ -0,0 +1,44 @@
+/**
+ * @file tile_import.h
+ * @brief Bulk tile import from a streamed archive
+ *
+ * Parses tar and .pack archives as they arrive (HTTP upload or FTP STOR)
+ * and writes the tiles into the layer archives through pack batches.
+ * The public entry points are tiles_import_*() in tiles.h.
+ */
+
+#ifndef GEOGRAM_TILE_IMPORT_H
+#define GEOGRAM_TILE_IMPORT_H
+
+#include "esp_err.h"
+#include "tile_pack.h"
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Called while an import is writing and once when it ends
+ *
+ * @param finished True for the final call of an import
+ * @param replaced True if the import may have overwritten cached tiles
+ */
+typedef void (*tile_import_notify_fn_t)(bool finished, bool replaced);
+
+/**
+ * @brief Hand the layer archives to the importer
+ *
+ * @param packs Archive per layer, indexed by tile_layer_t
+ * @param layer_count Number of layers
+ * @param notify_fn Progress callback (may be NULL)
+ * @return ESP_OK on success
+ */
+esp_err_t tile_import_init(tile_pack_t *const *packs, int layer_count,
+                           tile_import_notify_fn_t notify_fn);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_TILE_IMPORT_H
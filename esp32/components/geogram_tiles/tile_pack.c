@@ -0,0 +1,1312 @@
+/**
+ * @file tile_pack.c
+ * @brief Append-only packed tile archive implementation
+ */
+
+#include "sdkconfig.h"
+
+#if CONFIG_GEOGRAM_BOARD_EPAPER_1IN54
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "tile_pack.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "tile_pack";
+
+#define PACK_RECORD_MAGIC   0x4B505447  // "GTPK"
+#define PACK_INDEX_MAGIC    0x58495447  // "GTIX"
+#define PACK_INDEX_VERSION  3
+
+// Largest tile accepted into the archive (sanity bound for recovery scans)
+#define PACK_MAX_TILE_SIZE  (1024 * 1024)
+
+// Highest zoom level that fits the index key layout
+#define PACK_MAX_ZOOM       22
+
+// Initial hash table size (entries, power of two)
+#define PACK_INITIAL_SLOTS  4096
+
+// Entries read per fread() while loading the journal
+#define PACK_LOAD_BATCH     64
+
+// Copy buffer for compaction
+#define PACK_COPY_CHUNK     (16 * 1024)
+
+// Suffix of files being rewritten by snapshot/compaction
+#define PACK_NEW_SUFFIX     ".new"
+
+#define PACK_PATH_MAX       64
+
+// Write-behind buffer of a bulk write and the records it may hold
+#define PACK_BATCH_SIZE     (32 * 1024)
+#define PACK_BATCH_ENTRIES  256
+
+// Slack for shifting batch data to match the file offset's word alignment
+#define PACK_BATCH_ALIGN    4
+
+/**
+ * @brief Record header preceding each tile in the data file
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint8_t z;
+    uint8_t flags;
+    uint16_t reserved;
+    uint32_t x;
+    uint32_t y;
+    uint32_t len;
+} pack_record_t;
+
+_Static_assert(sizeof(pack_record_t) == TILE_PACK_RECORD_SIZE, "record header size");
+
+/**
+ * @brief Index journal header
+ *
+ * epoch is drawn anew whenever the index starts over (cleared or rebuilt),
+ * so write stamps of a previous archive never match the current one.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t epoch;
+} pack_index_header_t;
+
+/**
+ * @brief Index entry (journal record and hash table slot)
+ *
+ * offset points at the tile payload, just past its record header.
+ * key == 0 marks an empty slot; in the journal, len == 0 is a tombstone.
+ * stamp is the access clock value (minutes) of the last read or write.
+ * written is the write stamp of the stored copy: it grows with every tile
+ * written and stays the same when compaction moves the record.
+ */
+typedef struct __attribute__((packed)) {
+    uint64_t key;
+    uint32_t offset;
+    uint32_t len;
+    uint32_t stamp;
+    uint32_t written;
+} pack_entry_t;
+
+struct tile_pack {
+    FILE *data;
+    FILE *index;
+    SemaphoreHandle_t lock;
+    SemaphoreHandle_t rewrite_lock; // Serializes compaction and clear
+    pack_entry_t *slots;
+    uint32_t capacity;
+    uint32_t count;
+    uint64_t bytes;
+    uint32_t data_end;
+    uint32_t epoch;             // Index generation (see pack_index_header_t)
+    uint32_t next_written;      // Write stamp of the next stored tile
+    bool dirty;                 // Access stamps changed since last snapshot
+    char data_path[PACK_PATH_MAX];
+    char index_path[PACK_PATH_MAX];
+};
+
+struct tile_pack_batch {
+    tile_pack_t *pack;
+    uint8_t *buf;               // PACK_BATCH_SIZE + PACK_BATCH_ALIGN bytes
+    uint32_t shift;             // Records start at buf + shift
+    uint32_t fill;              // Bytes of committed records
+    uint32_t reserved;          // Record size of the open reservation (0 = none)
+    pack_entry_t *entries;      // Committed records, offsets relative to the buffer
+    uint32_t entry_count;
+};
+
+// Access clock shared by all archives so stamps compare across layers
+static uint32_t s_clock_base = 0;
+
+static uint32_t clock_now(void)
+{
+    return s_clock_base + (uint32_t)(esp_timer_get_time() / (60LL * 1000000LL));
+}
+
+static void clock_observe(uint32_t stamp)
+{
+    // Continue after the newest stamp seen on the card
+    uint32_t now = clock_now();
+    if (stamp >= now) {
+        s_clock_base += stamp - now + 1;
+    }
+}
+
+static uint64_t make_key(int z, int x, int y)
+{
+    // z + 1 keeps the key non-zero for tile 0/0/0
+    return ((uint64_t)(z + 1) << 56) | ((uint64_t)x << 28) | (uint64_t)y;
+}
+
+static bool coords_valid(int z, int x, int y)
+{
+    if (z < 0 || z > PACK_MAX_ZOOM) {
+        return false;
+    }
+    int32_t max = (int32_t)1 << z;
+    return x >= 0 && y >= 0 && x < max && y < max;
+}
+
+static uint32_t hash_key(uint64_t key)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return (uint32_t)key;
+}
+
+static uint32_t record_size(uint32_t len)
+{
+    return sizeof(pack_record_t) + len;
+}
+
+static bool file_exists(const char *path)
+{
+    struct stat st;
+    return stat(path, &st) == 0;
+}
+
+static void *alloc_psram(size_t size)
+{
+    void *p = heap_caps_calloc(1, size, MALLOC_CAP_SPIRAM);
+    if (p == NULL) {
+        p = calloc(1, size);
+    }
+    return p;
+}
+
+static pack_entry_t *find_slot(pack_entry_t *slots, uint32_t capacity, uint64_t key)
+{
+    uint32_t mask = capacity - 1;
+    uint32_t i = hash_key(key) & mask;
+    while (slots[i].key != 0 && slots[i].key != key) {
+        i = (i + 1) & mask;
+    }
+    return &slots[i];
+}
+
+static esp_err_t grow_table(tile_pack_t *pack)
+{
+    uint32_t new_capacity = pack->capacity * 2;
+    pack_entry_t *new_slots = alloc_psram((size_t)new_capacity * sizeof(pack_entry_t));
+    if (new_slots == NULL) {
+        ESP_LOGE(TAG, "Failed to grow index to %lu entries", (unsigned long)new_capacity);
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (uint32_t i = 0; i < pack->capacity; i++) {
+        if (pack->slots[i].key != 0) {
+            *find_slot(new_slots, new_capacity, pack->slots[i].key) = pack->slots[i];
+        }
+    }
+
+    free(pack->slots);
+    pack->slots = new_slots;
+    pack->capacity = new_capacity;
+    return ESP_OK;
+}
+
+static void reset_table(tile_pack_t *pack)
+{
+    memset(pack->slots, 0, (size_t)pack->capacity * sizeof(pack_entry_t));
+    pack->count = 0;
+    pack->bytes = 0;
+    pack->data_end = 0;
+    pack->next_written = 1;
+}
+
+static esp_err_t index_insert(tile_pack_t *pack, const pack_entry_t *entry)
+{
+    // Keep load factor below 75%
+    if ((pack->count + 1) * 4 > pack->capacity * 3) {
+        esp_err_t ret = grow_table(pack);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+
+    pack_entry_t *slot = find_slot(pack->slots, pack->capacity, entry->key);
+    if (slot->key == 0) {
+        pack->count++;
+    } else {
+        pack->bytes -= slot->len;
+    }
+    *slot = *entry;
+    pack->bytes += entry->len;
+
+    uint32_t end = entry->offset + entry->len;
+    if (end > pack->data_end) {
+        pack->data_end = end;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Remove a slot, shifting back the rest of its probe run
+ */
+static void index_remove_at(tile_pack_t *pack, uint32_t i)
+{
+    uint32_t mask = pack->capacity - 1;
+
+    pack->count--;
+    pack->bytes -= pack->slots[i].len;
+
+    uint32_t j = i;
+    while (true) {
+        j = (j + 1) & mask;
+        if (pack->slots[j].key == 0) {
+            break;
+        }
+        uint32_t k = hash_key(pack->slots[j].key) & mask;
+        // Entry at j may stay if its home slot k lies cyclically in (i, j]
+        bool stays = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+        if (!stays) {
+            pack->slots[i] = pack->slots[j];
+            i = j;
+        }
+    }
+    pack->slots[i].key = 0;
+}
+
+static void index_remove(tile_pack_t *pack, uint64_t key)
+{
+    pack_entry_t *slot = find_slot(pack->slots, pack->capacity, key);
+    if (slot->key != 0) {
+        index_remove_at(pack, (uint32_t)(slot - pack->slots));
+    }
+}
+
+static esp_err_t journal_append(tile_pack_t *pack, const pack_entry_t *entry, bool sync)
+{
+    if (fwrite(entry, sizeof(*entry), 1, pack->index) != 1) {
+        return ESP_FAIL;
+    }
+    if (sync) {
+        fflush(pack->index);
+        fsync(fileno(pack->index));
+    }
+    return ESP_OK;
+}
+
+static void journal_sync(tile_pack_t *pack)
+{
+    fflush(pack->index);
+    fsync(fileno(pack->index));
+}
+
+/**
+ * @brief Load the index journal (snapshot followed by appended entries)
+ *
+ * @return true if the journal was valid, false if it must be rebuilt
+ */
+static bool journal_load(tile_pack_t *pack, uint32_t data_size)
+{
+    FILE *f = fopen(pack->index_path, "rb");
+    if (f == NULL) {
+        return false;
+    }
+
+    pack_index_header_t header;
+    if (fread(&header, sizeof(header), 1, f) != 1 ||
+        header.magic != PACK_INDEX_MAGIC || header.version != PACK_INDEX_VERSION) {
+        fclose(f);
+        ESP_LOGW(TAG, "Invalid index %s - rebuilding", pack->index_path);
+        return false;
+    }
+    pack->epoch = header.epoch;
+
+    pack_entry_t batch[PACK_LOAD_BATCH];
+    size_t n;
+    while ((n = fread(batch, sizeof(pack_entry_t), PACK_LOAD_BATCH, f)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            if (batch[i].key == 0) {
+                continue;
+            }
+            if (batch[i].len == 0) {
+                index_remove(pack, batch[i].key);
+                continue;
+            }
+            // Skip entries whose payload did not make it to the data file
+            if ((uint64_t)batch[i].offset + batch[i].len > data_size) {
+                continue;
+            }
+            if (index_insert(pack, &batch[i]) != ESP_OK) {
+                fclose(f);
+                return false;
+            }
+            clock_observe(batch[i].stamp);
+            if (batch[i].written >= pack->next_written) {
+                pack->next_written = batch[i].written + 1;
+            }
+        }
+    }
+
+    fclose(f);
+    return true;
+}
+
+/**
+ * @brief Index records appended after the last journal entry
+ *
+ * Truncates the data file at the first incomplete or corrupt record.
+ */
+static void recover_tail(tile_pack_t *pack, uint32_t data_size)
+{
+    uint32_t pos = pack->data_end;
+    uint32_t recovered = 0;
+    uint32_t now = clock_now();
+
+    while (pos + sizeof(pack_record_t) <= data_size) {
+        pack_record_t rec;
+        if (fseek(pack->data, pos, SEEK_SET) != 0 ||
+            fread(&rec, sizeof(rec), 1, pack->data) != 1) {
+            break;
+        }
+
+        uint32_t payload = pos + sizeof(pack_record_t);
+        if (rec.magic != PACK_RECORD_MAGIC ||
+            !coords_valid(rec.z, (int)rec.x, (int)rec.y) ||
+            rec.len == 0 || rec.len > PACK_MAX_TILE_SIZE ||
+            (uint64_t)payload + rec.len > data_size) {
+            break;
+        }
+
+        pack_entry_t entry = {
+            .key = make_key(rec.z, (int)rec.x, (int)rec.y),
+            .offset = payload,
+            .len = rec.len,
+            .stamp = now,
+            .written = pack->next_written++,
+        };
+        if (index_insert(pack, &entry) != ESP_OK || journal_append(pack, &entry, false) != ESP_OK) {
+            break;
+        }
+        pos = payload + rec.len;
+        recovered++;
+    }
+
+    if (recovered > 0) {
+        journal_sync(pack);
+        ESP_LOGI(TAG, "Recovered %lu unindexed tiles", (unsigned long)recovered);
+    }
+
+    if (pos < data_size) {
+        ESP_LOGW(TAG, "Discarding %lu bytes of incomplete data at offset %lu",
+                 (unsigned long)(data_size - pos), (unsigned long)pos);
+        fflush(pack->data);
+        ftruncate(fileno(pack->data), pos);
+    }
+    pack->data_end = pos;
+}
+
+/**
+ * @brief Finish or roll back a snapshot/compaction interrupted by reset
+ *
+ * New files are written as *.new. Deleting the old index is the commit
+ * point: before it the *.new files are discarded, after it they are
+ * moved into place.
+ */
+static void recover_rewrite(const char *data_path, const char *index_path)
+{
+    char new_data[PACK_PATH_MAX + 8];
+    char new_index[PACK_PATH_MAX + 8];
+    snprintf(new_data, sizeof(new_data), "%s%s", data_path, PACK_NEW_SUFFIX);
+    snprintf(new_index, sizeof(new_index), "%s%s", index_path, PACK_NEW_SUFFIX);
+
+    if (!file_exists(new_index)) {
+        unlink(new_data);
+        return;
+    }
+
+    if (file_exists(index_path)) {
+        ESP_LOGW(TAG, "Discarding unfinished rewrite of %s", data_path);
+        unlink(new_data);
+        unlink(new_index);
+        return;
+    }
+
+    ESP_LOGW(TAG, "Completing interrupted rewrite of %s", data_path);
+    if (file_exists(new_data)) {
+        unlink(data_path);
+        rename(new_data, data_path);
+    }
+    rename(new_index, index_path);
+}
+
+/**
+ * @brief Open data file and journal, load index
+ *
+ * Called with the lock held (or before the pack is shared).
+ */
+static esp_err_t pack_load(tile_pack_t *pack)
+{
+    recover_rewrite(pack->data_path, pack->index_path);
+
+    pack->data = fopen(pack->data_path, "r+b");
+    if (pack->data == NULL) {
+        pack->data = fopen(pack->data_path, "w+b");
+    }
+    if (pack->data == NULL) {
+        ESP_LOGE(TAG, "Failed to open %s", pack->data_path);
+        return ESP_FAIL;
+    }
+
+    fseek(pack->data, 0, SEEK_END);
+    long size = ftell(pack->data);
+    uint32_t data_size = size > 0 ? (uint32_t)size : 0;
+
+    reset_table(pack);
+    if (journal_load(pack, data_size)) {
+        pack->index = fopen(pack->index_path, "ab");
+    } else {
+        // Start a fresh journal and re-index the whole data file
+        reset_table(pack);
+        pack->epoch = esp_random();
+        pack->index = fopen(pack->index_path, "wb");
+        if (pack->index != NULL) {
+            pack_index_header_t header = {
+                .magic = PACK_INDEX_MAGIC,
+                .version = PACK_INDEX_VERSION,
+                .epoch = pack->epoch,
+            };
+            fwrite(&header, sizeof(header), 1, pack->index);
+            journal_sync(pack);
+        }
+    }
+    if (pack->index == NULL) {
+        ESP_LOGE(TAG, "Failed to open %s", pack->index_path);
+        return ESP_FAIL;
+    }
+
+    // data_end points past the last indexed payload, i.e. at a record boundary
+    recover_tail(pack, data_size);
+    pack->dirty = false;
+    return ESP_OK;
+}
+
+static void pack_unload(tile_pack_t *pack)
+{
+    if (pack->data != NULL) {
+        fclose(pack->data);
+        pack->data = NULL;
+    }
+    if (pack->index != NULL) {
+        fclose(pack->index);
+        pack->index = NULL;
+    }
+}
+
+/**
+ * @brief Write a full index snapshot (header + all live entries)
+ */
+static esp_err_t write_index_file(tile_pack_t *pack, const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        return ESP_FAIL;
+    }
+
+    pack_index_header_t header = {
+        .magic = PACK_INDEX_MAGIC,
+        .version = PACK_INDEX_VERSION,
+        .epoch = pack->epoch,
+    };
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+
+    for (uint32_t i = 0; ok && i < pack->capacity; i++) {
+        if (pack->slots[i].key != 0) {
+            ok = fwrite(&pack->slots[i], sizeof(pack_entry_t), 1, f) == 1;
+        }
+    }
+
+    ok = ok && fflush(f) == 0;
+    fsync(fileno(f));
+    fclose(f);
+    return ok ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t tile_pack_open(const char *data_path, const char *index_path, tile_pack_t **out_pack)
+{
+    if (data_path == NULL || index_path == NULL || out_pack == NULL ||
+        strlen(data_path) >= PACK_PATH_MAX || strlen(index_path) >= PACK_PATH_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    tile_pack_t *pack = calloc(1, sizeof(tile_pack_t));
+    if (pack == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    strlcpy(pack->data_path, data_path, sizeof(pack->data_path));
+    strlcpy(pack->index_path, index_path, sizeof(pack->index_path));
+
+    pack->capacity = PACK_INITIAL_SLOTS;
+    pack->slots = alloc_psram((size_t)pack->capacity * sizeof(pack_entry_t));
+    pack->lock = xSemaphoreCreateMutex();
+    pack->rewrite_lock = xSemaphoreCreateMutex();
+    if (pack->slots == NULL || pack->lock == NULL || pack->rewrite_lock == NULL) {
+        tile_pack_close(pack);
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = pack_load(pack);
+    if (ret != ESP_OK) {
+        tile_pack_close(pack);
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Opened %s: %lu tiles, %llu bytes (%lu on card)", data_path,
+             (unsigned long)pack->count, (unsigned long long)pack->bytes,
+             (unsigned long)pack->data_end);
+
+    *out_pack = pack;
+    return ESP_OK;
+}
+
+void tile_pack_close(tile_pack_t *pack)
+{
+    if (pack == NULL) {
+        return;
+    }
+    pack_unload(pack);
+    if (pack->lock != NULL) {
+        vSemaphoreDelete(pack->lock);
+    }
+    if (pack->rewrite_lock != NULL) {
+        vSemaphoreDelete(pack->rewrite_lock);
+    }
+    free(pack->slots);
+    free(pack);
+}
+
+bool tile_pack_contains(tile_pack_t *pack, int z, int x, int y)
+{
+    if (pack == NULL || !coords_valid(z, x, y)) {
+        return false;
+    }
+
+    xSemaphoreTake(pack->lock, portMAX_DELAY);
+    bool found = find_slot(pack->slots, pack->capacity, make_key(z, x, y))->key != 0;
+    xSemaphoreGive(pack->lock);
+    return found;
+}
+
+esp_err_t tile_pack_stat(tile_pack_t *pack, int z, int x, int y,
+                         size_t *tile_size, uint64_t *version)
+{
+    if (pack == NULL || !coords_valid(z, x, y)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    xSemaphoreTake(pack->lock, portMAX_DELAY);
+    pack_entry_t entry = *find_slot(pack->slots, pack->capacity, make_key(z, x, y));
+    uint32_t epoch = pack->epoch;
+    xSemaphoreGive(pack->lock);
+
+    if (entry.key == 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (tile_size) {
+        *tile_size = entry.len;
+    }
+    if (version) {
+        *version = ((uint64_t)epoch << 32) | entry.written;
+    }
+    return ESP_OK;
+}
+
+esp_err_t tile_pack_read(tile_pack_t *pack, int z, int x, int y,
+                         uint8_t *buffer, size_t buffer_size, size_t *tile_size)
+{
+    if (pack == NULL || buffer == NULL || tile_size == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!coords_valid(z, x, y)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    xSemaphoreTake(pack->lock, portMAX_DELAY);
+
+    pack_entry_t *slot = find_slot(pack->slots, pack->capacity, make_key(z, x, y));
+    esp_err_t ret = ESP_OK;
+
+    if (slot->key == 0 || pack->data == NULL) {
+        ret = ESP_ERR_NOT_FOUND;
+    } else if (slot->len > buffer_size) {
+        ret = ESP_ERR_INVALID_SIZE;
+    } else if (fseek(pack->data, slot->offset, SEEK_SET) != 0 ||
+               fread(buffer, 1, slot->len, pack->data) != slot->len) {
+        ESP_LOGE(TAG, "Read failed at offset %lu", (unsigned long)slot->offset);
+        ret = ESP_FAIL;
+    } else {
+        *tile_size = slot->len;
+        // Stamp is persisted by the next snapshot, not per read
+        uint32_t now = clock_now();
+        if (slot->stamp != now) {
+            slot->stamp = now;
+            pack->dirty = true;
+        }
+    }
+
+    xSemaphoreGive(pack->lock);
+    return ret;
+}
+
+esp_err_t tile_pack_read_part(tile_pack_t *pack, int z, int x, int y, size_t offset,
+                              uint8_t *buffer, size_t buffer_size,
+                              size_t *bytes_read, size_t *tile_size)
+{
+    if (pack == NULL || buffer == NULL || bytes_read == NULL || tile_size == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!coords_valid(z, x, y)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    xSemaphoreTake(pack->lock, portMAX_DELAY);
+
+    pack_entry_t *slot = find_slot(pack->slots, pack->capacity, make_key(z, x, y));
+    esp_err_t ret = ESP_OK;
+
+    if (slot->key == 0 || pack->data == NULL) {
+        ret = ESP_ERR_NOT_FOUND;
+    } else if (offset > slot->len) {
+        ret = ESP_ERR_INVALID_ARG;
+    } else {
+        size_t n = slot->len - offset;
+        if (n > buffer_size) {
+            n = buffer_size;
+        }
+        if (n > 0 && (fseek(pack->data, slot->offset + offset, SEEK_SET) != 0 ||
+                      fread(buffer, 1, n, pack->data) != n)) {
+            ESP_LOGE(TAG, "Read failed at offset %lu", (unsigned long)(slot->offset + offset));
+            ret = ESP_FAIL;
+        } else {
+            *bytes_read = n;
+            *tile_size = slot->len;
+            if (offset == 0) {
+                uint32_t now = clock_now();
+                if (slot->stamp != now) {
+                    slot->stamp = now;
+                    pack->dirty = true;
+                }
+            }
+        }
+    }
+
+    xSemaphoreGive(pack->lock);
+    return ret;
+}
+
+esp_err_t tile_pack_append(tile_pack_t *pack, int z, int x, int y,
+                           const uint8_t *data, size_t len)
+{
+    if (pack == NULL || data == NULL || len == 0 || len > PACK_MAX_TILE_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!coords_valid(z, x, y)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(pack->lock, portMAX_DELAY);
+
+    if (pack->data == NULL || pack->index == NULL) {
+        xSemaphoreGive(pack->lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint32_t start = pack->data_end;
+    uint64_t end = (uint64_t)start + record_size(len);
+
+    // FAT32 caps a single file at 4 GB
+    if (end > UINT32_MAX) {
+        xSemaphoreGive(pack->lock);
+        ESP_LOGW(TAG, "Archive full");
+        return ESP_ERR_NO_MEM;
+    }
+
+    pack_record_t rec = {
+        .magic = PACK_RECORD_MAGIC,
+        .z = (uint8_t)z,
+        .x = (uint32_t)x,
+        .y = (uint32_t)y,
+        .len = (uint32_t)len,
+    };
+
+    esp_err_t ret = ESP_OK;
+    if (fseek(pack->data, start, SEEK_SET) != 0 ||
+        fwrite(&rec, sizeof(rec), 1, pack->data) != 1 ||
+        fwrite(data, 1, len, pack->data) != len ||
+        fflush(pack->data) != 0) {
+        ESP_LOGE(TAG, "Write failed at offset %lu", (unsigned long)start);
+        // Drop the partial record so the next append starts on a boundary
+        ftruncate(fileno(pack->data), start);
+        ret = ESP_FAIL;
+    }
+
+    if (ret == ESP_OK) {
+        fsync(fileno(pack->data));
+
+        pack_entry_t entry = {
+            .key = make_key(z, x, y),
+            .offset = start + sizeof(pack_record_t),
+            .len = (uint32_t)len,
+            .stamp = clock_now(),
+            .written = pack->next_written++,
+        };
+        ret = index_insert(pack, &entry);
+        if (ret == ESP_OK && journal_append(pack, &entry, true) != ESP_OK) {
+            // Record is still recoverable from the data file on next open
+            ESP_LOGW(TAG, "Failed to journal tile %d/%d/%d", z, x, y);
+        }
+    }
+
+    xSemaphoreGive(pack->lock);
+    return ret;
+}
+
+uint32_t tile_pack_count(tile_pack_t *pack)
+{
+    return pack != NULL ? pack->count : 0;
+}
+
+uint64_t tile_pack_bytes(tile_pack_t *pack)
+{
+    return pack != NULL ? pack->bytes : 0;
+}
+
+uint32_t tile_pack_disk_bytes(tile_pack_t *pack)
+{
+    return pack != NULL ? pack->data_end : 0;
+}
+
+bool tile_pack_stamp_range(tile_pack_t *pack, uint32_t *oldest, uint32_t *newest)
+{
+    if (pack == NULL || pack->count == 0) {
+        return false;
+    }
+
+    xSemaphoreTake(pack->lock, portMAX_DELAY);
+    uint32_t lo = UINT32_MAX;
+    uint32_t hi = 0;
+    for (uint32_t i = 0; i < pack->capacity; i++) {
+        if (pack->slots[i].key != 0) {
+            if (pack->slots[i].stamp < lo) {
+                lo = pack->slots[i].stamp;
+            }
+            if (pack->slots[i].stamp > hi) {
+                hi = pack->slots[i].stamp;
+            }
+        }
+    }
+    xSemaphoreGive(pack->lock);
+
+    *oldest = lo;
+    *newest = hi;
+    return lo <= hi;
+}
+
+void tile_pack_age_histogram(tile_pack_t *pack, uint32_t oldest, uint32_t newest,
+                             uint64_t *bins, int nbins)
+{
+    if (pack == NULL || bins == NULL || nbins <= 0 || newest < oldest) {
+        return;
+    }
+
+    uint64_t span = (uint64_t)newest - oldest + 1;
+
+    xSemaphoreTake(pack->lock, portMAX_DELAY);
+    for (uint32_t i = 0; i < pack->capacity; i++) {
+        const pack_entry_t *e = &pack->slots[i];
+        if (e->key == 0 || e->stamp < oldest || e->stamp > newest) {
+            continue;
+        }
+        int bin = (int)(((uint64_t)(e->stamp - oldest) * nbins) / span);
+        bins[bin] += record_size(e->len);
+    }
+    xSemaphoreGive(pack->lock);
+}
+
+uint32_t tile_pack_evict(tile_pack_t *pack, uint32_t below, uint32_t upto, uint64_t *extra_bytes)
+{
+    if (pack == NULL) {
+        return 0;
+    }
+
+    uint32_t evicted = 0;
+    xSemaphoreTake(pack->lock, portMAX_DELAY);
+
+    uint32_t i = 0;
+    while (i < pack->capacity && pack->index != NULL) {
+        pack_entry_t *e = &pack->slots[i];
+        bool evict = false;
+        if (e->key != 0) {
+            if (e->stamp < below) {
+                evict = true;
+            } else if (e->stamp < upto && extra_bytes != NULL && *extra_bytes > 0) {
+                uint32_t size = record_size(e->len);
+                *extra_bytes = (*extra_bytes > size) ? *extra_bytes - size : 0;
+                evict = true;
+            }
+        }
+
+        if (!evict) {
+            i++;
+            continue;
+        }
+
+        pack_entry_t tombstone = { .key = e->key, .offset = 0, .len = 0, .stamp = 0 };
+        journal_append(pack, &tombstone, false);
+        // Backward shift may move an unvisited entry into slot i; re-check it
+        index_remove_at(pack, i);
+        evicted++;
+    }
+
+    if (evicted > 0) {
+        journal_sync(pack);
+    }
+
+    xSemaphoreGive(pack->lock);
+    return evicted;
+}
+
+/**
+ * @brief Old and new position of a record moved by compaction
+ */
+typedef struct {
+    uint32_t old_offset;
+    uint32_t new_offset;
+    uint32_t len;
+} pack_move_t;
+
+static int cmp_move_offset(const void *a, const void *b)
+{
+    const pack_move_t *ma = a;
+    const pack_move_t *mb = b;
+    return (ma->old_offset > mb->old_offset) - (ma->old_offset < mb->old_offset);
+}
+
+static const pack_move_t *find_move(const pack_move_t *moves, uint32_t n, uint32_t old_offset)
+{
+    pack_move_t probe = { .old_offset = old_offset };
+    return bsearch(&probe, moves, n, sizeof(pack_move_t), cmp_move_offset);
+}
+
+/**
+ * @brief Copy one record (header + payload) to the end of `out`
+ */
+static bool copy_record(FILE *in, FILE *out, uint32_t payload_offset, uint32_t len, uint8_t *chunk)
+{
+    uint32_t remaining = record_size(len);
+    if (fseek(in, payload_offset - sizeof(pack_record_t), SEEK_SET) != 0) {
+        return false;
+    }
+    while (remaining > 0) {
+        size_t step = remaining < PACK_COPY_CHUNK ? remaining : PACK_COPY_CHUNK;
+        if (fread(chunk, 1, step, in) != step || fwrite(chunk, 1, step, out) != step) {
+            return false;
+        }
+        remaining -= step;
+    }
+    return true;
+}
+
+uint64_t tile_pack_compact_bytes(tile_pack_t *pack)
+{
+    if (pack == NULL) {
+        return 0;
+    }
+
+    xSemaphoreTake(pack->lock, portMAX_DELAY);
+    uint64_t live = pack->bytes + (uint64_t)pack->count * sizeof(pack_record_t);
+    uint64_t need = 0;
+    if (pack->data != NULL && pack->data_end > live) {
+        need = live + sizeof(pack_index_header_t) + (uint64_t)pack->count * sizeof(pack_entry_t);
+    }
+    xSemaphoreGive(pack->lock);
+    return need;
+}
+
+esp_err_t tile_pack_compact(tile_pack_t *pack)
+{
+    if (pack == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(pack->rewrite_lock, portMAX_DELAY);
+    xSemaphoreTake(pack->lock, portMAX_DELAY);
+
+    uint64_t live = pack->bytes + (uint64_t)pack->count * sizeof(pack_record_t);
+    if (pack->data == NULL || pack->data_end <= live) {
+        // No dead space
+        xSemaphoreGive(pack->lock);
+        xSemaphoreGive(pack->rewrite_lock);
+        return ESP_OK;
+    }
+
+    // Take a list of live records; the bulk copy runs without the lock
+    uint32_t n = 0;
+    uint32_t copy_end = pack->data_end;
+    pack_move_t *moves = alloc_psram((size_t)(pack->count + 1) * sizeof(pack_move_t));
+    if (moves != NULL) {
+        for (uint32_t i = 0; i < pack->capacity; i++) {
+            if (pack->slots[i].key != 0) {
+                moves[n].old_offset = pack->slots[i].offset;
+                moves[n].len = pack->slots[i].len;
+                n++;
+            }
+        }
+    }
+
+    xSemaphoreGive(pack->lock);
+
+    char new_data[PACK_PATH_MAX + 8];
+    char new_index[PACK_PATH_MAX + 8];
+    snprintf(new_data, sizeof(new_data), "%s%s", pack->data_path, PACK_NEW_SUFFIX);
+    snprintf(new_index, sizeof(new_index), "%s%s", pack->index_path, PACK_NEW_SUFFIX);
+
+    uint8_t *chunk = malloc(PACK_COPY_CHUNK);
+    FILE *in = fopen(pack->data_path, "rb");
+    FILE *out = fopen(new_data, "wb");
+    esp_err_t ret = (moves && chunk && in && out) ? ESP_OK : ESP_ERR_NO_MEM;
+
+    // Copy live records in file order; reads and appends continue meanwhile
+    uint32_t pos = 0;
+    if (ret == ESP_OK) {
+        qsort(moves, n, sizeof(pack_move_t), cmp_move_offset);
+        for (uint32_t i = 0; i < n; i++) {
+            if (!copy_record(in, out, moves[i].old_offset, moves[i].len, chunk)) {
+                ret = ESP_FAIL;
+                break;
+            }
+            moves[i].new_offset = pos + sizeof(pack_record_t);
+            pos += record_size(moves[i].len);
+        }
+    }
+    if (in != NULL) {
+        fclose(in);
+    }
+
+    xSemaphoreTake(pack->lock, portMAX_DELAY);
+
+    // Remap the current index: records copied above move, records appended
+    // since are copied now, and tiles evicted meanwhile are simply dropped
+    for (uint32_t i = 0; ret == ESP_OK && i < pack->capacity; i++) {
+        pack_entry_t *e = &pack->slots[i];
+        if (e->key == 0) {
+            continue;
+        }
+        if (e->offset < copy_end) {
+            const pack_move_t *m = find_move(moves, n, e->offset);
+            if (m == NULL) {
+                ret = ESP_FAIL;
+                break;
+            }
+            e->offset = m->new_offset;
+        } else {
+            if (!copy_record(pack->data, out, e->offset, e->len, chunk)) {
+                ret = ESP_FAIL;
+                break;
+            }
+            e->offset = pos + sizeof(pack_record_t);
+            pos += record_size(e->len);
+        }
+    }
+
+    if (out != NULL) {
+        if (ret == ESP_OK && fflush(out) != 0) {
+            ret = ESP_FAIL;
+        }
+        fsync(fileno(out));
+        fclose(out);
+    }
+    free(chunk);
+    free(moves);
+
+    if (ret == ESP_OK) {
+        ret = write_index_file(pack, new_index);
+    }
+
+    uint32_t old_size = pack->data_end;
+    if (ret == ESP_OK) {
+        pack_unload(pack);
+
+        // Commit point: the old index goes away (see recover_rewrite)
+        unlink(pack->index_path);
+        unlink(pack->data_path);
+        rename(new_data, pack->data_path);
+        rename(new_index, pack->index_path);
+    } else {
+        ESP_LOGE(TAG, "Compaction of %s failed (card full?)", pack->data_path);
+        unlink(new_data);
+        unlink(new_index);
+        // In-RAM offsets may be half rewritten; reload from card
+        pack_unload(pack);
+    }
+
+    esp_err_t load_ret = pack_load(pack);
+    if (ret == ESP_OK) {
+        ret = load_ret;
+        ESP_LOGI(TAG, "Compacted %s: %lu -> %lu bytes", pack->data_path,
+                 (unsigned long)old_size, (unsigned long)pos);
+    }
+
+    xSemaphoreGive(pack->lock);
+    xSemaphoreGive(pack->rewrite_lock);
+    return ret;
+}
+
+esp_err_t tile_pack_snapshot(tile_pack_t *pack)
+{
+    if (pack == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(pack->lock, portMAX_DELAY);
+
+    if (!pack->dirty || pack->index == NULL) {
+        xSemaphoreGive(pack->lock);
+        return ESP_OK;
+    }
+
+    char new_index[PACK_PATH_MAX + 8];
+    snprintf(new_index, sizeof(new_index), "%s%s", pack->index_path, PACK_NEW_SUFFIX);
+
+    esp_err_t ret = write_index_file(pack, new_index);
+    if (ret != ESP_OK) {
+        unlink(new_index);
+        xSemaphoreGive(pack->lock);
+        ESP_LOGW(TAG, "Index snapshot of %s failed", pack->index_path);
+        return ret;
+    }
+
+    // Commit point: the old index goes away (see recover_rewrite)
+    fclose(pack->index);
+    unlink(pack->index_path);
+    rename(new_index, pack->index_path);
+
+    pack->index = fopen(pack->index_path, "ab");
+    pack->dirty = false;
+    ret = pack->index != NULL ? ESP_OK : ESP_FAIL;
+
+    xSemaphoreGive(pack->lock);
+    ESP_LOGD(TAG, "Index snapshot written: %s", pack->index_path);
+    return ret;
+}
+
+esp_err_t tile_pack_clear(tile_pack_t *pack)
+{
+    if (pack == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(pack->rewrite_lock, portMAX_DELAY);
+    xSemaphoreTake(pack->lock, portMAX_DELAY);
+
+    pack_unload(pack);
+    unlink(pack->index_path);
+    unlink(pack->data_path);
+    esp_err_t ret = pack_load(pack);
+
+    xSemaphoreGive(pack->lock);
+    xSemaphoreGive(pack->rewrite_lock);
+    ESP_LOGI(TAG, "Cleared %s", pack->data_path);
+    return ret;
+}
+
+esp_err_t tile_pack_batch_begin(tile_pack_t *pack, tile_pack_batch_t **out_batch)
+{
+    if (pack == NULL || out_batch == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    tile_pack_batch_t *batch = calloc(1, sizeof(tile_pack_batch_t));
+    if (batch == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Internal DMA-capable memory lets the SD driver write straight from
+    // the buffer; from PSRAM it would bounce every sector through a copy
+    batch->buf = heap_caps_malloc(PACK_BATCH_SIZE + PACK_BATCH_ALIGN, MALLOC_CAP_DMA);
+    if (batch->buf == NULL) {
+        batch->buf = heap_caps_malloc(PACK_BATCH_SIZE + PACK_BATCH_ALIGN, MALLOC_CAP_SPIRAM);
+    }
+    batch->entries = alloc_psram(PACK_BATCH_ENTRIES * sizeof(pack_entry_t));
+    if (batch->buf == NULL || batch->entries == NULL) {
+        free(batch->buf);
+        free(batch->entries);
+        free(batch);
+        return ESP_ERR_NO_MEM;
+    }
+
+    batch->pack = pack;
+    *out_batch = batch;
+    return ESP_OK;
+}
+
+esp_err_t tile_pack_batch_reserve(tile_pack_batch_t *batch, int z, int x, int y,
+                                  size_t len, uint8_t **payload)
+{
+    if (batch == NULL || payload == NULL || len == 0 || len > PACK_MAX_TILE_SIZE ||
+        !coords_valid(z, x, y)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (record_size(len) > PACK_BATCH_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    batch->reserved = 0;
+    if (batch->fill + record_size(len) > PACK_BATCH_SIZE ||
+        batch->entry_count == PACK_BATCH_ENTRIES) {
+        esp_err_t ret = tile_pack_batch_flush(batch);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+
+    pack_record_t rec = {
+        .magic = PACK_RECORD_MAGIC,
+        .z = (uint8_t)z,
+        .x = (uint32_t)x,
+        .y = (uint32_t)y,
+        .len = (uint32_t)len,
+    };
+    uint8_t *p = batch->buf + batch->shift + batch->fill;
+    memcpy(p, &rec, sizeof(rec));
+
+    // Offset is relative to the buffer until the flush places it
+    batch->entries[batch->entry_count] = (pack_entry_t){
+        .key = make_key(z, x, y),
+        .offset = batch->fill + sizeof(pack_record_t),
+        .len = (uint32_t)len,
+    };
+    batch->reserved = record_size(len);
+    *payload = p + sizeof(rec);
+    return ESP_OK;
+}
+
+esp_err_t tile_pack_batch_commit(tile_pack_batch_t *batch)
+{
+    if (batch == NULL || batch->reserved == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    batch->fill += batch->reserved;
+    batch->entry_count++;
+    batch->reserved = 0;
+    return ESP_OK;
+}
+
+esp_err_t tile_pack_batch_flush(tile_pack_batch_t *batch)
+{
+    if (batch == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    batch->reserved = 0;
+    if (batch->fill == 0) {
+        return ESP_OK;
+    }
+
+    tile_pack_t *pack = batch->pack;
+    xSemaphoreTake(pack->lock, portMAX_DELAY);
+
+    esp_err_t ret = ESP_OK;
+    uint32_t start = pack->data_end;
+    if (pack->data == NULL || pack->index == NULL) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else if ((uint64_t)start + batch->fill > UINT32_MAX) {
+        ESP_LOGW(TAG, "Archive full");
+        ret = ESP_ERR_NO_MEM;
+    }
+
+    if (ret == ESP_OK) {
+        // FATFS writes whole sectors directly from the caller's buffer, which
+        // the SD DMA needs word aligned: match the buffer to the file offset
+        uint32_t shift = start % PACK_BATCH_ALIGN;
+        if (shift != batch->shift) {
+            memmove(batch->buf + shift, batch->buf + batch->shift, batch->fill);
+            batch->shift = shift;
+        }
+
+        if (fseek(pack->data, start, SEEK_SET) != 0 ||
+            fwrite(batch->buf + shift, 1, batch->fill, pack->data) != batch->fill ||
+            fflush(pack->data) != 0) {
+            ESP_LOGE(TAG, "Batch write failed at offset %lu", (unsigned long)start);
+            ftruncate(fileno(pack->data), start);
+            ret = ESP_FAIL;
+        }
+    }
+
+    if (ret == ESP_OK) {
+        fsync(fileno(pack->data));
+
+        uint32_t now = clock_now();
+        uint32_t indexed = 0;
+        for (; indexed < batch->entry_count; indexed++) {
+            pack_entry_t *entry = &batch->entries[indexed];
+            entry->offset += start;
+            entry->stamp = now;
+            entry->written = pack->next_written++;
+            if (index_insert(pack, entry) != ESP_OK) {
+                ret = ESP_ERR_NO_MEM;
+                break;
+            }
+        }
+
+        // One journal write for the whole batch; the data file tail scan
+        // recovers the records if it does not make it to the card
+        if (indexed > 0 &&
+            fwrite(batch->entries, sizeof(pack_entry_t), indexed, pack->index) != indexed) {
+            ESP_LOGW(TAG, "Failed to journal %lu tiles", (unsigned long)indexed);
+        }
+        journal_sync(pack);
+    }
+
+    xSemaphoreGive(pack->lock);
+
+    batch->fill = 0;
+    batch->entry_count = 0;
+    return ret;
+}
+
+esp_err_t tile_pack_batch_end(tile_pack_batch_t *batch)
+{
+    if (batch == NULL) {
+        return ESP_OK;
+    }
+
+    esp_err_t ret = tile_pack_batch_flush(batch);
+    free(batch->buf);
+    free(batch->entries);
+    free(batch);
+    return ret;
+}
+
+bool tile_pack_parse_record(const uint8_t *header, int *z, int *x, int *y, size_t *len)
+{
+    pack_record_t rec;
+    memcpy(&rec, header, sizeof(rec));
+
+    if (rec.magic != PACK_RECORD_MAGIC || rec.len == 0 || rec.len > PACK_MAX_TILE_SIZE ||
+        rec.x > INT32_MAX || rec.y > INT32_MAX ||
+        !coords_valid(rec.z, (int)rec.x, (int)rec.y)) {
+        return false;
+    }
+
+    *z = rec.z;
+    *x = (int)rec.x;
+    *y = (int)rec.y;
+    *len = rec.len;
+    return true;
+}
+
+#endif // CONFIG_GEOGRAM_BOARD_EPAPER_1IN54
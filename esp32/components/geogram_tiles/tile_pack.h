@@ -0,0 +1,291 @@
+/**
+ * @file tile_pack.h
+ * @brief Append-only packed tile archive
+ *
+ * Stores all tiles of one layer in a single data file on the SD card
+ * instead of one file per tile:
+ * - {name}.pack holds self-describing records (header + tile bytes)
+ * - {name}.idx is a snapshot of (z,x,y) -> (offset,len,last access)
+ *   followed by an append-only journal of additions and removals
+ * - The index is loaded into a hash table in PSRAM at open time
+ *
+ * A lookup is a hash probe in RAM followed by one seek and one read.
+ * Records appended after the last journal entry (e.g. power loss between
+ * the two writes) are recovered by scanning the data file tail on open,
+ * so boot never needs a full scan of the data file.
+ *
+ * Last-access times are kept in RAM as minute stamps of a clock shared
+ * by all archives and persisted by tile_pack_snapshot(). Evicted tiles
+ * stay in the data file as dead space until tile_pack_compact().
+ */
+
+#ifndef GEOGRAM_TILE_PACK_H
+#define GEOGRAM_TILE_PACK_H
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Opaque packed archive handle
+ */
+typedef struct tile_pack tile_pack_t;
+
+/**
+ * @brief Opaque bulk writer handle (see tile_pack_batch_begin())
+ */
+typedef struct tile_pack_batch tile_pack_batch_t;
+
+// Size of the record header preceding each tile in the data file
+#define TILE_PACK_RECORD_SIZE   20
+
+/**
+ * @brief Open (or create) a packed archive
+ *
+ * Loads the index journal and recovers any unindexed records at the
+ * end of the data file.
+ *
+ * @param data_path Path to the data file (e.g. /sdcard/tiles/standard.pack)
+ * @param index_path Path to the index journal (e.g. /sdcard/tiles/standard.idx)
+ * @param out_pack Receives the archive handle
+ * @return ESP_OK on success
+ */
+esp_err_t tile_pack_open(const char *data_path, const char *index_path, tile_pack_t **out_pack);
+
+/**
+ * @brief Close archive and free its index
+ *
+ * @param pack Archive handle (may be NULL)
+ */
+void tile_pack_close(tile_pack_t *pack);
+
+/**
+ * @brief Check whether a tile is stored in the archive
+ *
+ * @return true if the tile is indexed
+ */
+bool tile_pack_contains(tile_pack_t *pack, int z, int x, int y);
+
+/**
+ * @brief Get size and version of a stored tile without reading it
+ *
+ * The version is a write stamp of the stored copy: it changes whenever the
+ * tile is rewritten or the archive cleared, never repeats for the same
+ * tile, and survives compaction, so it can serve as an HTTP validator.
+ *
+ * @param pack Archive handle
+ * @param z Zoom level
+ * @param x X tile coordinate
+ * @param y Y tile coordinate
+ * @param tile_size Tile size (may be NULL)
+ * @param version Stored copy identifier (may be NULL)
+ * @return ESP_OK if stored, ESP_ERR_NOT_FOUND otherwise
+ */
+esp_err_t tile_pack_stat(tile_pack_t *pack, int z, int x, int y,
+                         size_t *tile_size, uint64_t *version);
+
+/**
+ * @brief Read a tile from the archive
+ *
+ * @param pack Archive handle
+ * @param z Zoom level
+ * @param x X tile coordinate
+ * @param y Y tile coordinate
+ * @param buffer Buffer to store tile data
+ * @param buffer_size Size of buffer
+ * @param tile_size Actual tile size returned
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if not stored,
+ *         ESP_ERR_INVALID_SIZE if the buffer is too small
+ */
+esp_err_t tile_pack_read(tile_pack_t *pack, int z, int x, int y,
+                         uint8_t *buffer, size_t buffer_size, size_t *tile_size);
+
+/**
+ * @brief Read part of a tile
+ *
+ * Lets callers stream a tile through a small buffer. Each call looks the
+ * tile up again, so parts stay consistent across compaction; the access
+ * time is updated on the part at offset 0.
+ *
+ * @param pack Archive handle
+ * @param z Zoom level
+ * @param x X tile coordinate
+ * @param y Y tile coordinate
+ * @param offset Byte offset within the tile
+ * @param buffer Buffer to store data
+ * @param buffer_size Maximum bytes to read
+ * @param bytes_read Bytes stored in buffer (0 at end of tile)
+ * @param tile_size Total tile size
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if not stored
+ */
+esp_err_t tile_pack_read_part(tile_pack_t *pack, int z, int x, int y, size_t offset,
+                              uint8_t *buffer, size_t buffer_size,
+                              size_t *bytes_read, size_t *tile_size);
+
+/**
+ * @brief Append a tile to the archive
+ *
+ * Writing the same tile again supersedes the previous copy.
+ *
+ * @param pack Archive handle
+ * @param z Zoom level
+ * @param x X tile coordinate
+ * @param y Y tile coordinate
+ * @param data Tile data
+ * @param len Tile size in bytes
+ * @return ESP_OK on success
+ */
+esp_err_t tile_pack_append(tile_pack_t *pack, int z, int x, int y,
+                           const uint8_t *data, size_t len);
+
+/**
+ * @brief Start a bulk write
+ *
+ * Records are collected in a write-behind buffer and written to the
+ * card in one large write per buffer, followed by one journal write for
+ * all of their index entries. Meant for imports of many tiles; regular
+ * tile_pack_append() calls may run concurrently.
+ *
+ * @param pack Archive handle
+ * @param out_batch Receives the batch handle
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the buffer cannot be allocated
+ */
+esp_err_t tile_pack_batch_begin(tile_pack_t *pack, tile_pack_batch_t **out_batch);
+
+/**
+ * @brief Reserve buffer space for a tile
+ *
+ * The caller copies exactly `len` bytes of tile data to *payload (in as
+ * many pieces as it likes) and then calls tile_pack_batch_commit(). A
+ * reservation that is not committed is dropped by the next reserve,
+ * flush or end. May flush the buffer to make room.
+ *
+ * @param batch Batch handle
+ * @param z Zoom level
+ * @param x X tile coordinate
+ * @param y Y tile coordinate
+ * @param len Tile size in bytes
+ * @param payload Receives where to store the tile data
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for invalid coordinates,
+ *         ESP_ERR_INVALID_SIZE if the tile is larger than the buffer
+ *         (use tile_pack_append()), or the flush error
+ */
+esp_err_t tile_pack_batch_reserve(tile_pack_batch_t *batch, int z, int x, int y,
+                                  size_t len, uint8_t **payload);
+
+/**
+ * @brief Commit the tile filled in after tile_pack_batch_reserve()
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE without a reservation
+ */
+esp_err_t tile_pack_batch_commit(tile_pack_batch_t *batch);
+
+/**
+ * @brief Write committed tiles to the card and index them
+ *
+ * @return ESP_OK on success
+ */
+esp_err_t tile_pack_batch_flush(tile_pack_batch_t *batch);
+
+/**
+ * @brief Flush committed tiles and free the batch
+ *
+ * @param batch Batch handle (may be NULL)
+ * @return Result of the final flush
+ */
+esp_err_t tile_pack_batch_end(tile_pack_batch_t *batch);
+
+/**
+ * @brief Decode a record header of the data file format
+ *
+ * Lets other stations' .pack files be imported as a stream.
+ *
+ * @param header TILE_PACK_RECORD_SIZE bytes
+ * @param z Zoom level
+ * @param x X tile coordinate
+ * @param y Y tile coordinate
+ * @param len Size of the tile data following the header
+ * @return true if the header is a valid record
+ */
+bool tile_pack_parse_record(const uint8_t *header, int *z, int *x, int *y, size_t *len);
+
+/**
+ * @brief Number of tiles indexed in the archive
+ */
+uint32_t tile_pack_count(tile_pack_t *pack);
+
+/**
+ * @brief Total payload bytes of indexed tiles
+ */
+uint64_t tile_pack_bytes(tile_pack_t *pack);
+
+/**
+ * @brief Size of the data file, including dead space left by eviction
+ */
+uint32_t tile_pack_disk_bytes(tile_pack_t *pack);
+
+/**
+ * @brief Get the oldest and newest access stamps in the archive
+ *
+ * @return false if the archive is empty
+ */
+bool tile_pack_stamp_range(tile_pack_t *pack, uint32_t *oldest, uint32_t *newest);
+
+/**
+ * @brief Add on-card bytes per access-age bucket
+ *
+ * Splits [oldest, newest] into nbins equal buckets and adds the record
+ * size of every tile to its bucket. Bins are not cleared, so histograms
+ * of several archives can be accumulated.
+ */
+void tile_pack_age_histogram(tile_pack_t *pack, uint32_t oldest, uint32_t newest,
+                             uint64_t *bins, int nbins);
+
+/**
+ * @brief Remove cold tiles from the index
+ *
+ * Removes every tile last accessed before `below`, then tiles accessed
+ * before `upto` until `extra_bytes` (decremented in place) reaches zero.
+ * Space is reclaimed by tile_pack_compact().
+ *
+ * @return Number of tiles removed
+ */
+uint32_t tile_pack_evict(tile_pack_t *pack, uint32_t below, uint32_t upto, uint64_t *extra_bytes);
+
+/**
+ * @brief Card space tile_pack_compact() needs for its copy
+ *
+ * @return Bytes of the live records plus their index, or 0 when there is
+ *         no dead space to compact
+ */
+uint64_t tile_pack_compact_bytes(tile_pack_t *pack);
+
+/**
+ * @brief Rewrite the data file without dead space
+ *
+ * Crash safe: an interrupted compaction is rolled back or completed on
+ * the next open. Needs free card space for a copy of the live tiles
+ * (see tile_pack_compact_bytes()).
+ */
+esp_err_t tile_pack_compact(tile_pack_t *pack);
+
+/**
+ * @brief Persist access stamps by rewriting the index if it changed
+ */
+esp_err_t tile_pack_snapshot(tile_pack_t *pack);
+
+/**
+ * @brief Delete all tiles and start an empty archive
+ */
+esp_err_t tile_pack_clear(tile_pack_t *pack);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_TILE_PACK_H
@@ -0,0 +1,155 @@
+/**
+ * @file tile_peer.c
+ * @brief Tile lookup on the parent mesh node
+ */
+
+#include "sdkconfig.h"
+
+#if CONFIG_GEOGRAM_BOARD_EPAPER_1IN54 && CONFIG_GEOGRAM_TILES_MESH_PEERS
+
+#include <stdio.h>
+#include <string.h>
+#include "tile_peer.h"
+#include "mesh_bsp.h"
+#include "http_client_async.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "tile_peer";
+
+// Poll interval while the parent answers 503 (its own download is pending)
+#define PEER_RETRY_MS       500
+
+// Shortest request worth making before the deadline
+#define PEER_MIN_REQUEST_MS 200
+
+// Recently missed tiles remembered (ring buffer)
+#define PEER_NEG_ENTRIES    64
+
+#define PEER_NEG_TTL_US     ((int64_t)CONFIG_GEOGRAM_TILES_PEER_NEG_TTL_S * 1000000LL)
+
+typedef struct {
+    uint32_t hash;
+    int64_t expires;
+} peer_neg_entry_t;
+
+static peer_neg_entry_t s_neg[PEER_NEG_ENTRIES];
+static int s_neg_next = 0;
+static portMUX_TYPE s_neg_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t tile_hash(int z, int x, int y, const char *layer)
+{
+    // FNV-1a over coordinates and layer; collisions only cost a skipped peer lookup
+    uint32_t h = 2166136261u;
+    int v[3] = { z, x, y };
+    const uint8_t *p = (const uint8_t *)v;
+    for (size_t i = 0; i < sizeof(v); i++) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    while (*layer) {
+        h = (h ^ (uint8_t)*layer++) * 16777619u;
+    }
+    return h != 0 ? h : 1;
+}
+
+static bool neg_contains(uint32_t hash)
+{
+    int64_t now = esp_timer_get_time();
+    bool found = false;
+
+    taskENTER_CRITICAL(&s_neg_lock);
+    for (int i = 0; i < PEER_NEG_ENTRIES; i++) {
+        if (s_neg[i].hash == hash && s_neg[i].expires > now) {
+            found = true;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&s_neg_lock);
+    return found;
+}
+
+static void neg_add(uint32_t hash)
+{
+    taskENTER_CRITICAL(&s_neg_lock);
+    s_neg[s_neg_next].hash = hash;
+    s_neg[s_neg_next].expires = esp_timer_get_time() + PEER_NEG_TTL_US;
+    s_neg_next = (s_neg_next + 1) % PEER_NEG_ENTRIES;
+    taskEXIT_CRITICAL(&s_neg_lock);
+}
+
+bool tile_peer_available(void)
+{
+    uint32_t ip;
+    return geogram_mesh_has_parent() && geogram_mesh_get_parent_ip(&ip) == ESP_OK;
+}
+
+esp_err_t tile_peer_get(int z, int x, int y, const char *layer,
+                        uint8_t *buffer, size_t buffer_size, size_t *tile_size)
+{
+    uint32_t ip;
+    if (geogram_mesh_get_parent_ip(&ip) != ESP_OK) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint32_t hash = tile_hash(z, x, y, layer);
+    if (neg_contains(hash)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const uint8_t *a = (const uint8_t *)&ip;
+    char url[128];
+    snprintf(url, sizeof(url), "http://%u.%u.%u.%u/tiles/%d/%d/%d.png?layer=%s&" TILE_PEER_QUERY "=1",
+             a[0], a[1], a[2], a[3], z, x, y, layer);
+
+    http_client_request_t request = http_client_default_config();
+    request.url = url;
+    request.user_agent = "Geogram-ESP32/1.0";
+
+    // The whole lookup, retries included, fits in one request timeout so
+    // a miss never holds a fetch worker much longer than that
+    int64_t deadline = esp_timer_get_time() + (int64_t)CONFIG_GEOGRAM_TILES_PEER_TIMEOUT_MS * 1000;
+    while (true) {
+        request.timeout_ms = (int)((deadline - esp_timer_get_time()) / 1000);
+
+        http_client_response_t response = {
+            .data = buffer,
+            .buffer_size = buffer_size,
+            .data_len = 0,
+            .status_code = 0,
+        };
+
+        esp_err_t ret = http_client_get_async(&request, &response);
+        if (ret != ESP_OK) {
+            // Parent unreachable; don't stall further misses on it
+            ESP_LOGW(TAG, "Parent tile request failed: %s", esp_err_to_name(ret));
+            neg_add(hash);
+            return ret;
+        }
+
+        if (response.status_code == 200 && response.data_len > 0) {
+            *tile_size = response.data_len;
+            ESP_LOGI(TAG, "Tile z=%d x=%d y=%d from parent (%zu bytes)", z, x, y, *tile_size);
+            return ESP_OK;
+        }
+        if (response.status_code != 503) {
+            break;
+        }
+
+        // Parent is downloading it for us; poll while the deadline allows.
+        // Past it the caller goes upstream; the parent is asked again next time.
+        if ((deadline - esp_timer_get_time()) / 1000 < PEER_RETRY_MS + PEER_MIN_REQUEST_MS) {
+            ESP_LOGD(TAG, "Parent still fetching z=%d x=%d y=%d", z, x, y);
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(pdMS_TO_TICKS(PEER_RETRY_MS));
+    }
+
+    ESP_LOGD(TAG, "Parent has no tile z=%d x=%d y=%d", z, x, y);
+    neg_add(hash);
+    return ESP_ERR_NOT_FOUND;
+}
+
+#endif // CONFIG_GEOGRAM_BOARD_EPAPER_1IN54 && CONFIG_GEOGRAM_TILES_MESH_PEERS
@@ -0,0 +1,59 @@
+/**
+ * @file tile_peer.h
+ * @brief Tile lookup on the parent mesh node
+ *
+ * Leaf nodes reach the internet through the mesh root, so every miss
+ * used to cost an uplink download even when a node closer in the tree
+ * had the tile. With mesh peers enabled, a miss first asks the parent
+ * node's tile server; the parent serves from its cache or downloads the
+ * tile once (asking its own parent first) for all of its children.
+ * Tiles the parent could not provide are remembered for a while so they
+ * go upstream directly.
+ */
+
+#ifndef GEOGRAM_TILE_PEER_H
+#define GEOGRAM_TILE_PEER_H
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Query parameter marking a request from a child node
+#define TILE_PEER_QUERY     "peer"
+
+/**
+ * @brief Check whether a parent node can be asked for tiles
+ */
+bool tile_peer_available(void);
+
+/**
+ * @brief Fetch a tile from the parent mesh node
+ *
+ * Polls while the parent reports the tile as pending (503), within
+ * CONFIG_GEOGRAM_TILES_PEER_TIMEOUT_MS for the whole lookup, and records
+ * a negative entry when the parent cannot provide it.
+ *
+ * @param z Zoom level
+ * @param x X tile coordinate
+ * @param y Y tile coordinate
+ * @param layer Layer name ("standard" or "satellite")
+ * @param buffer Buffer to store tile data
+ * @param buffer_size Size of buffer
+ * @param tile_size Actual tile size returned
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if the parent does not
+ *         have the tile (or recently did not), ESP_ERR_TIMEOUT if it was
+ *         still fetching the tile at the deadline, other errors on failure
+ */
+esp_err_t tile_peer_get(int z, int x, int y, const char *layer,
+                        uint8_t *buffer, size_t buffer_size, size_t *tile_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_TILE_PEER_H
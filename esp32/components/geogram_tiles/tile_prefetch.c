@@ -0,0 +1,423 @@
+/**
+ * @file tile_prefetch.c
+ * @brief Region prefetch job for the tile cache
+ *
+ * Walks the tile pyramid of a bounding box zoom level by zoom level,
+ * skips tiles already cached and downloads the rest through the fetch
+ * queue at a limited rate. The cursor is saved to the SD card so an
+ * interrupted job resumes after reboot.
+ */
+
+#include "sdkconfig.h"
+
+#if CONFIG_GEOGRAM_BOARD_EPAPER_1IN54
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include "tiles.h"
+#include "sdcard.h"
+#include "esp_log.h"
+#include "cJSON.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "tile_prefetch";
+
+#define PREFETCH_STATE_PATH     "/sdcard/tiles/prefetch.json"
+#define PREFETCH_STATE_SIZE     512
+
+// Save the cursor every N tiles visited
+#define PREFETCH_SAVE_INTERVAL  32
+
+// Per-tile wait for a queued download
+#define PREFETCH_FETCH_WAIT_MS  30000
+
+// Back-off when the fetch queue is busy with interactive requests
+#define PREFETCH_BUSY_DELAY_MS  1000
+
+#define PREFETCH_TASK_STACK     4096
+#define PREFETCH_TASK_PRIORITY  2
+
+// Web Mercator latitude limit
+#define MAX_LATITUDE            85.0511287798
+
+#ifndef CONFIG_GEOGRAM_TILES_PREFETCH_RATE
+#define CONFIG_GEOGRAM_TILES_PREFETCH_RATE 2
+#endif
+
+#ifndef CONFIG_GEOGRAM_TILES_PREFETCH_MAX_TILES
+#define CONFIG_GEOGRAM_TILES_PREFETCH_MAX_TILES 100000
+#endif
+
+static tile_bbox_t s_bbox;
+static tile_prefetch_status_t s_status = {0};
+static SemaphoreHandle_t s_mutex = NULL;
+static TaskHandle_t s_task = NULL;
+static volatile bool s_cancel = false;
+
+static int lon_to_tile_x(double lon, int z)
+{
+    int n = 1 << z;
+    int x = (int)floor((lon + 180.0) / 360.0 * n);
+    return x < 0 ? 0 : (x >= n ? n - 1 : x);
+}
+
+static int lat_to_tile_y(double lat, int z)
+{
+    int n = 1 << z;
+    if (lat > MAX_LATITUDE) {
+        lat = MAX_LATITUDE;
+    } else if (lat < -MAX_LATITUDE) {
+        lat = -MAX_LATITUDE;
+    }
+    double rad = lat * M_PI / 180.0;
+    int y = (int)floor((1.0 - log(tan(rad) + 1.0 / cos(rad)) / M_PI) / 2.0 * n);
+    return y < 0 ? 0 : (y >= n ? n - 1 : y);
+}
+
+/**
+ * @brief Tile range covered by the bbox at zoom z (y grows southwards)
+ */
+static void bbox_range(const tile_bbox_t *bbox, int z, int *x0, int *x1, int *y0, int *y1)
+{
+    *x0 = lon_to_tile_x(bbox->min_lon, z);
+    *x1 = lon_to_tile_x(bbox->max_lon, z);
+    *y0 = lat_to_tile_y(bbox->max_lat, z);
+    *y1 = lat_to_tile_y(bbox->min_lat, z);
+}
+
+/**
+ * @brief Tiles in the bbox across zoom levels (up to 4^19 / 3, past uint32)
+ */
+static uint64_t count_tiles(const tile_bbox_t *bbox, int zmin, int zmax)
+{
+    uint64_t total = 0;
+    for (int z = zmin; z <= zmax; z++) {
+        int x0, x1, y0, y1;
+        bbox_range(bbox, z, &x0, &x1, &y0, &y1);
+        total += (uint64_t)(x1 - x0 + 1) * (uint64_t)(y1 - y0 + 1);
+    }
+    return total;
+}
+
+static void save_state(void)
+{
+    cJSON *root = cJSON_CreateObject();
+    if (root == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    cJSON_AddNumberToObject(root, "min_lat", s_bbox.min_lat);
+    cJSON_AddNumberToObject(root, "min_lon", s_bbox.min_lon);
+    cJSON_AddNumberToObject(root, "max_lat", s_bbox.max_lat);
+    cJSON_AddNumberToObject(root, "max_lon", s_bbox.max_lon);
+    cJSON_AddNumberToObject(root, "zmin", s_status.zmin);
+    cJSON_AddNumberToObject(root, "zmax", s_status.zmax);
+    cJSON_AddStringToObject(root, "layer", s_status.layer == TILE_LAYER_SATELLITE ? "satellite" : "standard");
+    cJSON_AddNumberToObject(root, "z", s_status.z);
+    cJSON_AddNumberToObject(root, "x", s_status.x);
+    cJSON_AddNumberToObject(root, "y", s_status.y);
+    cJSON_AddNumberToObject(root, "done", s_status.done);
+    cJSON_AddNumberToObject(root, "fetched", s_status.fetched);
+    cJSON_AddNumberToObject(root, "skipped", s_status.skipped);
+    cJSON_AddNumberToObject(root, "failed", s_status.failed);
+    xSemaphoreGive(s_mutex);
+
+    char *json_str = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    if (json_str == NULL) {
+        return;
+    }
+
+    if (sdcard_write_file(PREFETCH_STATE_PATH, json_str, strlen(json_str)) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to save prefetch cursor");
+    }
+    free(json_str);
+}
+
+static int json_int(const cJSON *root, const char *key)
+{
+    const cJSON *item = cJSON_GetObjectItem(root, key);
+    return cJSON_IsNumber(item) ? item->valueint : 0;
+}
+
+static double json_double(const cJSON *root, const char *key)
+{
+    const cJSON *item = cJSON_GetObjectItem(root, key);
+    return cJSON_IsNumber(item) ? item->valuedouble : 0.0;
+}
+
+/**
+ * @brief Load a saved cursor into s_bbox / s_status
+ */
+static esp_err_t load_state(void)
+{
+    if (!sdcard_file_exists(PREFETCH_STATE_PATH)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    char buffer[PREFETCH_STATE_SIZE];
+    size_t len = 0;
+    esp_err_t ret = sdcard_read_file(PREFETCH_STATE_PATH, buffer, sizeof(buffer) - 1, &len);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    buffer[len] = '\0';
+
+    cJSON *root = cJSON_Parse(buffer);
+    if (root == NULL) {
+        ESP_LOGW(TAG, "Corrupt prefetch cursor - discarding");
+        unlink(PREFETCH_STATE_PATH);
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    s_bbox.min_lat = json_double(root, "min_lat");
+    s_bbox.min_lon = json_double(root, "min_lon");
+    s_bbox.max_lat = json_double(root, "max_lat");
+    s_bbox.max_lon = json_double(root, "max_lon");
+
+    memset(&s_status, 0, sizeof(s_status));
+    s_status.zmin = json_int(root, "zmin");
+    s_status.zmax = json_int(root, "zmax");
+    const cJSON *layer = cJSON_GetObjectItem(root, "layer");
+    s_status.layer = (cJSON_IsString(layer) && strcmp(layer->valuestring, "satellite") == 0)
+                     ? TILE_LAYER_SATELLITE : TILE_LAYER_STANDARD;
+    s_status.z = json_int(root, "z");
+    s_status.x = json_int(root, "x");
+    s_status.y = json_int(root, "y");
+    s_status.done = (uint32_t)json_int(root, "done");
+    s_status.fetched = (uint32_t)json_int(root, "fetched");
+    s_status.skipped = (uint32_t)json_int(root, "skipped");
+    s_status.failed = (uint32_t)json_int(root, "failed");
+    cJSON_Delete(root);
+
+    if (s_status.zmin < 0 || s_status.zmax > 18 || s_status.zmin > s_status.zmax ||
+        s_status.z < s_status.zmin || s_status.z > s_status.zmax) {
+        unlink(PREFETCH_STATE_PATH);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Saved by a firmware without the size cap, or before it was lowered
+    uint64_t total = count_tiles(&s_bbox, s_status.zmin, s_status.zmax);
+    if (total > CONFIG_GEOGRAM_TILES_PREFETCH_MAX_TILES) {
+        ESP_LOGW(TAG, "Saved prefetch of %llu tiles exceeds the limit - discarding",
+                 (unsigned long long)total);
+        unlink(PREFETCH_STATE_PATH);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    s_status.total = (uint32_t)total;
+    return ESP_OK;
+}
+
+/**
+ * @brief Fetch one tile, retrying while the fetch queue is full
+ */
+static esp_err_t prefetch_one(int z, int x, int y, tile_layer_t layer)
+{
+    while (!s_cancel) {
+        esp_err_t ret = tiles_fetch(z, x, y, layer, PREFETCH_FETCH_WAIT_MS);
+        if (ret != ESP_ERR_NO_MEM) {
+            return ret;
+        }
+        vTaskDelay(pdMS_TO_TICKS(PREFETCH_BUSY_DELAY_MS));
+    }
+    return ESP_ERR_INVALID_STATE;
+}
+
+static void prefetch_task(void *arg)
+{
+    const TickType_t interval = pdMS_TO_TICKS(1000 / CONFIG_GEOGRAM_TILES_PREFETCH_RATE);
+    TickType_t last_fetch = 0;
+    uint32_t since_save = 0;
+
+    tile_layer_t layer = s_status.layer;
+    int start_z = s_status.z;
+    int start_x = s_status.x;
+    int start_y = s_status.y;
+    bool resuming = true;
+    // A saved cursor points at the last tile already processed
+    bool skip_cursor = s_status.done > 0;
+
+    ESP_LOGI(TAG, "Prefetch z%d-%d %s: %lu tiles (resuming at %d/%d/%d)",
+             s_status.zmin, s_status.zmax,
+             layer == TILE_LAYER_SATELLITE ? "satellite" : "standard",
+             (unsigned long)s_status.total, start_z, start_x, start_y);
+
+    for (int z = start_z; z <= s_status.zmax && !s_cancel; z++) {
+        int x0, x1, y0, y1;
+        bbox_range(&s_bbox, z, &x0, &x1, &y0, &y1);
+
+        for (int x = x0; x <= x1 && !s_cancel; x++) {
+            if (resuming && x < start_x) {
+                continue;
+            }
+            for (int y = y0; y <= y1 && !s_cancel; y++) {
+                if (resuming) {
+                    if (x == start_x && (y < start_y || (y == start_y && skip_cursor))) {
+                        continue;
+                    }
+                    resuming = false;
+                }
+
+                xSemaphoreTake(s_mutex, portMAX_DELAY);
+                s_status.z = z;
+                s_status.x = x;
+                s_status.y = y;
+                xSemaphoreGive(s_mutex);
+
+                if (tiles_contains(z, x, y, layer)) {
+                    xSemaphoreTake(s_mutex, portMAX_DELAY);
+                    s_status.skipped++;
+                    s_status.done++;
+                    xSemaphoreGive(s_mutex);
+                } else {
+                    // Rate limit upstream requests
+                    TickType_t now = xTaskGetTickCount();
+                    if (last_fetch != 0 && now - last_fetch < interval) {
+                        vTaskDelay(interval - (now - last_fetch));
+                    }
+                    last_fetch = xTaskGetTickCount();
+
+                    esp_err_t ret = prefetch_one(z, x, y, layer);
+                    if (s_cancel) {
+                        break;
+                    }
+
+                    xSemaphoreTake(s_mutex, portMAX_DELAY);
+                    if (ret == ESP_OK) {
+                        s_status.fetched++;
+                    } else {
+                        s_status.failed++;
+                    }
+                    s_status.done++;
+                    xSemaphoreGive(s_mutex);
+                }
+
+                // Cached tiles count too, so a long cached stretch is not rescanned after a reboot
+                if (++since_save >= PREFETCH_SAVE_INTERVAL) {
+                    since_save = 0;
+                    save_state();
+                }
+            }
+        }
+        // Next zoom level starts from the beginning of its range
+        resuming = false;
+    }
+
+    if (s_cancel) {
+        ESP_LOGI(TAG, "Prefetch cancelled");
+    } else {
+        ESP_LOGI(TAG, "Prefetch complete: %lu fetched, %lu already cached, %lu failed",
+                 (unsigned long)s_status.fetched, (unsigned long)s_status.skipped,
+                 (unsigned long)s_status.failed);
+    }
+    unlink(PREFETCH_STATE_PATH);
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_status.running = false;
+    s_task = NULL;
+    xSemaphoreGive(s_mutex);
+
+    vTaskDelete(NULL);
+}
+
+static esp_err_t start_task(void)
+{
+    s_cancel = false;
+    s_status.running = true;
+    if (xTaskCreate(prefetch_task, "tile_prefetch", PREFETCH_TASK_STACK, NULL,
+                    PREFETCH_TASK_PRIORITY, &s_task) != pdPASS) {
+        s_status.running = false;
+        ESP_LOGE(TAG, "Failed to create prefetch task");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t tiles_prefetch_init(void)
+{
+    if (s_mutex == NULL) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (s_mutex == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    if (load_state() != ESP_OK) {
+        return ESP_OK;
+    }
+
+    ESP_LOGI(TAG, "Resuming interrupted prefetch");
+    return start_task();
+}
+
+esp_err_t tiles_prefetch(const tile_bbox_t *bbox, int zmin, int zmax, tile_layer_t layer)
+{
+    if (bbox == NULL || zmin < 0 || zmax > 18 || zmin > zmax ||
+        bbox->min_lat > bbox->max_lat || bbox->min_lon > bbox->max_lon ||
+        bbox->min_lat < -90.0 || bbox->max_lat > 90.0 ||
+        bbox->min_lon < -180.0 || bbox->max_lon > 180.0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint64_t total = count_tiles(bbox, zmin, zmax);
+    if (total > CONFIG_GEOGRAM_TILES_PREFETCH_MAX_TILES) {
+        ESP_LOGW(TAG, "Prefetch of %llu tiles refused (limit %d)",
+                 (unsigned long long)total, CONFIG_GEOGRAM_TILES_PREFETCH_MAX_TILES);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    if (!tiles_is_available() || s_mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (s_status.running) {
+        xSemaphoreGive(s_mutex);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_bbox = *bbox;
+    memset(&s_status, 0, sizeof(s_status));
+    s_status.layer = (layer == TILE_LAYER_SATELLITE) ? TILE_LAYER_SATELLITE : TILE_LAYER_STANDARD;
+    s_status.zmin = zmin;
+    s_status.zmax = zmax;
+    s_status.z = zmin;
+    s_status.total = (uint32_t)total;
+    xSemaphoreGive(s_mutex);
+
+    save_state();
+    return start_task();
+}
+
+esp_err_t tiles_prefetch_cancel(void)
+{
+    if (s_mutex == NULL || !s_status.running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_cancel = true;
+    return ESP_OK;
+}
+
+esp_err_t tiles_prefetch_get_status(tile_prefetch_status_t *status)
+{
+    if (status == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_mutex == NULL) {
+        memset(status, 0, sizeof(*status));
+        return ESP_OK;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    memcpy(status, &s_status, sizeof(*status));
+    xSemaphoreGive(s_mutex);
+    return ESP_OK;
+}
+
+#endif // CONFIG_GEOGRAM_BOARD_EPAPER_1IN54
@@ -0,0 +1,250 @@
+/**
+ * @file tile_ram_cache.c
+ * @brief LRU cache of hot tiles in PSRAM
+ */
+
+#include "sdkconfig.h"
+
+#if CONFIG_GEOGRAM_BOARD_EPAPER_1IN54
+
+#include <stdlib.h>
+#include <string.h>
+#include "tile_ram_cache.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "tile_ram";
+
+// Hash buckets (power of two); a 2 MB budget holds about 100 typical tiles
+#define RAM_CACHE_BUCKETS   256
+
+/**
+ * @brief Cached tile; data follows the header in the same allocation
+ */
+typedef struct ram_entry {
+    uint64_t key;
+    struct ram_entry *hash_next;
+    struct ram_entry *lru_prev;     // Towards most recently used
+    struct ram_entry *lru_next;     // Towards least recently used
+    uint32_t len;
+    uint8_t data[];
+} ram_entry_t;
+
+static ram_entry_t *s_buckets[RAM_CACHE_BUCKETS];
+static ram_entry_t *s_lru_head = NULL;     // Most recently used
+static ram_entry_t *s_lru_tail = NULL;     // Least recently used
+static SemaphoreHandle_t s_mutex = NULL;
+static size_t s_budget = 0;
+static size_t s_used = 0;
+static uint32_t s_count = 0;
+
+static uint64_t make_key(int layer, int z, int x, int y)
+{
+    return ((uint64_t)layer << 61) | ((uint64_t)z << 56) | ((uint64_t)x << 28) | (uint64_t)y;
+}
+
+static uint32_t bucket_of(uint64_t key)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return (uint32_t)key & (RAM_CACHE_BUCKETS - 1);
+}
+
+static size_t entry_cost(uint32_t len)
+{
+    return sizeof(ram_entry_t) + len;
+}
+
+static void lru_unlink(ram_entry_t *e)
+{
+    if (e->lru_prev) {
+        e->lru_prev->lru_next = e->lru_next;
+    } else {
+        s_lru_head = e->lru_next;
+    }
+    if (e->lru_next) {
+        e->lru_next->lru_prev = e->lru_prev;
+    } else {
+        s_lru_tail = e->lru_prev;
+    }
+    e->lru_prev = NULL;
+    e->lru_next = NULL;
+}
+
+static void lru_push_front(ram_entry_t *e)
+{
+    e->lru_prev = NULL;
+    e->lru_next = s_lru_head;
+    if (s_lru_head) {
+        s_lru_head->lru_prev = e;
+    }
+    s_lru_head = e;
+    if (s_lru_tail == NULL) {
+        s_lru_tail = e;
+    }
+}
+
+static ram_entry_t *lookup(uint64_t key)
+{
+    for (ram_entry_t *e = s_buckets[bucket_of(key)]; e != NULL; e = e->hash_next) {
+        if (e->key == key) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static void remove_entry(ram_entry_t *e)
+{
+    ram_entry_t **pp = &s_buckets[bucket_of(e->key)];
+    while (*pp != e) {
+        pp = &(*pp)->hash_next;
+    }
+    *pp = e->hash_next;
+
+    lru_unlink(e);
+    s_used -= entry_cost(e->len);
+    s_count--;
+    free(e);
+}
+
+esp_err_t tile_ram_cache_init(size_t budget_bytes)
+{
+    if (budget_bytes == 0) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    if (s_mutex == NULL) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (s_mutex == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    s_budget = budget_bytes;
+    ESP_LOGI(TAG, "RAM tile cache: %u KB", (unsigned)(budget_bytes / 1024));
+    return ESP_OK;
+}
+
+bool tile_ram_cache_get(int layer, int z, int x, int y,
+                        uint8_t *buffer, size_t buffer_size, size_t *tile_size)
+{
+    if (s_budget == 0) {
+        return false;
+    }
+
+    bool hit = false;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    ram_entry_t *e = lookup(make_key(layer, z, x, y));
+    if (e != NULL && e->len <= buffer_size) {
+        memcpy(buffer, e->data, e->len);
+        *tile_size = e->len;
+        lru_unlink(e);
+        lru_push_front(e);
+        hit = true;
+    }
+
+    xSemaphoreGive(s_mutex);
+    return hit;
+}
+
+bool tile_ram_cache_read_part(int layer, int z, int x, int y, size_t offset,
+                              uint8_t *buffer, size_t buffer_size,
+                              size_t *bytes_read, size_t *tile_size)
+{
+    if (s_budget == 0) {
+        return false;
+    }
+
+    bool hit = false;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    ram_entry_t *e = lookup(make_key(layer, z, x, y));
+    if (e != NULL && offset <= e->len) {
+        size_t n = e->len - offset;
+        if (n > buffer_size) {
+            n = buffer_size;
+        }
+        memcpy(buffer, e->data + offset, n);
+        *bytes_read = n;
+        *tile_size = e->len;
+        if (offset == 0) {
+            lru_unlink(e);
+            lru_push_front(e);
+        }
+        hit = true;
+    }
+
+    xSemaphoreGive(s_mutex);
+    return hit;
+}
+
+bool tile_ram_cache_accepts(size_t len)
+{
+    return s_budget > 0 && len > 0 && entry_cost(len) <= s_budget / 4;
+}
+
+void tile_ram_cache_put(int layer, int z, int x, int y, const uint8_t *data, size_t len)
+{
+    if (data == NULL || !tile_ram_cache_accepts(len)) {
+        return;
+    }
+
+    ram_entry_t *e = heap_caps_malloc(entry_cost(len), MALLOC_CAP_SPIRAM);
+    if (e == NULL) {
+        ESP_LOGD(TAG, "No PSRAM for %u byte tile", (unsigned)len);
+        return;
+    }
+    e->key = make_key(layer, z, x, y);
+    e->len = (uint32_t)len;
+    memcpy(e->data, data, len);
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    ram_entry_t *old = lookup(e->key);
+    if (old != NULL) {
+        remove_entry(old);
+    }
+
+    while (s_lru_tail != NULL && s_used + entry_cost(len) > s_budget) {
+        remove_entry(s_lru_tail);
+    }
+
+    uint32_t b = bucket_of(e->key);
+    e->hash_next = s_buckets[b];
+    s_buckets[b] = e;
+    lru_push_front(e);
+    s_used += entry_cost(len);
+    s_count++;
+
+    xSemaphoreGive(s_mutex);
+}
+
+void tile_ram_cache_clear(void)
+{
+    if (s_mutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    while (s_lru_tail != NULL) {
+        remove_entry(s_lru_tail);
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+void tile_ram_cache_usage(size_t *used_bytes, uint32_t *tile_count)
+{
+    if (used_bytes) {
+        *used_bytes = s_used;
+    }
+    if (tile_count) {
+        *tile_count = s_count;
+    }
+}
+
+#endif // CONFIG_GEOGRAM_BOARD_EPAPER_1IN54
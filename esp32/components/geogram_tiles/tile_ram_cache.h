@@ -0,0 +1,90 @@
+/**
+ * @file tile_ram_cache.h
+ * @brief LRU cache of hot tiles in PSRAM
+ *
+ * Keeps recently served tiles in SPIRAM so repeated requests (many
+ * clients panning over the same area) do not touch the SD card.
+ * Bounded by CONFIG_GEOGRAM_TILES_RAM_CACHE_KB.
+ */
+
+#ifndef GEOGRAM_TILE_RAM_CACHE_H
+#define GEOGRAM_TILE_RAM_CACHE_H
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initialize the RAM cache
+ *
+ * @param budget_bytes Maximum bytes of tile data (and entry overhead) to keep
+ * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if budget is 0
+ */
+esp_err_t tile_ram_cache_init(size_t budget_bytes);
+
+/**
+ * @brief Look up a tile and copy it out
+ *
+ * Marks the tile as most recently used.
+ *
+ * @param layer Layer index
+ * @param z Zoom level
+ * @param x X tile coordinate
+ * @param y Y tile coordinate
+ * @param buffer Buffer to store tile data
+ * @param buffer_size Size of buffer
+ * @param tile_size Actual tile size returned
+ * @return true on hit
+ */
+bool tile_ram_cache_get(int layer, int z, int x, int y,
+                        uint8_t *buffer, size_t buffer_size, size_t *tile_size);
+
+/**
+ * @brief Copy part of a cached tile
+ *
+ * Marks the tile as most recently used when offset is 0.
+ *
+ * @param offset Byte offset within the tile
+ * @param bytes_read Bytes copied to buffer (0 at end of tile)
+ * @param tile_size Total tile size
+ * @return true on hit
+ */
+bool tile_ram_cache_read_part(int layer, int z, int x, int y, size_t offset,
+                              uint8_t *buffer, size_t buffer_size,
+                              size_t *bytes_read, size_t *tile_size);
+
+/**
+ * @brief Check whether a tile of this size would be cached
+ */
+bool tile_ram_cache_accepts(size_t len);
+
+/**
+ * @brief Insert or replace a tile, evicting least recently used tiles
+ *
+ * Tiles larger than a quarter of the budget are not cached.
+ */
+void tile_ram_cache_put(int layer, int z, int x, int y, const uint8_t *data, size_t len);
+
+/**
+ * @brief Drop all cached tiles
+ */
+void tile_ram_cache_clear(void);
+
+/**
+ * @brief Get current usage
+ *
+ * @param used_bytes Bytes in use (may be NULL)
+ * @param tile_count Tiles held (may be NULL)
+ */
+void tile_ram_cache_usage(size_t *used_bytes, uint32_t *tile_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_TILE_RAM_CACHE_H
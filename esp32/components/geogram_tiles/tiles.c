@@ -8,13 +8,28 @@
 #if CONFIG_GEOGRAM_BOARD_EPAPER_1IN54
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include <sys/stat.h>
 #include <dirent.h>
 #include "tiles.h"
+#include "tile_pack.h"
+#include "tile_ram_cache.h"
+#include "tile_fetch.h"
+#include "tile_peer.h"
+#include "tile_import.h"
 #include "sdcard.h"
 #include "esp_log.h"
+#include "esp_heap_caps.h"
 #include "http_client_async.h"
+#include "geogram_http_util.h"
+#include "geogram_http_async.h"
+#include "geogram_http_metrics.h"
+#include "geogram_metrics.h"
+#include "json_utils.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 static const char *TAG = "tiles";
 
@@ -23,6 +38,10 @@ static const char *TAG = "tiles";
 #define TILES_STANDARD_PATH "/sdcard/tiles/standard"
 #define TILES_SATELLITE_PATH "/sdcard/tiles/satellite"
 
+// Packed archive files (one data file + index journal per layer)
+#define TILES_PACK_EXT      ".pack"
+#define TILES_INDEX_EXT     ".idx"
+
 // Tile sources
 #define OSM_TILE_URL_FMT    "https://tile.openstreetmap.org/%d/%d/%d.png"
 #define ESRI_TILE_URL_FMT   "https://server.arcgisonline.com/ArcGIS/rest/services/World_Imagery/MapServer/tile/%d/%d/%d"
@@ -33,10 +52,70 @@ static const char *TAG = "tiles";
 // HTTP timeout
 #define HTTP_TIMEOUT_MS     15000
 
+#define TILE_LAYER_COUNT    2
+
+#ifndef CONFIG_GEOGRAM_TILES_RAM_CACHE_KB
+#define CONFIG_GEOGRAM_TILES_RAM_CACHE_KB 0
+#endif
+
+// How long a synchronous tiles_get() waits for a queued download
+#define FETCH_WAIT_MS       (HTTP_TIMEOUT_MS + 5000)
+
+// Zoom levels searched upwards for a parent-tile fallback
+#define FALLBACK_MAX_LEVELS 4
+
+// Cache miss policy (see Kconfig "Tile cache miss handling")
+#if CONFIG_GEOGRAM_TILES_MISS_WAIT
+#define MISS_WAIT_MS        CONFIG_GEOGRAM_TILES_MISS_WAIT_MS
+#else
+#define MISS_WAIT_MS        0
+#endif
+
+#ifndef CONFIG_GEOGRAM_TILES_QUOTA_MB
+#define CONFIG_GEOGRAM_TILES_QUOTA_MB 0
+#endif
+
+// Card space the archives may use (0 = unlimited)
+#define QUOTA_BYTES         ((uint64_t)CONFIG_GEOGRAM_TILES_QUOTA_MB * 1024 * 1024)
+
+// Eviction frees space down to this share of the quota
+#define QUOTA_LOW_WATER_PCT 90
+
+// Access-age buckets used to pick the eviction threshold
+#define EVICT_BINS          64
+
+// Card space left free when compaction writes its copy
+#define COMPACT_RESERVE_BYTES   (1024 * 1024)
+
+// Cache maintenance task (quota check, index snapshots)
+#define MAINT_TASK_STACK    4096
+#define MAINT_TASK_PRIORITY 1
+#define MAINT_INTERVAL_MS   (60 * 1000)
+#define SNAPSHOT_EVERY      10      // Maintenance rounds between index snapshots
+
+// Receive timeouts tolerated in a row during an archive upload
+#define IMPORT_RECV_RETRIES 3
+
+#define STR_(x)             #x
+#define STR(x)              STR_(x)
+#define RETRY_AFTER_STR     STR(CONFIG_GEOGRAM_TILES_RETRY_AFTER_S)
+
 // Cache statistics
 static tile_cache_stats_t s_stats = {0};
 static bool s_initialized = false;
 
+// Packed archive per layer
+static tile_pack_t *s_packs[TILE_LAYER_COUNT] = {NULL};
+
+// True while a layer still has a legacy {z}/{x}/{y}.png directory tree
+static bool s_legacy[TILE_LAYER_COUNT] = {false};
+
+static TaskHandle_t s_maint_task = NULL;
+
+// Card too full to compact: writes stop waking maintenance until the
+// periodic round manages again
+static bool s_compact_stalled = false;
+
 /**
  * @brief Create directory recursively
  */
@@ -77,22 +156,23 @@ static esp_err_t mkdir_recursive(const char *path)
     return ESP_OK;
 }
 
-/**
- * @brief Build path to cached tile
- */
-static void build_tile_path(char *path, size_t path_size, int z, int x, int y, tile_layer_t layer)
+static const char *layer_path(tile_layer_t layer)
+{
+    return (layer == TILE_LAYER_SATELLITE) ? TILES_SATELLITE_PATH : TILES_STANDARD_PATH;
+}
+
+static bool dir_exists(const char *path)
 {
-    const char *layer_path = (layer == TILE_LAYER_SATELLITE) ? TILES_SATELLITE_PATH : TILES_STANDARD_PATH;
-    snprintf(path, path_size, "%s/%d/%d/%d.png", layer_path, z, x, y);
+    struct stat st;
+    return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
 }
 
 /**
- * @brief Build directory path for tile
+ * @brief Build path to a tile in the legacy per-file layout
  */
-static void build_tile_dir(char *path, size_t path_size, int z, int x, tile_layer_t layer)
+static void build_tile_path(char *path, size_t path_size, int z, int x, int y, tile_layer_t layer)
 {
-    const char *layer_path = (layer == TILE_LAYER_SATELLITE) ? TILES_SATELLITE_PATH : TILES_STANDARD_PATH;
-    snprintf(path, path_size, "%s/%d/%d", layer_path, z, x);
+    snprintf(path, path_size, "%s/%d/%d/%d.png", layer_path(layer), z, x, y);
 }
 
 /**
@@ -110,13 +190,44 @@ static void build_tile_url(char *url, size_t url_size, int z, int x, int y, tile
 }
 
 /**
- * @brief Check if tile exists in cache
+ * @brief Open the packed archive for a layer
+ */
+static esp_err_t open_layer_pack(tile_layer_t layer)
+{
+    char data_path[64];
+    char index_path[64];
+    snprintf(data_path, sizeof(data_path), "%s%s", layer_path(layer), TILES_PACK_EXT);
+    snprintf(index_path, sizeof(index_path), "%s%s", layer_path(layer), TILES_INDEX_EXT);
+
+    esp_err_t ret = tile_pack_open(data_path, index_path, &s_packs[layer]);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open tile archive %s: %s", data_path, esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+/**
+ * @brief Move a single legacy tile file into the archive
+ *
+ * Used on cache misses so stations with an old per-file cache keep
+ * serving those tiles while they migrate.
  */
-static bool tile_exists(int z, int x, int y, tile_layer_t layer)
+static esp_err_t tile_migrate_legacy(int z, int x, int y, tile_layer_t layer,
+                                     uint8_t *buffer, size_t buffer_size, size_t *tile_size)
 {
     char path[256];
     build_tile_path(path, sizeof(path), z, x, y, layer);
-    return sdcard_file_exists(path);
+
+    if (!sdcard_file_exists(path) ||
+        sdcard_read_file(path, buffer, buffer_size, tile_size) != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    if (tile_pack_append(s_packs[layer], z, x, y, buffer, *tile_size) == ESP_OK) {
+        unlink(path);
+        ESP_LOGD(TAG, "Migrated legacy tile: %s", path);
+    }
+    return ESP_OK;
 }
 
 /**
@@ -125,13 +236,14 @@ static bool tile_exists(int z, int x, int y, tile_layer_t layer)
 static esp_err_t tile_read_cache(int z, int x, int y, tile_layer_t layer,
                                   uint8_t *buffer, size_t buffer_size, size_t *tile_size)
 {
-    char path[256];
-    build_tile_path(path, sizeof(path), z, x, y, layer);
+    esp_err_t ret = tile_pack_read(s_packs[layer], z, x, y, buffer, buffer_size, tile_size);
+    if (ret == ESP_ERR_NOT_FOUND && s_legacy[layer]) {
+        ret = tile_migrate_legacy(z, x, y, layer, buffer, buffer_size, tile_size);
+    }
 
-    esp_err_t ret = sdcard_read_file(path, buffer, buffer_size, tile_size);
     if (ret == ESP_OK) {
         s_stats.cache_hits++;
-        ESP_LOGD(TAG, "Cache hit: %s (%zu bytes)", path, *tile_size);
+        ESP_LOGD(TAG, "Cache hit: z=%d x=%d y=%d (%zu bytes)", z, x, y, *tile_size);
     }
     return ret;
 }
@@ -142,6 +254,17 @@ static esp_err_t tile_read_cache(int z, int x, int y, tile_layer_t layer,
 static esp_err_t tile_download(int z, int x, int y, tile_layer_t layer,
                                 uint8_t *buffer, size_t buffer_size, size_t *tile_size)
 {
+#if CONFIG_GEOGRAM_TILES_MESH_PEERS
+    // Ask the parent mesh node before spending uplink bandwidth
+    if (tile_peer_available() &&
+        tile_peer_get(z, x, y, layer == TILE_LAYER_SATELLITE ? "satellite" : "standard",
+                      buffer, buffer_size, tile_size) == ESP_OK) {
+        s_stats.cache_misses++;
+        s_stats.peer_hits++;
+        return ESP_OK;
+    }
+#endif
+
     char url[256];
     build_tile_url(url, sizeof(url), z, x, y, layer);
 
@@ -185,33 +308,342 @@ static esp_err_t tile_download(int z, int x, int y, tile_layer_t layer,
 static esp_err_t tile_save_cache(int z, int x, int y, tile_layer_t layer,
                                   const uint8_t *buffer, size_t tile_size)
 {
-    // Create directory structure
-    char dir_path[256];
-    build_tile_dir(dir_path, sizeof(dir_path), z, x, layer);
+    esp_err_t ret = tile_pack_append(s_packs[layer], z, x, y, buffer, tile_size);
+
+    // Wake maintenance early when over quota (or the archive hit the FAT limit)
+    if (s_maint_task != NULL && !s_compact_stalled &&
+        (ret == ESP_ERR_NO_MEM || (QUOTA_BYTES > 0 && tiles_get_disk_usage() > QUOTA_BYTES))) {
+        xTaskNotifyGive(s_maint_task);
+    }
 
-    esp_err_t ret = mkdir_recursive(dir_path);
     if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "Failed to create tile directory: %s", dir_path);
+        ESP_LOGW(TAG, "Failed to save tile z=%d x=%d y=%d: %s", z, x, y, esp_err_to_name(ret));
         return ret;
     }
 
-    // Write tile file
-    char file_path[256];
-    build_tile_path(file_path, sizeof(file_path), z, x, y, layer);
+    ESP_LOGD(TAG, "Cached tile: z=%d x=%d y=%d", z, x, y);
+    return ESP_OK;
+}
 
-    ret = sdcard_write_file(file_path, buffer, tile_size);
+/**
+ * @brief Download a tile and store it in the caches (fetch worker callback)
+ */
+static esp_err_t tile_fetch_and_store(int z, int x, int y, int layer,
+                                      uint8_t *buffer, size_t buffer_size)
+{
+    size_t tile_size = 0;
+    esp_err_t ret = tile_download(z, x, y, (tile_layer_t)layer, buffer, buffer_size, &tile_size);
     if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "Failed to save tile: %s", file_path);
         return ret;
     }
 
-    s_stats.total_tiles++;
-    s_stats.cache_size_bytes += tile_size;
+    // Save to cache (ignore errors - tile is still held in RAM)
+    tile_save_cache(z, x, y, (tile_layer_t)layer, buffer, tile_size);
+    tile_ram_cache_put(layer, z, x, y, buffer, tile_size);
+    return ESP_OK;
+}
+
+/**
+ * @brief Import one legacy layer directory into its archive
+ */
+static esp_err_t import_layer(tile_layer_t layer, bool remove_source,
+                              uint8_t *buffer, uint32_t *imported)
+{
+    const char *base = layer_path(layer);
+    char z_path[128];
+    char x_path[192];
+    char file_path[256];
 
-    ESP_LOGD(TAG, "Cached tile: %s", file_path);
+    DIR *z_dir = opendir(base);
+    if (z_dir == NULL) {
+        s_legacy[layer] = false;
+        return ESP_OK;
+    }
+
+    struct dirent *z_ent;
+    while ((z_ent = readdir(z_dir)) != NULL) {
+        int z;
+        if (sscanf(z_ent->d_name, "%d", &z) != 1) {
+            continue;
+        }
+        // Names too long for the path buffers are not tile directories
+        if (snprintf(z_path, sizeof(z_path), "%s/%s", base, z_ent->d_name) >= (int)sizeof(z_path)) {
+            continue;
+        }
+
+        DIR *x_dir = opendir(z_path);
+        if (x_dir == NULL) {
+            continue;
+        }
+
+        struct dirent *x_ent;
+        while ((x_ent = readdir(x_dir)) != NULL) {
+            int x;
+            if (sscanf(x_ent->d_name, "%d", &x) != 1) {
+                continue;
+            }
+            if (snprintf(x_path, sizeof(x_path), "%s/%s", z_path, x_ent->d_name) >= (int)sizeof(x_path)) {
+                continue;
+            }
+
+            DIR *y_dir = opendir(x_path);
+            if (y_dir == NULL) {
+                continue;
+            }
+
+            struct dirent *y_ent;
+            while ((y_ent = readdir(y_dir)) != NULL) {
+                int y;
+                if (sscanf(y_ent->d_name, "%d.png", &y) != 1) {
+                    continue;
+                }
+                if (snprintf(file_path, sizeof(file_path), "%s/%s", x_path,
+                             y_ent->d_name) >= (int)sizeof(file_path)) {
+                    continue;
+                }
+
+                size_t len = 0;
+                if (!tile_pack_contains(s_packs[layer], z, x, y)) {
+                    if (sdcard_read_file(file_path, buffer, MAX_TILE_SIZE, &len) != ESP_OK ||
+                        tile_pack_append(s_packs[layer], z, x, y, buffer, len) != ESP_OK) {
+                        ESP_LOGW(TAG, "Failed to import %s", file_path);
+                        continue;
+                    }
+                    (*imported)++;
+                }
+                if (remove_source) {
+                    unlink(file_path);
+                }
+            }
+            closedir(y_dir);
+            if (remove_source) {
+                rmdir(x_path);
+            }
+        }
+        closedir(x_dir);
+        if (remove_source) {
+            rmdir(z_path);
+        }
+    }
+    closedir(z_dir);
+
+    if (remove_source && rmdir(base) == 0) {
+        s_legacy[layer] = false;
+    }
     return ESP_OK;
 }
 
+/**
+ * @brief First access stamp that falls into histogram bin `bin`
+ */
+static uint32_t bin_start(uint32_t oldest, uint64_t span, int bin)
+{
+    return oldest + (uint32_t)(((uint64_t)bin * span + EVICT_BINS - 1) / EVICT_BINS);
+}
+
+/**
+ * @brief Bytes of live records (headers included) in a layer's archive
+ */
+static uint64_t live_bytes(tile_layer_t layer)
+{
+    return tile_pack_bytes(s_packs[layer]) +
+           (uint64_t)tile_pack_count(s_packs[layer]) * TILE_PACK_RECORD_SIZE;
+}
+
+/**
+ * @brief Evict at least `need` bytes of the least recently used tiles
+ *
+ * The access-age threshold is chosen from a histogram combined over the
+ * layers first..last, so they share one LRU order.
+ *
+ * @return Number of tiles evicted
+ */
+static uint32_t evict_oldest(int first, int last, uint64_t need)
+{
+    uint32_t oldest = UINT32_MAX;
+    uint32_t newest = 0;
+    for (int layer = first; layer <= last; layer++) {
+        uint32_t lo, hi;
+        if (tile_pack_stamp_range(s_packs[layer], &lo, &hi)) {
+            oldest = lo < oldest ? lo : oldest;
+            newest = hi > newest ? hi : newest;
+        }
+    }
+    if (oldest > newest) {
+        return 0;
+    }
+
+    uint64_t bins[EVICT_BINS] = {0};
+    for (int layer = first; layer <= last; layer++) {
+        tile_pack_age_histogram(s_packs[layer], oldest, newest, bins, EVICT_BINS);
+    }
+
+    uint64_t span = (uint64_t)newest - oldest + 1;
+    int bin = 0;
+    uint64_t freed = 0;
+    while (bin < EVICT_BINS - 1 && freed + bins[bin] < need) {
+        freed += bins[bin++];
+    }
+
+    // Drop everything older than the threshold bin, then part of it
+    uint32_t below = bin_start(oldest, span, bin);
+    uint32_t upto = bin_start(oldest, span, bin + 1);
+    uint64_t extra = need - freed;
+    uint32_t evicted = 0;
+    for (int layer = first; layer <= last; layer++) {
+        evicted += tile_pack_evict(s_packs[layer], below, upto, &extra);
+    }
+    s_stats.evicted += evicted;
+    return evicted;
+}
+
+/**
+ * @brief Compact a layer's archive if the card has room for the copy
+ *
+ * When it does not, the layer's oldest tiles are evicted until the copy
+ * fits next to the old file.
+ *
+ * @return false if the card is too full to compact at all
+ */
+static bool compact_layer(tile_layer_t layer)
+{
+    const char *name = layer == TILE_LAYER_SATELLITE ? "satellite" : "standard";
+    uint64_t need = tile_pack_compact_bytes(s_packs[layer]);
+    if (need == 0) {
+        return true;
+    }
+
+    uint64_t free_bytes = 0;
+    if (sdcard_get_free_bytes(&free_bytes) == ESP_OK && free_bytes < need + COMPACT_RESERVE_BYTES) {
+        uint64_t shortfall = need + COMPACT_RESERVE_BYTES - free_bytes;
+        if (shortfall >= live_bytes(layer)) {
+            ESP_LOGW(TAG, "Card too full to compact %s tiles (%llu KB free, %llu KB needed)",
+                     name, (unsigned long long)(free_bytes / 1024),
+                     (unsigned long long)(need / 1024));
+            return false;
+        }
+        uint32_t evicted = evict_oldest(layer, layer, shortfall);
+        ESP_LOGW(TAG, "Card nearly full: evicted %lu %s tiles to make room for compaction",
+                 (unsigned long)evicted, name);
+    }
+
+    return tile_pack_compact(s_packs[layer]) == ESP_OK;
+}
+
+/**
+ * @brief Evict least recently used tiles until usage is below the low watermark
+ *
+ * Both layers share the quota and one LRU order. Evicted records are
+ * then compacted away.
+ */
+static void tiles_enforce_quota(void)
+{
+    uint64_t used = tiles_get_disk_usage();
+    if (QUOTA_BYTES == 0 || used <= QUOTA_BYTES) {
+        s_compact_stalled = false;
+        return;
+    }
+
+    uint64_t target = QUOTA_BYTES / 100 * QUOTA_LOW_WATER_PCT;
+    uint64_t live = 0;
+    for (int layer = 0; layer < TILE_LAYER_COUNT; layer++) {
+        live += live_bytes((tile_layer_t)layer);
+    }
+
+    // Space left by superseded or evicted tiles comes back with compaction alone
+    uint64_t dead = used > live ? used - live : 0;
+    if (live > 0 && used - dead > target) {
+        uint32_t evicted = evict_oldest(0, TILE_LAYER_COUNT - 1, used - dead - target);
+        ESP_LOGI(TAG, "Quota exceeded (%llu KB used): evicted %lu tiles",
+                 (unsigned long long)(used / 1024), (unsigned long)evicted);
+    }
+
+    bool stalled = false;
+    for (int layer = 0; layer < TILE_LAYER_COUNT; layer++) {
+        if (!compact_layer((tile_layer_t)layer)) {
+            stalled = true;
+        }
+    }
+    s_compact_stalled = stalled;
+}
+
+/**
+ * @brief Bulk import progress callback
+ */
+static void tiles_import_notify(bool finished, bool replaced)
+{
+    if (s_maint_task != NULL && !s_compact_stalled &&
+        QUOTA_BYTES > 0 && tiles_get_disk_usage() > QUOTA_BYTES) {
+        xTaskNotifyGive(s_maint_task);
+    }
+
+    // The RAM cache may still hold copies of tiles the import overwrote
+    if (finished && replaced) {
+        tile_ram_cache_clear();
+    }
+}
+
+/**
+ * @brief Cache maintenance task
+ *
+ * Enforces the quota (every MAINT_INTERVAL_MS, or when woken by a write
+ * that crossed it) and periodically persists tile access times.
+ */
+static void tiles_maint_task(void *arg)
+{
+    uint32_t rounds = 0;
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(MAINT_INTERVAL_MS));
+
+        tiles_enforce_quota();
+
+        if (++rounds % SNAPSHOT_EVERY == 0) {
+            for (int layer = 0; layer < TILE_LAYER_COUNT; layer++) {
+                tile_pack_snapshot(s_packs[layer]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Copy tile_cache_stats_t into /api/metrics
+ */
+static void tiles_collect_metrics(void)
+{
+    static geo_metric_t *hits, *misses, *ram_hits, *peer_hits, *not_modified;
+    static geo_metric_t *coalesced, *errors, *evicted, *tiles, *disk_bytes, *ram_bytes;
+    if (hits == NULL) {
+        hits = geo_metric_counter("geogram_tiles_cache_hits_total", NULL, "Tiles served from RAM or SD");
+        misses = geo_metric_counter("geogram_tiles_cache_misses_total", NULL, "Tiles fetched from remote");
+        ram_hits = geo_metric_counter("geogram_tiles_ram_hits_total", NULL, "Tiles served from the PSRAM cache");
+        peer_hits = geo_metric_counter("geogram_tiles_peer_hits_total", NULL, "Misses served by the parent mesh node");
+        not_modified = geo_metric_counter("geogram_tiles_not_modified_total", NULL, "Revalidations answered with 304");
+        coalesced = geo_metric_counter("geogram_tiles_coalesced_total", NULL, "Requests that joined an in-flight download");
+        errors = geo_metric_counter("geogram_tiles_download_errors_total", NULL, "Failed tile downloads");
+        evicted = geo_metric_counter("geogram_tiles_evicted_total", NULL, "Tiles evicted to stay within the quota");
+        tiles = geo_metric_gauge("geogram_tiles_cached", NULL, "Tiles in the cache");
+        disk_bytes = geo_metric_gauge("geogram_tiles_disk_bytes", NULL, "Card space used by the tile archives");
+        ram_bytes = geo_metric_gauge("geogram_tiles_ram_cache_bytes", NULL, "PSRAM tile cache usage");
+    }
+
+    tile_cache_stats_t stats;
+    if (!tiles_is_available() || tiles_get_stats(&stats) != ESP_OK) {
+        return;
+    }
+    geo_metric_set(hits, stats.cache_hits);
+    geo_metric_set(misses, stats.cache_misses);
+    geo_metric_set(ram_hits, stats.ram_hits);
+    geo_metric_set(peer_hits, stats.peer_hits);
+    geo_metric_set(not_modified, stats.not_modified);
+    geo_metric_set(coalesced, stats.coalesced);
+    geo_metric_set(errors, stats.download_errors);
+    geo_metric_set(evicted, stats.evicted);
+    geo_metric_set(tiles, stats.total_tiles);
+    geo_metric_set(disk_bytes, (int64_t)stats.disk_bytes);
+    geo_metric_set(ram_bytes, stats.ram_cache_bytes);
+}
+
 esp_err_t tiles_init(void)
 {
     if (s_initialized) {
@@ -223,19 +655,59 @@ esp_err_t tiles_init(void)
         return ESP_ERR_INVALID_STATE;
     }
 
-    // Create base directories
-    esp_err_t ret = mkdir_recursive(TILES_STANDARD_PATH);
+    // Create base directory
+    esp_err_t ret = mkdir_recursive(TILES_BASE_PATH);
     if (ret != ESP_OK) {
         return ret;
     }
 
-    ret = mkdir_recursive(TILES_SATELLITE_PATH);
+    for (int layer = 0; layer < TILE_LAYER_COUNT; layer++) {
+        ret = open_layer_pack((tile_layer_t)layer);
+        if (ret != ESP_OK) {
+            for (int i = 0; i < layer; i++) {
+                tile_pack_close(s_packs[i]);
+                s_packs[i] = NULL;
+            }
+            return ret;
+        }
+
+        s_legacy[layer] = dir_exists(layer_path((tile_layer_t)layer));
+        if (s_legacy[layer]) {
+            ESP_LOGI(TAG, "Legacy tile directory found: %s (use 'tiles import' to pack it)",
+                     layer_path((tile_layer_t)layer));
+        }
+    }
+
+    // Optional PSRAM hot-tile cache in front of the archives
+    tile_ram_cache_init((size_t)CONFIG_GEOGRAM_TILES_RAM_CACHE_KB * 1024);
+
+    ret = tile_fetch_init(tile_fetch_and_store, MAX_TILE_SIZE, CONFIG_GEOGRAM_TILES_FETCH_WORKERS);
     if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start tile fetch workers: %s", esp_err_to_name(ret));
         return ret;
     }
 
+    if (tile_import_init(s_packs, TILE_LAYER_COUNT, tiles_import_notify) != ESP_OK) {
+        ESP_LOGW(TAG, "Bulk tile import unavailable");
+    }
+
+    if (xTaskCreate(tiles_maint_task, "tiles_maint", MAINT_TASK_STACK, NULL,
+                    MAINT_TASK_PRIORITY, &s_maint_task) != pdPASS) {
+        ESP_LOGW(TAG, "Failed to start tile cache maintenance - quota not enforced");
+    }
+
     s_initialized = true;
-    ESP_LOGI(TAG, "Tile cache initialized at %s", TILES_BASE_PATH);
+    ESP_LOGI(TAG, "Tile cache initialized at %s (%lu tiles, %llu KB on card)", TILES_BASE_PATH,
+             (unsigned long)tiles_get_cache_count(),
+             (unsigned long long)(tiles_get_disk_usage() / 1024));
+    if (QUOTA_BYTES > 0 && tiles_get_disk_usage() > QUOTA_BYTES) {
+        xTaskNotifyGive(s_maint_task);
+    }
+
+    geo_metrics_register_collector(tiles_collect_metrics);
+
+    // Resume a region prefetch interrupted by reboot
+    tiles_prefetch_init();
     return ESP_OK;
 }
 
@@ -244,8 +716,25 @@ bool tiles_is_available(void)
     return s_initialized && sdcard_is_mounted();
 }
 
-esp_err_t tiles_get(int z, int x, int y, tile_layer_t layer,
-                    uint8_t *buffer, size_t buffer_size, size_t *tile_size)
+static esp_err_t validate_tile(int z, int x, int y)
+{
+    // Validate zoom level
+    if (z < 0 || z > 18) {
+        ESP_LOGW(TAG, "Invalid zoom level: %d", z);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Validate tile coordinates for this zoom level
+    int max_coord = 1 << z;
+    if (x < 0 || y < 0 || x >= max_coord || y >= max_coord) {
+        ESP_LOGW(TAG, "Invalid tile coordinates: z=%d x=%d y=%d", z, x, y);
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
+}
+
+esp_err_t tiles_lookup(int z, int x, int y, tile_layer_t layer,
+                       uint8_t *buffer, size_t buffer_size, size_t *tile_size)
 {
     if (!s_initialized) {
         return ESP_ERR_INVALID_STATE;
@@ -255,26 +744,98 @@ esp_err_t tiles_get(int z, int x, int y, tile_layer_t layer,
         return ESP_ERR_INVALID_ARG;
     }
 
-    // Validate zoom level
-    if (z < 0 || z > 18) {
-        ESP_LOGW(TAG, "Invalid zoom level: %d", z);
-        return ESP_ERR_INVALID_ARG;
+    esp_err_t ret = validate_tile(z, x, y);
+    if (ret != ESP_OK) {
+        return ret;
     }
 
-    // Check cache first
-    if (tile_exists(z, x, y, layer)) {
-        return tile_read_cache(z, x, y, layer, buffer, buffer_size, tile_size);
+    if (layer != TILE_LAYER_SATELLITE) {
+        layer = TILE_LAYER_STANDARD;
     }
 
-    // Download from remote (uses async HTTP client internally for TLS stack)
-    esp_err_t ret = tile_download(z, x, y, layer, buffer, buffer_size, tile_size);
+    // Check RAM cache first
+    if (tile_ram_cache_get(layer, z, x, y, buffer, buffer_size, tile_size)) {
+        s_stats.ram_hits++;
+        s_stats.cache_hits++;
+        return ESP_OK;
+    }
+    s_stats.ram_misses++;
+
+    // Then the SD card archive
+    ret = tile_read_cache(z, x, y, layer, buffer, buffer_size, tile_size);
+    if (ret == ESP_OK) {
+        tile_ram_cache_put(layer, z, x, y, buffer, *tile_size);
+    }
+    return ret;
+}
+
+bool tiles_contains(int z, int x, int y, tile_layer_t layer)
+{
+    if (!s_initialized || validate_tile(z, x, y) != ESP_OK) {
+        return false;
+    }
+    if (layer != TILE_LAYER_SATELLITE) {
+        layer = TILE_LAYER_STANDARD;
+    }
+    return tile_pack_contains(s_packs[layer], z, x, y);
+}
+
+esp_err_t tiles_fetch(int z, int x, int y, tile_layer_t layer, uint32_t wait_ms)
+{
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = validate_tile(z, x, y);
     if (ret != ESP_OK) {
         return ret;
     }
 
-    // Save to cache (ignore errors - tile can still be served)
-    tile_save_cache(z, x, y, layer, buffer, *tile_size);
+    if (layer != TILE_LAYER_SATELLITE) {
+        layer = TILE_LAYER_STANDARD;
+    }
+    return tile_fetch_request(z, x, y, layer, wait_ms);
+}
 
+esp_err_t tiles_get(int z, int x, int y, tile_layer_t layer,
+                    uint8_t *buffer, size_t buffer_size, size_t *tile_size)
+{
+    esp_err_t ret = tiles_lookup(z, x, y, layer, buffer, buffer_size, tile_size);
+    if (ret != ESP_ERR_NOT_FOUND) {
+        return ret;
+    }
+
+    // Download through the fetch queue (shares in-flight downloads)
+    ret = tiles_fetch(z, x, y, layer, FETCH_WAIT_MS);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    return tiles_lookup(z, x, y, layer, buffer, buffer_size, tile_size);
+}
+
+esp_err_t tiles_import_legacy(bool remove_source, uint32_t *imported)
+{
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint8_t *buffer = malloc(MAX_TILE_SIZE);
+    if (buffer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint32_t count = 0;
+    for (int layer = 0; layer < TILE_LAYER_COUNT; layer++) {
+        ESP_LOGI(TAG, "Importing %s", layer_path((tile_layer_t)layer));
+        import_layer((tile_layer_t)layer, remove_source, buffer, &count);
+    }
+    free(buffer);
+
+    ESP_LOGI(TAG, "Imported %lu legacy tiles", (unsigned long)count);
+    if (imported) {
+        *imported = count;
+    }
     return ESP_OK;
 }
 
@@ -285,24 +846,201 @@ esp_err_t tiles_get_stats(tile_cache_stats_t *stats)
     }
 
     memcpy(stats, &s_stats, sizeof(tile_cache_stats_t));
+    stats->total_tiles = tiles_get_cache_count();
+    stats->cache_size_bytes = tiles_get_cache_size();
+    stats->disk_bytes = tiles_get_disk_usage();
+    stats->quota_bytes = QUOTA_BYTES;
+
+    size_t ram_bytes = 0;
+    tile_ram_cache_usage(&ram_bytes, NULL);
+    stats->ram_cache_bytes = (uint32_t)ram_bytes;
+    stats->coalesced = tile_fetch_get_coalesced();
     return ESP_OK;
 }
 
 uint32_t tiles_get_cache_size(void)
 {
-    return s_stats.cache_size_bytes;
+    uint64_t bytes = 0;
+    for (int layer = 0; layer < TILE_LAYER_COUNT; layer++) {
+        bytes += tile_pack_bytes(s_packs[layer]);
+    }
+    return bytes > UINT32_MAX ? UINT32_MAX : (uint32_t)bytes;
 }
 
 uint32_t tiles_get_cache_count(void)
 {
-    return s_stats.total_tiles;
+    uint32_t count = 0;
+    for (int layer = 0; layer < TILE_LAYER_COUNT; layer++) {
+        count += tile_pack_count(s_packs[layer]);
+    }
+    return count;
+}
+
+uint64_t tiles_get_disk_usage(void)
+{
+    uint64_t bytes = 0;
+    for (int layer = 0; layer < TILE_LAYER_COUNT; layer++) {
+        bytes += tile_pack_disk_bytes(s_packs[layer]);
+    }
+    return bytes;
+}
+
+bool tiles_has_legacy_cache(void)
+{
+    return s_legacy[TILE_LAYER_STANDARD] || s_legacy[TILE_LAYER_SATELLITE];
 }
 
 esp_err_t tiles_clear_cache(void)
 {
-    // TODO: Implement recursive directory deletion
-    ESP_LOGW(TAG, "Cache clear not implemented");
-    return ESP_ERR_NOT_SUPPORTED;
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = ESP_OK;
+    for (int layer = 0; layer < TILE_LAYER_COUNT; layer++) {
+        esp_err_t err = tile_pack_clear(s_packs[layer]);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to clear %s: %s", layer_path((tile_layer_t)layer), esp_err_to_name(err));
+            ret = err;
+        }
+    }
+    tile_ram_cache_clear();
+
+    ESP_LOGI(TAG, "Tile cache cleared");
+    return ret;
+}
+
+/**
+ * @brief Move one legacy tile into the archive (cache miss path)
+ */
+static esp_err_t tile_migrate_one(int z, int x, int y, tile_layer_t layer)
+{
+    // Rare path; keep the whole-tile buffer out of internal RAM
+    uint8_t *buffer = heap_caps_malloc(MAX_TILE_SIZE, MALLOC_CAP_SPIRAM);
+    if (buffer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    size_t tile_size = 0;
+    esp_err_t ret = tile_migrate_legacy(z, x, y, layer, buffer, MAX_TILE_SIZE, &tile_size);
+    free(buffer);
+    return ret;
+}
+
+/**
+ * @brief Stream a cached tile to the client
+ *
+ * Sends from the PSRAM cache or the SD archive through a pooled
+ * GEO_HTTP_CHUNK_SIZE buffer, with Content-Length taken from the index,
+ * so a request never holds a whole tile in internal RAM. Tiles read from
+ * SD are staged in PSRAM on the way and added to the RAM cache.
+ *
+ * Exact tiles carry an ETag derived from the archive index (stored copy
+ * and size), so revalidations are answered with a bodyless 304.
+ *
+ * @param fallback Requested tile this one stands in for (NULL if exact)
+ * @param started Set once the response head has been sent
+ * @return ESP_OK when sent, ESP_ERR_NOT_FOUND if not cached; any error
+ *         with *started set means the response was cut short
+ */
+static esp_err_t tile_send(httpd_req_t *req, int z, int x, int y, tile_layer_t layer,
+                           const char *fallback, bool *started)
+{
+    esp_err_t ret = validate_tile(z, x, y);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    geo_http_header_t headers[4] = {
+        { "Access-Control-Allow-Origin", "*" },
+        { "Cache-Control", "public, max-age=86400" },
+    };
+    size_t header_count = 2;
+
+    char etag[24] = {0};
+    size_t stored_size = 0;
+    uint64_t version = 0;
+    if (fallback != NULL) {
+        // Parent tile stands in for this one; do not let clients keep it
+        headers[1].value = "no-store";
+        headers[header_count++] = (geo_http_header_t){ "X-Tile-Fallback", fallback };
+    } else if (tile_pack_stat(s_packs[layer], z, x, y, &stored_size, &version) == ESP_OK) {
+        snprintf(etag, sizeof(etag), "\"%016llx\"", (unsigned long long)version);
+        if (geo_http_not_modified(req, etag, 0)) {
+            s_stats.cache_hits++;
+            s_stats.not_modified++;
+            *started = true;
+            return geo_http_send_not_modified(req, etag, 0, headers, header_count);
+        }
+        headers[header_count++] = (geo_http_header_t){ "ETag", etag };
+    }
+
+    uint8_t *chunk = geo_http_buf_acquire();
+    if (chunk == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    size_t n = 0;
+    size_t total = 0;
+    bool from_ram = tile_ram_cache_read_part(layer, z, x, y, 0, chunk, GEO_HTTP_CHUNK_SIZE, &n, &total);
+    if (from_ram) {
+        s_stats.ram_hits++;
+    } else {
+        s_stats.ram_misses++;
+        ret = tile_pack_read_part(s_packs[layer], z, x, y, 0, chunk, GEO_HTTP_CHUNK_SIZE, &n, &total);
+        if (ret == ESP_ERR_NOT_FOUND && s_legacy[layer] && tile_migrate_one(z, x, y, layer) == ESP_OK) {
+            ret = tile_pack_read_part(s_packs[layer], z, x, y, 0, chunk, GEO_HTTP_CHUNK_SIZE, &n, &total);
+        }
+        if (ret != ESP_OK) {
+            geo_http_buf_release(chunk);
+            return ret;
+        }
+    }
+    s_stats.cache_hits++;
+
+    uint8_t *stage = NULL;
+    if (!from_ram && tile_ram_cache_accepts(total)) {
+        stage = heap_caps_malloc(total, MALLOC_CAP_SPIRAM);
+    }
+
+    if (etag[0] != '\0' && total != stored_size) {
+        // Served copy differs from the one the ETag describes (RAM cache lag)
+        header_count--;
+    }
+
+    *started = true;
+    ret = geo_http_send_head(req, "200 OK", "image/png", total, headers, header_count);
+
+    size_t offset = 0;
+    while (ret == ESP_OK) {
+        if (stage != NULL) {
+            memcpy(stage + offset, chunk, n);
+        }
+        ret = geo_http_send_body(req, chunk, n);
+        offset += n;
+        if (ret != ESP_OK || offset >= total) {
+            break;
+        }
+
+        // RAM copy may be evicted mid-stream; continue from the archive
+        size_t part_total = 0;
+        if (!from_ram || !tile_ram_cache_read_part(layer, z, x, y, offset, chunk,
+                                                   GEO_HTTP_CHUNK_SIZE, &n, &part_total)) {
+            from_ram = false;
+            ret = tile_pack_read_part(s_packs[layer], z, x, y, offset, chunk,
+                                      GEO_HTTP_CHUNK_SIZE, &n, &part_total);
+        }
+        if (ret == ESP_OK && (part_total != total || n == 0)) {
+            // Tile was replaced while streaming
+            ret = ESP_ERR_INVALID_STATE;
+        }
+    }
+
+    if (ret == ESP_OK && stage != NULL) {
+        tile_ram_cache_put(layer, z, x, y, stage, total);
+    }
+    free(stage);
+    geo_http_buf_release(chunk);
+    return ret;
 }
 
 // HTTP handler for /tiles/{z}/{x}/{y}.png
@@ -330,53 +1068,321 @@ static esp_err_t tiles_http_handler(httpd_req_t *req)
         return ESP_FAIL;
     }
 
-    // Parse layer from query parameter
+    // Parse layer (and child-node marker) from query parameters
     tile_layer_t layer = TILE_LAYER_STANDARD;
-    char layer_param[32] = {0};
-    if (httpd_req_get_url_query_str(req, layer_param, sizeof(layer_param)) == ESP_OK) {
-        char layer_value[16] = {0};
-        if (httpd_query_key_value(layer_param, "layer", layer_value, sizeof(layer_value)) == ESP_OK) {
-            if (strcmp(layer_value, "satellite") == 0) {
+    bool peer = false;
+    char query_str[48] = {0};
+    if (httpd_req_get_url_query_str(req, query_str, sizeof(query_str)) == ESP_OK) {
+        char value[16] = {0};
+        if (httpd_query_key_value(query_str, "layer", value, sizeof(value)) == ESP_OK) {
+            if (strcmp(value, "satellite") == 0) {
                 layer = TILE_LAYER_SATELLITE;
             }
         }
+        peer = httpd_query_key_value(query_str, TILE_PEER_QUERY, value, sizeof(value)) == ESP_OK;
     }
 
     ESP_LOGI(TAG, "Tile request: z=%d x=%d y=%d layer=%s",
              z, x, y, layer == TILE_LAYER_SATELLITE ? "satellite" : "standard");
 
-    // Allocate buffer for tile data
-    uint8_t *tile_buffer = malloc(MAX_TILE_SIZE);
-    if (tile_buffer == NULL) {
-        ESP_LOGE(TAG, "Failed to allocate tile buffer");
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Memory allocation failed");
-        return ESP_FAIL;
+    bool started = false;
+    esp_err_t ret = tile_send(req, z, x, y, layer, NULL, &started);
+
+    if (ret == ESP_ERR_NOT_FOUND) {
+        // Miss: queue the download and apply the configured miss policy.
+        // The wait happens on a worker so the server task keeps serving
+        // hits and chat; child nodes poll on 503 instead of waiting at all.
+        uint32_t wait_ms = peer ? 0 : MISS_WAIT_MS;
+        if (wait_ms > 0) {
+            esp_err_t deferred = geo_http_async_defer(req, tiles_http_handler);
+            if (deferred == ESP_OK) {
+                return ESP_OK;
+            }
+            if (deferred == ESP_ERR_NO_MEM) {
+                // Workers busy: answer right away (parent tile or 503)
+                wait_ms = 0;
+            }
+        }
+        ret = tiles_fetch(z, x, y, layer, wait_ms);
+        if (ret == ESP_OK) {
+            ret = tile_send(req, z, x, y, layer, NULL, &started);
+        }
     }
 
-    size_t tile_size = 0;
-    esp_err_t ret = tiles_get(z, x, y, layer, tile_buffer, MAX_TILE_SIZE, &tile_size);
+#if CONFIG_GEOGRAM_TILES_MISS_PARENT
+    // Child nodes would cache a stand-in tile; only browsers get one
+    if ((ret == ESP_ERR_TIMEOUT || ret == ESP_ERR_NO_MEM) && !peer) {
+        // Serve the nearest cached ancestor while the real tile downloads
+        for (int level = 1; level <= FALLBACK_MAX_LEVELS && level <= z && !started; level++) {
+            int pz = z - level;
+            int px = x >> level;
+            int py = y >> level;
+            char fallback[32];
+            snprintf(fallback, sizeof(fallback), "%d/%d/%d", pz, px, py);
+            if (tile_send(req, pz, px, py, layer, fallback, &started) == ESP_OK) {
+                ret = ESP_OK;
+            }
+        }
+    }
+#endif
+
+    if (started) {
+        // Response head is out; on error all we can do is drop the connection
+        return ret == ESP_OK ? ESP_OK : ESP_FAIL;
+    }
 
     if (ret != ESP_OK) {
-        free(tile_buffer);
         if (ret == ESP_ERR_INVALID_ARG) {
             httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid tile coordinates");
+        } else if (ret == ESP_ERR_TIMEOUT || ret == ESP_ERR_NO_MEM) {
+            // Download still pending (or queue full): ask the client to retry
+            httpd_resp_set_status(req, "503 Service Unavailable");
+            httpd_resp_set_type(req, "text/plain");
+            httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+            httpd_resp_set_hdr(req, "Retry-After", RETRY_AFTER_STR);
+            httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+            httpd_resp_sendstr(req, "Tile download pending");
+            return ESP_OK;
         } else {
             httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to get tile");
         }
         return ESP_FAIL;
     }
 
-    // Send tile
-    httpd_resp_set_type(req, "image/png");
+    return ESP_OK;
+}
+
+/**
+ * @brief Build prefetch status JSON
+ */
+static size_t build_prefetch_json(char *buffer, size_t buffer_size)
+{
+    tile_prefetch_status_t st;
+    tiles_prefetch_get_status(&st);
+
+    geo_json_builder_t builder;
+    geo_json_init(&builder, buffer, buffer_size);
+
+    geo_json_object_start(&builder);
+    geo_json_add_bool(&builder, "running", st.running);
+    geo_json_add_string(&builder, "layer", st.layer == TILE_LAYER_SATELLITE ? "satellite" : "standard");
+    geo_json_add_int(&builder, "zmin", st.zmin);
+    geo_json_add_int(&builder, "zmax", st.zmax);
+    geo_json_add_int(&builder, "z", st.z);
+    geo_json_add_int(&builder, "x", st.x);
+    geo_json_add_int(&builder, "y", st.y);
+    geo_json_add_uint(&builder, "total", st.total);
+    geo_json_add_uint(&builder, "done", st.done);
+    geo_json_add_uint(&builder, "fetched", st.fetched);
+    geo_json_add_uint(&builder, "skipped", st.skipped);
+    geo_json_add_uint(&builder, "failed", st.failed);
+    geo_json_object_end(&builder);
+
+    return geo_json_get_length(&builder);
+}
+
+/**
+ * @brief HTTP handler for /api/tiles/prefetch
+ *
+ * GET returns progress, DELETE cancels, POST starts a job:
+ *   POST /api/tiles/prefetch?bbox={min_lat},{min_lon},{max_lat},{max_lon}&zmin=10&zmax=14[&layer=satellite]
+ */
+static esp_err_t tiles_prefetch_handler(httpd_req_t *req)
+{
     httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-    httpd_resp_set_hdr(req, "Cache-Control", "public, max-age=86400");
-    httpd_resp_send(req, (char *)tile_buffer, tile_size);
 
-    free(tile_buffer);
+    if (req->method == HTTP_POST) {
+        char query[160] = {0};
+        char bbox_str[96] = {0};
+        char zmin_str[8] = {0};
+        char zmax_str[8] = {0};
+        char layer_str[16] = {0};
+
+        if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK ||
+            httpd_query_key_value(query, "bbox", bbox_str, sizeof(bbox_str)) != ESP_OK ||
+            httpd_query_key_value(query, "zmin", zmin_str, sizeof(zmin_str)) != ESP_OK ||
+            httpd_query_key_value(query, "zmax", zmax_str, sizeof(zmax_str)) != ESP_OK) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Required: bbox, zmin, zmax");
+            return ESP_FAIL;
+        }
+        httpd_query_key_value(query, "layer", layer_str, sizeof(layer_str));
+
+        // Commas may arrive percent-encoded
+        char *src = bbox_str;
+        char *dst = bbox_str;
+        while (*src) {
+            if (src[0] == '%' && src[1] == '2' && (src[2] == 'C' || src[2] == 'c')) {
+                *dst++ = ',';
+                src += 3;
+            } else {
+                *dst++ = *src++;
+            }
+        }
+        *dst = '\0';
+
+        tile_bbox_t bbox;
+        if (sscanf(bbox_str, "%lf,%lf,%lf,%lf", &bbox.min_lat, &bbox.min_lon,
+                   &bbox.max_lat, &bbox.max_lon) != 4) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid bbox");
+            return ESP_FAIL;
+        }
+
+        tile_layer_t layer = (strcmp(layer_str, "satellite") == 0) ? TILE_LAYER_SATELLITE : TILE_LAYER_STANDARD;
+        esp_err_t ret = tiles_prefetch(&bbox, atoi(zmin_str), atoi(zmax_str), layer);
+        if (ret == ESP_ERR_INVALID_ARG) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid region or zoom range");
+            return ESP_FAIL;
+        }
+        if (ret == ESP_ERR_INVALID_SIZE) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Region has too many tiles");
+            return ESP_FAIL;
+        }
+        if (ret == ESP_ERR_INVALID_STATE) {
+            httpd_resp_set_status(req, "409 Conflict");
+            httpd_resp_sendstr(req, "Prefetch already running");
+            return ESP_OK;
+        }
+        if (ret != ESP_OK) {
+            httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to start prefetch");
+            return ESP_FAIL;
+        }
+    } else if (req->method == HTTP_DELETE) {
+        tiles_prefetch_cancel();
+    }
+
+    char response[384];
+    size_t len = build_prefetch_json(response, sizeof(response));
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, response, len);
     return ESP_OK;
 }
 
-// URI handler definition
+/**
+ * @brief Build bulk import status JSON
+ */
+static size_t build_import_json(char *buffer, size_t buffer_size)
+{
+    tile_import_status_t st;
+    tiles_import_get_status(&st);
+
+    geo_json_builder_t builder;
+    geo_json_init(&builder, buffer, buffer_size);
+
+    geo_json_object_start(&builder);
+    geo_json_add_bool(&builder, "running", st.running);
+    geo_json_add_int64(&builder, "bytes", (int64_t)st.bytes);
+    geo_json_add_uint(&builder, "imported", st.imported);
+    geo_json_add_uint(&builder, "skipped", st.skipped);
+    geo_json_add_uint(&builder, "failed", st.failed);
+    geo_json_add_string(&builder, "result", esp_err_to_name(st.result));
+    geo_json_object_end(&builder);
+
+    return geo_json_get_length(&builder);
+}
+
+/**
+ * @brief HTTP handler for /api/tiles/import
+ *
+ * GET returns progress, POST streams an archive (tar or .pack) into the cache:
+ *   POST /api/tiles/import[?layer=satellite][&replace=1]
+ * The upload is received on an HTTP worker so the server task keeps
+ * serving tiles and chat while it lasts.
+ */
+static esp_err_t tiles_import_handler(httpd_req_t *req)
+{
+    if (req->method == HTTP_POST) {
+        esp_err_t deferred = geo_http_async_defer(req, tiles_import_handler);
+        if (deferred == ESP_OK) {
+            return ESP_OK;
+        }
+        if (deferred == ESP_ERR_NO_MEM) {
+            return geo_http_send_busy(req);
+        }
+    }
+
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    if (req->method == HTTP_POST) {
+        char query[64] = {0};
+        char layer_str[16] = {0};
+        char replace_str[8] = {0};
+
+        if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+            httpd_query_key_value(query, "layer", layer_str, sizeof(layer_str));
+            httpd_query_key_value(query, "replace", replace_str, sizeof(replace_str));
+        }
+        if (req->content_len == 0) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Empty archive");
+            return ESP_FAIL;
+        }
+
+        tile_layer_t layer = (strcmp(layer_str, "satellite") == 0) ? TILE_LAYER_SATELLITE : TILE_LAYER_STANDARD;
+        tiles_import_t *imp = NULL;
+        esp_err_t ret = tiles_import_begin(layer, strcmp(replace_str, "1") == 0, &imp);
+        if (ret == ESP_ERR_INVALID_STATE) {
+            httpd_resp_set_status(req, "409 Conflict");
+            httpd_resp_sendstr(req, "Import already running");
+            return ESP_OK;
+        }
+        if (ret != ESP_OK) {
+            httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to start import");
+            return ESP_FAIL;
+        }
+
+        uint8_t *chunk = geo_http_buf_acquire();
+        if (chunk == NULL) {
+            tiles_import_end(imp);
+            httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+            return ESP_FAIL;
+        }
+
+        // Feed the body through as it arrives; nothing is staged on the card
+        size_t remaining = req->content_len;
+        bool disconnected = false;
+        int retries = 0;
+        while (remaining > 0 && ret == ESP_OK) {
+            size_t want = remaining < GEO_HTTP_CHUNK_SIZE ? remaining : GEO_HTTP_CHUNK_SIZE;
+            int n = httpd_req_recv(req, (char *)chunk, want);
+            if (n == HTTPD_SOCK_ERR_TIMEOUT && ++retries <= IMPORT_RECV_RETRIES) {
+                continue;
+            }
+            if (n <= 0) {
+                disconnected = true;
+                break;
+            }
+            retries = 0;
+            remaining -= (size_t)n;
+            ret = tiles_import_write(imp, chunk, (size_t)n);
+        }
+        geo_http_buf_release(chunk);
+
+        ret = tiles_import_end(imp);
+        if (disconnected) {
+            ESP_LOGW(TAG, "Import upload aborted by client");
+            return ESP_FAIL;
+        }
+        if (ret == ESP_ERR_INVALID_ARG) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Not a tar or tile pack archive");
+            return ESP_FAIL;
+        }
+        if (ret == ESP_ERR_INVALID_SIZE) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Archive truncated");
+            return ESP_FAIL;
+        }
+        if (ret != ESP_OK) {
+            httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Import failed");
+            return ESP_FAIL;
+        }
+    }
+
+    char response[192];
+    size_t len = build_import_json(response, sizeof(response));
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, response, len);
+    return ESP_OK;
+}
+
+// URI handler definitions
 static const httpd_uri_t tiles_uri = {
     .uri = "/tiles/*",
     .method = HTTP_GET,
@@ -384,6 +1390,17 @@ static const httpd_uri_t tiles_uri = {
     .user_ctx = NULL
 };
 
+static const httpd_uri_t tiles_prefetch_uris[] = {
+    { .uri = "/api/tiles/prefetch", .method = HTTP_GET,    .handler = tiles_prefetch_handler, .user_ctx = NULL },
+    { .uri = "/api/tiles/prefetch", .method = HTTP_POST,   .handler = tiles_prefetch_handler, .user_ctx = NULL },
+    { .uri = "/api/tiles/prefetch", .method = HTTP_DELETE, .handler = tiles_prefetch_handler, .user_ctx = NULL },
+};
+
+static const httpd_uri_t tiles_import_uris[] = {
+    { .uri = "/api/tiles/import", .method = HTTP_GET,  .handler = tiles_import_handler, .user_ctx = NULL },
+    { .uri = "/api/tiles/import", .method = HTTP_POST, .handler = tiles_import_handler, .user_ctx = NULL },
+};
+
 esp_err_t tiles_register_http_handler(httpd_handle_t server)
 {
     if (server == NULL) {
@@ -395,13 +1412,29 @@ esp_err_t tiles_register_http_handler(httpd_handle_t server)
         return ESP_ERR_INVALID_STATE;
     }
 
-    esp_err_t ret = httpd_register_uri_handler(server, &tiles_uri);
+    esp_err_t ret = geo_http_register_uri(server, &tiles_uri);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to register tile handler: %s", esp_err_to_name(ret));
         return ret;
     }
 
-    ESP_LOGI(TAG, "Tile HTTP handler registered at /tiles/*");
+    for (size_t i = 0; i < sizeof(tiles_prefetch_uris) / sizeof(tiles_prefetch_uris[0]); i++) {
+        ret = geo_http_register_uri(server, &tiles_prefetch_uris[i]);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to register prefetch handler: %s", esp_err_to_name(ret));
+            return ret;
+        }
+    }
+
+    for (size_t i = 0; i < sizeof(tiles_import_uris) / sizeof(tiles_import_uris[0]); i++) {
+        ret = geo_http_register_uri(server, &tiles_import_uris[i]);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to register import handler: %s", esp_err_to_name(ret));
+            return ret;
+        }
+    }
+
+    ESP_LOGI(TAG, "Tile HTTP handlers registered at /tiles/*, /api/tiles/prefetch and /api/tiles/import");
     return ESP_OK;
 }
 
@@ -414,10 +1447,25 @@ esp_err_t tiles_init(void) { return ESP_ERR_NOT_SUPPORTED; }
 bool tiles_is_available(void) { return false; }
 esp_err_t tiles_get(int z, int x, int y, tile_layer_t layer,
                     uint8_t *buffer, size_t buffer_size, size_t *tile_size) { return ESP_ERR_NOT_SUPPORTED; }
+esp_err_t tiles_lookup(int z, int x, int y, tile_layer_t layer,
+                       uint8_t *buffer, size_t buffer_size, size_t *tile_size) { return ESP_ERR_NOT_SUPPORTED; }
+esp_err_t tiles_fetch(int z, int x, int y, tile_layer_t layer, uint32_t wait_ms) { return ESP_ERR_NOT_SUPPORTED; }
+bool tiles_contains(int z, int x, int y, tile_layer_t layer) { return false; }
+esp_err_t tiles_prefetch(const tile_bbox_t *bbox, int zmin, int zmax, tile_layer_t layer) { return ESP_ERR_NOT_SUPPORTED; }
+esp_err_t tiles_prefetch_init(void) { return ESP_ERR_NOT_SUPPORTED; }
+esp_err_t tiles_prefetch_cancel(void) { return ESP_ERR_NOT_SUPPORTED; }
+esp_err_t tiles_prefetch_get_status(tile_prefetch_status_t *status) { return ESP_ERR_NOT_SUPPORTED; }
 esp_err_t tiles_register_http_handler(httpd_handle_t server) { return ESP_ERR_NOT_SUPPORTED; }
 esp_err_t tiles_get_stats(tile_cache_stats_t *stats) { return ESP_ERR_NOT_SUPPORTED; }
 esp_err_t tiles_clear_cache(void) { return ESP_ERR_NOT_SUPPORTED; }
 uint32_t tiles_get_cache_size(void) { return 0; }
 uint32_t tiles_get_cache_count(void) { return 0; }
+uint64_t tiles_get_disk_usage(void) { return 0; }
+esp_err_t tiles_import_legacy(bool remove_source, uint32_t *imported) { return ESP_ERR_NOT_SUPPORTED; }
+bool tiles_has_legacy_cache(void) { return false; }
+esp_err_t tiles_import_begin(tile_layer_t layer, bool replace, tiles_import_t **out_import) { return ESP_ERR_NOT_SUPPORTED; }
+esp_err_t tiles_import_write(tiles_import_t *import, const void *data, size_t len) { return ESP_ERR_NOT_SUPPORTED; }
+esp_err_t tiles_import_end(tiles_import_t *import) { return ESP_ERR_NOT_SUPPORTED; }
+esp_err_t tiles_import_get_status(tile_import_status_t *status) { return ESP_ERR_NOT_SUPPORTED; }
 
 #endif // CONFIG_GEOGRAM_BOARD_EPAPER_1IN54
@@ -3,7 +3,13 @@
  * @brief Tile cache manager for Geogram Station
  *
  * Provides tile caching functionality:
- * - Stores tiles on SD card at /sdcard/tiles/{layer}/{z}/{x}/{y}.png
+ * - Stores tiles on SD card in one packed archive per layer
+ *   (/sdcard/tiles/{layer}.pack + /sdcard/tiles/{layer}.idx)
+ * - Imports the legacy /sdcard/tiles/{layer}/{z}/{x}/{y}.png layout
+ * - Bulk-imports uploaded tar or .pack archives
+ * - Keeps recently served tiles in a PSRAM LRU cache
+ * - Evicts least recently used tiles to stay within a card-space quota
+ * - Asks the parent mesh node on a miss (CONFIG_GEOGRAM_TILES_MESH_PEERS)
  * - Downloads tiles from OSM (standard) or Esri (satellite)
  * - Serves tiles via HTTP API
  */
@@ -15,11 +21,15 @@
 #include "esp_http_server.h"
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// Files uploaded into this directory over FTP are imported, not stored
+#define TILES_IMPORT_DIR    "/sdcard/tiles/import"
+
 /**
  * @brief Tile layer type
  */
@@ -32,17 +42,71 @@ typedef enum {
  * @brief Tile cache statistics
  */
 typedef struct {
-    uint32_t cache_hits;        // Tiles served from cache
+    uint32_t cache_hits;        // Tiles served from cache (RAM or SD)
     uint32_t cache_misses;      // Tiles fetched from remote
+    uint32_t ram_hits;          // Tiles served from the PSRAM cache
+    uint32_t ram_misses;        // PSRAM cache lookups that went to SD or remote
+    uint32_t ram_cache_bytes;   // PSRAM cache usage in bytes
+    uint32_t coalesced;         // Requests that joined an in-flight download
+    uint32_t peer_hits;         // Misses served by the parent mesh node
+    uint32_t not_modified;      // Revalidations answered with 304
     uint32_t download_errors;   // Failed downloads
-    uint32_t total_tiles;       // Total tiles in cache (estimated)
-    uint32_t cache_size_bytes;  // Total cache size in bytes (estimated)
+    uint32_t total_tiles;       // Total tiles in cache
+    uint32_t cache_size_bytes;  // Total cached tile payload in bytes
+    uint32_t evicted;           // Tiles evicted to stay within the quota
+    uint64_t disk_bytes;        // Card space used by the archives
+    uint64_t quota_bytes;       // Card space limit (0 = unlimited)
 } tile_cache_stats_t;
 
+/**
+ * @brief Geographic bounding box (degrees, WGS84)
+ */
+typedef struct {
+    double min_lat;
+    double min_lon;
+    double max_lat;
+    double max_lon;
+} tile_bbox_t;
+
+/**
+ * @brief Region prefetch progress
+ */
+typedef struct {
+    bool running;               // Job in progress
+    tile_layer_t layer;         // Layer being prefetched
+    int zmin;                   // First zoom level
+    int zmax;                   // Last zoom level
+    int z;                      // Cursor: current tile
+    int x;
+    int y;
+    uint32_t total;             // Tiles in the region across all zoom levels
+    uint32_t done;              // Tiles visited so far
+    uint32_t fetched;           // Tiles downloaded
+    uint32_t skipped;           // Tiles already cached
+    uint32_t failed;            // Failed downloads
+} tile_prefetch_status_t;
+
+/**
+ * @brief Bulk import progress
+ */
+typedef struct {
+    bool running;               // Archive being received
+    uint64_t bytes;             // Archive bytes received
+    uint32_t imported;          // Tiles written to the cache
+    uint32_t skipped;           // Tiles already cached and non-tile entries
+    uint32_t failed;            // Entries with invalid tile coordinates
+    esp_err_t result;           // Outcome of the last finished import
+} tile_import_status_t;
+
+/**
+ * @brief Opaque bulk import handle
+ */
+typedef struct tiles_import tiles_import_t;
+
 /**
  * @brief Initialize tile cache
  *
- * Creates necessary directories on SD card.
+ * Opens the packed archive of each layer and loads its index.
  * Must be called after sdcard_init().
  *
  * @return ESP_OK on success, error if SD card not available
@@ -56,6 +120,45 @@ esp_err_t tiles_init(void);
  */
 bool tiles_is_available(void);
 
+/**
+ * @brief Get a tile from cache (RAM or SD card) without downloading
+ *
+ * @param z Zoom level (0-18)
+ * @param x X tile coordinate
+ * @param y Y tile coordinate
+ * @param layer Tile layer (standard or satellite)
+ * @param buffer Buffer to store tile data
+ * @param buffer_size Size of buffer
+ * @param tile_size Actual tile size returned
+ * @return ESP_OK on hit, ESP_ERR_NOT_FOUND if not cached
+ */
+esp_err_t tiles_lookup(int z, int x, int y, tile_layer_t layer,
+                       uint8_t *buffer, size_t buffer_size, size_t *tile_size);
+
+/**
+ * @brief Queue a tile download on the fetch workers
+ *
+ * Concurrent requests for the same tile share one download.
+ *
+ * @param z Zoom level (0-18)
+ * @param x X tile coordinate
+ * @param y Y tile coordinate
+ * @param layer Tile layer (standard or satellite)
+ * @param wait_ms How long to wait for the download (0 = don't wait)
+ * @return ESP_OK once the tile is cached, ESP_ERR_TIMEOUT if still
+ *         pending, ESP_ERR_NO_MEM if the fetch queue is full
+ */
+esp_err_t tiles_fetch(int z, int x, int y, tile_layer_t layer, uint32_t wait_ms);
+
+/**
+ * @brief Check if a tile is cached on the SD card
+ *
+ * Index lookup only, no data is read.
+ *
+ * @return true if cached
+ */
+bool tiles_contains(int z, int x, int y, tile_layer_t layer);
+
 /**
  * @brief Get a tile from cache or download it
  *
@@ -93,26 +196,151 @@ esp_err_t tiles_get_stats(tile_cache_stats_t *stats);
 /**
  * @brief Clear tile cache
  *
- * Removes all cached tiles from SD card.
+ * Empties the packed archives of all layers and the RAM cache.
+ * Legacy per-file directories are left alone (see tiles_import_legacy()).
  *
  * @return ESP_OK on success
  */
 esp_err_t tiles_clear_cache(void);
 
 /**
- * @brief Get estimated cache size in bytes
+ * @brief Get cache size in bytes
  *
- * @return Cache size in bytes
+ * @return Payload bytes of all cached tiles
  */
 uint32_t tiles_get_cache_size(void);
 
 /**
- * @brief Get estimated tile count
+ * @brief Get card space used by the tile archives
+ *
+ * Includes record headers and space of evicted tiles not yet compacted.
+ * This is the figure checked against CONFIG_GEOGRAM_TILES_QUOTA_MB.
+ *
+ * @return Bytes on the SD card
+ */
+uint64_t tiles_get_disk_usage(void);
+
+/**
+ * @brief Get tile count
  *
  * @return Number of cached tiles
  */
 uint32_t tiles_get_cache_count(void);
 
+/**
+ * @brief Import legacy per-file tile cache into the packed archives
+ *
+ * Walks /sdcard/tiles/{layer}/{z}/{x}/{y}.png and appends every tile
+ * that is not already packed. Tiles missing from the archive are also
+ * migrated one by one as they are requested, so this is optional.
+ *
+ * @param remove_source Delete legacy files and directories after import
+ * @param imported Number of tiles imported (may be NULL)
+ * @return ESP_OK on success
+ */
+esp_err_t tiles_import_legacy(bool remove_source, uint32_t *imported);
+
+/**
+ * @brief Check if a legacy per-file tile directory is still present
+ *
+ * @return true if /sdcard/tiles/standard or /sdcard/tiles/satellite exists
+ */
+bool tiles_has_legacy_cache(void);
+
+/**
+ * @brief Start a region prefetch job
+ *
+ * Walks every tile of the bounding box from zmin to zmax, skipping tiles
+ * already cached and downloading the rest at most
+ * CONFIG_GEOGRAM_TILES_PREFETCH_RATE tiles per second. The cursor is
+ * saved to the SD card, so the job resumes after a reboot.
+ *
+ * @param bbox Region to cache
+ * @param zmin First zoom level (0-18)
+ * @param zmax Last zoom level (0-18)
+ * @param layer Tile layer
+ * @return ESP_OK if started, ESP_ERR_INVALID_ARG for a bad region or
+ *         zoom range, ESP_ERR_INVALID_SIZE if the region has more than
+ *         CONFIG_GEOGRAM_TILES_PREFETCH_MAX_TILES tiles,
+ *         ESP_ERR_INVALID_STATE if a job is running
+ */
+esp_err_t tiles_prefetch(const tile_bbox_t *bbox, int zmin, int zmax, tile_layer_t layer);
+
+/**
+ * @brief Resume a prefetch job saved before reboot
+ *
+ * Called from tiles_init().
+ *
+ * @return ESP_OK on success (also when there is nothing to resume)
+ */
+esp_err_t tiles_prefetch_init(void);
+
+/**
+ * @brief Cancel the running prefetch job
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if none is running
+ */
+esp_err_t tiles_prefetch_cancel(void);
+
+/**
+ * @brief Get prefetch progress
+ *
+ * @param status Pointer to status structure to fill
+ * @return ESP_OK on success
+ */
+esp_err_t tiles_prefetch_get_status(tile_prefetch_status_t *status);
+
+/**
+ * @brief Start a bulk import
+ *
+ * The archive is fed in with tiles_import_write() as it arrives and may
+ * be either:
+ * - a tar archive of {z}/{x}/{y}.png files; a standard/ or satellite/
+ *   directory anywhere above {z} selects the layer
+ * - a tile pack data file ({layer}.pack) copied from another station
+ *
+ * Tiles go straight into the layer archives through large sequential
+ * writes, with one index update per write. Only one import runs at a time.
+ *
+ * @param layer Layer for tiles whose path does not name one
+ * @param replace Overwrite tiles already cached (otherwise they are skipped)
+ * @param out_import Receives the import handle
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if an import is running
+ *         or the cache is not initialized
+ */
+esp_err_t tiles_import_begin(tile_layer_t layer, bool replace, tiles_import_t **out_import);
+
+/**
+ * @brief Feed the next piece of the archive
+ *
+ * @param import Import handle
+ * @param data Archive bytes
+ * @param len Number of bytes
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the stream is not a
+ *         supported archive, ESP_FAIL on card write errors
+ */
+esp_err_t tiles_import_write(tiles_import_t *import, const void *data, size_t len);
+
+/**
+ * @brief Finish an import and free its handle
+ *
+ * Tiles received so far stay in the cache even when the import failed
+ * or the archive was cut short.
+ *
+ * @param import Import handle (may be NULL)
+ * @return ESP_OK if the archive was complete, ESP_ERR_INVALID_SIZE if it
+ *         ended inside an entry, or the first error of the import
+ */
+esp_err_t tiles_import_end(tiles_import_t *import);
+
+/**
+ * @brief Get bulk import progress
+ *
+ * @param status Pointer to status structure to fill
+ * @return ESP_OK on success
+ */
+esp_err_t tiles_import_get_status(tile_import_status_t *status);
+
 #ifdef __cplusplus
 }
 #endif
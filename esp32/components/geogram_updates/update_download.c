@@ -0,0 +1,427 @@
+/**
+ * @file update_download.c
+ * @brief Resumable, integrity-checked release asset downloads
+ */
+
+#include "sdkconfig.h"
+
+#if CONFIG_GEOGRAM_BOARD_EPAPER_1IN54
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "update_download.h"
+#include "sdcard.h"
+#include "http_client_async.h"
+#include "esp_log.h"
+#include "cJSON.h"
+#include "mbedtls/sha256.h"
+
+static const char *TAG = "update_dl";
+
+// SD card write buffer for downloads
+#define DOWNLOAD_WRITE_BUFFER   (16 * 1024)
+
+// Progress is made durable (fsync + sidecar) this often
+#define DOWNLOAD_SYNC_BYTES     (1024 * 1024)
+
+// Time without progress before a transfer is dropped
+#define DOWNLOAD_TIMEOUT_MS     60000
+
+#define DOWNLOAD_READ_CHUNK     4096
+#define DOWNLOAD_ETAG_LEN       96
+
+/**
+ * @brief Sidecar contents
+ */
+typedef struct {
+    char url[256];
+    char etag[DOWNLOAD_ETAG_LEN];   // Validator sent as If-Range when resuming
+    char sha256[65];
+    uint64_t size;                  // Total size (0 = unknown yet)
+    uint64_t synced;                // Bytes flushed to the card
+} download_state_t;
+
+/**
+ * @brief One download in progress (also the HTTP sink context)
+ */
+typedef struct {
+    FILE *file;
+    const char *state_path;
+    download_state_t state;
+    mbedtls_sha256_context sha;
+    bool hash_at_end;               // Resumed: hash the whole file once complete
+    uint64_t offset;                // Bytes in the partial file
+    char etag[DOWNLOAD_ETAG_LEN];
+    char content_range[64];
+} download_t;
+
+static bool state_load(const char *path, download_state_t *st)
+{
+    char buf[512];
+    size_t len = 0;
+    if (sdcard_read_file(path, buf, sizeof(buf) - 1, &len) != ESP_OK) {
+        return false;
+    }
+    buf[len] = '\0';
+
+    cJSON *root = cJSON_Parse(buf);
+    if (root == NULL) {
+        return false;
+    }
+
+    cJSON *item;
+    if ((item = cJSON_GetObjectItem(root, "url")) && cJSON_IsString(item)) {
+        strlcpy(st->url, item->valuestring, sizeof(st->url));
+    }
+    if ((item = cJSON_GetObjectItem(root, "etag")) && cJSON_IsString(item)) {
+        strlcpy(st->etag, item->valuestring, sizeof(st->etag));
+    }
+    if ((item = cJSON_GetObjectItem(root, "sha256")) && cJSON_IsString(item)) {
+        strlcpy(st->sha256, item->valuestring, sizeof(st->sha256));
+    }
+    if ((item = cJSON_GetObjectItem(root, "size")) && cJSON_IsNumber(item)) {
+        st->size = (uint64_t)item->valuedouble;
+    }
+    if ((item = cJSON_GetObjectItem(root, "synced")) && cJSON_IsNumber(item)) {
+        st->synced = (uint64_t)item->valuedouble;
+    }
+    cJSON_Delete(root);
+    return true;
+}
+
+static esp_err_t state_save(const char *path, const download_state_t *st)
+{
+    cJSON *root = cJSON_CreateObject();
+    if (root == NULL) return ESP_ERR_NO_MEM;
+
+    cJSON_AddStringToObject(root, "url", st->url);
+    cJSON_AddStringToObject(root, "etag", st->etag);
+    cJSON_AddStringToObject(root, "sha256", st->sha256);
+    cJSON_AddNumberToObject(root, "size", (double)st->size);
+    cJSON_AddNumberToObject(root, "synced", (double)st->synced);
+
+    char *json_str = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    if (json_str == NULL) return ESP_ERR_NO_MEM;
+
+    esp_err_t ret = sdcard_write_file(path, json_str, strlen(json_str));
+    free(json_str);
+    return ret;
+}
+
+/**
+ * @brief Make everything received so far durable and record it
+ */
+static esp_err_t checkpoint(download_t *dl)
+{
+    if (fflush(dl->file) != 0 || fsync(fileno(dl->file)) != 0) {
+        ESP_LOGE(TAG, "SD card write failed at %" PRIu64 " bytes", dl->offset);
+        return ESP_FAIL;
+    }
+    dl->state.synced = dl->offset;
+    return state_save(dl->state_path, &dl->state);
+}
+
+/**
+ * @brief Discard the partial file and start from byte 0
+ */
+static esp_err_t restart(download_t *dl)
+{
+    fflush(dl->file);
+    if (ftruncate(fileno(dl->file), 0) != 0 || fseek(dl->file, 0, SEEK_SET) != 0) {
+        return ESP_FAIL;
+    }
+    mbedtls_sha256_starts(&dl->sha, 0);
+    dl->hash_at_end = false;
+    dl->offset = 0;
+    dl->state.synced = 0;
+    dl->state.size = 0;
+    return ESP_OK;
+}
+
+/**
+ * @brief Hash the first `len` bytes on the card
+ */
+static esp_err_t hash_existing(download_t *dl, uint64_t len)
+{
+    uint8_t *buf = malloc(DOWNLOAD_READ_CHUNK);
+    if (buf == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = ESP_OK;
+    fseek(dl->file, 0, SEEK_SET);
+    for (uint64_t done = 0; done < len; ) {
+        size_t want = len - done > DOWNLOAD_READ_CHUNK ? DOWNLOAD_READ_CHUNK : (size_t)(len - done);
+        size_t n = fread(buf, 1, want, dl->file);
+        if (n != want) {
+            ret = ESP_FAIL;
+            break;
+        }
+        mbedtls_sha256_update(&dl->sha, buf, n);
+        done += n;
+    }
+    free(buf);
+
+    fseek(dl->file, (long)len, SEEK_SET);
+    return ret;
+}
+
+static void download_on_header(void *ctx, const char *name, const char *value)
+{
+    download_t *dl = (download_t *)ctx;
+    if (strcasecmp(name, "ETag") == 0) {
+        strlcpy(dl->etag, value, sizeof(dl->etag));
+    } else if (strcasecmp(name, "Content-Range") == 0) {
+        strlcpy(dl->content_range, value, sizeof(dl->content_range));
+    }
+}
+
+static esp_err_t download_on_headers(void *ctx, int status_code, int64_t content_length)
+{
+    download_t *dl = (download_t *)ctx;
+
+    if (status_code == 206) {
+        // "bytes first-last/total"
+        unsigned long long first = 0, last = 0, total = 0;
+        int fields = sscanf(dl->content_range, "bytes %llu-%llu/%llu", &first, &last, &total);
+        if (fields < 2 || first != dl->offset) {
+            ESP_LOGE(TAG, "Unexpected Content-Range \"%s\" at %" PRIu64,
+                     dl->content_range, dl->offset);
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+        dl->state.size = fields == 3 ? total : 0;
+    } else if (status_code == 200) {
+        if (dl->offset > 0) {
+            // No range support, or the file changed since the last attempt
+            ESP_LOGW(TAG, "Server sent the whole file, restarting");
+            if (restart(dl) != ESP_OK) {
+                return ESP_FAIL;
+            }
+        }
+        dl->state.size = content_length > 0 ? (uint64_t)content_length : 0;
+    } else {
+        return ESP_OK;
+    }
+
+    strlcpy(dl->state.etag, dl->etag, sizeof(dl->state.etag));
+    return state_save(dl->state_path, &dl->state);
+}
+
+static esp_err_t download_on_data(void *ctx, const uint8_t *data, size_t len)
+{
+    download_t *dl = (download_t *)ctx;
+
+    if (fwrite(data, 1, len, dl->file) != len) {
+        ESP_LOGE(TAG, "SD card write failed at %" PRIu64 " bytes", dl->offset);
+        return ESP_FAIL;
+    }
+    if (!dl->hash_at_end) {
+        mbedtls_sha256_update(&dl->sha, data, len);
+    }
+    dl->offset += len;
+
+    if (dl->offset - dl->state.synced >= DOWNLOAD_SYNC_BYTES) {
+        return checkpoint(dl);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Fetch the rest of the partial file
+ */
+static esp_err_t fetch_remaining(download_t *dl)
+{
+    char range[40];
+    http_client_header_t headers[2];
+    size_t header_count = 0;
+
+    if (dl->offset > 0) {
+        snprintf(range, sizeof(range), "bytes=%" PRIu64 "-", dl->offset);
+        headers[header_count++] = (http_client_header_t){ "Range", range };
+        if (dl->state.etag[0] != '\0') {
+            // Get the whole file instead if it changed in between
+            headers[header_count++] = (http_client_header_t){ "If-Range", dl->state.etag };
+        }
+        ESP_LOGI(TAG, "Resuming at %" PRIu64 " of %" PRIu64 " bytes",
+                 dl->offset, dl->state.size);
+    }
+
+    http_client_request_t request = http_client_default_config();
+    request.url = dl->state.url;
+    request.timeout_ms = DOWNLOAD_TIMEOUT_MS;
+    request.user_agent = "Geogram-ESP32/1.0";
+    request.priority = HTTP_CLIENT_PRIORITY_LOW;
+    request.headers = headers;
+    request.header_count = header_count;
+
+    const http_client_sink_t sink = {
+        .on_header = download_on_header,
+        .on_headers = download_on_headers,
+        .on_data = download_on_data,
+        .ctx = dl,
+    };
+
+    int status_code = 0;
+    esp_err_t ret = http_client_get_stream(&request, &sink, &status_code);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    if (status_code == 416 && dl->state.size > 0 && dl->offset == dl->state.size) {
+        // Everything was already here
+        return ESP_OK;
+    }
+    if (status_code == 416) {
+        ESP_LOGW(TAG, "Range not satisfiable, restarting");
+        restart(dl);
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    if (status_code != 200 && status_code != 206) {
+        ESP_LOGE(TAG, "HTTP error %d", status_code);
+        return ESP_FAIL;
+    }
+    if (dl->state.size > 0 && dl->offset != dl->state.size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return ESP_OK;
+}
+
+esp_err_t update_download(const char *url, const char *name, const char *sha256,
+                          const char *dest_path, size_t *downloaded_size)
+{
+    if (url == NULL || name == NULL || dest_path == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (sha256 == NULL) {
+        sha256 = "";
+    }
+
+    sdcard_mkdir(UPDATES_INCOMING_DIR);
+
+    char part_path[192];
+    char state_path[192];
+    snprintf(part_path, sizeof(part_path), "%s/%s.part", UPDATES_INCOMING_DIR, name);
+    snprintf(state_path, sizeof(state_path), "%s/%s.json", UPDATES_INCOMING_DIR, name);
+
+    download_t dl = { .state_path = state_path };
+
+    // A partial file only counts if it belongs to the same asset
+    if (!state_load(state_path, &dl.state) ||
+        strcmp(dl.state.url, url) != 0 || strcasecmp(dl.state.sha256, sha256) != 0) {
+        memset(&dl.state, 0, sizeof(dl.state));
+        strlcpy(dl.state.url, url, sizeof(dl.state.url));
+        strlcpy(dl.state.sha256, sha256, sizeof(dl.state.sha256));
+        remove(part_path);
+    }
+
+    dl.file = fopen(part_path, "r+b");
+    if (dl.file == NULL) {
+        dl.file = fopen(part_path, "w+b");
+    }
+    if (dl.file == NULL) {
+        ESP_LOGE(TAG, "Failed to create %s", part_path);
+        return ESP_FAIL;
+    }
+    setvbuf(dl.file, NULL, _IOFBF, DOWNLOAD_WRITE_BUFFER);
+
+    // Bytes past the last checkpoint may not have reached the card intact
+    struct stat st = {0};
+    uint64_t resume = 0;
+    if (fstat(fileno(dl.file), &st) == 0) {
+        resume = (uint64_t)st.st_size < dl.state.synced ? (uint64_t)st.st_size : dl.state.synced;
+    }
+    if ((uint64_t)st.st_size > resume) {
+        ftruncate(fileno(dl.file), (off_t)resume);
+    }
+
+    // A resumed file is hashed in one pass once complete rather than
+    // re-read on every attempt
+    mbedtls_sha256_init(&dl.sha);
+    mbedtls_sha256_starts(&dl.sha, 0);
+    esp_err_t ret = ESP_OK;
+    if (fseek(dl.file, (long)resume, SEEK_SET) == 0) {
+        dl.offset = resume;
+        dl.hash_at_end = resume > 0;
+    } else {
+        ret = restart(&dl);
+    }
+
+    if (ret == ESP_OK && !(dl.state.size > 0 && dl.offset == dl.state.size)) {
+        ret = fetch_remaining(&dl);
+    }
+
+    // Keep whatever arrived for the next attempt
+    esp_err_t sync_ret = checkpoint(&dl);
+    if (ret == ESP_OK) {
+        ret = sync_ret;
+    }
+    if (ret == ESP_OK && dl.hash_at_end) {
+        ret = hash_existing(&dl, dl.offset);
+    }
+    fclose(dl.file);
+
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "%s: %s, %" PRIu64 " bytes kept", name, esp_err_to_name(ret), dl.offset);
+        mbedtls_sha256_free(&dl.sha);
+        return ret;
+    }
+
+    uint8_t digest[32];
+    char hex[65];
+    mbedtls_sha256_finish(&dl.sha, digest);
+    mbedtls_sha256_free(&dl.sha);
+    for (int i = 0; i < 32; i++) {
+        snprintf(hex + i * 2, 3, "%02x", digest[i]);
+    }
+
+    if (sha256[0] != '\0' && strcasecmp(hex, sha256) != 0) {
+        ESP_LOGE(TAG, "%s: SHA-256 mismatch (got %s)", name, hex);
+        remove(part_path);
+        remove(state_path);
+        return ESP_ERR_INVALID_CRC;
+    }
+    if (sha256[0] == '\0') {
+        ESP_LOGW(TAG, "%s: no checksum published, stored unverified", name);
+    }
+
+    remove(dest_path);
+    if (rename(part_path, dest_path) != 0) {
+        ESP_LOGE(TAG, "Failed to move %s to %s", part_path, dest_path);
+        return ESP_FAIL;
+    }
+    remove(state_path);
+
+    *downloaded_size = (size_t)dl.offset;
+    ESP_LOGI(TAG, "Downloaded %" PRIu64 " bytes to %s (sha256 %.16s...)", dl.offset, dest_path, hex);
+    return ESP_OK;
+}
+
+void update_download_purge(const char *keep_prefix)
+{
+    DIR *dir = opendir(UPDATES_INCOMING_DIR);
+    if (dir == NULL) {
+        return;
+    }
+
+    size_t prefix_len = strlen(keep_prefix);
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.' || strncmp(entry->d_name, keep_prefix, prefix_len) == 0) {
+            continue;
+        }
+        char path[320];
+        snprintf(path, sizeof(path), "%s/%s", UPDATES_INCOMING_DIR, entry->d_name);
+        ESP_LOGI(TAG, "Removing stale partial download %s", entry->d_name);
+        remove(path);
+    }
+    closedir(dir);
+}
+
+#endif // CONFIG_GEOGRAM_BOARD_EPAPER_1IN54
@@ -0,0 +1,49 @@
+/**
+ * @file update_download.h
+ * @brief Resumable, integrity-checked release asset downloads
+ *
+ * Assets are downloaded into UPDATES_INCOMING_DIR as {name}.part with a
+ * {name}.json sidecar recording the source URL, the server's ETag, the
+ * expected SHA-256 and how many bytes are safely on the card. An
+ * interrupted download continues from there with a Range request on the
+ * next attempt. Complete files are checked against the SHA-256 and then
+ * renamed into place, so a mirrored asset is never partial or corrupt.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Partial downloads and their sidecar files
+#define UPDATES_INCOMING_DIR    "/sdcard/updates/.incoming"
+
+/**
+ * @brief Download or resume one asset
+ *
+ * @param url Source URL
+ * @param name Unique name of the partial file in UPDATES_INCOMING_DIR
+ * @param sha256 Expected SHA-256 as hex (NULL or "" to skip the check)
+ * @param dest_path Final location of the verified file
+ * @param downloaded_size Receives the file size on success
+ * @return ESP_OK once dest_path is complete, ESP_ERR_INVALID_CRC if the
+ *         checksum did not match (the partial file is discarded), or the
+ *         transfer error (progress is kept for the next attempt)
+ */
+esp_err_t update_download(const char *url, const char *name, const char *sha256,
+                          const char *dest_path, size_t *downloaded_size);
+
+/**
+ * @brief Delete partial downloads whose name does not start with a prefix
+ *
+ * @param keep_prefix Name prefix of downloads to keep (e.g. "1.6.24_")
+ */
+void update_download_purge(const char *keep_prefix);
+
+#ifdef __cplusplus
+}
+#endif
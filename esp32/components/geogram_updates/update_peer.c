@@ -0,0 +1,90 @@
+/**
+ * @file update_peer.c
+ * @brief Release distribution over the mesh
+ */
+
+#include "sdkconfig.h"
+
+#if CONFIG_GEOGRAM_BOARD_EPAPER_1IN54 && CONFIG_GEOGRAM_UPDATES_MESH_PEERS
+
+#include <stdio.h>
+#include <string.h>
+#include "update_peer.h"
+#include "mesh_bsp.h"
+#include "esp_log.h"
+#include "esp_mac.h"
+
+static const char *TAG = "update_peer";
+
+#define ANNOUNCE_MAGIC      0x54445055  // "UPDT"
+#define ANNOUNCE_VERSION    1
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;             // ANNOUNCE_MAGIC
+    uint8_t version;            // ANNOUNCE_VERSION
+    uint8_t reserved[3];
+    char release[32];           // Release version, NUL-terminated
+} announce_packet_t;
+
+static update_peer_announce_cb_t s_on_announce = NULL;
+
+static void announce_handler(const uint8_t *src_mac, const void *data, size_t len)
+{
+    const announce_packet_t *pkt = (const announce_packet_t *)data;
+    if (len < sizeof(announce_packet_t) || pkt->magic != ANNOUNCE_MAGIC ||
+        pkt->version != ANNOUNCE_VERSION) {
+        return;
+    }
+
+    char release[sizeof(pkt->release)];
+    memcpy(release, pkt->release, sizeof(release));
+    release[sizeof(release) - 1] = '\0';
+
+    ESP_LOGI(TAG, "Release %s announced by " MACSTR, release, MAC2STR(src_mac));
+    if (s_on_announce && release[0] != '\0') {
+        s_on_announce(release);
+    }
+}
+
+esp_err_t update_peer_init(update_peer_announce_cb_t on_announce)
+{
+    if (s_on_announce != NULL) {
+        return ESP_OK;
+    }
+    s_on_announce = on_announce;
+    return geogram_mesh_add_packet_handler(announce_handler);
+}
+
+bool update_peer_available(void)
+{
+    uint32_t ip;
+    return geogram_mesh_has_parent() && geogram_mesh_get_parent_ip(&ip) == ESP_OK;
+}
+
+esp_err_t update_peer_parent_url(char *url, size_t url_size)
+{
+    uint32_t ip;
+    if (!geogram_mesh_has_parent() || geogram_mesh_get_parent_ip(&ip) != ESP_OK) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const uint8_t *a = (const uint8_t *)&ip;
+    snprintf(url, url_size, "http://%u.%u.%u.%u", a[0], a[1], a[2], a[3]);
+    return ESP_OK;
+}
+
+void update_peer_announce(const char *version)
+{
+    announce_packet_t pkt = {
+        .magic = ANNOUNCE_MAGIC,
+        .version = ANNOUNCE_VERSION,
+    };
+    strlcpy(pkt.release, version, sizeof(pkt.release));
+
+    size_t sent = geogram_mesh_broadcast(&pkt, sizeof(pkt));
+    if (sent > 0) {
+        ESP_LOGI(TAG, "Announced release %s to %zu nodes", version, sent);
+    }
+}
+
+#endif // CONFIG_GEOGRAM_BOARD_EPAPER_1IN54 && CONFIG_GEOGRAM_UPDATES_MESH_PEERS
@@ -0,0 +1,64 @@
+/**
+ * @file update_peer.h
+ * @brief Release distribution over the mesh
+ *
+ * Only the mesh root polls GitHub and downloads release assets. Every
+ * other node mirrors the release of its parent node through the parent's
+ * /api/updates/latest and /updates/... endpoints, so each asset crosses
+ * the uplink once and then travels down the tree one hop at a time.
+ * A node that completes a release announces it with a small mesh packet;
+ * nodes below it check their parent right away instead of waiting for
+ * the next poll.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Called when another node announces a complete release
+ *
+ * @param version Announced version
+ */
+typedef void (*update_peer_announce_cb_t)(const char *version);
+
+/**
+ * @brief Listen for release announcements from other nodes
+ *
+ * @param on_announce Called (in the mesh receive task) for each announcement
+ * @return ESP_OK on success
+ */
+esp_err_t update_peer_init(update_peer_announce_cb_t on_announce);
+
+/**
+ * @brief Check whether releases should come from the parent node
+ *
+ * @return true if this node has a reachable parent (i.e. is not the root)
+ */
+bool update_peer_available(void);
+
+/**
+ * @brief Get the base URL of the parent node's HTTP server
+ *
+ * @param url Buffer for "http://a.b.c.d"
+ * @param url_size Buffer size
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE without a parent
+ */
+esp_err_t update_peer_parent_url(char *url, size_t url_size);
+
+/**
+ * @brief Tell the other nodes that a release is complete on this node
+ *
+ * @param version Release version
+ */
+void update_peer_announce(const char *version);
+
+#ifdef __cplusplus
+}
+#endif
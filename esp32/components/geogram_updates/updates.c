@@ -8,13 +8,22 @@
 #if CONFIG_GEOGRAM_BOARD_EPAPER_1IN54
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <sys/stat.h>
 #include <dirent.h>
 #include "updates.h"
 #include "sdcard.h"
 #include "http_client_async.h"
+#include "update_download.h"
+#include "update_peer.h"
+#include "geogram_http_util.h"
+#include "geogram_http_async.h"
+#include "geogram_http_metrics.h"
+#include "geogram_metrics.h"
 #include "json_utils.h"
+#include "json_stream.h"
 #include "esp_log.h"
 #include "cJSON.h"
 #include "freertos/FreeRTOS.h"
@@ -29,12 +38,15 @@ static const char *TAG = "updates";
 #define UPDATES_BASE_PATH   "/sdcard/updates"
 #define RELEASE_JSON_PATH   "/sdcard/updates/release.json"
 
-// Download buffer size
-#define DOWNLOAD_BUFFER_SIZE    (64 * 1024)
-
-// Max response size for GitHub API
+// Max size of the cached release.json
 #define API_RESPONSE_SIZE       (24 * 1024)
 
+// Longest ETag / Last-Modified value kept
+#define VALIDATOR_LEN           96
+
+// Release info of the parent node
+#define PEER_LATEST_PATH        "/api/updates/latest"
+
 // Polling task
 static TaskHandle_t s_poll_task = NULL;
 static int s_poll_interval = 0;
@@ -44,6 +56,11 @@ static bool s_polling_active = false;
 static update_release_t s_release = {0};
 static bool s_initialized = false;
 
+// Validators of the last GitHub answer, sent back so an unchanged
+// release is answered with 304 Not Modified
+static char s_etag[VALIDATOR_LEN] = {0};
+static char s_last_modified[VALIDATOR_LEN] = {0};
+
 // Statistics
 static update_stats_t s_stats = {0};
 
@@ -125,6 +142,8 @@ static esp_err_t save_release_json(const update_release_t *release)
     cJSON_AddStringToObject(root, "name", release->name);
     cJSON_AddStringToObject(root, "publishedAt", release->published_at);
     cJSON_AddStringToObject(root, "htmlUrl", release->html_url);
+    cJSON_AddStringToObject(root, "etag", s_etag);
+    cJSON_AddStringToObject(root, "lastModified", s_last_modified);
 
     cJSON *assets = cJSON_CreateArray();
     for (int i = 0; i < release->asset_count; i++) {
@@ -132,6 +151,7 @@ static esp_err_t save_release_json(const update_release_t *release)
         cJSON_AddStringToObject(asset, "filename", release->assets[i].filename);
         cJSON_AddStringToObject(asset, "localPath", release->assets[i].local_path);
         cJSON_AddNumberToObject(asset, "sizeBytes", release->assets[i].size_bytes);
+        cJSON_AddStringToObject(asset, "sha256", release->assets[i].sha256);
         cJSON_AddBoolToObject(asset, "downloaded", release->assets[i].downloaded);
         cJSON_AddNumberToObject(asset, "type", release->assets[i].type);
         cJSON_AddItemToArray(assets, asset);
@@ -191,6 +211,12 @@ static esp_err_t load_release_json(update_release_t *release)
     if ((item = cJSON_GetObjectItem(root, "htmlUrl")) && cJSON_IsString(item)) {
         strlcpy(release->html_url, item->valuestring, sizeof(release->html_url));
     }
+    if ((item = cJSON_GetObjectItem(root, "etag")) && cJSON_IsString(item)) {
+        strlcpy(s_etag, item->valuestring, sizeof(s_etag));
+    }
+    if ((item = cJSON_GetObjectItem(root, "lastModified")) && cJSON_IsString(item)) {
+        strlcpy(s_last_modified, item->valuestring, sizeof(s_last_modified));
+    }
 
     cJSON *assets = cJSON_GetObjectItem(root, "assets");
     if (assets && cJSON_IsArray(assets)) {
@@ -210,6 +236,9 @@ static esp_err_t load_release_json(update_release_t *release)
                 if ((item = cJSON_GetObjectItem(asset, "sizeBytes")) && cJSON_IsNumber(item)) {
                     release->assets[i].size_bytes = (size_t)item->valuedouble;
                 }
+                if ((item = cJSON_GetObjectItem(asset, "sha256")) && cJSON_IsString(item)) {
+                    strlcpy(release->assets[i].sha256, item->valuestring, sizeof(release->assets[i].sha256));
+                }
                 if ((item = cJSON_GetObjectItem(asset, "downloaded")) && cJSON_IsBool(item)) {
                     release->assets[i].downloaded = cJSON_IsTrue(item);
                 }
@@ -227,162 +256,417 @@ static esp_err_t load_release_json(update_release_t *release)
     return ESP_OK;
 }
 
+/**
+ * @brief Check a release or asset name is safe as one SD card path element
+ *
+ * Versions and filenames come from GitHub or the parent node and end up in
+ * "%s/%s" and "%s_%s" paths: no separators, no "..", no hidden names.
+ */
+static bool safe_path_name(const char *name)
+{
+    return name[0] != '\0' && name[0] != '.' &&
+           strchr(name, '/') == NULL && strchr(name, '\\') == NULL &&
+           strstr(name, "..") == NULL;
+}
+
 /**
  * @brief Download a binary file from URL to SD card
  */
-static esp_err_t download_binary(const char *url, const char *local_path, size_t *downloaded_size)
+static esp_err_t download_binary(const char *url, const char *version, update_asset_t *asset)
 {
     ESP_LOGI(TAG, "Downloading: %s", url);
 
-    uint8_t *buffer = malloc(DOWNLOAD_BUFFER_SIZE);
-    if (buffer == NULL) {
-        ESP_LOGE(TAG, "Failed to allocate download buffer");
-        return ESP_ERR_NO_MEM;
-    }
-
-    http_client_request_t request = http_client_default_config();
-    request.url = url;
-    request.timeout_ms = 60000;  // 60 second timeout for large files
-    request.user_agent = "Geogram-ESP32/1.0";
-
-    http_client_response_t response = {
-        .data = buffer,
-        .buffer_size = DOWNLOAD_BUFFER_SIZE,
-        .data_len = 0,
-        .status_code = 0,
-    };
+    char name[128];
+    snprintf(name, sizeof(name), "%s_%s", version, asset->filename);
 
     s_stats.downloads_started++;
 
-    esp_err_t ret = http_client_get_async(&request, &response);
+    size_t downloaded = 0;
+    esp_err_t ret = update_download(url, name, asset->sha256, asset->local_path, &downloaded);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Download failed: %s", esp_err_to_name(ret));
-        free(buffer);
+        ESP_LOGE(TAG, "Download of %s failed: %s", asset->filename, esp_err_to_name(ret));
         s_stats.downloads_failed++;
         return ret;
     }
 
-    if (response.status_code != 200) {
-        ESP_LOGE(TAG, "HTTP error %d", response.status_code);
-        free(buffer);
-        s_stats.downloads_failed++;
-        return ESP_FAIL;
+    asset->downloaded = true;
+    asset->size_bytes = downloaded;
+    s_stats.downloads_completed++;
+    return ESP_OK;
+}
+
+/**
+ * @brief Check whether every asset of a release is on the card
+ */
+static bool release_complete(const update_release_t *release)
+{
+    for (int i = 0; i < release->asset_count; i++) {
+        if (!release->assets[i].downloaded) {
+            return false;
+        }
     }
+    return true;
+}
 
-    // Save to SD card
-    ret = sdcard_write_file(local_path, buffer, response.data_len);
-    free(buffer);
+/**
+ * @brief Find a previously downloaded asset of the cached release
+ */
+static const update_asset_t *find_downloaded_asset(const char *filename)
+{
+    for (int i = 0; i < s_release.asset_count; i++) {
+        const update_asset_t *a = &s_release.assets[i];
+        if (a->downloaded && strcmp(a->filename, filename) == 0 &&
+            sdcard_file_exists(a->local_path)) {
+            return a;
+        }
+    }
+    return NULL;
+}
 
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to save file: %s", local_path);
-        s_stats.downloads_failed++;
-        return ret;
+/**
+ * @brief GitHub release answer being scanned
+ *
+ * Only the fields update_release_t needs are kept, so the (often 20 KB+)
+ * API answer is never held in memory.
+ */
+typedef struct {
+    geo_json_stream_t json;
+    update_release_t release;
+    char urls[UPDATE_ASSET_COUNT][256];     // Download URL per kept asset
+    bool in_assets;
+    // Asset object being read
+    char asset_name[64];
+    char asset_url[256];
+    size_t asset_size;
+    char asset_sha256[65];
+    // Validators of this answer
+    char etag[VALIDATOR_LEN];
+    char last_modified[VALIDATOR_LEN];
+    // Parent node answer: its base URL and whether it has every asset
+    char peer_url[32];
+    bool peer_complete;
+} release_scan_t;
+
+static void release_scan_add_asset(release_scan_t *scan)
+{
+    update_release_t *r = &scan->release;
+    if (r->asset_count >= UPDATE_ASSET_COUNT ||
+        scan->asset_name[0] == '\0' || scan->asset_url[0] == '\0') {
+        return;
     }
 
-    *downloaded_size = response.data_len;
-    s_stats.downloads_completed++;
+    if (!safe_path_name(scan->asset_name)) {
+        ESP_LOGW(TAG, "Skipping asset with unsafe name: %s", scan->asset_name);
+        return;
+    }
 
-    ESP_LOGI(TAG, "Downloaded %zu bytes to %s", response.data_len, local_path);
-    return ESP_OK;
+    // Only download known asset types (APK is most important for mobile clients)
+    update_asset_type_t type = updates_asset_type_from_filename(scan->asset_name);
+    if (type == UPDATE_ASSET_UNKNOWN) {
+        return;
+    }
+
+    update_asset_t *a = &r->assets[r->asset_count];
+    strlcpy(a->filename, scan->asset_name, sizeof(a->filename));
+    strlcpy(a->sha256, scan->asset_sha256, sizeof(a->sha256));
+    a->size_bytes = scan->asset_size;
+    a->type = type;
+    strlcpy(scan->urls[r->asset_count], scan->asset_url, sizeof(scan->urls[0]));
+    r->asset_count++;
+}
+
+static void release_scan_cb(void *ctx, geo_json_event_t event, int depth,
+                            const char *key, const char *value)
+{
+    release_scan_t *scan = (release_scan_t *)ctx;
+    update_release_t *r = &scan->release;
+
+    if (depth == 1 && key != NULL) {
+        if (event == GEO_JSON_STRING) {
+            if (strcmp(key, "tag_name") == 0) {
+                // Version is the tag without its 'v' prefix
+                strlcpy(r->tag_name, value, sizeof(r->tag_name));
+                strlcpy(r->version, value[0] == 'v' ? value + 1 : value, sizeof(r->version));
+            } else if (strcmp(key, "name") == 0) {
+                strlcpy(r->name, value, sizeof(r->name));
+            } else if (strcmp(key, "published_at") == 0) {
+                strlcpy(r->published_at, value, sizeof(r->published_at));
+            } else if (strcmp(key, "html_url") == 0) {
+                strlcpy(r->html_url, value, sizeof(r->html_url));
+            }
+        } else if (strcmp(key, "assets") == 0) {
+            scan->in_assets = event == GEO_JSON_ARRAY_START;
+        }
+        return;
+    }
+
+    if (!scan->in_assets) {
+        return;
+    }
+
+    if (depth == 2 && event == GEO_JSON_OBJECT_START) {
+        scan->asset_name[0] = '\0';
+        scan->asset_url[0] = '\0';
+        scan->asset_size = 0;
+        scan->asset_sha256[0] = '\0';
+    } else if (depth == 2 && event == GEO_JSON_OBJECT_END) {
+        release_scan_add_asset(scan);
+    } else if (depth == 3 && key != NULL) {
+        if (event == GEO_JSON_STRING) {
+            if (strcmp(key, "name") == 0) {
+                strlcpy(scan->asset_name, value, sizeof(scan->asset_name));
+            } else if (strcmp(key, "browser_download_url") == 0) {
+                strlcpy(scan->asset_url, value, sizeof(scan->asset_url));
+            } else if (strcmp(key, "digest") == 0 && strncmp(value, "sha256:", 7) == 0) {
+                // GitHub publishes "sha256:<hex>" per asset
+                strlcpy(scan->asset_sha256, value + 7, sizeof(scan->asset_sha256));
+            }
+        } else if (event == GEO_JSON_NUMBER && strcmp(key, "size") == 0) {
+            scan->asset_size = (size_t)strtoull(value, NULL, 10);
+        }
+    }
 }
 
 /**
- * @brief Parse GitHub release JSON and download assets
+ * @brief Scan the parent node's /api/updates/latest answer
+ *
+ * Same shape as updates_build_latest_json(); asset URLs are relative to
+ * the parent.
  */
-static esp_err_t parse_and_download_release(const char *json_str)
+static void peer_scan_cb(void *ctx, geo_json_event_t event, int depth,
+                         const char *key, const char *value)
 {
-    cJSON *root = cJSON_Parse(json_str);
-    if (root == NULL) {
-        ESP_LOGE(TAG, "Failed to parse GitHub API response");
-        return ESP_FAIL;
+    release_scan_t *scan = (release_scan_t *)ctx;
+    update_release_t *r = &scan->release;
+
+    if (depth == 1 && key != NULL) {
+        if (event == GEO_JSON_STRING) {
+            if (strcmp(key, "version") == 0) {
+                strlcpy(r->version, value, sizeof(r->version));
+            } else if (strcmp(key, "tagName") == 0) {
+                strlcpy(r->tag_name, value, sizeof(r->tag_name));
+            } else if (strcmp(key, "name") == 0) {
+                strlcpy(r->name, value, sizeof(r->name));
+            } else if (strcmp(key, "publishedAt") == 0) {
+                strlcpy(r->published_at, value, sizeof(r->published_at));
+            } else if (strcmp(key, "htmlUrl") == 0) {
+                strlcpy(r->html_url, value, sizeof(r->html_url));
+            }
+        } else if (event == GEO_JSON_BOOL && strcmp(key, "complete") == 0) {
+            scan->peer_complete = strcmp(value, "true") == 0;
+        } else if (strcmp(key, "assets") == 0) {
+            scan->in_assets = event == GEO_JSON_ARRAY_START;
+        }
+        return;
     }
 
-    update_release_t new_release = {0};
+    if (!scan->in_assets) {
+        return;
+    }
 
-    // Parse version from tag_name (strip 'v' prefix)
-    cJSON *tag_name = cJSON_GetObjectItem(root, "tag_name");
-    if (tag_name && cJSON_IsString(tag_name)) {
-        const char *tag = tag_name->valuestring;
-        if (tag[0] == 'v') tag++;
-        strlcpy(new_release.version, tag, sizeof(new_release.version));
-        strlcpy(new_release.tag_name, tag_name->valuestring, sizeof(new_release.tag_name));
+    if (depth == 2 && event == GEO_JSON_OBJECT_START) {
+        scan->asset_name[0] = '\0';
+        scan->asset_url[0] = '\0';
+        scan->asset_size = 0;
+        scan->asset_sha256[0] = '\0';
+    } else if (depth == 2 && event == GEO_JSON_OBJECT_END) {
+        release_scan_add_asset(scan);
+    } else if (depth == 3 && key != NULL) {
+        if (event == GEO_JSON_STRING) {
+            if (strcmp(key, "filename") == 0) {
+                strlcpy(scan->asset_name, value, sizeof(scan->asset_name));
+            } else if (strcmp(key, "url") == 0 && value[0] == '/') {
+                snprintf(scan->asset_url, sizeof(scan->asset_url), "%s%s", scan->peer_url, value);
+            } else if (strcmp(key, "sha256") == 0) {
+                strlcpy(scan->asset_sha256, value, sizeof(scan->asset_sha256));
+            }
+        } else if (event == GEO_JSON_NUMBER && strcmp(key, "size") == 0) {
+            scan->asset_size = (size_t)strtoull(value, NULL, 10);
+        }
     }
+}
 
-    // Check if we already have this version
-    if (s_release.valid && strcmp(s_release.version, new_release.version) == 0) {
-        ESP_LOGI(TAG, "Already have version %s", new_release.version);
-        cJSON_Delete(root);
-        return ESP_ERR_NOT_FOUND;
+static void release_on_header(void *ctx, const char *name, const char *value)
+{
+    release_scan_t *scan = (release_scan_t *)ctx;
+    if (strcasecmp(name, "ETag") == 0) {
+        strlcpy(scan->etag, value, sizeof(scan->etag));
+    } else if (strcasecmp(name, "Last-Modified") == 0) {
+        strlcpy(scan->last_modified, value, sizeof(scan->last_modified));
     }
+}
 
-    ESP_LOGI(TAG, "New release found: %s", new_release.version);
+static esp_err_t release_on_data(void *ctx, const uint8_t *data, size_t len)
+{
+    release_scan_t *scan = (release_scan_t *)ctx;
+    if (!geo_json_stream_feed(&scan->json, (const char *)data, len)) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    return ESP_OK;
+}
 
-    // Parse other fields
-    cJSON *item;
-    if ((item = cJSON_GetObjectItem(root, "name")) && cJSON_IsString(item)) {
-        strlcpy(new_release.name, item->valuestring, sizeof(new_release.name));
+/**
+ * @brief Mirror a scanned release: download its assets and cache it
+ */
+static esp_err_t apply_release(release_scan_t *scan)
+{
+    update_release_t *new_release = &scan->release;
+
+    if (new_release->version[0] == '\0') {
+        ESP_LOGE(TAG, "GitHub API response has no tag_name");
+        return ESP_FAIL;
     }
-    if ((item = cJSON_GetObjectItem(root, "published_at")) && cJSON_IsString(item)) {
-        strlcpy(new_release.published_at, item->valuestring, sizeof(new_release.published_at));
+    if (!safe_path_name(new_release->version)) {
+        ESP_LOGE(TAG, "Rejecting release with unsafe version: %s", new_release->version);
+        return ESP_ERR_INVALID_RESPONSE;
     }
-    if ((item = cJSON_GetObjectItem(root, "html_url")) && cJSON_IsString(item)) {
-        strlcpy(new_release.html_url, item->valuestring, sizeof(new_release.html_url));
+
+    // Check if we already have this version; finish it if downloads were interrupted
+    bool same_version = s_release.valid && strcmp(s_release.version, new_release->version) == 0;
+    if (same_version && release_complete(&s_release)) {
+        ESP_LOGI(TAG, "Already have version %s", new_release->version);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    if (same_version) {
+        ESP_LOGI(TAG, "Resuming downloads of %s", new_release->version);
+    } else {
+        ESP_LOGI(TAG, "New release found: %s", new_release->version);
     }
 
+    // Partial downloads of other versions will never be finished
+    char keep_prefix[40];
+    snprintf(keep_prefix, sizeof(keep_prefix), "%s_", new_release->version);
+    update_download_purge(keep_prefix);
+
     // Create version directory
     char version_dir[128];
-    snprintf(version_dir, sizeof(version_dir), "%s/%s", UPDATES_BASE_PATH, new_release.version);
+    snprintf(version_dir, sizeof(version_dir), "%s/%s", UPDATES_BASE_PATH, new_release->version);
     ensure_dir(version_dir);
 
-    // Parse and download assets
-    cJSON *assets = cJSON_GetObjectItem(root, "assets");
-    if (assets && cJSON_IsArray(assets)) {
-        int asset_idx = 0;
-        cJSON *asset;
-        cJSON_ArrayForEach(asset, assets) {
-            if (asset_idx >= UPDATE_ASSET_COUNT) break;
+    for (int i = 0; i < new_release->asset_count; i++) {
+        update_asset_t *a = &new_release->assets[i];
+        snprintf(a->local_path, sizeof(a->local_path), "%s/%s", version_dir, a->filename);
+
+        // Download the binary (or keep the copy from an earlier poll)
+        const update_asset_t *have = same_version ? find_downloaded_asset(a->filename) : NULL;
+        if (have != NULL) {
+            a->downloaded = true;
+            a->size_bytes = have->size_bytes;
+        } else {
+            download_binary(scan->urls[i], new_release->version, a);
+        }
+    }
 
-            cJSON *name = cJSON_GetObjectItem(asset, "name");
-            cJSON *download_url = cJSON_GetObjectItem(asset, "browser_download_url");
-            cJSON *size = cJSON_GetObjectItem(asset, "size");
+    // Save and cache the new release
+    new_release->valid = true;
+    memcpy(&s_release, new_release, sizeof(update_release_t));
+    save_release_json(&s_release);
 
-            if (name && cJSON_IsString(name) && download_url && cJSON_IsString(download_url)) {
-                update_asset_type_t type = updates_asset_type_from_filename(name->valuestring);
+#if CONFIG_GEOGRAM_UPDATES_MESH_PEERS
+    // Nodes below us can mirror it from here now
+    if (release_complete(&s_release)) {
+        update_peer_announce(s_release.version);
+    }
+#endif
 
-                // Only download known asset types (APK is most important for mobile clients)
-                if (type == UPDATE_ASSET_UNKNOWN) {
-                    continue;
-                }
+    return ESP_OK;
+}
 
-                update_asset_t *a = &new_release.assets[asset_idx];
-                strlcpy(a->filename, name->valuestring, sizeof(a->filename));
-                // Use version_dir to avoid overlap warning
-                snprintf(a->local_path, sizeof(a->local_path), "%s/%s",
-                         version_dir, name->valuestring);
-                a->type = type;
-                a->size_bytes = size ? (size_t)size->valuedouble : 0;
-
-                // Download the binary
-                size_t downloaded = 0;
-                if (download_binary(download_url->valuestring, a->local_path, &downloaded) == ESP_OK) {
-                    a->downloaded = true;
-                    a->size_bytes = downloaded;
-                }
+#if CONFIG_GEOGRAM_UPDATES_MESH_PEERS
+/**
+ * @brief Another node finished a release: check our parent now
+ */
+static void on_peer_announce(const char *version)
+{
+    bool have = s_release.valid && strcmp(s_release.version, version) == 0 &&
+                release_complete(&s_release);
+    if (!have && s_poll_task != NULL && update_peer_available()) {
+        xTaskNotifyGive(s_poll_task);
+    }
+}
 
-                asset_idx++;
-            }
-        }
-        new_release.asset_count = asset_idx;
+/**
+ * @brief Mirror the release of the parent mesh node
+ *
+ * Only a release the parent holds completely is taken; until then the
+ * parent's own announcement triggers the next check.
+ */
+static esp_err_t updates_check_parent(void)
+{
+    release_scan_t *scan = calloc(1, sizeof(release_scan_t));
+    if (scan == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t ret = update_peer_parent_url(scan->peer_url, sizeof(scan->peer_url));
+    if (ret != ESP_OK) {
+        free(scan);
+        return ret;
     }
+    geo_json_stream_init(&scan->json, peer_scan_cb, scan);
 
-    cJSON_Delete(root);
+    char url[64];
+    snprintf(url, sizeof(url), "%s" PEER_LATEST_PATH, scan->peer_url);
+    ESP_LOGI(TAG, "Checking parent node for updates: %s", url);
+    s_stats.checks_from_parent++;
 
-    // Save and cache the new release
-    new_release.valid = true;
-    memcpy(&s_release, &new_release, sizeof(update_release_t));
-    save_release_json(&s_release);
+    http_client_request_t request = http_client_default_config();
+    request.url = url;
+    request.timeout_ms = 10000;
+    request.user_agent = "Geogram-ESP32/1.0";
+    request.priority = HTTP_CLIENT_PRIORITY_LOW;
 
-    return ESP_OK;
+    const http_client_sink_t sink = {
+        .on_data = release_on_data,
+        .ctx = scan,
+    };
+
+    int status = 0;
+    ret = http_client_get_stream(&request, &sink, &status);
+    if (ret == ESP_OK && (status != 200 || !geo_json_stream_done(&scan->json))) {
+        ESP_LOGW(TAG, "Parent node answered %d", status);
+        ret = ESP_FAIL;
+    }
+    if (ret != ESP_OK) {
+        free(scan);
+        return ret;
+    }
+
+    if (scan->release.version[0] == '\0' || !scan->peer_complete) {
+        ESP_LOGI(TAG, "Parent node has no complete release yet");
+        free(scan);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    ret = apply_release(scan);
+    free(scan);
+    return ret;
+}
+#endif // CONFIG_GEOGRAM_UPDATES_MESH_PEERS
+
+/**
+ * @brief Copy update_stats_t into /api/metrics
+ */
+static void updates_collect_metrics(void)
+{
+    static geo_metric_t *checks, *downloads, *download_errors, *files_served, *bytes_served;
+    if (checks == NULL) {
+        checks = geo_metric_counter("geogram_updates_checks_total", NULL, "Release checks performed");
+        downloads = geo_metric_counter("geogram_updates_downloads_total", NULL, "Release assets downloaded");
+        download_errors = geo_metric_counter("geogram_updates_download_errors_total", NULL, "Failed asset downloads");
+        files_served = geo_metric_counter("geogram_updates_files_served_total", NULL, "Update files served to clients");
+        bytes_served = geo_metric_counter("geogram_updates_bytes_served_total", NULL, "Update bytes served to clients");
+    }
+
+    update_stats_t stats;
+    if (updates_get_stats(&stats) != ESP_OK) {
+        return;
+    }
+    geo_metric_set(checks, stats.checks_performed);
+    geo_metric_set(downloads, stats.downloads_completed);
+    geo_metric_set(download_errors, stats.downloads_failed);
+    geo_metric_set(files_served, stats.files_served);
+    geo_metric_set(bytes_served, (int64_t)stats.bytes_served);
 }
 
 esp_err_t updates_init(void)
@@ -408,7 +692,12 @@ esp_err_t updates_init(void)
                  s_release.version, s_release.asset_count);
     }
 
+#if CONFIG_GEOGRAM_UPDATES_MESH_PEERS
+    update_peer_init(on_peer_announce);
+#endif
+
     s_initialized = true;
+    geo_metrics_register_collector(updates_collect_metrics);
     ESP_LOGI(TAG, "Update mirror initialized at %s", UPDATES_BASE_PATH);
     return ESP_OK;
 }
@@ -427,58 +716,119 @@ esp_err_t updates_check_github(void)
     ESP_LOGI(TAG, "Checking GitHub for updates...");
     s_stats.checks_performed++;
 
-    uint8_t *buffer = malloc(API_RESPONSE_SIZE);
-    if (buffer == NULL) {
+    release_scan_t *scan = calloc(1, sizeof(release_scan_t));
+    if (scan == NULL) {
         return ESP_ERR_NO_MEM;
     }
+    geo_json_stream_init(&scan->json, release_scan_cb, scan);
+
+    // Ask for the release only if it changed. Skipped while assets are
+    // missing: resuming them needs the download URLs of a full answer.
+    http_client_header_t headers[2];
+    size_t header_count = 0;
+    if (s_release.valid && release_complete(&s_release)) {
+        if (s_etag[0] != '\0') {
+            headers[header_count++] = (http_client_header_t){ "If-None-Match", s_etag };
+        }
+        if (s_last_modified[0] != '\0') {
+            headers[header_count++] = (http_client_header_t){ "If-Modified-Since", s_last_modified };
+        }
+    }
 
     http_client_request_t request = http_client_default_config();
     request.url = GITHUB_API_URL;
     request.timeout_ms = 30000;
     request.user_agent = "Geogram-ESP32/1.0";
-
-    http_client_response_t response = {
-        .data = buffer,
-        .buffer_size = API_RESPONSE_SIZE - 1,
-        .data_len = 0,
-        .status_code = 0,
+    request.priority = HTTP_CLIENT_PRIORITY_LOW;
+    request.headers = headers;
+    request.header_count = header_count;
+
+    const http_client_sink_t sink = {
+        .on_header = release_on_header,
+        .on_data = release_on_data,
+        .ctx = scan,
     };
 
-    esp_err_t ret = http_client_get_async(&request, &response);
+    int status = 0;
+    esp_err_t ret = http_client_get_stream(&request, &sink, &status);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "GitHub API request failed: %s", esp_err_to_name(ret));
-        free(buffer);
+        free(scan);
         return ret;
     }
 
-    if (response.status_code != 200) {
-        ESP_LOGE(TAG, "GitHub API error: %d", response.status_code);
-        free(buffer);
+    if (status == 304) {
+        ESP_LOGI(TAG, "Release %s unchanged", s_release.version);
+        s_stats.checks_not_modified++;
+        free(scan);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    if (status != 200) {
+        ESP_LOGE(TAG, "GitHub API error: %d", status);
+        free(scan);
         return ESP_FAIL;
     }
 
-    buffer[response.data_len] = '\0';
-    ret = parse_and_download_release((char *)buffer);
-    free(buffer);
+    if (!geo_json_stream_done(&scan->json)) {
+        ESP_LOGE(TAG, "Failed to parse GitHub API response");
+        free(scan);
+        return ESP_FAIL;
+    }
+
+    bool validators_changed = strcmp(s_etag, scan->etag) != 0 ||
+                              strcmp(s_last_modified, scan->last_modified) != 0;
+    strlcpy(s_etag, scan->etag, sizeof(s_etag));
+    strlcpy(s_last_modified, scan->last_modified, sizeof(s_last_modified));
+
+    ret = apply_release(scan);
+    if (ret == ESP_ERR_NOT_FOUND && validators_changed) {
+        // Same release, new validators: keep them for the next poll
+        save_release_json(&s_release);
+    }
 
+    free(scan);
     return ret;
 }
 
+esp_err_t updates_check(void)
+{
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+#if CONFIG_GEOGRAM_UPDATES_MESH_PEERS
+    // Below the root the uplink is shared: take the release from the parent
+    if (update_peer_available()) {
+        esp_err_t ret = updates_check_parent();
+        if (ret == ESP_OK || ret == ESP_ERR_NOT_FOUND || ret == ESP_ERR_NO_MEM) {
+            return ret;
+        }
+        ESP_LOGW(TAG, "Parent node unreachable (%s), asking GitHub", esp_err_to_name(ret));
+    }
+#endif
+
+    return updates_check_github();
+}
+
 /**
  * @brief Polling task
  */
 static void poll_task(void *arg)
 {
-    // Initial delay before first check (1 minute after boot)
-    ESP_LOGI(TAG, "First GitHub check in 60 seconds...");
-    vTaskDelay(pdMS_TO_TICKS(60000));
+    // Initial delay before first check (1 minute after boot); an
+    // announcement from another node cuts any wait short
+    ESP_LOGI(TAG, "First update check in 60 seconds...");
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(60000));
 
     while (s_polling_active) {
-        updates_check_github();
+        updates_check();
 
         // Wait for next poll interval
         for (int i = 0; i < s_poll_interval && s_polling_active; i++) {
-            vTaskDelay(pdMS_TO_TICKS(1000));
+            if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000)) > 0) {
+                break;
+            }
         }
     }
 
@@ -558,6 +908,7 @@ size_t updates_build_latest_json(char *buffer, size_t buffer_size)
         geo_json_add_string(&builder, "name", s_release.name);
         geo_json_add_string(&builder, "publishedAt", s_release.published_at);
         geo_json_add_string(&builder, "htmlUrl", s_release.html_url);
+        geo_json_add_bool(&builder, "complete", release_complete(&s_release));
 
         // Build assets array with objects
         geo_json_array_start(&builder, "assets");
@@ -570,6 +921,8 @@ size_t updates_build_latest_json(char *buffer, size_t buffer_size)
                          s_release.version, s_release.assets[i].filename);
                 geo_json_add_string(&builder, "url", url);
                 geo_json_add_string(&builder, "filename", s_release.assets[i].filename);
+                geo_json_add_string(&builder, "sha256", s_release.assets[i].sha256);
+                geo_json_add_uint(&builder, "size", (uint32_t)s_release.assets[i].size_bytes);
                 geo_json_object_end(&builder);
             }
         }
@@ -585,13 +938,19 @@ size_t updates_build_latest_json(char *buffer, size_t buffer_size)
  */
 static esp_err_t updates_latest_handler(httpd_req_t *req)
 {
-    char response[1024];
-    size_t len = updates_build_latest_json(response, sizeof(response));
+    // Up to UPDATE_ASSET_COUNT assets with their checksums
+    char *response = (char *)geo_http_buf_acquire();
+    if (response == NULL) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Memory allocation failed");
+        return ESP_FAIL;
+    }
+    size_t len = updates_build_latest_json(response, GEO_HTTP_CHUNK_SIZE);
 
     httpd_resp_set_type(req, "application/json");
     httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-    httpd_resp_send(req, response, len);
-    return ESP_OK;
+    esp_err_t ret = httpd_resp_send(req, response, len);
+    geo_http_buf_release((uint8_t *)response);
+    return ret;
 }
 
 /**
@@ -612,18 +971,24 @@ static esp_err_t updates_file_handler(httpd_req_t *req)
     char *query = strchr(uri, '?');
     if (query) *query = '\0';
 
+    // Partial downloads (.incoming) and ".." are not served
+    if (strstr(uri, "/.") != NULL) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "File not found");
+        return ESP_FAIL;
+    }
+
     // Build local path: /sdcard/updates/... (max 7 + 127 = 134 < 256)
     char local_path[256];
     snprintf(local_path, sizeof(local_path), "/sdcard%.*s", (int)(sizeof(local_path) - 8), uri);
 
     // Check if file exists
-    if (!sdcard_file_exists(local_path)) {
+    struct stat st;
+    if (stat(local_path, &st) != 0 || !S_ISREG(st.st_mode)) {
         ESP_LOGW(TAG, "File not found: %s", local_path);
         httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "File not found");
         return ESP_FAIL;
     }
-
-    ESP_LOGI(TAG, "Serving file: %s", local_path);
+    size_t file_size = (size_t)st.st_size;
 
     // Determine content type
     const char *content_type = "application/octet-stream";
@@ -644,37 +1009,103 @@ static esp_err_t updates_file_handler(httpd_req_t *req)
     if (filename) filename++;
     else filename = "download";
 
-    // Read and send file
-    uint8_t *buffer = malloc(DOWNLOAD_BUFFER_SIZE);
-    if (buffer == NULL) {
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Memory allocation failed");
-        return ESP_FAIL;
+    // Assets are never rewritten in place, so size and mtime identify them
+    char etag[32];
+    snprintf(etag, sizeof(etag), "\"%lx-%lx\"", (unsigned long)st.st_mtime, (unsigned long)file_size);
+    char last_modified[GEO_HTTP_DATE_LEN];
+    geo_http_format_date(st.st_mtime, last_modified, sizeof(last_modified));
+
+    char disposition[128];
+    snprintf(disposition, sizeof(disposition), "attachment; filename=\"%s\"", filename);
+    char content_range[64];
+    geo_http_header_t headers[6] = {
+        { "Access-Control-Allow-Origin", "*" },
+        { "Accept-Ranges", "bytes" },
+        { "ETag", etag },
+        { "Last-Modified", last_modified },
+        { "Content-Disposition", disposition },
+    };
+    size_t header_count = 5;
+
+    if (geo_http_not_modified(req, etag, st.st_mtime)) {
+        return geo_http_send_not_modified(req, etag, st.st_mtime, headers, 2);
     }
 
-    size_t file_size = 0;
-    esp_err_t ret = sdcard_read_file(local_path, buffer, DOWNLOAD_BUFFER_SIZE, &file_size);
-    if (ret != ESP_OK) {
-        free(buffer);
+    // Resumed and parallel (segmented) downloads ask for byte ranges
+    size_t first = 0;
+    size_t last = file_size > 0 ? file_size - 1 : 0;
+    const char *status = "200 OK";
+    switch (geo_http_get_range(req, file_size, etag, st.st_mtime, &first, &last)) {
+        case GEO_HTTP_RANGE_PARTIAL:
+            status = "206 Partial Content";
+            snprintf(content_range, sizeof(content_range), "bytes %zu-%zu/%zu", first, last, file_size);
+            headers[header_count++] = (geo_http_header_t){ "Content-Range", content_range };
+            break;
+        case GEO_HTTP_RANGE_UNSATISFIABLE:
+            snprintf(content_range, sizeof(content_range), "bytes */%zu", file_size);
+            headers[header_count++] = (geo_http_header_t){ "Content-Range", content_range };
+            return geo_http_send_head(req, "416 Range Not Satisfiable", "text/plain", 0,
+                                      headers, header_count);
+        default:
+            break;
+    }
+    size_t length = file_size > 0 ? last - first + 1 : 0;
+
+    if (req->method == HTTP_HEAD) {
+        return geo_http_send_head(req, status, content_type, length, headers, header_count);
+    }
+
+    // Streaming megabytes off the card would stall every other client
+    esp_err_t deferred = geo_http_async_defer(req, updates_file_handler);
+    if (deferred == ESP_OK) {
+        return ESP_OK;
+    }
+    if (deferred == ESP_ERR_NO_MEM) {
+        return geo_http_send_busy(req);
+    }
+
+    ESP_LOGI(TAG, "Serving %s (%s, %zu bytes)", local_path, status, length);
+
+    FILE *f = fopen(local_path, "rb");
+    if (f == NULL || (first > 0 && fseek(f, (long)first, SEEK_SET) != 0)) {
+        if (f) fclose(f);
         httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to read file");
         return ESP_FAIL;
     }
 
-    // Set headers
-    httpd_resp_set_type(req, content_type);
-    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    uint8_t *buffer = geo_http_buf_acquire();
+    if (buffer == NULL) {
+        fclose(f);
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Memory allocation failed");
+        return ESP_FAIL;
+    }
 
-    char disposition[128];
-    snprintf(disposition, sizeof(disposition), "attachment; filename=\"%s\"", filename);
-    httpd_resp_set_hdr(req, "Content-Disposition", disposition);
+    // Stream the file; assets are far larger than any RAM buffer
+    esp_err_t ret = geo_http_send_head(req, status, content_type, length, headers, header_count);
+    size_t sent = 0;
+    while (ret == ESP_OK && sent < length) {
+        size_t want = length - sent < GEO_HTTP_CHUNK_SIZE ? length - sent : GEO_HTTP_CHUNK_SIZE;
+        size_t n = fread(buffer, 1, want, f);
+        if (n == 0) {
+            ret = ESP_FAIL;
+            break;
+        }
+        ret = geo_http_send_body(req, buffer, n);
+        sent += n;
+    }
+    geo_http_buf_release(buffer);
+    fclose(f);
 
-    // Send file
-    httpd_resp_send(req, (char *)buffer, file_size);
-    free(buffer);
+    if (ret != ESP_OK) {
+        // Head already sent; drop the connection so the client sees a short body
+        ESP_LOGW(TAG, "Transfer of %s aborted after %zu bytes", local_path, sent);
+        return ESP_FAIL;
+    }
 
     s_stats.files_served++;
-    s_stats.bytes_served += file_size;
+    s_stats.bytes_served += length;
 
-    ESP_LOGI(TAG, "Served %zu bytes", file_size);
+    ESP_LOGI(TAG, "Served %zu bytes", length);
     return ESP_OK;
 }
 
@@ -692,24 +1123,37 @@ static const httpd_uri_t updates_file_uri = {
     .user_ctx = NULL
 };
 
+static const httpd_uri_t updates_file_head_uri = {
+    .uri = "/updates/*",
+    .method = HTTP_HEAD,
+    .handler = updates_file_handler,
+    .user_ctx = NULL
+};
+
 esp_err_t updates_register_http_handlers(httpd_handle_t server)
 {
     if (server == NULL) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    esp_err_t ret = httpd_register_uri_handler(server, &updates_latest_uri);
+    esp_err_t ret = geo_http_register_uri(server, &updates_latest_uri);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to register /api/updates/latest handler");
         return ret;
     }
 
-    ret = httpd_register_uri_handler(server, &updates_file_uri);
+    ret = geo_http_register_uri(server, &updates_file_uri);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to register /updates/* handler");
         return ret;
     }
 
+    ret = geo_http_register_uri(server, &updates_file_head_uri);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register HEAD /updates/* handler");
+        return ret;
+    }
+
     ESP_LOGI(TAG, "Update HTTP handlers registered");
     return ESP_OK;
 }
@@ -722,6 +1166,7 @@ esp_err_t updates_register_http_handlers(httpd_handle_t server)
 esp_err_t updates_init(void) { return ESP_ERR_NOT_SUPPORTED; }
 bool updates_is_available(void) { return false; }
 esp_err_t updates_check_github(void) { return ESP_ERR_NOT_SUPPORTED; }
+esp_err_t updates_check(void) { return ESP_ERR_NOT_SUPPORTED; }
 esp_err_t updates_start_polling(int interval_seconds) { return ESP_ERR_NOT_SUPPORTED; }
 void updates_stop_polling(void) {}
 esp_err_t updates_get_release(update_release_t *release) { return ESP_ERR_NOT_FOUND; }
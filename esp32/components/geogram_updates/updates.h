@@ -41,6 +41,7 @@ typedef struct {
     char filename[64];          /**< Original filename from GitHub */
     char local_path[192];       /**< Local path on SD card */
     size_t size_bytes;          /**< File size in bytes */
+    char sha256[65];            /**< SHA-256 published by GitHub (hex, may be empty) */
     bool downloaded;            /**< Whether file is downloaded */
     update_asset_type_t type;   /**< Asset type */
 } update_asset_t;
@@ -64,6 +65,8 @@ typedef struct {
  */
 typedef struct {
     uint32_t checks_performed;      /**< Number of GitHub checks */
+    uint32_t checks_not_modified;   /**< Checks answered 304 Not Modified */
+    uint32_t checks_from_parent;    /**< Checks answered by the parent mesh node */
     uint32_t downloads_started;     /**< Number of downloads started */
     uint32_t downloads_completed;   /**< Number of downloads completed */
     uint32_t downloads_failed;      /**< Number of downloads failed */
@@ -91,17 +94,32 @@ bool updates_is_available(void);
  * @brief Check for new release from GitHub
  *
  * Downloads release metadata from GitHub API. If a new version is found,
- * triggers background download of binaries.
+ * triggers background download of binaries. Once the cached release is
+ * complete the request is conditional (If-None-Match / If-Modified-Since),
+ * so an unchanged release costs a 304 with no body.
  *
  * @return ESP_OK on success, ESP_ERR_NOT_FOUND if no new version
  */
 esp_err_t updates_check_github(void);
 
+/**
+ * @brief Check for a new release from the best source
+ *
+ * Nodes below the mesh root mirror the release of their parent node
+ * (CONFIG_GEOGRAM_UPDATES_MESH_PEERS), so a whole mesh downloads each
+ * asset over the uplink once. The root, and stations outside a mesh,
+ * ask GitHub. Used by the polling task.
+ *
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if no new version
+ */
+esp_err_t updates_check(void);
+
 /**
  * @brief Start background update polling
  *
- * Starts a task that periodically checks GitHub for new releases
- * and downloads binaries in the background.
+ * Starts a task that periodically checks for new releases (see
+ * updates_check()) and downloads binaries in the background. A release
+ * announced by another mesh node triggers a check right away.
  *
  * @param interval_seconds Polling interval (minimum 60 seconds)
  * @return ESP_OK on success
@@ -142,8 +160,10 @@ size_t updates_build_latest_json(char *buffer, size_t buffer_size);
  * @brief Register HTTP handlers for update endpoints
  *
  * Registers:
- * - GET /api/updates/latest - Returns cached release info
- * - GET /updates/{version}/{filename} - Serves binary files
+ * - GET /api/updates/latest - Returns cached release info (also read by
+ *   child mesh nodes mirroring this station)
+ * - GET/HEAD /updates/{version}/{filename} - Serves binary files (streamed,
+ *   with ETag, 304 and single-range 206 support for resumed downloads)
  *
  * @param server HTTP server handle
  * @return ESP_OK on success
@@ -15,6 +15,7 @@
 #include <esp_http_server.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
+#include "geogram_metrics.h"
 
 #ifdef CONFIG_GEOGRAM_MESH_ENABLED
 #include "mesh_bsp.h"
@@ -135,8 +136,7 @@ static void set_client_id(int fd, const char *id)
     xSemaphoreTake(s_mutex, portMAX_DELAY);
     int idx = find_client_by_fd(fd);
     if (idx >= 0) {
-        strncpy(s_clients[idx].id, id, sizeof(s_clients[idx].id) - 1);
-        s_clients[idx].id[sizeof(s_clients[idx].id) - 1] = '\0';
+        strlcpy(s_clients[idx].id, id, sizeof(s_clients[idx].id));
         ESP_LOGI(TAG, "Client identified: fd=%d, id=%s", fd, id);
     }
     xSemaphoreGive(s_mutex);
@@ -239,6 +239,16 @@ int ws_get_client_count(void)
     return count;
 }
 
+static void ws_collect_metrics(void)
+{
+    static geo_metric_t *clients;
+    if (clients == NULL) {
+        clients = geo_metric_gauge("geogram_ws_clients", NULL, "Connected WebSocket clients");
+    }
+    geo_metric_set(clients, ws_get_client_count());
+}
+
+#ifdef CONFIG_GEOGRAM_MESH_ENABLED
 // Parse SHA1 hex string to bytes
 static bool parse_sha1_hex(const char *hex, uint8_t *out)
 {
@@ -252,7 +262,6 @@ static bool parse_sha1_hex(const char *hex, uint8_t *out)
     return true;
 }
 
-#ifdef CONFIG_GEOGRAM_MESH_ENABLED
 // Forward file request to all mesh nodes
 static void forward_file_request_to_mesh(const char *sha1_hex, const char *from_id)
 {
@@ -511,12 +520,6 @@ static esp_err_t ws_handler(httpd_req_t *req)
     return ESP_OK;
 }
 
-// Async send callback for client closure detection
-static void ws_async_send_callback(void *arg)
-{
-    // Not used currently
-}
-
 esp_err_t ws_server_register(httpd_handle_t server)
 {
     if (!server) {
@@ -556,6 +559,7 @@ esp_err_t ws_server_register(httpd_handle_t server)
         return ret;
     }
 
+    geo_metrics_register_collector(ws_collect_metrics);
     ESP_LOGI(TAG, "WebSocket server registered at /ws");
     return ESP_OK;
 }
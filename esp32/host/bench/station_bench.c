@@ -0,0 +1,879 @@
+/**
+ * @file station_bench.c
+ * @brief Load test of the station HTTP API on the host build
+ *
+ * Starts the station as the board does (SD card, tile cache, file cache,
+ * chat, HTTP server) and runs simulated clients against it over loopback:
+ *
+ *   chat   long-poll /api/chat/messages and post to /api/chat/send
+ *   tiles  GET /tiles/{z}/{x}/{y}.png over a working set, misses going to
+ *          the simulated upstream
+ *   files  relay files through /api/file/upload and /api/file/download,
+ *          checking every chunk against the SHA-1 of the original
+ *
+ * Reports throughput and latency percentiles per request type, and the
+ * peak of the modelled internal/PSRAM heaps. Client buffers come from
+ * mmap() so that only the firmware code is charged to those heaps.
+ */
+
+#include <errno.h>
+#include <ftw.h>
+#include <getopt.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs_flash.h"
+#include "sdcard.h"
+#include "station.h"
+#include "http_server.h"
+#include "file_cache.h"
+#include "file_relay.h"
+#include "tiles.h"
+#include "mbedtls/sha1.h"
+#include "geogram_host.h"
+
+// ============================================================================
+// Options
+// ============================================================================
+
+typedef struct {
+    int clients;
+    int duration_s;
+    int mix[3];                 // chat, tiles, files (weights)
+    int chat_wait_s;
+    int chat_send_ms;
+    int tile_set;
+    int file_kb;
+    int origin_ms;
+    int origin_kb;
+    int origin_fail;
+    int internal_kb;
+    int psram_kb;
+    int port;
+    const char *sdcard;
+    bool keep;
+    bool json;
+    bool verbose;
+} bench_opts_t;
+
+static bench_opts_t s_opts = {
+    .clients = 16,
+    .duration_s = 20,
+    .mix = { 50, 35, 15 },
+    .chat_wait_s = 5,
+    .chat_send_ms = 3000,
+    .tile_set = 256,
+    .file_kb = 64,
+    .origin_ms = 150,
+    .origin_kb = 20,
+    .origin_fail = 0,
+    .internal_kb = HOST_HEAP_INTERNAL_DEFAULT / 1024,
+    .psram_kb = HOST_HEAP_PSRAM_DEFAULT / 1024,
+    .port = 0,
+};
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s [options]\n"
+           "  --clients N        simulated clients (default %d)\n"
+           "  --duration S       run time in seconds (default %d)\n"
+           "  --mix C:T:F        share of chat, tile and file clients (default %d:%d:%d)\n"
+           "  --chat-wait S      long-poll wait, 0 for short polls (default %d)\n"
+           "  --chat-send-ms MS  time between posts of one chat client (default %d)\n"
+           "  --tiles N          tile working set (default %d)\n"
+           "  --file-kb KB       size of relayed files (default %d)\n"
+           "  --origin-ms MS     upstream tile latency (default %d)\n"
+           "  --origin-kb KB     upstream tile size (default %d)\n"
+           "  --origin-fail PCT  upstream 503 rate (default %d)\n"
+           "  --internal-kb KB   internal RAM budget (default %d)\n"
+           "  --psram-kb KB      PSRAM budget (default %d)\n"
+           "  --port P           HTTP port (default: any free port)\n"
+           "  --sdcard DIR       directory standing in for the card (default: temporary)\n"
+           "  --keep             keep the temporary card directory\n"
+           "  --json             print the report as JSON\n"
+           "  --verbose          firmware log at INFO (else GEOGRAM_LOG or errors only)\n",
+           prog, s_opts.clients, s_opts.duration_s, s_opts.mix[0], s_opts.mix[1], s_opts.mix[2],
+           s_opts.chat_wait_s, s_opts.chat_send_ms, s_opts.tile_set, s_opts.file_kb,
+           s_opts.origin_ms, s_opts.origin_kb, s_opts.origin_fail, s_opts.internal_kb,
+           s_opts.psram_kb);
+}
+
+static bool parse_opts(int argc, char **argv)
+{
+    enum {
+        OPT_CLIENTS = 1, OPT_DURATION, OPT_MIX, OPT_CHAT_WAIT, OPT_CHAT_SEND, OPT_TILES,
+        OPT_FILE_KB, OPT_ORIGIN_MS, OPT_ORIGIN_KB, OPT_ORIGIN_FAIL, OPT_INTERNAL_KB,
+        OPT_PSRAM_KB, OPT_PORT, OPT_SDCARD, OPT_KEEP, OPT_JSON, OPT_VERBOSE, OPT_HELP,
+    };
+    static const struct option options[] = {
+        { "clients", required_argument, NULL, OPT_CLIENTS },
+        { "duration", required_argument, NULL, OPT_DURATION },
+        { "mix", required_argument, NULL, OPT_MIX },
+        { "chat-wait", required_argument, NULL, OPT_CHAT_WAIT },
+        { "chat-send-ms", required_argument, NULL, OPT_CHAT_SEND },
+        { "tiles", required_argument, NULL, OPT_TILES },
+        { "file-kb", required_argument, NULL, OPT_FILE_KB },
+        { "origin-ms", required_argument, NULL, OPT_ORIGIN_MS },
+        { "origin-kb", required_argument, NULL, OPT_ORIGIN_KB },
+        { "origin-fail", required_argument, NULL, OPT_ORIGIN_FAIL },
+        { "internal-kb", required_argument, NULL, OPT_INTERNAL_KB },
+        { "psram-kb", required_argument, NULL, OPT_PSRAM_KB },
+        { "port", required_argument, NULL, OPT_PORT },
+        { "sdcard", required_argument, NULL, OPT_SDCARD },
+        { "keep", no_argument, NULL, OPT_KEEP },
+        { "json", no_argument, NULL, OPT_JSON },
+        { "verbose", no_argument, NULL, OPT_VERBOSE },
+        { "help", no_argument, NULL, OPT_HELP },
+        { NULL, 0, NULL, 0 },
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", options, NULL)) != -1) {
+        switch (opt) {
+            case OPT_CLIENTS: s_opts.clients = atoi(optarg); break;
+            case OPT_DURATION: s_opts.duration_s = atoi(optarg); break;
+            case OPT_MIX:
+                if (sscanf(optarg, "%d:%d:%d", &s_opts.mix[0], &s_opts.mix[1], &s_opts.mix[2]) != 3) {
+                    fprintf(stderr, "--mix takes chat:tiles:files, e.g. 50:35:15\n");
+                    return false;
+                }
+                break;
+            case OPT_CHAT_WAIT: s_opts.chat_wait_s = atoi(optarg); break;
+            case OPT_CHAT_SEND: s_opts.chat_send_ms = atoi(optarg); break;
+            case OPT_TILES: s_opts.tile_set = atoi(optarg); break;
+            case OPT_FILE_KB: s_opts.file_kb = atoi(optarg); break;
+            case OPT_ORIGIN_MS: s_opts.origin_ms = atoi(optarg); break;
+            case OPT_ORIGIN_KB: s_opts.origin_kb = atoi(optarg); break;
+            case OPT_ORIGIN_FAIL: s_opts.origin_fail = atoi(optarg); break;
+            case OPT_INTERNAL_KB: s_opts.internal_kb = atoi(optarg); break;
+            case OPT_PSRAM_KB: s_opts.psram_kb = atoi(optarg); break;
+            case OPT_PORT: s_opts.port = atoi(optarg); break;
+            case OPT_SDCARD: s_opts.sdcard = optarg; break;
+            case OPT_KEEP: s_opts.keep = true; break;
+            case OPT_JSON: s_opts.json = true; break;
+            case OPT_VERBOSE: s_opts.verbose = true; break;
+            default:
+                usage(argv[0]);
+                return false;
+        }
+    }
+    if (s_opts.clients < 1 || s_opts.duration_s < 1 || s_opts.tile_set < 1 || s_opts.file_kb < 1 ||
+        s_opts.mix[0] < 0 || s_opts.mix[1] < 0 || s_opts.mix[2] < 0 ||
+        s_opts.mix[0] + s_opts.mix[1] + s_opts.mix[2] == 0) {
+        usage(argv[0]);
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// Statistics: per request type, log-scale latency histogram
+// ============================================================================
+
+#define HIST_STEPS_PER_OCTAVE   32      // ~2% resolution
+#define HIST_BUCKETS            (28 * HIST_STEPS_PER_OCTAVE)
+
+typedef enum {
+    OP_CHAT_POLL = 0,
+    OP_CHAT_SEND,
+    OP_TILE,
+    OP_FILE_UP,
+    OP_FILE_DOWN,
+    OP_FILE_XFER,
+    OP_COUNT,
+} op_t;
+
+static const char *const s_op_names[OP_COUNT] = {
+    "chat_poll", "chat_send", "tile", "file_up", "file_down", "file_xfer",
+};
+
+typedef struct {
+    _Atomic uint64_t ops;
+    _Atomic uint64_t errors;
+    _Atomic uint64_t busy;      // 503, "wait" or a full transfer table
+    _Atomic uint64_t bytes;
+    _Atomic uint64_t sum_us;
+    _Atomic uint64_t max_us;
+    _Atomic uint32_t hist[HIST_BUCKETS];
+} op_stats_t;
+
+static op_stats_t s_stats[OP_COUNT];
+static _Atomic uint64_t s_reconnects;
+static atomic_bool s_running = true;
+
+static int hist_bucket(uint64_t us)
+{
+    if (us < 1) {
+        return 0;
+    }
+    int b = (int)(log2((double)us) * HIST_STEPS_PER_OCTAVE);
+    return b < HIST_BUCKETS ? b : HIST_BUCKETS - 1;
+}
+
+static uint64_t hist_value(int bucket)
+{
+    return (uint64_t)exp2((double)(bucket + 1) / HIST_STEPS_PER_OCTAVE);
+}
+
+static void stats_record(op_t op, int64_t start_us, size_t bytes)
+{
+    uint64_t us = (uint64_t)(esp_timer_get_time() - start_us);
+    op_stats_t *st = &s_stats[op];
+    st->ops++;
+    st->bytes += bytes;
+    st->sum_us += us;
+    st->hist[hist_bucket(us)]++;
+    uint64_t max = st->max_us;
+    while (us > max && !atomic_compare_exchange_weak(&st->max_us, &max, us)) {
+    }
+}
+
+static double stats_percentile_ms(const op_stats_t *st, double pct)
+{
+    uint64_t total = st->ops;
+    if (total == 0) {
+        return 0.0;
+    }
+    uint64_t want = (uint64_t)ceil(total * pct / 100.0);
+    uint64_t seen = 0;
+    for (int b = 0; b < HIST_BUCKETS; b++) {
+        seen += st->hist[b];
+        if (seen >= want) {
+            uint64_t us = hist_value(b);
+            return (us < st->max_us ? us : st->max_us) / 1000.0;
+        }
+    }
+    return st->max_us / 1000.0;
+}
+
+// ============================================================================
+// HTTP client (keep-alive, Content-Length and chunked bodies)
+// ============================================================================
+
+#define CONN_RBUF_SIZE      16384
+#define RESP_BODY_MAX       (256 * 1024)
+
+typedef struct {
+    int fd;
+    size_t rpos;
+    size_t rlen;
+    char rbuf[CONN_RBUF_SIZE];
+} conn_t;
+
+typedef struct {
+    int status;
+    char content_type[64];
+    size_t body_len;            // Bytes kept in body (the rest is counted, not kept)
+    size_t body_total;
+    char *body;                 // Caller's buffer of RESP_BODY_MAX + 1
+} resp_t;
+
+static uint16_t s_port;
+
+static bool conn_open(conn_t *c)
+{
+    c->fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (c->fd < 0) {
+        return false;
+    }
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(s_port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    // Long polls hold the connection for chat_wait_s; anything longer is a hang
+    struct timeval tv = { .tv_sec = s_opts.chat_wait_s + 15 };
+    int one = 1;
+    setsockopt(c->fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(c->fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    setsockopt(c->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (connect(c->fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(c->fd);
+        c->fd = -1;
+        return false;
+    }
+    c->rpos = c->rlen = 0;
+    return true;
+}
+
+static void conn_close(conn_t *c)
+{
+    if (c->fd >= 0) {
+        close(c->fd);
+        c->fd = -1;
+    }
+}
+
+static bool conn_fill(conn_t *c)
+{
+    if (c->rpos > 0) {
+        memmove(c->rbuf, c->rbuf + c->rpos, c->rlen - c->rpos);
+        c->rlen -= c->rpos;
+        c->rpos = 0;
+    }
+    if (c->rlen == sizeof(c->rbuf)) {
+        return false;
+    }
+    ssize_t n = recv(c->fd, c->rbuf + c->rlen, sizeof(c->rbuf) - c->rlen, 0);
+    if (n <= 0) {
+        return false;
+    }
+    c->rlen += (size_t)n;
+    return true;
+}
+
+/**
+ * @brief Next CRLF-terminated line, NUL-terminated in place
+ */
+static char *conn_line(conn_t *c)
+{
+    for (;;) {
+        char *start = c->rbuf + c->rpos;
+        char *eol = memmem(start, c->rlen - c->rpos, "\r\n", 2);
+        if (eol != NULL) {
+            *eol = '\0';
+            c->rpos = (size_t)(eol + 2 - c->rbuf);
+            return start;
+        }
+        if (!conn_fill(c)) {
+            return NULL;
+        }
+    }
+}
+
+static bool conn_body(conn_t *c, size_t len, resp_t *resp)
+{
+    while (len > 0) {
+        if (c->rpos == c->rlen && !conn_fill(c)) {
+            return false;
+        }
+        size_t n = c->rlen - c->rpos < len ? c->rlen - c->rpos : len;
+        size_t keep = RESP_BODY_MAX - resp->body_len < n ? RESP_BODY_MAX - resp->body_len : n;
+        memcpy(resp->body + resp->body_len, c->rbuf + c->rpos, keep);
+        resp->body_len += keep;
+        resp->body_total += n;
+        c->rpos += n;
+        len -= n;
+    }
+    return true;
+}
+
+static bool read_response(conn_t *c, resp_t *resp)
+{
+    char *line = conn_line(c);
+    if (line == NULL || sscanf(line, "HTTP/1.%*d %d", &resp->status) != 1) {
+        return false;
+    }
+
+    long long content_len = -1;
+    bool chunked = false;
+    resp->content_type[0] = '\0';
+    while ((line = conn_line(c)) != NULL && line[0] != '\0') {
+        if (strncasecmp(line, "Content-Length:", 15) == 0) {
+            content_len = atoll(line + 15);
+        } else if (strncasecmp(line, "Transfer-Encoding:", 18) == 0 && strstr(line, "chunked") != NULL) {
+            chunked = true;
+        } else if (strncasecmp(line, "Content-Type:", 13) == 0) {
+            const char *v = line + 13;
+            while (*v == ' ') {
+                v++;
+            }
+            snprintf(resp->content_type, sizeof(resp->content_type), "%s", v);
+        }
+    }
+    if (line == NULL) {
+        return false;
+    }
+
+    resp->body_len = resp->body_total = 0;
+    bool ok = true;
+    if (chunked) {
+        for (;;) {
+            line = conn_line(c);
+            if (line == NULL) {
+                return false;
+            }
+            size_t size = strtoul(line, NULL, 16);
+            if (size == 0) {
+                ok = conn_line(c) != NULL;  // Blank line after the last chunk
+                break;
+            }
+            if (!conn_body(c, size, resp) || (line = conn_line(c)) == NULL) {
+                return false;
+            }
+        }
+    } else if (content_len > 0) {
+        ok = conn_body(c, (size_t)content_len, resp);
+    }
+    resp->body[resp->body_len] = '\0';
+    return ok;
+}
+
+/**
+ * @brief One request on a kept-alive connection, reconnecting as needed.
+ *
+ * The station purges idle sessions (LRU) when all of its sockets are in
+ * use, so a kept connection may be gone: a request that fails before any
+ * response arrived on a reused connection is retried once on a new one.
+ */
+static bool http_request(conn_t *c, const char *method, const char *path,
+                         const void *body, size_t body_len, const char *content_type,
+                         resp_t *resp)
+{
+    char head[768];
+    int head_len = snprintf(head, sizeof(head),
+                            "%s %s HTTP/1.1\r\nHost: 127.0.0.1\r\nConnection: keep-alive\r\n"
+                            "Content-Type: %s\r\nContent-Length: %zu\r\n\r\n",
+                            method, path, content_type != NULL ? content_type : "text/plain",
+                            body_len);
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (c->rpos != c->rlen) {
+            conn_close(c);      // Bytes nobody asked for: out of step with the server
+        }
+        c->rpos = c->rlen = 0;
+        bool reused = c->fd >= 0;
+        if (!reused && !conn_open(c)) {
+            return false;
+        }
+        if (send(c->fd, head, (size_t)head_len, MSG_NOSIGNAL) == head_len &&
+            (body_len == 0 || send(c->fd, body, body_len, MSG_NOSIGNAL) == (ssize_t)body_len) &&
+            read_response(c, resp)) {
+            return true;
+        }
+        bool nothing_read = c->rlen == 0;
+        conn_close(c);
+        if (!reused || !nothing_read) {
+            return false;
+        }
+        s_reconnects++;
+    }
+    return false;
+}
+
+// ============================================================================
+// Clients
+// ============================================================================
+
+typedef struct {
+    int id;
+    uint32_t rng;
+    conn_t *conn;
+    char *body;                 // RESP_BODY_MAX + 1
+    uint8_t *file;              // File being relayed (files clients)
+} client_t;
+
+static uint32_t rng_next(client_t *cl)
+{
+    // xorshift32
+    cl->rng ^= cl->rng << 13;
+    cl->rng ^= cl->rng >> 17;
+    cl->rng ^= cl->rng << 5;
+    return cl->rng;
+}
+
+static void sleep_ms(int ms)
+{
+    struct timespec ts = { .tv_sec = ms / 1000, .tv_nsec = (long)(ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+static void *map_buffer(size_t size)
+{
+    void *p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return p == MAP_FAILED ? NULL : p;
+}
+
+static void chat_send(client_t *cl, uint32_t seq)
+{
+    resp_t resp = { .body = cl->body };
+    char form[128];
+    int len = snprintf(form, sizeof(form), "text=bench+message+%u+from+%d&callsign=BENCH%d",
+                       seq, cl->id, cl->id);
+    int64_t start = esp_timer_get_time();
+    if (!http_request(cl->conn, "POST", "/api/chat/send", form, (size_t)len,
+                      "application/x-www-form-urlencoded", &resp) || resp.status != 200) {
+        s_stats[OP_CHAT_SEND].errors++;
+    } else {
+        stats_record(OP_CHAT_SEND, start, resp.body_total);
+    }
+}
+
+/**
+ * @brief Poll for messages and post now and then, on one connection.
+ *
+ * A post that falls due during a long poll goes out when the poll
+ * returns, which is at the latest chat_wait_s later.
+ */
+static void chat_client(client_t *cl)
+{
+    resp_t resp = { .body = cl->body };
+    uint32_t since = 0;
+    uint32_t sent = 0;
+    // Spread the posts so clients do not all send in the same instant
+    int64_t next_send = esp_timer_get_time() +
+                        (int64_t)(rng_next(cl) % (uint32_t)(s_opts.chat_send_ms + 1)) * 1000;
+
+    while (s_running) {
+        if (s_opts.chat_send_ms > 0 && esp_timer_get_time() >= next_send) {
+            chat_send(cl, sent++);
+            next_send = esp_timer_get_time() + (int64_t)s_opts.chat_send_ms * 1000;
+        }
+
+        char path[96];
+        snprintf(path, sizeof(path), "/api/chat/messages?since=%u&wait=%d", since, s_opts.chat_wait_s);
+        int64_t start = esp_timer_get_time();
+        if (!http_request(cl->conn, "GET", path, NULL, 0, NULL, &resp) || resp.status != 200) {
+            s_stats[OP_CHAT_POLL].errors++;
+            sleep_ms(200);
+            continue;
+        }
+        stats_record(OP_CHAT_POLL, start, resp.body_total);
+
+        uint32_t latest = since;
+        const char *p = strstr(resp.body, "\"latest_id\":");
+        if (p != NULL) {
+            latest = (uint32_t)strtoul(p + 12, NULL, 10);
+        }
+        // Nothing new and not held: short polls, or every long-poll slot
+        // taken. Either way the app waits before asking again.
+        if (latest == since) {
+            sleep_ms(1000);
+        }
+        since = latest;
+    }
+}
+
+static void tile_client(client_t *cl)
+{
+    resp_t resp = { .body = cl->body };
+    while (s_running) {
+        // Squaring a uniform draw skews requests toward the low tile numbers,
+        // so part of the working set is hot and the rest keeps missing
+        double u = (double)(rng_next(cl) % 1000000) / 1000000.0;
+        int n = (int)(u * u * s_opts.tile_set);
+        int z = 14;
+        int x = 8000 + n % 64;
+        int y = 5000 + n / 64;
+
+        char path[64];
+        snprintf(path, sizeof(path), "/tiles/%d/%d/%d.png", z, x, y);
+        int64_t start = esp_timer_get_time();
+        if (!http_request(cl->conn, "GET", path, NULL, 0, NULL, &resp)) {
+            s_stats[OP_TILE].errors++;
+            sleep_ms(100);
+        } else if (resp.status == 503) {
+            s_stats[OP_TILE].busy++;
+            sleep_ms(250);
+        } else if (resp.status != 200) {
+            s_stats[OP_TILE].errors++;
+        } else {
+            stats_record(OP_TILE, start, resp.body_total);
+        }
+    }
+}
+
+static bool json_status_is(const resp_t *resp, const char *status)
+{
+    char want[48];
+    snprintf(want, sizeof(want), "\"status\":\"%s\"", status);
+    return strstr(resp->body, want) != NULL;
+}
+
+/**
+ * @brief Relay one file: upload chunks as the window allows, download
+ *        each chunk as soon as it is there, and compare it to the source
+ */
+static void file_transfer(client_t *cl, uint32_t seq)
+{
+    size_t size = (size_t)s_opts.file_kb * 1024;
+    for (size_t i = 0; i < size; i += 4) {
+        uint32_t v = rng_next(cl);
+        memcpy(cl->file + i, &v, size - i < 4 ? size - i : 4);
+    }
+    uint8_t digest[20];
+    char sha1[41];
+    mbedtls_sha1(cl->file, size, digest);
+    for (int i = 0; i < 20; i++) {
+        sprintf(sha1 + i * 2, "%02x", digest[i]);
+    }
+
+    int total = (int)((size + FILE_RELAY_CHUNK_SIZE - 1) / FILE_RELAY_CHUNK_SIZE);
+    int up = 0;
+    int down = 0;
+    resp_t resp = { .body = cl->body };
+    int64_t xfer_start = esp_timer_get_time();
+
+    while (s_running && down < total) {
+        bool progressed = false;
+
+        if (up < total) {
+            size_t off = (size_t)up * FILE_RELAY_CHUNK_SIZE;
+            size_t len = size - off < FILE_RELAY_CHUNK_SIZE ? size - off : FILE_RELAY_CHUNK_SIZE;
+            char path[256];
+            snprintf(path, sizeof(path),
+                     "/api/file/upload?sha1=%s&chunk=%d&total_chunks=%d&size=%zu"
+                     "&filename=bench-%d-%u.bin&mime=application%%2Foctet-stream",
+                     sha1, up, total, size, cl->id, seq);
+            int64_t start = esp_timer_get_time();
+            if (!http_request(cl->conn, "POST", path, cl->file + off, len,
+                              "application/octet-stream", &resp) || resp.status != 200) {
+                s_stats[OP_FILE_UP].errors++;
+                return;
+            }
+            if (json_status_is(&resp, "accepted")) {
+                stats_record(OP_FILE_UP, start, len);
+                up++;
+                progressed = true;
+            } else if (json_status_is(&resp, "cached")) {
+                stats_record(OP_FILE_UP, start, 0);
+                up = total;
+                progressed = true;
+            } else if (json_status_is(&resp, "wait") || strstr(resp.body, "Too many transfers") != NULL) {
+                s_stats[OP_FILE_UP].busy++;
+            } else {
+                s_stats[OP_FILE_UP].errors++;
+                return;
+            }
+        }
+
+        if (down < up) {
+            char path[128];
+            snprintf(path, sizeof(path), "/api/file/download?sha1=%s&chunk=%d", sha1, down);
+            int64_t start = esp_timer_get_time();
+            // 503 carries "wait" when the file lock stayed busy
+            if (!http_request(cl->conn, "GET", path, NULL, 0, NULL, &resp) ||
+                (resp.status != 200 && resp.status != 503)) {
+                s_stats[OP_FILE_DOWN].errors++;
+                return;
+            }
+            if (strncmp(resp.content_type, "application/octet-stream", 24) == 0) {
+                size_t off = (size_t)down * FILE_RELAY_CHUNK_SIZE;
+                size_t len = size - off < FILE_RELAY_CHUNK_SIZE ? size - off : FILE_RELAY_CHUNK_SIZE;
+                if (resp.body_len != len || memcmp(resp.body, cl->file + off, len) != 0) {
+                    fprintf(stderr, "client %d: chunk %d of %.8s corrupted\n", cl->id, down, sha1);
+                    s_stats[OP_FILE_DOWN].errors++;
+                    return;
+                }
+                stats_record(OP_FILE_DOWN, start, len);
+                down++;
+                progressed = true;
+            } else if (json_status_is(&resp, "wait")) {
+                s_stats[OP_FILE_DOWN].busy++;
+            } else {
+                s_stats[OP_FILE_DOWN].errors++;
+                return;
+            }
+        }
+
+        if (!progressed) {
+            sleep_ms(50);
+        }
+    }
+
+    if (down == total) {
+        stats_record(OP_FILE_XFER, xfer_start, size);
+    }
+}
+
+static void file_client(client_t *cl)
+{
+    for (uint32_t seq = 0; s_running; seq++) {
+        file_transfer(cl, seq);
+    }
+}
+
+static void *client_main(void *arg)
+{
+    client_t *cl = arg;
+    int weight = s_opts.mix[0] + s_opts.mix[1] + s_opts.mix[2];
+    // Deal roles round-robin in proportion to the mix
+    int slot = (int)(((long)cl->id * weight) / s_opts.clients) % weight;
+    if (slot < s_opts.mix[0]) {
+        chat_client(cl);
+    } else if (slot < s_opts.mix[0] + s_opts.mix[1]) {
+        tile_client(cl);
+    } else {
+        file_client(cl);
+    }
+    conn_close(cl->conn);
+    return NULL;
+}
+
+// ============================================================================
+// Report
+// ============================================================================
+
+static void report(double elapsed_s, const host_heap_stats_t *heap)
+{
+    size_t internal_total = (size_t)s_opts.internal_kb * 1024;
+    size_t psram_total = (size_t)s_opts.psram_kb * 1024;
+
+    if (s_opts.json) {
+        printf("{\"clients\":%d,\"duration_s\":%.1f,\"ops\":{", s_opts.clients, elapsed_s);
+        for (int i = 0; i < OP_COUNT; i++) {
+            const op_stats_t *st = &s_stats[i];
+            printf("%s\"%s\":{\"count\":%llu,\"per_s\":%.1f,\"p50_ms\":%.2f,\"p90_ms\":%.2f,"
+                   "\"p99_ms\":%.2f,\"max_ms\":%.2f,\"errors\":%llu,\"busy\":%llu,\"bytes\":%llu}",
+                   i > 0 ? "," : "", s_op_names[i], (unsigned long long)st->ops,
+                   st->ops / elapsed_s, stats_percentile_ms(st, 50), stats_percentile_ms(st, 90),
+                   stats_percentile_ms(st, 99), st->max_us / 1000.0,
+                   (unsigned long long)st->errors, (unsigned long long)st->busy,
+                   (unsigned long long)st->bytes);
+        }
+        printf("},\"heap\":{\"internal_total\":%zu,\"internal_peak\":%zu,\"psram_total\":%zu,"
+               "\"psram_peak\":%zu,\"failed\":%u},\"reconnects\":%llu,\"origin_requests\":%u}\n",
+               internal_total, heap->internal_peak, psram_total, heap->psram_peak,
+               heap->failed, (unsigned long long)s_reconnects, host_origin_get_requests());
+        return;
+    }
+
+    printf("\n%d clients, %.1f s\n\n", s_opts.clients, elapsed_s);
+    printf("%-10s %8s %8s %8s %8s %8s %8s %7s %7s\n",
+           "request", "count", "per s", "p50 ms", "p90 ms", "p99 ms", "max ms", "errors", "busy");
+    for (int i = 0; i < OP_COUNT; i++) {
+        const op_stats_t *st = &s_stats[i];
+        if (st->ops == 0 && st->errors == 0 && st->busy == 0) {
+            continue;
+        }
+        printf("%-10s %8llu %8.1f %8.2f %8.2f %8.2f %8.2f %7llu %7llu\n",
+               s_op_names[i], (unsigned long long)st->ops, st->ops / elapsed_s,
+               stats_percentile_ms(st, 50), stats_percentile_ms(st, 90),
+               stats_percentile_ms(st, 99), st->max_us / 1000.0,
+               (unsigned long long)st->errors, (unsigned long long)st->busy);
+    }
+    printf("\nheap peak: internal %zu / %zu KB, PSRAM %zu / %zu KB, %u failed allocations\n",
+           heap->internal_peak / 1024, internal_total / 1024,
+           heap->psram_peak / 1024, psram_total / 1024, heap->failed);
+    printf("reconnects: %llu, upstream tile requests: %u\n",
+           (unsigned long long)s_reconnects, host_origin_get_requests());
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+static int remove_entry(const char *path, const struct stat *st, int flag, struct FTW *ftw)
+{
+    (void)st;
+    (void)flag;
+    (void)ftw;
+    return remove(path);
+}
+
+int main(int argc, char **argv)
+{
+    if (!parse_opts(argc, argv)) {
+        return 2;
+    }
+    if (s_opts.verbose) {
+        esp_log_level_set("*", ESP_LOG_INFO);
+    } else if (getenv("GEOGRAM_LOG") == NULL) {
+        esp_log_level_set("*", ESP_LOG_ERROR);
+    }
+
+    host_heap_configure((size_t)s_opts.internal_kb * 1024, (size_t)s_opts.psram_kb * 1024);
+    host_origin_configure((uint32_t)s_opts.origin_ms, (size_t)s_opts.origin_kb * 1024, s_opts.origin_fail);
+    host_httpd_set_port((uint16_t)s_opts.port);
+
+    char tmp_card[] = "/tmp/geogram-bench-XXXXXX";
+    const char *card = s_opts.sdcard;
+    if (card == NULL) {
+        card = mkdtemp(tmp_card);
+        if (card == NULL) {
+            perror("mkdtemp");
+            return 1;
+        }
+    }
+    if (host_sdcard_set_root(card) != ESP_OK || sdcard_init() != ESP_OK) {
+        fprintf(stderr, "Cannot use %s as the SD card\n", card);
+        return 1;
+    }
+
+    // Boot order of main.cpp for the ePaper board
+    nvs_flash_init();
+    if (tiles_init() != ESP_OK) {
+        fprintf(stderr, "Tile cache init failed\n");
+    }
+    if (file_cache_init() != ESP_OK) {
+        fprintf(stderr, "File cache init failed\n");
+    }
+    station_init();
+    if (http_server_start_ex(NULL, true) != ESP_OK) {
+        fprintf(stderr, "HTTP server did not start\n");
+        return 1;
+    }
+    s_port = host_httpd_get_port();
+    host_heap_reset_peak();
+    if (!s_opts.json) {
+        printf("station on 127.0.0.1:%u, card at %s\n", s_port, card);
+    }
+
+    size_t file_size = (size_t)s_opts.file_kb * 1024;
+    client_t *clients = map_buffer(sizeof(client_t) * (size_t)s_opts.clients);
+    pthread_t *threads = map_buffer(sizeof(pthread_t) * (size_t)s_opts.clients);
+    if (clients == NULL || threads == NULL) {
+        perror("mmap");
+        return 1;
+    }
+    for (int i = 0; i < s_opts.clients; i++) {
+        client_t *cl = &clients[i];
+        cl->id = i;
+        cl->rng = 0x9e3779b9u * (uint32_t)(i + 1);
+        cl->conn = map_buffer(sizeof(conn_t));
+        cl->body = map_buffer(RESP_BODY_MAX + 1);
+        cl->file = map_buffer(file_size);
+        if (cl->conn == NULL || cl->body == NULL || cl->file == NULL) {
+            perror("mmap");
+            return 1;
+        }
+        cl->conn->fd = -1;
+    }
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < s_opts.clients; i++) {
+        pthread_create(&threads[i], NULL, client_main, &clients[i]);
+        sleep_ms(5);    // Not all in the same instant: the listen backlog is small
+    }
+    sleep((unsigned)s_opts.duration_s);
+    s_running = false;
+    double elapsed_s = (esp_timer_get_time() - start) / 1e6;
+
+    // Parked long polls answer within chat_wait_s; wake them with a post
+    char form[] = "text=bench+done&callsign=BENCH";
+    conn_t *conn = map_buffer(sizeof(conn_t));
+    char *body = map_buffer(RESP_BODY_MAX + 1);
+    if (conn != NULL && body != NULL) {
+        resp_t resp = { .body = body };
+        conn->fd = -1;
+        http_request(conn, "POST", "/api/chat/send", form, sizeof(form) - 1,
+                     "application/x-www-form-urlencoded", &resp);
+        conn_close(conn);
+    }
+    for (int i = 0; i < s_opts.clients; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    host_heap_stats_t heap;
+    host_heap_get_stats(&heap);
+    report(elapsed_s, &heap);
+
+    http_server_stop();
+    if (s_opts.sdcard == NULL && !s_opts.keep) {
+        nftw(card, remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+    }
+    return heap.failed > 0 ? 3 : 0;
+}
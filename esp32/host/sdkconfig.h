@@ -0,0 +1,86 @@
+/**
+ * @file sdkconfig.h
+ * @brief Configuration of the host build: the ESP32-S3 ePaper board with
+ *        Kconfig defaults
+ *
+ * Every value can be overridden from the compiler command line, e.g.
+ * cmake -DCMAKE_C_FLAGS=-DCONFIG_GEOGRAM_HTTP_ASYNC_WORKERS=0, to compare
+ * settings under the same load.
+ */
+
+#ifndef HOST_SDKCONFIG_H
+#define HOST_SDKCONFIG_H
+
+#define CONFIG_IDF_TARGET "linux"
+#define CONFIG_IDF_TARGET_LINUX 1
+#define CONFIG_FREERTOS_HZ 1000
+#define CONFIG_HTTPD_MAX_REQ_HDR_LEN 1024
+#define CONFIG_HTTPD_MAX_URI_LEN 512
+#define CONFIG_SPIRAM 1
+#define CONFIG_SPIRAM_USE_MALLOC 1
+
+#define CONFIG_GEOGRAM_BOARD_EPAPER_1IN54 1
+
+// CONFIG_GEOGRAM_MESH_ENABLED stays unset: mesh needs the radio, so chat
+// and tiles run as on a node without peers
+
+// geogram_common
+#ifndef CONFIG_GEOGRAM_HTTP_ASYNC_WORKERS
+#define CONFIG_GEOGRAM_HTTP_ASYNC_WORKERS 2
+#endif
+#ifndef CONFIG_GEOGRAM_HTTP_ASYNC_QUEUE
+#define CONFIG_GEOGRAM_HTTP_ASYNC_QUEUE 3
+#endif
+
+// geogram_http
+#ifndef CONFIG_GEOGRAM_FILE_CACHE_QUOTA_MB
+#define CONFIG_GEOGRAM_FILE_CACHE_QUOTA_MB 256
+#endif
+
+// geogram_http_client
+#ifndef CONFIG_GEOGRAM_HTTP_CLIENT_WORKERS
+#define CONFIG_GEOGRAM_HTTP_CLIENT_WORKERS 2
+#endif
+#ifndef CONFIG_GEOGRAM_HTTP_CLIENT_HOSTS
+#define CONFIG_GEOGRAM_HTTP_CLIENT_HOSTS 2
+#endif
+#ifndef CONFIG_GEOGRAM_HTTP_CLIENT_IDLE_S
+#define CONFIG_GEOGRAM_HTTP_CLIENT_IDLE_S 20
+#endif
+
+// geogram_tiles
+#ifndef CONFIG_GEOGRAM_TILES_RAM_CACHE_KB
+#define CONFIG_GEOGRAM_TILES_RAM_CACHE_KB 2048
+#endif
+#ifndef CONFIG_GEOGRAM_TILES_FETCH_WORKERS
+#define CONFIG_GEOGRAM_TILES_FETCH_WORKERS 2
+#endif
+#ifndef CONFIG_GEOGRAM_TILES_QUOTA_MB
+#define CONFIG_GEOGRAM_TILES_QUOTA_MB 1024
+#endif
+#if !defined(CONFIG_GEOGRAM_TILES_MISS_503) && !defined(CONFIG_GEOGRAM_TILES_MISS_PARENT)
+#define CONFIG_GEOGRAM_TILES_MISS_WAIT 1
+#endif
+#ifndef CONFIG_GEOGRAM_TILES_MISS_WAIT_MS
+#define CONFIG_GEOGRAM_TILES_MISS_WAIT_MS 3000
+#endif
+#ifndef CONFIG_GEOGRAM_TILES_RETRY_AFTER_S
+#define CONFIG_GEOGRAM_TILES_RETRY_AFTER_S 2
+#endif
+#ifndef CONFIG_GEOGRAM_TILES_MESH_PEERS
+#define CONFIG_GEOGRAM_TILES_MESH_PEERS 1
+#endif
+#ifndef CONFIG_GEOGRAM_TILES_PEER_TIMEOUT_MS
+#define CONFIG_GEOGRAM_TILES_PEER_TIMEOUT_MS 3000
+#endif
+#ifndef CONFIG_GEOGRAM_TILES_PEER_NEG_TTL_S
+#define CONFIG_GEOGRAM_TILES_PEER_NEG_TTL_S 120
+#endif
+#ifndef CONFIG_GEOGRAM_TILES_PREFETCH_RATE
+#define CONFIG_GEOGRAM_TILES_PREFETCH_RATE 2
+#endif
+#ifndef CONFIG_GEOGRAM_TILES_PREFETCH_MAX_TILES
+#define CONFIG_GEOGRAM_TILES_PREFETCH_MAX_TILES 100000
+#endif
+
+#endif // HOST_SDKCONFIG_H
@@ -0,0 +1,112 @@
+/**
+ * @file board.c
+ * @brief Host shim: board components the station code calls into
+ *
+ * A host station is a standalone node: no mesh, no LED, a fixed Nostr
+ * identity and no update mirror.
+ */
+
+#include <string.h>
+#include "esp_err.h"
+#include "mesh_bsp.h"
+#include "led_bsp.h"
+#include "nostr_keys.h"
+#include "updates.h"
+
+// ============================================================================
+// Mesh: never connected
+// ============================================================================
+
+bool geogram_mesh_is_connected(void)
+{
+    return false;
+}
+
+bool geogram_mesh_is_root(void)
+{
+    return false;
+}
+
+uint8_t geogram_mesh_get_layer(void)
+{
+    return 0;
+}
+
+bool geogram_mesh_has_parent(void)
+{
+    return false;
+}
+
+esp_err_t geogram_mesh_get_parent_ip(uint32_t *ip)
+{
+    (void)ip;
+    return ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t geogram_mesh_get_nodes(geogram_mesh_node_t *nodes, size_t max_nodes, size_t *node_count)
+{
+    (void)nodes;
+    (void)max_nodes;
+    *node_count = 0;
+    return ESP_OK;
+}
+
+size_t geogram_mesh_get_node_count(void)
+{
+    return 0;
+}
+
+esp_err_t geogram_mesh_send_to_node(const uint8_t *dest_mac, const void *data, size_t len)
+{
+    (void)dest_mac;
+    (void)data;
+    (void)len;
+    return ESP_ERR_INVALID_STATE;
+}
+
+// ============================================================================
+// LED
+// ============================================================================
+
+esp_err_t led_notify_chat(void)
+{
+    return ESP_OK;
+}
+
+// ============================================================================
+// Nostr identity
+// ============================================================================
+
+// Placeholder of the right length; nothing on the host checks it
+#define HOST_NPUB       "npub1hostxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxsk7xxh"
+#define HOST_CALLSIGN   "X1HOST"
+
+esp_err_t nostr_keys_init(void)
+{
+    return ESP_OK;
+}
+
+bool nostr_keys_available(void)
+{
+    return true;
+}
+
+const char *nostr_keys_get_callsign(void)
+{
+    return HOST_CALLSIGN;
+}
+
+const char *nostr_keys_get_npub(void)
+{
+    return HOST_NPUB;
+}
+
+// ============================================================================
+// Update mirror: not on the host (needs mbedTLS and a firmware store)
+// ============================================================================
+
+esp_err_t updates_register_http_handlers(httpd_handle_t server)
+{
+    (void)server;
+    return ESP_ERR_NOT_SUPPORTED;
+}
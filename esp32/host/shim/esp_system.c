@@ -0,0 +1,442 @@
+/**
+ * @file esp_system.c
+ * @brief Host shim: errors, logging, time, heap accounting, MAC and RNG
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/random.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+#include "esp_mac.h"
+#include "esp_wifi.h"
+#include "esp_random.h"
+#include "geogram_host.h"
+#include "host_internal.h"
+
+// ============================================================================
+// Errors
+// ============================================================================
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_INVALID_RESPONSE: return "ESP_ERR_INVALID_RESPONSE";
+        case ESP_ERR_INVALID_CRC: return "ESP_ERR_INVALID_CRC";
+        case ESP_ERR_INVALID_VERSION: return "ESP_ERR_INVALID_VERSION";
+        case ESP_ERR_INVALID_MAC: return "ESP_ERR_INVALID_MAC";
+        case ESP_ERR_NOT_FINISHED: return "ESP_ERR_NOT_FINISHED";
+        case ESP_ERR_NOT_ALLOWED: return "ESP_ERR_NOT_ALLOWED";
+        case ESP_ERR_NVS_NOT_INITIALIZED: return "ESP_ERR_NVS_NOT_INITIALIZED";
+        case ESP_ERR_NVS_NOT_FOUND: return "ESP_ERR_NVS_NOT_FOUND";
+        case ESP_ERR_NVS_INVALID_LENGTH: return "ESP_ERR_NVS_INVALID_LENGTH";
+        case ESP_ERR_HTTPD_HANDLERS_FULL: return "ESP_ERR_HTTPD_HANDLERS_FULL";
+        case ESP_ERR_HTTPD_HANDLER_EXISTS: return "ESP_ERR_HTTPD_HANDLER_EXISTS";
+        case ESP_ERR_HTTPD_INVALID_REQ: return "ESP_ERR_HTTPD_INVALID_REQ";
+        case ESP_ERR_HTTPD_RESULT_TRUNC: return "ESP_ERR_HTTPD_RESULT_TRUNC";
+        case ESP_ERR_HTTPD_RESP_HDR: return "ESP_ERR_HTTPD_RESP_HDR";
+        case ESP_ERR_HTTPD_RESP_SEND: return "ESP_ERR_HTTPD_RESP_SEND";
+        case ESP_ERR_HTTPD_ALLOC_MEM: return "ESP_ERR_HTTPD_ALLOC_MEM";
+        case ESP_ERR_HTTPD_TASK: return "ESP_ERR_HTTPD_TASK";
+        default: return "UNKNOWN ERROR";
+    }
+}
+
+// ============================================================================
+// Time and logging
+// ============================================================================
+
+static int64_t s_start_us;
+
+static int64_t monotonic_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+__attribute__((constructor))
+static void host_clock_init(void)
+{
+    s_start_us = monotonic_us();
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return monotonic_us() - s_start_us;
+}
+
+uint32_t esp_log_timestamp(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static esp_log_level_t s_log_level = ESP_LOG_INFO;
+
+__attribute__((constructor))
+static void host_log_init(void)
+{
+    // GEOGRAM_LOG=e|w|i|d|v picks the level, as "esp_log_level_set *" would
+    const char *env = getenv("GEOGRAM_LOG");
+    if (env == NULL) {
+        return;
+    }
+    switch (env[0]) {
+        case 'n': s_log_level = ESP_LOG_NONE; break;
+        case 'e': s_log_level = ESP_LOG_ERROR; break;
+        case 'w': s_log_level = ESP_LOG_WARN; break;
+        case 'd': s_log_level = ESP_LOG_DEBUG; break;
+        case 'v': s_log_level = ESP_LOG_VERBOSE; break;
+        default: s_log_level = ESP_LOG_INFO; break;
+    }
+}
+
+void esp_log_level_set(const char *tag, esp_log_level_t level)
+{
+    (void)tag;
+    s_log_level = level;
+}
+
+esp_log_level_t esp_log_level_get(const char *tag)
+{
+    (void)tag;
+    return s_log_level;
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    (void)level;
+    (void)tag;
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+}
+
+void esp_restart(void)
+{
+    ESP_LOGW("host", "esp_restart() called, exiting");
+    exit(0);
+}
+
+// ============================================================================
+// Heap accounting
+// ============================================================================
+
+// malloc(), calloc(), realloc() and free() of the firmware objects are
+// routed here with the linker's --wrap, so every allocation carries a
+// header saying which modelled pool it counts against
+void *__real_malloc(size_t size);
+void __real_free(void *ptr);
+
+#define HEAP_MAGIC      0x47454f48u     // "GEOH"
+
+enum { POOL_INTERNAL, POOL_PSRAM, POOL_COUNT };
+
+typedef struct {
+    size_t size;
+    uint32_t pool;
+    uint32_t magic;
+} __attribute__((aligned(16))) heap_hdr_t;
+
+static pthread_mutex_t s_heap_lock = PTHREAD_MUTEX_INITIALIZER;
+static size_t s_cap[POOL_COUNT] = { HOST_HEAP_INTERNAL_DEFAULT, HOST_HEAP_PSRAM_DEFAULT };
+static size_t s_used[POOL_COUNT];
+static size_t s_peak[POOL_COUNT];
+static size_t s_lifetime_peak;
+static uint32_t s_failed;
+
+static bool pool_reserve(int pool, size_t bytes)
+{
+    pthread_mutex_lock(&s_heap_lock);
+    bool ok = s_used[pool] + bytes <= s_cap[pool];
+    if (ok) {
+        s_used[pool] += bytes;
+        if (s_used[pool] > s_peak[pool]) {
+            s_peak[pool] = s_used[pool];
+        }
+        size_t total = s_used[POOL_INTERNAL] + s_used[POOL_PSRAM];
+        if (total > s_lifetime_peak) {
+            s_lifetime_peak = total;
+        }
+    }
+    pthread_mutex_unlock(&s_heap_lock);
+    return ok;
+}
+
+static void pool_release(int pool, size_t bytes)
+{
+    pthread_mutex_lock(&s_heap_lock);
+    s_used[pool] -= bytes < s_used[pool] ? bytes : s_used[pool];
+    pthread_mutex_unlock(&s_heap_lock);
+}
+
+static void *pool_alloc(int pool, size_t size)
+{
+    if (!pool_reserve(pool, size)) {
+        return NULL;
+    }
+    heap_hdr_t *h = __real_malloc(sizeof(heap_hdr_t) + size);
+    if (h == NULL) {
+        pool_release(pool, size);
+        return NULL;
+    }
+    h->size = size;
+    h->pool = (uint32_t)pool;
+    h->magic = HEAP_MAGIC;
+    return h + 1;
+}
+
+/**
+ * @brief Allocate as ESP-IDF would for @p caps: PSRAM-only, internal-only,
+ *        or the default policy (small blocks internal, large in PSRAM,
+ *        falling back to the other pool)
+ */
+static void *caps_alloc(size_t size, uint32_t caps)
+{
+    void *p = NULL;
+    if (caps & MALLOC_CAP_SPIRAM) {
+        p = pool_alloc(POOL_PSRAM, size);
+    } else if (caps & (MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA)) {
+        p = pool_alloc(POOL_INTERNAL, size);
+    } else {
+        int first = size <= HOST_HEAP_ALWAYS_INTERNAL ? POOL_INTERNAL : POOL_PSRAM;
+        p = pool_alloc(first, size);
+        if (p == NULL) {
+            p = pool_alloc(first == POOL_INTERNAL ? POOL_PSRAM : POOL_INTERNAL, size);
+        }
+    }
+    if (p == NULL) {
+        pthread_mutex_lock(&s_heap_lock);
+        s_failed++;
+        pthread_mutex_unlock(&s_heap_lock);
+    }
+    return p;
+}
+
+static heap_hdr_t *header_of(void *ptr)
+{
+    heap_hdr_t *h = (heap_hdr_t *)ptr - 1;
+    return h->magic == HEAP_MAGIC ? h : NULL;
+}
+
+void *__wrap_malloc(size_t size)
+{
+    return caps_alloc(size, MALLOC_CAP_DEFAULT);
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+    return heap_caps_calloc(n, size, MALLOC_CAP_DEFAULT);
+}
+
+void __wrap_free(void *ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+    heap_hdr_t *h = header_of(ptr);
+    if (h == NULL) {
+        // Allocated inside libc (not counted)
+        __real_free(ptr);
+        return;
+    }
+    h->magic = 0;
+    pool_release((int)h->pool, h->size);
+    __real_free(h);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    return heap_caps_realloc(ptr, size, MALLOC_CAP_DEFAULT);
+}
+
+void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    return caps_alloc(size, caps);
+}
+
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps)
+{
+    if (size != 0 && n > SIZE_MAX / size) {
+        return NULL;
+    }
+    void *p = caps_alloc(n * size, caps);
+    if (p != NULL) {
+        memset(p, 0, n * size);
+    }
+    return p;
+}
+
+void *heap_caps_realloc(void *ptr, size_t size, uint32_t caps)
+{
+    if (ptr == NULL) {
+        return caps_alloc(size, caps);
+    }
+    if (size == 0) {
+        __wrap_free(ptr);
+        return NULL;
+    }
+    heap_hdr_t *h = header_of(ptr);
+    size_t old_size = h != NULL ? h->size : 0;
+    void *p = caps_alloc(size, caps);
+    if (p == NULL) {
+        return NULL;
+    }
+    memcpy(p, ptr, old_size < size ? old_size : size);
+    __wrap_free(ptr);
+    return p;
+}
+
+void heap_caps_free(void *ptr)
+{
+    __wrap_free(ptr);
+}
+
+static int caps_pool(uint32_t caps)
+{
+    return (caps & MALLOC_CAP_SPIRAM) ? POOL_PSRAM : POOL_INTERNAL;
+}
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+    int pool = caps_pool(caps);
+    pthread_mutex_lock(&s_heap_lock);
+    size_t free_bytes = s_cap[pool] - s_used[pool];
+    pthread_mutex_unlock(&s_heap_lock);
+    return free_bytes;
+}
+
+size_t heap_caps_get_total_size(uint32_t caps)
+{
+    return s_cap[caps_pool(caps)];
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps)
+{
+    int pool = caps_pool(caps);
+    pthread_mutex_lock(&s_heap_lock);
+    size_t free_bytes = s_cap[pool] - s_peak[pool];
+    pthread_mutex_unlock(&s_heap_lock);
+    return free_bytes;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+    return heap_caps_get_free_size(caps);
+}
+
+uint32_t esp_get_free_heap_size(void)
+{
+    return (uint32_t)(heap_caps_get_free_size(MALLOC_CAP_INTERNAL) +
+                      heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+}
+
+uint32_t esp_get_minimum_free_heap_size(void)
+{
+    pthread_mutex_lock(&s_heap_lock);
+    size_t free_bytes = s_cap[POOL_INTERNAL] + s_cap[POOL_PSRAM] - s_lifetime_peak;
+    pthread_mutex_unlock(&s_heap_lock);
+    return (uint32_t)free_bytes;
+}
+
+bool host_heap_charge(size_t bytes)
+{
+    return pool_reserve(POOL_INTERNAL, bytes);
+}
+
+void host_heap_uncharge(size_t bytes)
+{
+    pool_release(POOL_INTERNAL, bytes);
+}
+
+void host_heap_configure(size_t internal_bytes, size_t psram_bytes)
+{
+    pthread_mutex_lock(&s_heap_lock);
+    s_cap[POOL_INTERNAL] = internal_bytes;
+    s_cap[POOL_PSRAM] = psram_bytes;
+    pthread_mutex_unlock(&s_heap_lock);
+}
+
+void host_heap_get_stats(host_heap_stats_t *stats)
+{
+    pthread_mutex_lock(&s_heap_lock);
+    stats->internal_used = s_used[POOL_INTERNAL];
+    stats->internal_peak = s_peak[POOL_INTERNAL];
+    stats->psram_used = s_used[POOL_PSRAM];
+    stats->psram_peak = s_peak[POOL_PSRAM];
+    stats->failed = s_failed;
+    pthread_mutex_unlock(&s_heap_lock);
+}
+
+void host_heap_reset_peak(void)
+{
+    pthread_mutex_lock(&s_heap_lock);
+    s_peak[POOL_INTERNAL] = s_used[POOL_INTERNAL];
+    s_peak[POOL_PSRAM] = s_used[POOL_PSRAM];
+    pthread_mutex_unlock(&s_heap_lock);
+}
+
+// ============================================================================
+// MAC, WiFi and RNG
+// ============================================================================
+
+// Locally administered address, stable across runs
+static const uint8_t s_base_mac[6] = { 0x02, 0x47, 0x45, 0x4f, 0x00, 0x01 };
+
+esp_err_t esp_efuse_mac_get_default(uint8_t *mac)
+{
+    memcpy(mac, s_base_mac, sizeof(s_base_mac));
+    return ESP_OK;
+}
+
+esp_err_t esp_read_mac(uint8_t *mac, esp_mac_type_t type)
+{
+    if (mac == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memcpy(mac, s_base_mac, sizeof(s_base_mac));
+    mac[5] += (uint8_t)type;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_mac(wifi_interface_t ifx, uint8_t mac[6])
+{
+    return esp_read_mac(mac, ifx == WIFI_IF_AP ? ESP_MAC_WIFI_SOFTAP : ESP_MAC_WIFI_STA);
+}
+
+void esp_fill_random(void *buf, size_t len)
+{
+    uint8_t *p = buf;
+    while (len > 0) {
+        ssize_t n = getrandom(p, len, 0);
+        if (n <= 0) {
+            break;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+}
+
+uint32_t esp_random(void)
+{
+    uint32_t r = 0;
+    esp_fill_random(&r, sizeof(r));
+    return r;
+}
@@ -0,0 +1,26 @@
+/**
+ * @file host_internal.h
+ * @brief Shared between the shim sources; not for component code
+ */
+
+#ifndef HOST_INTERNAL_H
+#define HOST_INTERNAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Count memory the firmware holds outside malloc() (task stacks)
+ * @return false if the internal budget cannot take it
+ */
+bool host_heap_charge(size_t bytes);
+
+void host_heap_uncharge(size_t bytes);
+
+/**
+ * @brief Map a /sdcard path to the host directory standing in for the card
+ * @return @p path itself if it is not on the card, else @p buf
+ */
+const char *host_vfs_path(const char *path, char *buf, size_t buf_size);
+
+#endif // HOST_INTERNAL_H
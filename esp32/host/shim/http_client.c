@@ -0,0 +1,178 @@
+/**
+ * @file http_client.c
+ * @brief Host shim: http_client_async.h answered by a simulated upstream
+ *
+ * Stands in for the real client and the tile servers behind it, so tile
+ * misses cost what host_origin_configure() says they cost and nothing
+ * leaves the machine.
+ */
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "http_client_async.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "geogram_host.h"
+
+static const char *TAG = "http_client";
+
+#define DEFAULT_TIMEOUT_MS      15000
+#define DEFAULT_USER_AGENT      "ESP32-HTTP/1.0"
+
+// Pieces handed to on_data(), as the real client reads them
+#define ORIGIN_PIECE_SIZE       4096
+
+static atomic_uint s_latency_ms = 150;
+static atomic_size_t s_body_size = 20 * 1024;
+static atomic_int s_fail_percent = 0;
+static atomic_uint s_requests = 0;
+
+static SemaphoreHandle_t s_workers = NULL;
+static pthread_once_t s_once = PTHREAD_ONCE_INIT;
+
+static void origin_init(void)
+{
+    s_workers = xSemaphoreCreateCounting(CONFIG_GEOGRAM_HTTP_CLIENT_WORKERS,
+                                         CONFIG_GEOGRAM_HTTP_CLIENT_WORKERS);
+}
+
+void host_origin_configure(uint32_t latency_ms, size_t body_size, int fail_percent)
+{
+    s_latency_ms = latency_ms;
+    s_body_size = body_size < 8 ? 8 : body_size;
+    s_fail_percent = fail_percent;
+}
+
+uint32_t host_origin_get_requests(void)
+{
+    return s_requests;
+}
+
+http_client_request_t http_client_default_config(void)
+{
+    http_client_request_t config = {
+        .url = NULL,
+        .user_agent = DEFAULT_USER_AGENT,
+        .timeout_ms = DEFAULT_TIMEOUT_MS,
+        .skip_cert_verify = true,
+        .priority = HTTP_CLIENT_PRIORITY_NORMAL,
+    };
+    return config;
+}
+
+/**
+ * @brief FNV-1a of the URL: the same URL always gets the same body
+ */
+static uint32_t url_hash(const char *url)
+{
+    uint32_t h = 2166136261u;
+    for (const char *p = url; *p != '\0'; p++) {
+        h = (h ^ (uint8_t)*p) * 16777619u;
+    }
+    return h;
+}
+
+static esp_err_t submit(const http_client_request_t *request, const http_client_sink_t *sink,
+                        int *status_code)
+{
+    if (request == NULL || request->url == NULL || sink == NULL || sink->on_headers == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_once(&s_once, origin_init);
+
+    int timeout_ms = request->timeout_ms > 0 ? request->timeout_ms : DEFAULT_TIMEOUT_MS;
+    if (xSemaphoreTake(s_workers, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+        ESP_LOGW(TAG, "Timed out waiting for a worker: %s", request->url);
+        return ESP_ERR_TIMEOUT;
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(s_latency_ms));
+    s_requests++;
+
+    uint32_t seed = url_hash(request->url);
+    int status = (int)(seed % 100) < s_fail_percent ? 503 : 200;
+    size_t size = s_body_size;
+    esp_err_t ret = sink->on_headers(sink->ctx, status, status == 200 ? (int64_t)size : -1);
+    if (status_code != NULL) {
+        *status_code = status;
+    }
+
+    if (ret == ESP_OK && status == 200 && sink->on_data != NULL) {
+        static const uint8_t png_signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+        uint8_t piece[ORIGIN_PIECE_SIZE];
+        for (size_t off = 0; ret == ESP_OK && off < size; off += sizeof(piece)) {
+            size_t len = size - off < sizeof(piece) ? size - off : sizeof(piece);
+            for (size_t i = 0; i < len; i++) {
+                piece[i] = (uint8_t)(seed >> ((i % 4) * 8)) ^ (uint8_t)(off + i);
+            }
+            if (off == 0) {
+                memcpy(piece, png_signature, sizeof(png_signature));
+            }
+            ret = sink->on_data(sink->ctx, piece, len);
+        }
+    }
+
+    xSemaphoreGive(s_workers);
+    return ret;
+}
+
+static esp_err_t buffer_on_headers(void *ctx, int status_code, int64_t content_length)
+{
+    http_client_response_t *resp = ctx;
+    resp->status_code = status_code;
+    resp->data_len = 0;
+    if (status_code == 200 && content_length > 0 && (uint64_t)content_length > resp->buffer_size) {
+        ESP_LOGE(TAG, "Response too large: %lld bytes (buffer: %zu)",
+                 (long long)content_length, resp->buffer_size);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t buffer_on_data(void *ctx, const uint8_t *data, size_t len)
+{
+    http_client_response_t *resp = ctx;
+    if (resp->status_code != 200) {
+        return ESP_OK;
+    }
+    if (len > resp->buffer_size - resp->data_len) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(resp->data + resp->data_len, data, len);
+    resp->data_len += len;
+    return ESP_OK;
+}
+
+esp_err_t http_client_get_async(const http_client_request_t *request, http_client_response_t *response)
+{
+    if (response == NULL || response->data == NULL || response->buffer_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    response->status_code = 0;
+    response->data_len = 0;
+
+    const http_client_sink_t sink = {
+        .on_headers = buffer_on_headers,
+        .on_data = buffer_on_data,
+        .ctx = response,
+    };
+    return submit(request, &sink, NULL);
+}
+
+esp_err_t http_client_get_stream(const http_client_request_t *request,
+                                 const http_client_sink_t *sink, int *status_code)
+{
+    if (status_code != NULL) {
+        *status_code = 0;
+    }
+    esp_err_t ret = submit(request, sink, status_code);
+    if (sink != NULL && sink->on_complete != NULL) {
+        sink->on_complete(sink->ctx, ret);
+    }
+    return ret;
+}
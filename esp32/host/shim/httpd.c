@@ -0,0 +1,1186 @@
+/**
+ * @file httpd.c
+ * @brief Host shim: esp_http_server on POSIX sockets
+ *
+ * Keeps the parts of the ESP-IDF server the station depends on for its
+ * behaviour under load: a single server thread that parses requests and
+ * runs handlers, a fixed session table with LRU purge, per-session send
+ * overrides, and sessions that stay parked while an async handler owns
+ * them. Error handling follows httpd_txrx.c: a handler error or a default
+ * error response closes the connection.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "esp_http_server.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "geogram_host.h"
+#include "host_internal.h"
+
+static const char *TAG = "httpd";
+
+#define HTTPD_RESP_HDRS_MAX     16
+#define HTTPD_RESP_HEAD_MAX     1024
+
+typedef struct {
+    int fd;                     /**< -1 when the slot is free */
+    bool busy;                  /**< A handler (inline or async) owns the session */
+    bool close_pending;         /**< Close once no handler owns it */
+    int64_t last_used_us;       /**< For LRU purge */
+    httpd_send_func_t send_fn;  /**< NULL for the default send */
+    size_t buf_len;             /**< Bytes received past the last request head */
+    char buf[HTTPD_MAX_REQ_HDR_LEN];
+} httpd_sess_t;
+
+struct httpd_data;
+
+typedef struct {
+    struct httpd_data *hd;
+    httpd_sess_t *sess;
+    size_t remaining;           /**< Body bytes not yet read */
+    const char *status;
+    const char *content_type;
+    struct {
+        const char *field;
+        const char *value;
+    } resp_hdrs[HTTPD_RESP_HDRS_MAX];
+    size_t resp_hdr_count;
+    bool chunked;               /**< Head of a chunked response sent */
+    bool async;                 /**< Handed to httpd_req_async_handler_begin() */
+    char hdrs[HTTPD_MAX_REQ_HDR_LEN + 1];   /**< Request header lines, CRLF separated */
+} httpd_req_aux_t;
+
+struct httpd_data {
+    httpd_config_t config;
+    int listen_fd;
+    int wake_fd[2];
+    pthread_t thread;
+    atomic_bool stop;
+    pthread_mutex_t lock;       /**< Session flags, the handler table */
+    httpd_uri_t *handlers;
+    size_t handler_count;
+    httpd_err_handler_func_t err_handlers[HTTPD_ERR_CODE_MAX];
+    httpd_sess_t *sessions;
+    httpd_req_t req;            /**< The request the server thread is handling */
+    httpd_req_aux_t aux;
+};
+
+static int s_port_override = -1;
+static uint16_t s_bound_port = 0;
+
+void host_httpd_set_port(uint16_t port)
+{
+    s_port_override = port;
+}
+
+uint16_t host_httpd_get_port(void)
+{
+    return s_bound_port;
+}
+
+// ============================================================================
+// Sessions
+// ============================================================================
+
+static void wake(struct httpd_data *hd)
+{
+    char c = 0;
+    (void)!write(hd->wake_fd[1], &c, 1);
+}
+
+static httpd_sess_t *sess_find(struct httpd_data *hd, int fd)
+{
+    for (int i = 0; i < hd->config.max_open_sockets; i++) {
+        if (hd->sessions[i].fd == fd && fd >= 0) {
+            return &hd->sessions[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Close a session; called on the server thread with no handler owning it
+ */
+static void sess_close(struct httpd_data *hd, httpd_sess_t *s)
+{
+    pthread_mutex_lock(&hd->lock);
+    int fd = s->fd;
+    s->fd = -1;
+    s->busy = false;
+    s->close_pending = false;
+    s->send_fn = NULL;
+    s->buf_len = 0;
+    pthread_mutex_unlock(&hd->lock);
+
+    if (hd->config.close_fn != NULL) {
+        hd->config.close_fn(hd, fd);
+    } else {
+        close(fd);
+    }
+}
+
+static void sess_accept(struct httpd_data *hd)
+{
+    int fd = accept(hd->listen_fd, NULL, NULL);
+    if (fd < 0) {
+        return;
+    }
+
+    httpd_sess_t *slot = NULL;
+    httpd_sess_t *lru = NULL;
+    pthread_mutex_lock(&hd->lock);
+    for (int i = 0; i < hd->config.max_open_sockets && slot == NULL; i++) {
+        httpd_sess_t *s = &hd->sessions[i];
+        if (s->fd < 0) {
+            slot = s;
+        } else if (!s->busy && (lru == NULL || s->last_used_us < lru->last_used_us)) {
+            lru = s;
+        }
+    }
+    pthread_mutex_unlock(&hd->lock);
+
+    if (slot == NULL && hd->config.lru_purge_enable && lru != NULL) {
+        ESP_LOGD(TAG, "Purging least recently used session %d", lru->fd);
+        sess_close(hd, lru);
+        slot = lru;
+    }
+    if (slot == NULL) {
+        ESP_LOGW(TAG, "No free session for new connection");
+        close(fd);
+        return;
+    }
+
+    struct timeval rcv = { .tv_sec = hd->config.recv_wait_timeout };
+    struct timeval snd = { .tv_sec = hd->config.send_wait_timeout };
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &rcv, sizeof(rcv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &snd, sizeof(snd));
+    // Loopback plus Nagle would add delayed-ACK stalls the board never sees
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    if (hd->config.open_fn != NULL && hd->config.open_fn(hd, fd) != ESP_OK) {
+        close(fd);
+        return;
+    }
+
+    pthread_mutex_lock(&hd->lock);
+    slot->fd = fd;
+    slot->busy = false;
+    slot->close_pending = false;
+    slot->send_fn = NULL;
+    slot->buf_len = 0;
+    slot->last_used_us = esp_timer_get_time();
+    pthread_mutex_unlock(&hd->lock);
+}
+
+// ============================================================================
+// Request handling
+// ============================================================================
+
+static const char *const s_method_names[] = {
+    [HTTP_DELETE] = "DELETE",
+    [HTTP_GET] = "GET",
+    [HTTP_HEAD] = "HEAD",
+    [HTTP_POST] = "POST",
+    [HTTP_PUT] = "PUT",
+    [HTTP_CONNECT] = "CONNECT",
+    [HTTP_OPTIONS] = "OPTIONS",
+    [HTTP_TRACE] = "TRACE",
+    [HTTP_PATCH] = "PATCH",
+};
+
+#define METHOD_COUNT    (sizeof(s_method_names) / sizeof(s_method_names[0]))
+
+const char *http_method_str(enum http_method m)
+{
+    if ((size_t)m < METHOD_COUNT && s_method_names[m] != NULL) {
+        return s_method_names[m];
+    }
+    return "<unknown>";
+}
+
+static int method_parse(const char *name)
+{
+    for (size_t i = 0; i < METHOD_COUNT; i++) {
+        if (s_method_names[i] != NULL && strcmp(s_method_names[i], name) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+static void req_reset(struct httpd_data *hd, httpd_sess_t *s)
+{
+    httpd_req_t *r = &hd->req;
+    httpd_req_aux_t *aux = &hd->aux;
+    memset(r, 0, sizeof(*r));
+    r->handle = hd;
+    r->aux = aux;
+    aux->hd = hd;
+    aux->sess = s;
+    aux->remaining = 0;
+    aux->status = HTTPD_200;
+    aux->content_type = HTTPD_TYPE_TEXT;
+    aux->resp_hdr_count = 0;
+    aux->chunked = false;
+    aux->async = false;
+    aux->hdrs[0] = '\0';
+}
+
+/**
+ * @brief As httpd_req_handle_err(): custom handler if registered, else
+ *        the default error response and a closed connection
+ */
+static esp_err_t req_handle_err(httpd_req_t *r, httpd_err_code_t error)
+{
+    struct httpd_data *hd = r->handle;
+    if (hd->err_handlers[error] != NULL) {
+        esp_err_t ret = hd->err_handlers[error](r, error);
+        return error == HTTPD_500_INTERNAL_SERVER_ERROR ? ESP_FAIL : ret;
+    }
+    httpd_resp_send_err(r, error, NULL);
+    return ESP_FAIL;
+}
+
+static bool uri_matches(struct httpd_data *hd, const char *reference, const char *uri, size_t len)
+{
+    if (hd->config.uri_match_fn != NULL) {
+        return hd->config.uri_match_fn(reference, uri, len);
+    }
+    return strlen(reference) == len && strncmp(reference, uri, len) == 0;
+}
+
+/**
+ * @brief Read and discard what the handler left of the body
+ */
+static bool req_drain(httpd_req_t *r)
+{
+    char scratch[512];
+    httpd_req_aux_t *aux = r->aux;
+    while (aux->remaining > 0) {
+        int n = httpd_req_recv(r, scratch, sizeof(scratch));
+        if (n <= 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Parse the head in the session buffer into hd->req.
+ * @return HTTPD_ERR_CODE_MAX on success, else the error to answer with
+ */
+static httpd_err_code_t req_parse(struct httpd_data *hd, httpd_sess_t *s, size_t head_len)
+{
+    httpd_req_t *r = &hd->req;
+    httpd_req_aux_t *aux = &hd->aux;
+
+    char *line_end = memmem(s->buf, head_len, "\r\n", 2);
+    *line_end = '\0';
+    char *method = s->buf;
+    char *uri = strchr(method, ' ');
+    char *version = uri != NULL ? strchr(uri + 1, ' ') : NULL;
+    if (version == NULL) {
+        return HTTPD_400_BAD_REQUEST;
+    }
+    *uri++ = '\0';
+    *version++ = '\0';
+
+    int m = method_parse(method);
+    if (m < 0) {
+        return HTTPD_501_METHOD_NOT_IMPLEMENTED;
+    }
+    if (strncmp(version, "HTTP/1.", 7) != 0) {
+        return HTTPD_505_VERSION_NOT_SUPPORTED;
+    }
+    if (strlen(uri) > HTTPD_MAX_URI_LEN) {
+        return HTTPD_414_URI_TOO_LONG;
+    }
+    r->method = m;
+    strcpy((char *)r->uri, uri);
+
+    // Header lines, up to and including the CRLF before the blank line
+    size_t hdrs_len = head_len - 2 - (size_t)(line_end + 2 - s->buf);
+    memcpy(aux->hdrs, line_end + 2, hdrs_len);
+    aux->hdrs[hdrs_len] = '\0';
+
+    char value[24];
+    if (httpd_req_get_hdr_value_str(r, "Content-Length", value, sizeof(value)) == ESP_OK) {
+        char *end;
+        unsigned long long len = strtoull(value, &end, 10);
+        if (end == value || *end != '\0') {
+            return HTTPD_400_BAD_REQUEST;
+        }
+        r->content_len = (size_t)len;
+    } else if (httpd_req_get_hdr_value_len(r, "Transfer-Encoding") > 0) {
+        return HTTPD_411_LENGTH_REQUIRED;
+    }
+    aux->remaining = r->content_len;
+    return HTTPD_ERR_CODE_MAX;
+}
+
+/**
+ * @brief Handle one request on a session; returns with the session either
+ *        idle, closed, or owned by an async handler
+ */
+static void sess_process(struct httpd_data *hd, httpd_sess_t *s)
+{
+    char *end;
+    while ((end = memmem(s->buf, s->buf_len, "\r\n\r\n", 4)) == NULL) {
+        if (s->buf_len == sizeof(s->buf)) {
+            req_reset(hd, s);
+            req_handle_err(&hd->req, HTTPD_431_REQ_HDR_FIELDS_TOO_LARGE);
+            sess_close(hd, s);
+            return;
+        }
+        ssize_t n = recv(s->fd, s->buf + s->buf_len, sizeof(s->buf) - s->buf_len, 0);
+        if (n <= 0) {
+            // Peer closed or stalled mid-head
+            sess_close(hd, s);
+            return;
+        }
+        s->buf_len += (size_t)n;
+    }
+    size_t head_len = (size_t)(end + 4 - s->buf);
+
+    req_reset(hd, s);
+    httpd_req_t *r = &hd->req;
+    httpd_err_code_t err = req_parse(hd, s, head_len);
+
+    // Whatever followed the head is body (or the next request)
+    memmove(s->buf, s->buf + head_len, s->buf_len - head_len);
+    s->buf_len -= head_len;
+
+    if (err != HTTPD_ERR_CODE_MAX) {
+        req_handle_err(r, err);
+        sess_close(hd, s);
+        return;
+    }
+
+    httpd_uri_t match = { 0 };
+    bool found = false;
+    bool uri_found = false;
+    size_t path_len = strcspn(r->uri, "?");
+    pthread_mutex_lock(&hd->lock);
+    for (size_t i = 0; i < hd->handler_count && !found; i++) {
+        if (uri_matches(hd, hd->handlers[i].uri, r->uri, path_len)) {
+            uri_found = true;
+            if (hd->handlers[i].method == (httpd_method_t)r->method) {
+                match = hd->handlers[i];
+                found = true;
+            }
+        }
+    }
+    s->busy = true;
+    pthread_mutex_unlock(&hd->lock);
+
+    esp_err_t ret;
+    if (!found) {
+        ret = req_handle_err(r, uri_found ? HTTPD_405_METHOD_NOT_ALLOWED : HTTPD_404_NOT_FOUND);
+    } else if (match.is_websocket) {
+        ESP_LOGW(TAG, "WebSocket upgrade of %s refused on the host", r->uri);
+        ret = req_handle_err(r, HTTPD_501_METHOD_NOT_IMPLEMENTED);
+    } else {
+        r->user_ctx = match.user_ctx;
+        ret = match.handler(r);
+    }
+
+    if (hd->aux.async) {
+        // The async copy owns the session until httpd_req_async_handler_complete()
+        return;
+    }
+    if (ret == ESP_OK && !req_drain(r)) {
+        ret = ESP_FAIL;
+    }
+
+    pthread_mutex_lock(&hd->lock);
+    s->busy = false;
+    s->last_used_us = esp_timer_get_time();
+    bool close_now = ret != ESP_OK || s->close_pending;
+    pthread_mutex_unlock(&hd->lock);
+    if (close_now) {
+        sess_close(hd, s);
+    }
+}
+
+static void *server_main(void *arg)
+{
+    struct httpd_data *hd = arg;
+    size_t max = hd->config.max_open_sockets;
+    struct pollfd *fds = calloc(max + 2, sizeof(struct pollfd));
+    httpd_sess_t **polled = calloc(max, sizeof(httpd_sess_t *));
+    if (fds == NULL || polled == NULL) {
+        ESP_LOGE(TAG, "No memory for the poll set");
+        free(fds);
+        free(polled);
+        return NULL;
+    }
+
+    while (!hd->stop) {
+        size_t count = 0;
+        bool buffered = false;
+
+        // Sessions to close, and the idle ones to wait on
+        for (size_t i = 0; i < max; i++) {
+            httpd_sess_t *s = &hd->sessions[i];
+            pthread_mutex_lock(&hd->lock);
+            bool open = s->fd >= 0;
+            bool busy = s->busy;
+            bool closing = s->close_pending;
+            pthread_mutex_unlock(&hd->lock);
+            if (!open || busy) {
+                continue;
+            }
+            if (closing) {
+                sess_close(hd, s);
+                continue;
+            }
+            buffered |= s->buf_len > 0;
+            polled[count] = s;
+            fds[count++] = (struct pollfd){ .fd = s->fd, .events = POLLIN };
+        }
+        fds[count] = (struct pollfd){ .fd = hd->wake_fd[0], .events = POLLIN };
+        fds[count + 1] = (struct pollfd){ .fd = hd->listen_fd, .events = POLLIN };
+
+        int n = poll(fds, count + 2, buffered ? 0 : 1000);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ESP_LOGE(TAG, "poll() failed: %s", strerror(errno));
+            break;
+        }
+
+        if (fds[count].revents & POLLIN) {
+            char drain[64];
+            while (read(hd->wake_fd[0], drain, sizeof(drain)) > 0) {
+            }
+        }
+        // Sessions before accept(): a purged slot must not be mistaken for a polled one
+        for (size_t i = 0; i < count && !hd->stop; i++) {
+            if ((fds[i].revents & (POLLIN | POLLHUP | POLLERR)) || polled[i]->buf_len > 0) {
+                sess_process(hd, polled[i]);
+            }
+        }
+        if (fds[count + 1].revents & POLLIN) {
+            sess_accept(hd);
+        }
+    }
+
+    free(fds);
+    free(polled);
+    return NULL;
+}
+
+// ============================================================================
+// Server
+// ============================================================================
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config)
+{
+    if (handle == NULL || config == NULL || config->max_open_sockets == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    struct httpd_data *hd = calloc(1, sizeof(*hd));
+    if (hd == NULL) {
+        return ESP_ERR_HTTPD_ALLOC_MEM;
+    }
+    hd->config = *config;
+    if (hd->config.max_resp_headers > HTTPD_RESP_HDRS_MAX) {
+        hd->config.max_resp_headers = HTTPD_RESP_HDRS_MAX;
+    }
+    hd->listen_fd = -1;
+    hd->wake_fd[0] = hd->wake_fd[1] = -1;
+    pthread_mutex_init(&hd->lock, NULL);
+    hd->sessions = calloc(config->max_open_sockets, sizeof(httpd_sess_t));
+    hd->handlers = calloc(config->max_uri_handlers, sizeof(httpd_uri_t));
+    if (hd->sessions == NULL || hd->handlers == NULL) {
+        free(hd->sessions);
+        free(hd->handlers);
+        free(hd);
+        return ESP_ERR_HTTPD_ALLOC_MEM;
+    }
+    for (int i = 0; i < config->max_open_sockets; i++) {
+        hd->sessions[i].fd = -1;
+    }
+
+    // lwIP has no SIGPIPE; a client hanging up must not kill the process
+    signal(SIGPIPE, SIG_IGN);
+
+    uint16_t port = s_port_override >= 0 ? (uint16_t)s_port_override : config->server_port;
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    int one = 1;
+    hd->listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (hd->listen_fd < 0 ||
+        setsockopt(hd->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0 ||
+        bind(hd->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(hd->listen_fd, config->backlog_conn) != 0 ||
+        pipe2(hd->wake_fd, O_NONBLOCK | O_CLOEXEC) != 0) {
+        ESP_LOGE(TAG, "Cannot listen on port %u: %s", port, strerror(errno));
+        goto fail;
+    }
+    socklen_t addr_len = sizeof(addr);
+    getsockname(hd->listen_fd, (struct sockaddr *)&addr, &addr_len);
+
+    // The server task's stack, as on the board
+    if (!host_heap_charge(config->stack_size)) {
+        ESP_LOGE(TAG, "No heap for the server task stack");
+        goto fail;
+    }
+    if (pthread_create(&hd->thread, NULL, server_main, hd) != 0) {
+        host_heap_uncharge(config->stack_size);
+        goto fail;
+    }
+    pthread_setname_np(hd->thread, "httpd");
+
+    s_bound_port = ntohs(addr.sin_port);
+    ESP_LOGI(TAG, "Listening on port %u", s_bound_port);
+    *handle = hd;
+    return ESP_OK;
+
+fail:
+    if (hd->listen_fd >= 0) {
+        close(hd->listen_fd);
+    }
+    if (hd->wake_fd[0] >= 0) {
+        close(hd->wake_fd[0]);
+        close(hd->wake_fd[1]);
+    }
+    free(hd->sessions);
+    free(hd->handlers);
+    free(hd);
+    return ESP_ERR_HTTPD_TASK;
+}
+
+esp_err_t httpd_stop(httpd_handle_t handle)
+{
+    struct httpd_data *hd = handle;
+    if (hd == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    hd->stop = true;
+    wake(hd);
+    pthread_join(hd->thread, NULL);
+    host_heap_uncharge(hd->config.stack_size);
+
+    for (int i = 0; i < hd->config.max_open_sockets; i++) {
+        if (hd->sessions[i].fd >= 0) {
+            sess_close(hd, &hd->sessions[i]);
+        }
+    }
+    close(hd->listen_fd);
+    close(hd->wake_fd[0]);
+    close(hd->wake_fd[1]);
+    for (size_t i = 0; i < hd->handler_count; i++) {
+        free((char *)hd->handlers[i].uri);
+    }
+    if (hd->config.global_user_ctx_free_fn != NULL) {
+        hd->config.global_user_ctx_free_fn(hd->config.global_user_ctx);
+    }
+    if (hd->config.global_transport_ctx_free_fn != NULL) {
+        hd->config.global_transport_ctx_free_fn(hd->config.global_transport_ctx);
+    }
+    pthread_mutex_destroy(&hd->lock);
+    free(hd->sessions);
+    free(hd->handlers);
+    free(hd);
+    s_bound_port = 0;
+    return ESP_OK;
+}
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri_handler)
+{
+    struct httpd_data *hd = handle;
+    if (hd == NULL || uri_handler == NULL || uri_handler->uri == NULL ||
+        uri_handler->handler == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&hd->lock);
+    esp_err_t ret = ESP_OK;
+    for (size_t i = 0; i < hd->handler_count; i++) {
+        if (hd->handlers[i].method == uri_handler->method &&
+            strcmp(hd->handlers[i].uri, uri_handler->uri) == 0) {
+            ret = ESP_ERR_HTTPD_HANDLER_EXISTS;
+        }
+    }
+    if (ret == ESP_OK && hd->handler_count >= hd->config.max_uri_handlers) {
+        ESP_LOGW(TAG, "No slot left for URI handler %s", uri_handler->uri);
+        ret = ESP_ERR_HTTPD_HANDLERS_FULL;
+    }
+    // Not strdup(): libc's allocation would bypass the heap accounting
+    size_t uri_size = strlen(uri_handler->uri) + 1;
+    char *uri = ret == ESP_OK ? malloc(uri_size) : NULL;
+    if (uri != NULL) {
+        memcpy(uri, uri_handler->uri, uri_size);
+    } else if (ret == ESP_OK) {
+        ret = ESP_ERR_HTTPD_ALLOC_MEM;
+    }
+    if (ret == ESP_OK) {
+        httpd_uri_t *slot = &hd->handlers[hd->handler_count++];
+        *slot = *uri_handler;
+        slot->uri = uri;
+    }
+    pthread_mutex_unlock(&hd->lock);
+    return ret;
+}
+
+esp_err_t httpd_unregister_uri_handler(httpd_handle_t handle, const char *uri, httpd_method_t method)
+{
+    struct httpd_data *hd = handle;
+    if (hd == NULL || uri == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&hd->lock);
+    for (size_t i = 0; i < hd->handler_count; i++) {
+        if (hd->handlers[i].method == method && strcmp(hd->handlers[i].uri, uri) == 0) {
+            free((char *)hd->handlers[i].uri);
+            memmove(&hd->handlers[i], &hd->handlers[i + 1],
+                    (hd->handler_count - i - 1) * sizeof(httpd_uri_t));
+            hd->handler_count--;
+            pthread_mutex_unlock(&hd->lock);
+            return ESP_OK;
+        }
+    }
+    pthread_mutex_unlock(&hd->lock);
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t httpd_register_err_handler(httpd_handle_t handle, httpd_err_code_t error,
+                                     httpd_err_handler_func_t handler_fn)
+{
+    struct httpd_data *hd = handle;
+    if (hd == NULL || error >= HTTPD_ERR_CODE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    hd->err_handlers[error] = handler_fn;
+    return ESP_OK;
+}
+
+bool httpd_uri_match_wildcard(const char *uri_template, const char *uri_to_match, size_t match_upto)
+{
+    // Same rules as ESP-IDF: a trailing '?' makes the character before it
+    // optional, a trailing '*' accepts anything after the template
+    const size_t tpl_len = strlen(uri_template);
+    size_t exact_match_chars = tpl_len;
+
+    const char last = tpl_len > 0 ? uri_template[tpl_len - 1] : 0;
+    const char prevlast = tpl_len > 1 ? uri_template[tpl_len - 2] : 0;
+    const bool asterisk = last == '*' || (prevlast == '*' && last == '?');
+    const bool quest = last == '?' || (prevlast == '?' && last == '*');
+
+    if (exact_match_chars < (size_t)(asterisk + quest * 2)) {
+        return false;
+    }
+    exact_match_chars -= asterisk + quest * 2;
+    if (match_upto < exact_match_chars) {
+        return false;
+    }
+
+    if (!quest) {
+        if (!asterisk && match_upto != exact_match_chars) {
+            return false;
+        }
+        return strncmp(uri_template, uri_to_match, exact_match_chars) == 0;
+    }
+    if (match_upto > exact_match_chars &&
+        uri_template[exact_match_chars] != uri_to_match[exact_match_chars]) {
+        return false;
+    }
+    if (strncmp(uri_template, uri_to_match, exact_match_chars) != 0) {
+        return false;
+    }
+    return asterisk || match_upto <= exact_match_chars + 1;
+}
+
+// ============================================================================
+// Request data
+// ============================================================================
+
+int httpd_req_to_sockfd(httpd_req_t *r)
+{
+    if (r == NULL || r->aux == NULL) {
+        return -1;
+    }
+    httpd_req_aux_t *aux = r->aux;
+    return aux->sess->fd;
+}
+
+int httpd_req_recv(httpd_req_t *r, char *buf, size_t buf_len)
+{
+    if (r == NULL || r->aux == NULL || buf == NULL) {
+        return HTTPD_SOCK_ERR_INVALID;
+    }
+    httpd_req_aux_t *aux = r->aux;
+    httpd_sess_t *s = aux->sess;
+    if (aux->remaining == 0 || buf_len == 0) {
+        return 0;
+    }
+    size_t want = buf_len < aux->remaining ? buf_len : aux->remaining;
+
+    if (s->buf_len > 0) {
+        size_t n = want < s->buf_len ? want : s->buf_len;
+        memcpy(buf, s->buf, n);
+        memmove(s->buf, s->buf + n, s->buf_len - n);
+        s->buf_len -= n;
+        aux->remaining -= n;
+        return (int)n;
+    }
+
+    ssize_t n = recv(s->fd, buf, want, 0);
+    if (n < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK ? HTTPD_SOCK_ERR_TIMEOUT : HTTPD_SOCK_ERR_FAIL;
+    }
+    aux->remaining -= (size_t)n;
+    return (int)n;
+}
+
+/**
+ * @brief Value of a request header, case-insensitive on the field name
+ */
+static const char *hdr_find(httpd_req_t *r, const char *field, size_t *len)
+{
+    httpd_req_aux_t *aux = r->aux;
+    size_t field_len = strlen(field);
+    const char *line = aux->hdrs;
+    while (*line != '\0') {
+        const char *eol = strstr(line, "\r\n");
+        if (eol == NULL) {
+            eol = line + strlen(line);
+        }
+        if ((size_t)(eol - line) > field_len && line[field_len] == ':' &&
+            strncasecmp(line, field, field_len) == 0) {
+            const char *v = line + field_len + 1;
+            while (v < eol && (*v == ' ' || *v == '\t')) {
+                v++;
+            }
+            const char *v_end = eol;
+            while (v_end > v && (v_end[-1] == ' ' || v_end[-1] == '\t')) {
+                v_end--;
+            }
+            *len = (size_t)(v_end - v);
+            return v;
+        }
+        line = *eol != '\0' ? eol + 2 : eol;
+    }
+    return NULL;
+}
+
+size_t httpd_req_get_hdr_value_len(httpd_req_t *r, const char *field)
+{
+    size_t len = 0;
+    if (r == NULL || r->aux == NULL || field == NULL || hdr_find(r, field, &len) == NULL) {
+        return 0;
+    }
+    return len;
+}
+
+/**
+ * @brief Copy @p len bytes of @p src into a NUL-terminated buffer, truncating
+ */
+static esp_err_t copy_value(char *dst, size_t dst_size, const char *src, size_t len)
+{
+    if (dst_size == 0) {
+        return ESP_ERR_HTTPD_RESULT_TRUNC;
+    }
+    size_t n = len < dst_size - 1 ? len : dst_size - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+    return n < len ? ESP_ERR_HTTPD_RESULT_TRUNC : ESP_OK;
+}
+
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *r, const char *field, char *val, size_t val_size)
+{
+    if (r == NULL || r->aux == NULL || field == NULL || val == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t len;
+    const char *v = hdr_find(r, field, &len);
+    if (v == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    return copy_value(val, val_size, v, len);
+}
+
+size_t httpd_req_get_url_query_len(httpd_req_t *r)
+{
+    const char *q = r != NULL ? strchr(r->uri, '?') : NULL;
+    return q != NULL ? strlen(q + 1) : 0;
+}
+
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *r, char *buf, size_t buf_len)
+{
+    if (r == NULL || buf == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const char *q = strchr(r->uri, '?');
+    if (q == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    return copy_value(buf, buf_len, q + 1, strlen(q + 1));
+}
+
+esp_err_t httpd_query_key_value(const char *qry, const char *key, char *val, size_t val_size)
+{
+    if (qry == NULL || key == NULL || val == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t key_len = strlen(key);
+    const char *p = qry;
+    while (*p != '\0') {
+        const char *eq = strchr(p, '=');
+        if (eq == NULL) {
+            break;
+        }
+        if ((size_t)(eq - p) != key_len || strncasecmp(p, key, key_len) != 0) {
+            p = strchr(eq, '&');
+            if (p == NULL) {
+                break;
+            }
+            p++;
+            continue;
+        }
+        const char *v = eq + 1;
+        const char *v_end = strchr(v, '&');
+        if (v_end == NULL) {
+            v_end = v + strlen(v);
+        }
+        return copy_value(val, val_size, v, (size_t)(v_end - v));
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+// ============================================================================
+// Responses
+// ============================================================================
+
+static int default_send(httpd_handle_t hd, int sockfd, const char *buf, size_t buf_len, int flags)
+{
+    (void)hd;
+    ssize_t n = send(sockfd, buf, buf_len, flags | MSG_NOSIGNAL);
+    if (n < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK ? HTTPD_SOCK_ERR_TIMEOUT : HTTPD_SOCK_ERR_FAIL;
+    }
+    return (int)n;
+}
+
+int httpd_send(httpd_req_t *r, const char *buf, size_t buf_len)
+{
+    if (r == NULL || r->aux == NULL || (buf == NULL && buf_len > 0)) {
+        return HTTPD_SOCK_ERR_INVALID;
+    }
+    httpd_req_aux_t *aux = r->aux;
+    httpd_send_func_t send_fn = aux->sess->send_fn != NULL ? aux->sess->send_fn : default_send;
+    return send_fn(aux->hd, aux->sess->fd, buf, buf_len, 0);
+}
+
+static esp_err_t send_all(httpd_req_t *r, const char *buf, size_t len)
+{
+    while (len > 0) {
+        int sent = httpd_send(r, buf, len);
+        if (sent <= 0) {
+            return ESP_ERR_HTTPD_RESP_SEND;
+        }
+        buf += sent;
+        len -= (size_t)sent;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Status line and headers; @p content_len < 0 for a chunked body
+ */
+static esp_err_t send_head(httpd_req_t *r, ssize_t content_len)
+{
+    httpd_req_aux_t *aux = r->aux;
+    char head[HTTPD_RESP_HEAD_MAX];
+    int n = snprintf(head, sizeof(head), "HTTP/1.1 %s\r\nContent-Type: %s\r\n",
+                     aux->status, aux->content_type);
+    if (content_len < 0) {
+        n += snprintf(head + n, sizeof(head) - n, "Transfer-Encoding: chunked\r\n");
+    } else {
+        n += snprintf(head + n, sizeof(head) - n, "Content-Length: %zd\r\n", content_len);
+    }
+    for (size_t i = 0; i < aux->resp_hdr_count && (size_t)n < sizeof(head); i++) {
+        n += snprintf(head + n, sizeof(head) - n, "%s: %s\r\n",
+                      aux->resp_hdrs[i].field, aux->resp_hdrs[i].value);
+    }
+    if ((size_t)n + 2 >= sizeof(head)) {
+        return ESP_ERR_HTTPD_RESP_HDR;
+    }
+    memcpy(head + n, "\r\n", 2);
+    return send_all(r, head, (size_t)n + 2);
+}
+
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status)
+{
+    if (r == NULL || r->aux == NULL || status == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ((httpd_req_aux_t *)r->aux)->status = status;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type)
+{
+    if (r == NULL || r->aux == NULL || type == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ((httpd_req_aux_t *)r->aux)->content_type = type;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value)
+{
+    if (r == NULL || r->aux == NULL || field == NULL || value == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    httpd_req_aux_t *aux = r->aux;
+    if (aux->resp_hdr_count >= aux->hd->config.max_resp_headers) {
+        return ESP_ERR_HTTPD_RESP_HDR;
+    }
+    aux->resp_hdrs[aux->resp_hdr_count].field = field;
+    aux->resp_hdrs[aux->resp_hdr_count].value = value;
+    aux->resp_hdr_count++;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len)
+{
+    if (r == NULL || r->aux == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (buf_len == HTTPD_RESP_USE_STRLEN) {
+        buf_len = buf != NULL ? (ssize_t)strlen(buf) : 0;
+    }
+    esp_err_t ret = send_head(r, buf_len);
+    if (ret == ESP_OK && buf_len > 0) {
+        ret = send_all(r, buf, (size_t)buf_len);
+    }
+    return ret;
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t buf_len)
+{
+    if (r == NULL || r->aux == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    httpd_req_aux_t *aux = r->aux;
+    if (buf_len == HTTPD_RESP_USE_STRLEN) {
+        buf_len = buf != NULL ? (ssize_t)strlen(buf) : 0;
+    }
+    if (!aux->chunked) {
+        esp_err_t ret = send_head(r, -1);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        aux->chunked = true;
+    }
+
+    char size_line[16];
+    int n = snprintf(size_line, sizeof(size_line), "%zx\r\n", (size_t)(buf != NULL ? buf_len : 0));
+    if (send_all(r, size_line, (size_t)n) != ESP_OK ||
+        (buf != NULL && buf_len > 0 && send_all(r, buf, (size_t)buf_len) != ESP_OK) ||
+        send_all(r, "\r\n", 2) != ESP_OK) {
+        return ESP_ERR_HTTPD_RESP_SEND;
+    }
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_err(httpd_req_t *req, httpd_err_code_t error, const char *msg)
+{
+    static const struct {
+        const char *status;
+        const char *msg;
+    } errors[HTTPD_ERR_CODE_MAX] = {
+        [HTTPD_500_INTERNAL_SERVER_ERROR] = { HTTPD_500, "Server has encountered an unexpected error" },
+        [HTTPD_501_METHOD_NOT_IMPLEMENTED] = { "501 Method Not Implemented", "Server does not support this method" },
+        [HTTPD_505_VERSION_NOT_SUPPORTED] = { "505 Version Not Supported", "HTTP version not supported by server" },
+        [HTTPD_400_BAD_REQUEST] = { HTTPD_400, "Bad request syntax" },
+        [HTTPD_401_UNAUTHORIZED] = { "401 Unauthorized", "No permission -- see authorization schemes" },
+        [HTTPD_403_FORBIDDEN] = { "403 Forbidden", "Request forbidden -- authorization will not help" },
+        [HTTPD_404_NOT_FOUND] = { HTTPD_404, "Nothing matches the given URI" },
+        [HTTPD_405_METHOD_NOT_ALLOWED] = { "405 Method Not Allowed", "Specified method is invalid for this resource" },
+        [HTTPD_408_REQ_TIMEOUT] = { HTTPD_408, "Server closed this connection" },
+        [HTTPD_411_LENGTH_REQUIRED] = { "411 Length Required", "Chunked encoding not supported" },
+        [HTTPD_414_URI_TOO_LONG] = { "414 URI Too Long", "URI is too long" },
+        [HTTPD_431_REQ_HDR_FIELDS_TOO_LARGE] = { "431 Request Header Fields Too Large", "Header fields are too long" },
+    };
+    if (req == NULL || error >= HTTPD_ERR_CODE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    httpd_resp_set_status(req, errors[error].status);
+    httpd_resp_set_type(req, HTTPD_TYPE_TEXT);
+    return httpd_resp_sendstr(req, msg != NULL ? msg : errors[error].msg);
+}
+
+// ============================================================================
+// Async handlers and sessions
+// ============================================================================
+
+esp_err_t httpd_req_async_handler_begin(httpd_req_t *r, httpd_req_t **out)
+{
+    if (r == NULL || r->aux == NULL || out == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    httpd_req_t *copy = malloc(sizeof(httpd_req_t));
+    httpd_req_aux_t *aux = malloc(sizeof(httpd_req_aux_t));
+    if (copy == NULL || aux == NULL) {
+        free(copy);
+        free(aux);
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(copy, r, sizeof(*copy));
+    memcpy(aux, r->aux, sizeof(*aux));
+    copy->aux = aux;
+
+    // The session stays parked until the copy completes
+    ((httpd_req_aux_t *)r->aux)->async = true;
+    *out = copy;
+    return ESP_OK;
+}
+
+esp_err_t httpd_req_async_handler_complete(httpd_req_t *r)
+{
+    if (r == NULL || r->aux == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    httpd_req_aux_t *aux = r->aux;
+    struct httpd_data *hd = aux->hd;
+
+    if (pthread_equal(pthread_self(), hd->thread)) {
+        // Completed inside the handler that began it (e.g. the queue was
+        // full): nothing was handed off, the server finishes the request
+        hd->aux.async = false;
+    } else {
+        pthread_mutex_lock(&hd->lock);
+        aux->sess->busy = false;
+        aux->sess->last_used_us = esp_timer_get_time();
+        if (aux->remaining > 0) {
+            aux->sess->close_pending = true;
+        }
+        pthread_mutex_unlock(&hd->lock);
+        wake(hd);
+    }
+    free(aux);
+    free(r);
+    return ESP_OK;
+}
+
+esp_err_t httpd_sess_trigger_close(httpd_handle_t handle, int sockfd)
+{
+    struct httpd_data *hd = handle;
+    if (hd == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&hd->lock);
+    httpd_sess_t *s = sess_find(hd, sockfd);
+    if (s != NULL) {
+        s->close_pending = true;
+    }
+    pthread_mutex_unlock(&hd->lock);
+    if (s == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    wake(hd);
+    return ESP_OK;
+}
+
+esp_err_t httpd_sess_set_send_override(httpd_handle_t handle, int sockfd, httpd_send_func_t send_func)
+{
+    struct httpd_data *hd = handle;
+    if (hd == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&hd->lock);
+    httpd_sess_t *s = sess_find(hd, sockfd);
+    if (s != NULL) {
+        s->send_fn = send_func;
+    }
+    pthread_mutex_unlock(&hd->lock);
+    return s != NULL ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t httpd_get_client_list(httpd_handle_t handle, size_t *fds, int *client_fds)
+{
+    struct httpd_data *hd = handle;
+    if (hd == NULL || fds == NULL || client_fds == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t count = 0;
+    pthread_mutex_lock(&hd->lock);
+    for (int i = 0; i < hd->config.max_open_sockets; i++) {
+        if (hd->sessions[i].fd >= 0) {
+            if (count == *fds) {
+                pthread_mutex_unlock(&hd->lock);
+                return ESP_ERR_INVALID_ARG;
+            }
+            client_fds[count++] = hd->sessions[i].fd;
+        }
+    }
+    pthread_mutex_unlock(&hd->lock);
+    *fds = count;
+    return ESP_OK;
+}
+
+// ============================================================================
+// WebSocket: upgrades are refused, so there are never frames to move
+// ============================================================================
+
+esp_err_t httpd_ws_recv_frame(httpd_req_t *req, httpd_ws_frame_t *pkt, size_t max_len)
+{
+    (void)req;
+    (void)pkt;
+    (void)max_len;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t httpd_ws_send_frame(httpd_req_t *req, httpd_ws_frame_t *pkt)
+{
+    (void)req;
+    (void)pkt;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t httpd_ws_send_frame_async(httpd_handle_t hd, int fd, httpd_ws_frame_t *frame)
+{
+    (void)hd;
+    (void)fd;
+    (void)frame;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+httpd_ws_client_info_t httpd_ws_get_fd_info(httpd_handle_t handle, int fd)
+{
+    struct httpd_data *hd = handle;
+    if (hd == NULL) {
+        return HTTPD_WS_CLIENT_INVALID;
+    }
+    pthread_mutex_lock(&hd->lock);
+    httpd_sess_t *s = sess_find(hd, fd);
+    pthread_mutex_unlock(&hd->lock);
+    return s != NULL ? HTTPD_WS_CLIENT_HTTP : HTTPD_WS_CLIENT_INVALID;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file esp_system.h
+ * @brief Host shim: heap figures and restart
+ */
+
+#ifndef HOST_ESP_SYSTEM_H
+#define HOST_ESP_SYSTEM_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Modelled heap size minus what the firmware code holds
+ */
+uint32_t esp_get_free_heap_size(void);
+
+/**
+ * @brief Lowest esp_get_free_heap_size() seen since start
+ */
+uint32_t esp_get_minimum_free_heap_size(void);
+
+/**
+ * @brief Exits the process
+ */
+void esp_restart(void) __attribute__((noreturn));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_ESP_SYSTEM_H
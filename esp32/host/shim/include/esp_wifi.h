@@ -0,0 +1,31 @@
+/**
+ * @file esp_wifi.h
+ * @brief Host shim: the parts of the WiFi API station code reads
+ */
+
+#ifndef HOST_ESP_WIFI_H
+#define HOST_ESP_WIFI_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_mac.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    WIFI_IF_STA,
+    WIFI_IF_AP,
+} wifi_interface_t;
+
+/**
+ * @brief MAC of the interface (same fixed address as esp_read_mac())
+ */
+esp_err_t esp_wifi_get_mac(wifi_interface_t ifx, uint8_t mac[6]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_ESP_WIFI_H
@@ -0,0 +1,66 @@
+/**
+ * @file FreeRTOS.h
+ * @brief Host shim: FreeRTOS types on POSIX threads
+ *
+ * Tasks are pthreads, ticks are milliseconds and critical sections are
+ * recursive mutexes, so concurrent code runs truly in parallel here. That
+ * is stricter than a dual-core ESP32, which is the point.
+ */
+
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t StackType_t;
+
+#define pdFALSE                 ((BaseType_t)0)
+#define pdTRUE                  ((BaseType_t)1)
+#define pdFAIL                  pdFALSE
+#define pdPASS                  pdTRUE
+#define errQUEUE_EMPTY          pdFALSE
+#define errQUEUE_FULL           pdFALSE
+
+#define configTICK_RATE_HZ      1000
+#define portTICK_PERIOD_MS      ((TickType_t)1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY           ((TickType_t)0xffffffffUL)
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define pdTICKS_TO_MS(ticks)    ((uint32_t)(((uint64_t)(ticks) * 1000) / configTICK_RATE_HZ))
+
+#define tskNO_AFFINITY          0x7fffffff
+
+/**
+ * @brief Spinlock stand-in for taskENTER_CRITICAL()
+ */
+typedef struct {
+    pthread_mutex_t mutex;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED    { PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP }
+
+void vPortCPUInitializeMutex(portMUX_TYPE *mux);
+void vPortEnterCritical(portMUX_TYPE *mux);
+void vPortExitCritical(portMUX_TYPE *mux);
+
+#define portENTER_CRITICAL(mux)         vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux)          vPortExitCritical(mux)
+#define taskENTER_CRITICAL(mux)         vPortEnterCritical(mux)
+#define taskEXIT_CRITICAL(mux)          vPortExitCritical(mux)
+#define taskENTER_CRITICAL_ISR(mux)     vPortEnterCritical(mux)
+#define taskEXIT_CRITICAL_ISR(mux)      vPortExitCritical(mux)
+#define portMUX_INITIALIZE(mux)         vPortCPUInitializeMutex(mux)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_FREERTOS_H
@@ -0,0 +1,35 @@
+/**
+ * @file semphr.h
+ * @brief Host shim: FreeRTOS semaphores and mutexes
+ *
+ * All kinds are counting semaphores underneath; a mutex is one that
+ * starts at one. Priority inheritance does not exist on the host.
+ */
+
+#ifndef HOST_FREERTOS_SEMPHR_H
+#define HOST_FREERTOS_SEMPHR_H
+
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct host_semaphore *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count);
+void vSemaphoreDelete(SemaphoreHandle_t sem);
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t sem);
+
+#define xSemaphoreCreateMutex()         xSemaphoreCreateCounting(1, 1)
+#define xSemaphoreCreateBinary()        xSemaphoreCreateCounting(1, 0)
+#define xSemaphoreGiveFromISR(sem, woken)   xSemaphoreGive(sem)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_FREERTOS_SEMPHR_H
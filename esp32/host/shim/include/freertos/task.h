@@ -0,0 +1,54 @@
+/**
+ * @file task.h
+ * @brief Host shim: FreeRTOS tasks and notifications
+ */
+
+#ifndef HOST_FREERTOS_TASK_H
+#define HOST_FREERTOS_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct host_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *arg);
+
+/**
+ * @brief Start a task on its own thread.
+ *
+ * The stack depth (bytes, as in ESP-IDF) is charged to the internal heap
+ * budget while the task lives, as its stack would be on the board.
+ */
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                       void *arg, UBaseType_t priority, TaskHandle_t *out_handle);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                                   void *arg, UBaseType_t priority, TaskHandle_t *out_handle,
+                                   BaseType_t core_id);
+
+/**
+ * @brief End a task. Only NULL (the calling task) is supported.
+ */
+void vTaskDelete(TaskHandle_t task);
+
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
+
+/**
+ * @brief Handle of the calling thread, created on first use for threads
+ *        that were not started with xTaskCreate()
+ */
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+const char *pcTaskGetName(TaskHandle_t task);
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_FREERTOS_TASK_H
@@ -0,0 +1,95 @@
+/**
+ * @file geogram_host.h
+ * @brief Controls of the host (Linux) build that have no ESP-IDF equivalent
+ *
+ * The station components build unchanged against the shim headers next
+ * to this one. A host program (the benchmark, a test) uses these calls
+ * to place the SD card, pick the HTTP port, size the modelled heaps and
+ * shape the simulated upstream tile server before starting them.
+ */
+
+#ifndef GEOGRAM_HOST_H
+#define GEOGRAM_HOST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Modelled heaps of the ESP32-S3 ePaper board after boot
+#define HOST_HEAP_INTERNAL_DEFAULT      (300 * 1024)
+#define HOST_HEAP_PSRAM_DEFAULT         (8 * 1024 * 1024)
+
+// Allocations up to this size stay internal (CONFIG_SPIRAM_MALLOC_ALWAYSINTERNAL)
+#define HOST_HEAP_ALWAYS_INTERNAL       16384
+
+/**
+ * @brief Heap usage of the firmware code (the host program excluded)
+ */
+typedef struct {
+    size_t internal_used;       /**< Internal RAM in use, task stacks included */
+    size_t internal_peak;       /**< Highest internal_used since reset */
+    size_t psram_used;          /**< PSRAM in use */
+    size_t psram_peak;          /**< Highest psram_used since reset */
+    uint32_t failed;            /**< Allocations refused because a budget ran out */
+} host_heap_stats_t;
+
+/**
+ * @brief Set the heap budgets. Call before anything allocates.
+ * @param internal_bytes Internal RAM available to the firmware
+ * @param psram_bytes PSRAM available (0 for boards without)
+ */
+void host_heap_configure(size_t internal_bytes, size_t psram_bytes);
+
+void host_heap_get_stats(host_heap_stats_t *stats);
+
+/**
+ * @brief Start peak tracking over from the current usage
+ */
+void host_heap_reset_peak(void);
+
+/**
+ * @brief Directory that stands in for the card mounted at /sdcard.
+ *
+ * Paths under /sdcard are redirected there for every file call the
+ * components make, as the FAT VFS does on the board. Call before
+ * sdcard_init(); the directory is created if needed.
+ */
+esp_err_t host_sdcard_set_root(const char *dir);
+
+/**
+ * @brief Port for the next httpd_start(), overriding the configured one.
+ * @param port 0 for any free port
+ */
+void host_httpd_set_port(uint16_t port);
+
+/**
+ * @brief Port the running server listens on (0 if none)
+ */
+uint16_t host_httpd_get_port(void);
+
+/**
+ * @brief Simulated upstream for http_client_get_async() and _get_stream().
+ *
+ * There is no network on the host: every GET is answered after
+ * @p latency_ms with @p body_size bytes (a PNG signature followed by
+ * filler), and @p fail_percent of requests get a 503 instead. At most
+ * CONFIG_GEOGRAM_HTTP_CLIENT_WORKERS requests are in flight at once, as
+ * with the real client's worker pool.
+ */
+void host_origin_configure(uint32_t latency_ms, size_t body_size, int fail_percent);
+
+/**
+ * @brief Requests the simulated upstream has answered
+ */
+uint32_t host_origin_get_requests(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEOGRAM_HOST_H
@@ -0,0 +1,23 @@
+/**
+ * @file host_strlcpy.h
+ * @brief Host shim: strlcpy() for C libraries without it (glibc < 2.38)
+ *
+ * Force-included by the host build when <string.h> lacks it.
+ */
+
+#ifndef HOST_STRLCPY_H
+#define HOST_STRLCPY_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+size_t strlcpy(char *dst, const char *src, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_STRLCPY_H
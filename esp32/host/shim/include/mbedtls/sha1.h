@@ -0,0 +1,33 @@
+/**
+ * @file sha1.h
+ * @brief Host shim: the mbedTLS SHA-1 API the file cache uses
+ */
+
+#ifndef HOST_MBEDTLS_SHA1_H
+#define HOST_MBEDTLS_SHA1_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t state[5];
+    uint64_t total;
+    uint8_t buffer[64];
+} mbedtls_sha1_context;
+
+void mbedtls_sha1_init(mbedtls_sha1_context *ctx);
+void mbedtls_sha1_free(mbedtls_sha1_context *ctx);
+int mbedtls_sha1_starts(mbedtls_sha1_context *ctx);
+int mbedtls_sha1_update(mbedtls_sha1_context *ctx, const unsigned char *input, size_t ilen);
+int mbedtls_sha1_finish(mbedtls_sha1_context *ctx, unsigned char output[20]);
+int mbedtls_sha1(const unsigned char *input, size_t ilen, unsigned char output[20]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_MBEDTLS_SHA1_H
@@ -0,0 +1,245 @@
+/**
+ * @file nvs.c
+ * @brief Host shim: in-memory NVS
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include "nvs.h"
+#include "nvs_flash.h"
+
+#define NVS_MAX_ENTRIES     64
+#define NVS_MAX_HANDLES     16
+#define NVS_KEY_LEN         16      // As on flash: 15 characters
+#define NVS_VALUE_MAX       4000    // Longest string or blob NVS stores
+
+typedef struct {
+    bool used;
+    char ns[NVS_KEY_LEN];
+    char key[NVS_KEY_LEN];
+    size_t len;
+    uint8_t value[NVS_VALUE_MAX];
+} nvs_entry_t;
+
+typedef struct {
+    bool used;
+    bool writable;
+    char ns[NVS_KEY_LEN];
+} nvs_open_t;
+
+// Static, like the flash partition: not part of the modelled heap
+static nvs_entry_t s_entries[NVS_MAX_ENTRIES];
+static nvs_open_t s_handles[NVS_MAX_HANDLES];
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+
+esp_err_t nvs_flash_init(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void)
+{
+    pthread_mutex_lock(&s_lock);
+    memset(s_entries, 0, sizeof(s_entries));
+    pthread_mutex_unlock(&s_lock);
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char *namespace_name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    if (namespace_name == NULL || strlen(namespace_name) >= NVS_KEY_LEN || out_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&s_lock);
+    for (int i = 0; i < NVS_MAX_HANDLES; i++) {
+        if (!s_handles[i].used) {
+            s_handles[i].used = true;
+            s_handles[i].writable = open_mode == NVS_READWRITE;
+            strcpy(s_handles[i].ns, namespace_name);
+            pthread_mutex_unlock(&s_lock);
+            *out_handle = (nvs_handle_t)(i + 1);
+            return ESP_OK;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    return ESP_ERR_NO_MEM;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+    pthread_mutex_lock(&s_lock);
+    if (handle >= 1 && handle <= NVS_MAX_HANDLES) {
+        s_handles[handle - 1].used = false;
+    }
+    pthread_mutex_unlock(&s_lock);
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    (void)handle;
+    return ESP_OK;
+}
+
+/**
+ * @brief Namespace of an open handle; called with the lock held
+ */
+static nvs_open_t *handle_get(nvs_handle_t handle)
+{
+    if (handle < 1 || handle > NVS_MAX_HANDLES || !s_handles[handle - 1].used) {
+        return NULL;
+    }
+    return &s_handles[handle - 1];
+}
+
+static nvs_entry_t *entry_find(const char *ns, const char *key)
+{
+    for (int i = 0; i < NVS_MAX_ENTRIES; i++) {
+        if (s_entries[i].used && strcmp(s_entries[i].ns, ns) == 0 &&
+            strcmp(s_entries[i].key, key) == 0) {
+            return &s_entries[i];
+        }
+    }
+    return NULL;
+}
+
+static esp_err_t nvs_set(nvs_handle_t handle, const char *key, const void *value, size_t len)
+{
+    if (key == NULL || strlen(key) >= NVS_KEY_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (len > NVS_VALUE_MAX) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+
+    pthread_mutex_lock(&s_lock);
+    nvs_open_t *h = handle_get(handle);
+    if (h == NULL || !h->writable) {
+        pthread_mutex_unlock(&s_lock);
+        return h == NULL ? ESP_ERR_INVALID_ARG : ESP_ERR_NOT_ALLOWED;
+    }
+    nvs_entry_t *e = entry_find(h->ns, key);
+    for (int i = 0; e == NULL && i < NVS_MAX_ENTRIES; i++) {
+        if (!s_entries[i].used) {
+            e = &s_entries[i];
+            e->used = true;
+            strcpy(e->ns, h->ns);
+            strcpy(e->key, key);
+        }
+    }
+    if (e == NULL) {
+        pthread_mutex_unlock(&s_lock);
+        return ESP_ERR_NVS_NO_FREE_PAGES;
+    }
+    memcpy(e->value, value, len);
+    e->len = len;
+    pthread_mutex_unlock(&s_lock);
+    return ESP_OK;
+}
+
+/**
+ * @brief Copy a value out; @p len is in/out as for nvs_get_blob()
+ */
+static esp_err_t nvs_get(nvs_handle_t handle, const char *key, void *out, size_t *len, bool exact)
+{
+    if (key == NULL || len == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&s_lock);
+    nvs_open_t *h = handle_get(handle);
+    nvs_entry_t *e = h != NULL ? entry_find(h->ns, key) : NULL;
+    esp_err_t ret = ESP_OK;
+    if (h == NULL) {
+        ret = ESP_ERR_INVALID_ARG;
+    } else if (e == NULL) {
+        ret = ESP_ERR_NVS_NOT_FOUND;
+    } else if (out == NULL) {
+        *len = e->len;
+    } else if (*len < e->len || (exact && *len != e->len)) {
+        ret = ESP_ERR_NVS_INVALID_LENGTH;
+    } else {
+        memcpy(out, e->value, e->len);
+        *len = e->len;
+    }
+    pthread_mutex_unlock(&s_lock);
+    return ret;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+    pthread_mutex_lock(&s_lock);
+    nvs_open_t *h = handle_get(handle);
+    nvs_entry_t *e = h != NULL && key != NULL ? entry_find(h->ns, key) : NULL;
+    if (e != NULL) {
+        e->used = false;
+    }
+    pthread_mutex_unlock(&s_lock);
+    return e != NULL ? ESP_OK : ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_erase_all(nvs_handle_t handle)
+{
+    pthread_mutex_lock(&s_lock);
+    nvs_open_t *h = handle_get(handle);
+    for (int i = 0; h != NULL && i < NVS_MAX_ENTRIES; i++) {
+        if (s_entries[i].used && strcmp(s_entries[i].ns, h->ns) == 0) {
+            s_entries[i].used = false;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    return h != NULL ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t nvs_set_str(nvs_handle_t handle, const char *key, const char *value)
+{
+    return nvs_set(handle, key, value, strlen(value) + 1);
+}
+
+esp_err_t nvs_get_str(nvs_handle_t handle, const char *key, char *out_value, size_t *length)
+{
+    return nvs_get(handle, key, out_value, length, false);
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    return nvs_set(handle, key, value, length);
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    return nvs_get(handle, key, out_value, length, false);
+}
+
+esp_err_t nvs_set_u8(nvs_handle_t handle, const char *key, uint8_t value)
+{
+    return nvs_set(handle, key, &value, sizeof(value));
+}
+
+esp_err_t nvs_get_u8(nvs_handle_t handle, const char *key, uint8_t *out_value)
+{
+    size_t len = sizeof(*out_value);
+    return nvs_get(handle, key, out_value, &len, true);
+}
+
+esp_err_t nvs_set_i32(nvs_handle_t handle, const char *key, int32_t value)
+{
+    return nvs_set(handle, key, &value, sizeof(value));
+}
+
+esp_err_t nvs_get_i32(nvs_handle_t handle, const char *key, int32_t *out_value)
+{
+    size_t len = sizeof(*out_value);
+    return nvs_get(handle, key, out_value, &len, true);
+}
+
+esp_err_t nvs_set_u32(nvs_handle_t handle, const char *key, uint32_t value)
+{
+    return nvs_set(handle, key, &value, sizeof(value));
+}
+
+esp_err_t nvs_get_u32(nvs_handle_t handle, const char *key, uint32_t *out_value)
+{
+    size_t len = sizeof(*out_value);
+    return nvs_get(handle, key, out_value, &len, true);
+}
@@ -0,0 +1,320 @@
+/**
+ * @file sdcard.c
+ * @brief Host shim: the SD card as a directory
+ *
+ * Components open files under /sdcard directly, as the FAT VFS lets them
+ * on the board. The linker routes their file calls (--wrap) through the
+ * functions at the end of this file, which move /sdcard paths into the
+ * directory given to host_sdcard_set_root().
+ */
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include "sdcard.h"
+#include "esp_log.h"
+#include "geogram_host.h"
+#include "host_internal.h"
+
+static const char *TAG = "sdcard";
+
+#define SDCARD_MOUNT_POINT  "/sdcard"
+
+static char s_root[PATH_MAX] = "sdcard";
+static bool s_mounted = false;
+
+const char *host_vfs_path(const char *path, char *buf, size_t buf_size)
+{
+    size_t mount_len = strlen(SDCARD_MOUNT_POINT);
+    if (path == NULL || strncmp(path, SDCARD_MOUNT_POINT, mount_len) != 0 ||
+        (path[mount_len] != '\0' && path[mount_len] != '/')) {
+        return path;
+    }
+    snprintf(buf, buf_size, "%s%s", s_root, path + mount_len);
+    return buf;
+}
+
+esp_err_t host_sdcard_set_root(const char *dir)
+{
+    if (dir == NULL || strlen(dir) >= sizeof(s_root) - 64) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (mkdir(dir, 0755) != 0 && access(dir, W_OK) != 0) {
+        ESP_LOGE(TAG, "Cannot use %s as the card", dir);
+        return ESP_FAIL;
+    }
+    strcpy(s_root, dir);
+    return ESP_OK;
+}
+
+esp_err_t sdcard_init(void)
+{
+    if (s_mounted) {
+        return ESP_OK;
+    }
+    if (mkdir(s_root, 0755) != 0 && access(s_root, W_OK) != 0) {
+        ESP_LOGE(TAG, "Card directory %s not writable", s_root);
+        return ESP_FAIL;
+    }
+    s_mounted = true;
+    ESP_LOGI(TAG, "SD card at %s (%.1f GB free)", s_root, sdcard_get_capacity_gb());
+    return ESP_OK;
+}
+
+esp_err_t sdcard_deinit(void)
+{
+    s_mounted = false;
+    return ESP_OK;
+}
+
+bool sdcard_is_mounted(void)
+{
+    return s_mounted;
+}
+
+esp_err_t sdcard_get_info(sdcard_info_t *info)
+{
+    if (info == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(info, 0, sizeof(*info));
+    info->mounted = s_mounted;
+    if (s_mounted) {
+        info->capacity_gb = sdcard_get_capacity_gb();
+        snprintf(info->mount_point, sizeof(info->mount_point), "%s", SDCARD_MOUNT_POINT);
+    }
+    return ESP_OK;
+}
+
+float sdcard_get_capacity_gb(void)
+{
+    struct statvfs vfs;
+    if (statvfs(s_root, &vfs) != 0) {
+        return 0.0f;
+    }
+    return (float)((double)vfs.f_blocks * vfs.f_frsize / (1024.0 * 1024.0 * 1024.0));
+}
+
+esp_err_t sdcard_get_free_bytes(uint64_t *free_bytes)
+{
+    if (free_bytes == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_mounted) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    struct statvfs vfs;
+    if (statvfs(s_root, &vfs) != 0) {
+        return ESP_FAIL;
+    }
+    *free_bytes = (uint64_t)vfs.f_bavail * vfs.f_frsize;
+    return ESP_OK;
+}
+
+static FILE *open_on_card(const char *path, const char *mode)
+{
+    if (path == NULL) {
+        return NULL;
+    }
+    if (!s_mounted) {
+        ESP_LOGE(TAG, "SD card not mounted");
+        return NULL;
+    }
+    return fopen(path, mode);
+}
+
+esp_err_t sdcard_write_file(const char *path, const void *data, size_t len)
+{
+    if (path == NULL || data == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    FILE *f = open_on_card(path, "wb");
+    if (f == NULL) {
+        return s_mounted ? ESP_FAIL : ESP_ERR_INVALID_STATE;
+    }
+    size_t written = fwrite(data, 1, len, f);
+    fclose(f);
+    return written == len ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t sdcard_read_file(const char *path, void *buffer, size_t buffer_size, size_t *bytes_read)
+{
+    if (path == NULL || buffer == NULL || buffer_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    FILE *f = open_on_card(path, "rb");
+    if (f == NULL) {
+        return s_mounted ? ESP_ERR_NOT_FOUND : ESP_ERR_INVALID_STATE;
+    }
+    size_t read_bytes = fread(buffer, 1, buffer_size, f);
+    fclose(f);
+    if (bytes_read != NULL) {
+        *bytes_read = read_bytes;
+    }
+    return ESP_OK;
+}
+
+esp_err_t sdcard_append_file(const char *path, const void *data, size_t len)
+{
+    if (path == NULL || data == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    FILE *f = open_on_card(path, "ab");
+    if (f == NULL) {
+        return s_mounted ? ESP_ERR_NOT_FOUND : ESP_ERR_INVALID_STATE;
+    }
+    if (len == 0) {
+        len = strlen((const char *)data);
+    }
+    size_t written = fwrite(data, 1, len, f);
+    fclose(f);
+    return written == len ? ESP_OK : ESP_FAIL;
+}
+
+bool sdcard_file_exists(const char *path)
+{
+    struct stat st;
+    return path != NULL && s_mounted && stat(path, &st) == 0;
+}
+
+esp_err_t sdcard_delete_file(const char *path)
+{
+    if (path == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_mounted) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return unlink(path) == 0 ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t sdcard_mkdir(const char *path)
+{
+    if (path == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_mounted) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    struct stat st;
+    if (stat(path, &st) == 0) {
+        return ESP_OK;
+    }
+    return mkdir(path, 0755) == 0 ? ESP_OK : ESP_FAIL;
+}
+
+// ============================================================================
+// VFS: /sdcard path redirection (linked with -Wl,--wrap=<name>)
+// ============================================================================
+
+#define VFS_PATH(var, path)     char var##_buf[PATH_MAX]; \
+                                const char *var = host_vfs_path(path, var##_buf, sizeof(var##_buf))
+
+FILE *__real_fopen(const char *path, const char *mode);
+DIR *__real_opendir(const char *path);
+int __real_open(const char *path, int flags, ...);
+int __real_stat(const char *path, struct stat *st);
+int __real_mkdir(const char *path, mode_t mode);
+int __real_rmdir(const char *path);
+int __real_unlink(const char *path);
+int __real_remove(const char *path);
+int __real_rename(const char *from, const char *to);
+int __real_access(const char *path, int mode);
+int __real_truncate(const char *path, off_t length);
+int __real_utime(const char *path, const struct utimbuf *times);
+int __real_statvfs(const char *path, struct statvfs *buf);
+
+FILE *__wrap_fopen(const char *path, const char *mode)
+{
+    VFS_PATH(p, path);
+    return __real_fopen(p, mode);
+}
+
+DIR *__wrap_opendir(const char *path)
+{
+    VFS_PATH(p, path);
+    return __real_opendir(p);
+}
+
+int __wrap_open(const char *path, int flags, ...)
+{
+    mode_t mode = 0;
+    if (flags & O_CREAT) {
+        va_list args;
+        va_start(args, flags);
+        mode = (mode_t)va_arg(args, int);
+        va_end(args);
+    }
+    VFS_PATH(p, path);
+    return __real_open(p, flags, mode);
+}
+
+int __wrap_stat(const char *path, struct stat *st)
+{
+    VFS_PATH(p, path);
+    return __real_stat(p, st);
+}
+
+int __wrap_mkdir(const char *path, mode_t mode)
+{
+    VFS_PATH(p, path);
+    return __real_mkdir(p, mode);
+}
+
+int __wrap_rmdir(const char *path)
+{
+    VFS_PATH(p, path);
+    return __real_rmdir(p);
+}
+
+int __wrap_unlink(const char *path)
+{
+    VFS_PATH(p, path);
+    return __real_unlink(p);
+}
+
+int __wrap_remove(const char *path)
+{
+    VFS_PATH(p, path);
+    return __real_remove(p);
+}
+
+int __wrap_rename(const char *from, const char *to)
+{
+    VFS_PATH(f, from);
+    VFS_PATH(t, to);
+    return __real_rename(f, t);
+}
+
+int __wrap_access(const char *path, int mode)
+{
+    VFS_PATH(p, path);
+    return __real_access(p, mode);
+}
+
+int __wrap_truncate(const char *path, off_t length)
+{
+    VFS_PATH(p, path);
+    return __real_truncate(p, length);
+}
+
+int __wrap_utime(const char *path, const struct utimbuf *times)
+{
+    VFS_PATH(p, path);
+    return __real_utime(p, times);
+}
+
+int __wrap_statvfs(const char *path, struct statvfs *buf)
+{
+    VFS_PATH(p, path);
+    return __real_statvfs(p, buf);
+}
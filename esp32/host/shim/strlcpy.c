@@ -0,0 +1,18 @@
+/**
+ * @file strlcpy.c
+ * @brief Host shim: strlcpy() as newlib provides it
+ */
+
+#include <string.h>
+#include "host_strlcpy.h"
+
+size_t strlcpy(char *dst, const char *src, size_t size)
+{
+    size_t len = strlen(src);
+    if (size > 0) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
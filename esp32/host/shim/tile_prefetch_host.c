@@ -0,0 +1,38 @@
+/**
+ * @file tile_prefetch_host.c
+ * @brief Host shim: region prefetch when cJSON is not available
+ *
+ * tile_prefetch.c keeps its job file as JSON; without cJSON on the host
+ * the prefetch API reports itself unsupported and idle.
+ */
+
+#include <string.h>
+#include "tiles.h"
+
+esp_err_t tiles_prefetch_init(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t tiles_prefetch(const tile_bbox_t *bbox, int zmin, int zmax, tile_layer_t layer)
+{
+    (void)bbox;
+    (void)zmin;
+    (void)zmax;
+    (void)layer;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t tiles_prefetch_cancel(void)
+{
+    return ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t tiles_prefetch_get_status(tile_prefetch_status_t *status)
+{
+    if (status == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(status, 0, sizeof(*status));
+    return ESP_OK;
+}
@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+"""
+Compile the station's web pages into gzip blobs linked into the firmware.
+
+Run by the geogram_http component at build time; the output is a C file
+with one entry per asset (see components/geogram_http/web_assets.h):
+
+    www/index.html       -> served at /
+    www/<name>           -> served at /assets/<name>
+
+Each asset is minified, gzipped (deterministically, so unchanged assets
+keep their ETag across builds) and tagged with a strong ETag derived from
+the compressed bytes. In HTML files, {{name}} is replaced with the URL of
+asset <name> including its ETag as version, so those assets can be cached
+by browsers indefinitely and still change with the firmware.
+
+Minification is deliberately conservative:
+    .html  leading indentation and line breaks are dropped, so each line
+           continues the previous one exactly (write a needed space at the
+           end of a line, never at the start)
+    .js    the leading license/banner comment and source map references
+           are dropped (the bundles are already minified)
+
+Usage:
+    ./build_web_assets.py components/geogram_http/www -o web_assets.c
+"""
+
+import argparse
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+CONTENT_TYPES = {
+    ".html": "text/html; charset=utf-8",
+    ".js": "application/javascript",
+    ".css": "text/css",
+    ".svg": "image/svg+xml",
+    ".json": "application/json",
+}
+
+
+def minify(name: str, data: bytes) -> bytes:
+    ext = os.path.splitext(name)[1]
+    if ext == ".html":
+        return b"".join(line.lstrip() for line in data.splitlines())
+    if ext == ".js":
+        text = data.decode("utf-8")
+        text = re.sub(r"^\s*/\*.*?\*/\s*", "", text, count=1, flags=re.S)
+        text = re.sub(r"^//# sourceMappingURL=.*$", "", text, flags=re.M)
+        return text.strip().encode("utf-8")
+    return data
+
+
+def url_for(name: str) -> str:
+    return "/" if name == "index.html" else "/assets/" + name
+
+
+def compress(data: bytes) -> bytes:
+    return gzip.compress(data, compresslevel=9, mtime=0)
+
+
+def etag_for(gz: bytes) -> str:
+    return '"' + hashlib.sha256(gz).hexdigest()[:16] + '"'
+
+
+def c_bytes(data: bytes) -> str:
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("    " + " ".join(f"0x{b:02x}," for b in data[i:i + 16]))
+    return "\n".join(lines)
+
+
+def c_string(s: str) -> str:
+    return '"' + s.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def build(src_dir: str) -> list:
+    names = sorted(n for n in os.listdir(src_dir)
+                   if os.path.isfile(os.path.join(src_dir, n)) and not n.startswith("."))
+    for n in names:
+        if os.path.splitext(n)[1] not in CONTENT_TYPES:
+            sys.exit(f"build_web_assets: no content type for {n}")
+
+    # Assets referenced from HTML first, so their versioned URLs are known
+    assets = {}
+    for n in sorted(names, key=lambda n: n.endswith(".html")):
+        with open(os.path.join(src_dir, n), "rb") as f:
+            data = minify(n, f.read())
+        if n.endswith(".html"):
+            def versioned(m):
+                ref = m.group(1).decode()
+                if ref not in assets:
+                    sys.exit(f"build_web_assets: {n} references unknown asset {ref}")
+                tag = assets[ref]["etag"].strip('"')
+                return f"{url_for(ref)}?v={tag}".encode()
+            data = re.sub(rb"\{\{([A-Za-z0-9._-]+)\}\}", versioned, data)
+        gz = compress(data)
+        assets[n] = {
+            "name": n,
+            "url": url_for(n),
+            "type": CONTENT_TYPES[os.path.splitext(n)[1]],
+            "gz": gz,
+            "raw_size": len(data),
+            "etag": etag_for(gz),
+            # Versioned URLs never change content; pages are revalidated
+            "immutable": not n.endswith(".html"),
+        }
+    return [assets[n] for n in names]
+
+
+def write_c(assets: list, out_path: str) -> None:
+    out = [
+        "// Generated by scripts/build_web_assets.py - do not edit",
+        "",
+        '#include "web_assets.h"',
+        "",
+    ]
+    for i, a in enumerate(assets):
+        out.append(f"// {a['name']}: {a['raw_size']} bytes, {len(a['gz'])} gzipped")
+        out.append(f"static const uint8_t s_asset_{i}[] = {{")
+        out.append(c_bytes(a["gz"]))
+        out.append("};")
+        out.append("")
+    out.append("const web_asset_t web_assets[] = {")
+    for i, a in enumerate(assets):
+        out.append(f"    {{ {c_string(a['url'])}, {c_string(a['type'])}, {c_string(a['etag'])},")
+        out.append(f"      s_asset_{i}, sizeof(s_asset_{i}), {'true' if a['immutable'] else 'false'} }},")
+    out.append("};")
+    out.append("")
+    out.append("const size_t web_asset_count = sizeof(web_assets) / sizeof(web_assets[0]);")
+    out.append("")
+
+    text = "\n".join(out)
+    # Leave the file alone when nothing changed, so it is not recompiled
+    if os.path.exists(out_path):
+        with open(out_path) as f:
+            if f.read() == text:
+                return
+    with open(out_path, "w") as f:
+        f.write(text)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compile web assets into a C source file")
+    parser.add_argument("src_dir", help="Directory with index.html and its assets")
+    parser.add_argument("-o", "--output", required=True, help="C file to write")
+    parser.add_argument("-v", "--verbose", action="store_true", help="Print asset sizes")
+    args = parser.parse_args()
+
+    assets = build(args.src_dir)
+    write_c(assets, args.output)
+
+    if args.verbose:
+        for a in assets:
+            print(f"{a['url']}: {a['raw_size']} -> {len(a['gz'])} bytes {a['etag']}")
+
+
+if __name__ == "__main__":
+    main()
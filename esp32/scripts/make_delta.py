@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+"""
+Build a binary delta between two Geogram station firmware images.
+
+The delta is applied on the station by `ota file` / `ota url` (geogram_ota),
+which rebuilds the new image from the running one while writing it to the
+inactive OTA slot. Point releases usually change a few percent of the image,
+so the delta is a fraction of the full firmware size.
+
+Format (see components/geogram_ota/ota_delta.h): a fixed header followed by
+a raw deflate stream of bsdiff-style blocks (add_len, extra_len, seek, diff
+bytes, literal bytes).
+
+Usage:
+    # Delta from the firmware running on the stations to the new build
+    ./make_delta.py old.bin new.bin -o update.gdlt
+
+    # Check that the delta rebuilds new.bin exactly
+    ./make_delta.py old.bin new.bin -o update.gdlt --verify
+"""
+
+import argparse
+import hashlib
+import struct
+import sys
+import zlib
+
+MAGIC = b"GDLT"
+FORMAT_VERSION = 1
+
+# Length of the exact seed match used to find an alignment
+SEED_LEN = 8
+# Candidate source positions remembered per seed
+MAX_CANDIDATES = 8
+# Minimum score (matching bytes minus mismatches) of an accepted alignment
+MIN_SCORE = 24
+# Give up extending an alignment once the score drops this far below its best
+MAX_DROP = 32
+
+
+def build_index(old: bytes) -> dict:
+    """Map every SEED_LEN-byte string of the source to a few of its positions."""
+    index = {}
+    for pos in range(0, len(old) - SEED_LEN + 1):
+        seed = old[pos:pos + SEED_LEN]
+        positions = index.get(seed)
+        if positions is None:
+            index[seed] = [pos]
+        elif len(positions) < MAX_CANDIDATES:
+            positions.append(pos)
+    return index
+
+
+def extend(old: bytes, new: bytes, src: int, dst: int) -> tuple:
+    """
+    Extend an approximate match of new[dst:] against old[src:].
+
+    Mismatching bytes are allowed (they end up in the diff stream as small
+    values, which deflate compresses well), as bsdiff does for code that
+    moved and had its addresses adjusted. Returns (length, score) of the
+    best-scoring prefix.
+    """
+    score = best = best_len = 0
+    k = 0
+    limit = min(len(old) - src, len(new) - dst)
+    while k < limit:
+        score += 1 if old[src + k] == new[dst + k] else -1
+        k += 1
+        if score > best:
+            best, best_len = score, k
+        elif score < best - MAX_DROP:
+            break
+    return best_len, best
+
+
+def diff(old: bytes, new: bytes) -> list:
+    """Return blocks as (source position, add length, extra bytes)."""
+    index = build_index(old)
+    blocks = []
+    cur_src, cur_add, extra = 0, 0, bytearray()
+    pos = 0
+
+    while pos < len(new):
+        best_len = best_score = 0
+        best_src = None
+
+        # Same alignment as the previous match, after the bytes that changed
+        candidates = [cur_src + cur_add + len(extra)]
+        candidates += index.get(new[pos:pos + SEED_LEN], [])
+        for src in candidates:
+            if src >= len(old):
+                continue
+            length, score = extend(old, new, src, pos)
+            if score > best_score:
+                best_len, best_score, best_src = length, score, src
+
+        if best_src is not None and best_score >= MIN_SCORE:
+            blocks.append((cur_src, cur_add, bytes(extra)))
+            cur_src, cur_add, extra = best_src, best_len, bytearray()
+            pos += best_len
+        else:
+            extra.append(new[pos])
+            pos += 1
+
+    blocks.append((cur_src, cur_add, bytes(extra)))
+    return blocks
+
+
+def encode(old: bytes, new: bytes, blocks: list) -> bytes:
+    header = MAGIC + struct.pack("<II", FORMAT_VERSION, len(old)) + hashlib.sha256(old).digest()
+    header += struct.pack("<I", len(new)) + hashlib.sha256(new).digest()
+
+    deflate = zlib.compressobj(9, zlib.DEFLATED, -15)
+    body = bytearray()
+    out = 0
+    for i, (src, add_len, extra) in enumerate(blocks):
+        # Source cursor after this block must land on the next block's source
+        next_src = blocks[i + 1][0] if i + 1 < len(blocks) else src + add_len
+        seek = next_src - (src + add_len)
+        body += deflate.compress(struct.pack("<IIi", add_len, len(extra), seek))
+        diff_bytes = bytes((new[out + k] - old[src + k]) & 0xFF for k in range(add_len))
+        body += deflate.compress(diff_bytes)
+        body += deflate.compress(extra)
+        out += add_len + len(extra)
+    body += deflate.flush()
+
+    assert out == len(new)
+    return header + bytes(body)
+
+
+def apply(old: bytes, delta: bytes) -> bytes:
+    """Reference decoder, mirrors ota_delta.c."""
+    if delta[:4] != MAGIC:
+        raise ValueError("not a delta")
+    version, source_size = struct.unpack_from("<II", delta, 4)
+    target_size, = struct.unpack_from("<I", delta, 44)
+    if version != FORMAT_VERSION or source_size != len(old):
+        raise ValueError("unsupported delta or wrong source")
+    if hashlib.sha256(old).digest() != delta[12:44]:
+        raise ValueError("delta was made for another source image")
+
+    body = zlib.decompress(delta[80:], -15)
+    new = bytearray()
+    src = pos = 0
+    while pos < len(body):
+        add_len, extra_len, seek = struct.unpack_from("<IIi", body, pos)
+        pos += 12
+        new += bytes((old[src + k] + body[pos + k]) & 0xFF for k in range(add_len))
+        pos += add_len
+        new += body[pos:pos + extra_len]
+        pos += extra_len
+        src += add_len + seek
+
+    if len(new) != target_size or hashlib.sha256(new).digest() != delta[48:80]:
+        raise ValueError("rebuilt image does not match the target")
+    return bytes(new)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Build a Geogram firmware delta (GDLT)")
+    parser.add_argument("old", help="Firmware image running on the stations")
+    parser.add_argument("new", help="New firmware image")
+    parser.add_argument("-o", "--output", required=True, help="Delta file to write")
+    parser.add_argument("--verify", action="store_true", help="Rebuild the new image from the delta")
+    args = parser.parse_args()
+
+    with open(args.old, "rb") as f:
+        old = f.read()
+    with open(args.new, "rb") as f:
+        new = f.read()
+
+    blocks = diff(old, new)
+    delta = encode(old, new, blocks)
+
+    with open(args.output, "wb") as f:
+        f.write(delta)
+
+    print(f"{args.output}: {len(delta)} bytes, {len(blocks)} blocks "
+          f"({100.0 * len(delta) / len(new):.1f}% of {len(new)} bytes)")
+    print(f"Target SHA-256: {hashlib.sha256(new).hexdigest()}")
+    print(f"Delta SHA-256:  {hashlib.sha256(delta).hexdigest()}")
+
+    if args.verify:
+        if apply(old, delta) != new:
+            print("Verification FAILED")
+            sys.exit(1)
+        print("Verification OK")
+
+
+if __name__ == "__main__":
+    main()
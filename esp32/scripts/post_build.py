@@ -5,6 +5,27 @@ import filecmp
 import json
 from datetime import datetime, timezone
 
+def smallest_app_slot(env):
+    """
+    Size in bytes of the smallest app partition in the board's partition table.
+    """
+    table = env.GetProjectOption("board_build.partitions", "partitions.csv")
+    path = os.path.join(env.subst("$PROJECT_DIR"), table)
+    sizes = []
+    with open(path) as f:
+        for line in f:
+            fields = [field.strip() for field in line.split("#")[0].split(",")]
+            if len(fields) >= 5 and fields[1] == "app":
+                size = fields[4].upper()
+                if size.endswith("K"):
+                    sizes.append(int(size[:-1], 0) * 1024)
+                elif size.endswith("M"):
+                    sizes.append(int(size[:-1], 0) * 1024 * 1024)
+                else:
+                    sizes.append(int(fields[4], 0))
+    return min(sizes) if sizes else None
+
+
 def post_build_action(source, target, env):
     """
     Post-build script to rename firmware to custom name and sync to flasher downloads.
@@ -16,6 +37,15 @@ def post_build_action(source, target, env):
     bin_src = os.path.join(build_dir, "firmware.bin")
     elf_src = os.path.join(build_dir, "firmware.elf")
 
+    # An image larger than an OTA slot would flash over USB but never update
+    slot = smallest_app_slot(env)
+    if slot and os.path.exists(bin_src):
+        size = os.path.getsize(bin_src)
+        print(f"[Geogram] Image {size} bytes, {size * 100 // slot}% of the {slot} byte app slot")
+        if size > slot:
+            print(f"[Geogram] Error: image exceeds the app slot by {size - slot} bytes")
+            return 1
+
     # Destination files
     output_dir = os.path.join(env.subst("$PROJECT_DIR"), "firmware")
     os.makedirs(output_dir, exist_ok=True)
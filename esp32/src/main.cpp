@@ -32,6 +32,9 @@
 // Plain log helper (no ANSI)
 #include "geogram_log_plain.h"
 
+// Firmware update (A/B slots, boot confirmation)
+#include "geogram_ota.h"
+
 // Mesh networking (optional, enabled via CONFIG_GEOGRAM_MESH_ENABLED)
 #ifdef CONFIG_GEOGRAM_MESH_ENABLED
 #include "mesh_bsp.h"
@@ -55,6 +58,7 @@
     #include "sdcard.h"
     #include "tiles.h"
     #include "updates.h"
+    #include "file_cache.h"
     #include "ftp_server.h"
 #elif BOARD_MODEL == MODEL_ESP32C3_MINI
     #include "model_config.h"
@@ -750,6 +754,27 @@ static void rtc_task(void *pvParameter)
 
 #endif  // BOARD_MODEL == MODEL_ESP32S3_EPAPER_1IN54
 
+/**
+ * @brief Health check a new firmware must pass before it is kept
+ *
+ * Serving HTTP and reachable: on a network, running its own access point
+ * or joined to the mesh.
+ */
+static bool firmware_healthy(void)
+{
+    if (!http_server_is_running()) {
+        return false;
+    }
+#ifdef CONFIG_GEOGRAM_MESH_ENABLED
+    if (geogram_mesh_is_connected()) {
+        return true;
+    }
+#endif
+    geogram_wifi_status_t wifi = geogram_wifi_get_status();
+    return wifi == GEOGRAM_WIFI_STATUS_GOT_IP || wifi == GEOGRAM_WIFI_STATUS_AP_STARTED ||
+           wifi == GEOGRAM_WIFI_STATUS_AP_STACONNECTED;
+}
+
 extern "C" void app_main(void)
 {
     ESP_LOGI(TAG, "=====================================");
@@ -770,6 +795,12 @@ extern "C" void app_main(void)
 
     ESP_LOGI(TAG, "Board initialized successfully");
 
+    // A freshly installed firmware must stay up and healthy before it is kept
+    ret = geogram_ota_init(firmware_healthy);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "OTA init failed: %s", esp_err_to_name(ret));
+    }
+
 #if BOARD_MODEL == MODEL_ESP32S3_EPAPER_1IN54
     // Initialize tile cache if SD card is available
     if (sdcard_is_mounted()) {
@@ -787,6 +818,14 @@ extern "C" void app_main(void)
         } else {
             ESP_LOGW(TAG, "Update mirror init failed: %s", esp_err_to_name(ret));
         }
+
+        // Keep relayed chat files for receivers that come later
+        ret = file_cache_init();
+        if (ret == ESP_OK) {
+            ESP_LOGI(TAG, "Chat file cache initialized");
+        } else {
+            ESP_LOGW(TAG, "Chat file cache init failed: %s", esp_err_to_name(ret));
+        }
     }
 #endif
 